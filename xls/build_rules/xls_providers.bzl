@@ -150,6 +150,8 @@ SCHEDULING_FIELDS = {
                        "scheduling.",
     "pipeline_stages": "Optional(string): The number of pipeline stages.",
     "delay_model": "Optional(string) Delay model used in codegen.",
+    "estimate_cache_path": "Optional(string) File of memoized delay " +
+                           "estimates to load at startup and save at exit.",
     "clock_margin_percent": "The percentage of clock period to set aside as " +
                             "a margin to ensure timing is met.",
     "period_relaxation_percent": "The percentage of clock period that will " +
@@ -212,6 +214,7 @@ SCHEDULING_FIELDS = {
     "fdo_default_driver_cell": "Cell to assume is driving primary inputs.",
     "fdo_default_load": "Cell to assume is being driven by primary outputs.",
     "multi_proc": "If true, schedule all procs and codegen them all.",
+    "scheduling_threads": "Number of threads to use to schedule procs.",
     "simulation_macro_name": "Name of the Verilog macro used to guard simulation-only " +
                              "constructs. If prefixed with `!` the polarity of the guard " +
                              "is inverted.",
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <string>
 #include <tuple>
@@ -23,6 +24,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
@@ -31,24 +33,70 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
+namespace {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
-  // Leaf node 0.
-  nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
-                           /*p=*/1));
-  // Leaf node 1.
+// Initial and maximum number of entries in the computed table. The table
+// starts small so that the many small BDDs built for individual functions
+// stay cheap, and doubles as the number of nodes grows.
+constexpr int64_t kInitialComputedTableSize = 1 << 10;
+constexpr int64_t kMaxComputedTableSize = 1 << 20;
+
+}  // namespace
+
+std::string BddStats::ToString() const {
+  return absl::StrFormat(
+      "{ nodes: %d, peak nodes: %d, variables: %d, garbage collections: %d, "
+      "nodes freed: %d, computed table size: %d, computed table hits: %d/%d, "
+      "reorderings: %d, reordering swaps: %d, memory: %d bytes }",
+      node_count, peak_node_count, variable_count, garbage_collections,
+      nodes_freed, computed_table_size, computed_table_hits,
+      computed_table_lookups, reorderings, reordering_swaps, memory_bytes);
+}
+
+BinaryDecisionDiagram::BinaryDecisionDiagram()
+    : computed_table_(kInitialComputedTableSize) {
+  // The terminal node; one() refers to it and zero() to its complement.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
+  peak_node_count_ = 1;
+}
+
+BddNodeIndex BinaryDecisionDiagram::AllocateNode(const BddNode& node) {
+  int32_t slot;
+  if (free_slots_.empty()) {
+    slot = nodes_.size();
+    nodes_.push_back(node);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    nodes_[slot] = node;
+  }
+  peak_node_count_ = std::max(peak_node_count_, size());
+  if (size() > computed_table_.size() &&
+      computed_table_.size() < kMaxComputedTableSize) {
+    // Entries are placed by hash, so they cannot be kept when resizing.
+    computed_table_.assign(2 * computed_table_.size(), ComputedEntry());
+  }
+  if (reordering_) {
+    if (slot >= reference_counts_.size()) {
+      reference_counts_.resize(slot + 1);
+    }
+    reference_counts_[slot] = 0;
+    AddReference(node.high);
+    AddReference(node.low);
+    variable_nodes_[node.variable.value()].push_back(slot);
+  }
+  return MakeIndex(slot, /*complemented=*/false);
 }
 
 BddNodeIndex BinaryDecisionDiagram::CreateVariableBaseNode(BddVariable var) {
   const BddNodeIndex high = one();
   const BddNodeIndex low = zero();
   const int32_t paths = 2;
-  nodes_.emplace_back(var, high, low, paths);
-  return BddNodeIndex(nodes_.size() - 1);
+  return AllocateNode(BddNode(var, high, low, paths));
 }
 
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
@@ -58,6 +106,13 @@ BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
     return low;
   }
 
+  // Only store nodes whose high child is not complemented, so that each
+  // expression has a unique representation: (var ? !h : !l) is stored as the
+  // complement of (var ? h : l).
+  if (IsComplemented(high)) {
+    return Complement(GetOrCreateNode(var, Complement(high), Complement(low)));
+  }
+
   // If low == 0 and high == 1, then this is a variable base node and is kept
   // in the variable_base_nodes_ vector.
   if (low == zero() && high == one()) {
@@ -73,9 +128,7 @@ BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
         std::min(static_cast<int64_t>(GetNode(low).path_count) +
                      GetNode(high).path_count,
                  static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-    nodes_.emplace_back(var, high, low, paths);
-    BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
-    ctor(key, node_index);
+    ctor(key, AllocateNode(BddNode(var, high, low, paths)));
   });
   return it->second;
 }
@@ -87,13 +140,21 @@ BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
   }
 
   const BddNode& node = GetNode(expr);
-  CHECK_LE(var, node.variable);
+  CHECK_LE(variable_levels_[var.value()], GetLevel(expr));
   if (node.variable == var) {
     return value ? node.high : node.low;
   }
   return expr;
 }
 
+int64_t BinaryDecisionDiagram::ComputedTableSlot(BddNodeIndex cond,
+                                                 BddNodeIndex if_true,
+                                                 BddNodeIndex if_false) const {
+  // The table size is a power of two.
+  return absl::HashOf(cond.value(), if_true.value(), if_false.value()) &
+         (computed_table_.size() - 1);
+}
+
 BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                                BddNodeIndex if_true,
                                                BddNodeIndex if_false) {
@@ -103,32 +164,67 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   if (cond == zero()) {
     return if_false;
   }
+  // Within the branches the value of the condition is known.
+  if (if_true == cond) {
+    if_true = one();
+  } else if (if_true == Complement(cond)) {
+    if_true = zero();
+  }
+  if (if_false == cond) {
+    if_false = zero();
+  } else if (if_false == Complement(cond)) {
+    if_false = one();
+  }
   if (if_true == one() && if_false == zero()) {
     return cond;
   }
+  if (if_true == zero() && if_false == one()) {
+    return Complement(cond);
+  }
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+
+  // Normalize the expression so that equivalent expressions share an entry in
+  // the computed table: the condition and the if-true branch are made
+  // non-complemented using the identities
+  //
+  //   ite(!c, t, e) = ite(c, e, t)
+  //   ite(c, !t, !e) = !ite(c, t, e)
+  if (IsComplemented(cond)) {
+    cond = Complement(cond);
+    std::swap(if_true, if_false);
+  }
+  const bool complement_result = IsComplemented(if_true);
+  if (complement_result) {
+    if_true = Complement(if_true);
+    if_false = Complement(if_false);
+  }
+
+  ++computed_table_lookups_;
+  const ComputedEntry& entry =
+      computed_table_[ComputedTableSlot(cond, if_true, if_false)];
+  if (entry.cond == cond && entry.if_true == if_true &&
+      entry.if_false == if_false) {
+    ++computed_table_hits_;
+    return complement_result ? Complement(entry.result) : entry.result;
   }
 
   // The expression is non-trivial and has not been computed before. Recursively
   // decompose the expression by peeling away the first variable and performing
   // a Shannon decomposition.
 
-  // First, find the lowest-index variable amongst all expressions. In all paths
-  // through the BDD the variable indices are strictly increasing.
-  BddVariable min_var = GetNode(cond).variable;
+  // First, find the lowest-level variable amongst all expressions. In all paths
+  // through the BDD the variable levels are strictly increasing.
+  int64_t min_level = GetLevel(cond);
   // Only non-leaf nodes (not zero or one) have associated variables.
   if (if_true != zero() && if_true != one()) {
-    min_var = std::min(min_var, GetNode(if_true).variable);
+    min_level = std::min(min_level, GetLevel(if_true));
   }
   if (if_false != zero() && if_false != one()) {
-    min_var = std::min(min_var, GetNode(if_false).variable);
+    min_level = std::min(min_level, GetLevel(if_false));
   }
+  const BddVariable min_var = level_variables_[min_level];
 
   // Perform a Shannon expansion about the variable where Shannon expansion is
   // the identity:
@@ -142,13 +238,285 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
 
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
   BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
-  return expr;
+  // The recursive calls may have resized the table, so find the slot again.
+  computed_table_[ComputedTableSlot(cond, if_true, if_false)] = ComputedEntry{
+      .cond = cond, .if_true = if_true, .if_false = if_false, .result = expr};
+  return complement_result ? Complement(expr) : expr;
+}
+
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  std::vector<bool> live(nodes_.size(), false);
+  std::vector<int32_t> worklist;
+  auto mark = [&](BddNodeIndex index) {
+    int32_t slot = Slot(index);
+    CHECK_NE(nodes_[slot].path_count, 0) << "Root refers to a freed node";
+    if (!live[slot]) {
+      live[slot] = true;
+      worklist.push_back(slot);
+    }
+  };
+  mark(one());
+  for (BddNodeIndex variable : variable_base_nodes_) {
+    mark(variable);
+  }
+  for (BddNodeIndex root : roots) {
+    mark(root);
+  }
+  while (!worklist.empty()) {
+    int32_t slot = worklist.back();
+    worklist.pop_back();
+    if (slot == 0) {
+      continue;
+    }
+    mark(nodes_[slot].high);
+    mark(nodes_[slot].low);
+  }
+
+  int64_t freed = 0;
+  for (int32_t slot = 1; slot < nodes_.size(); ++slot) {
+    BddNode& node = nodes_[slot];
+    if (live[slot] || node.path_count == 0) {
+      continue;
+    }
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    node = BddNode();
+    free_slots_.push_back(slot);
+    ++freed;
+  }
+  // Reuse the lowest slots first to keep the live nodes dense.
+  std::sort(free_slots_.begin(), free_slots_.end(), std::greater<int32_t>());
+
+  // The computed table may refer to freed nodes.
+  std::fill(computed_table_.begin(), computed_table_.end(), ComputedEntry());
+
+  ++garbage_collections_;
+  nodes_freed_ += freed;
+  VLOG(2) << absl::StreamFormat(
+      "BDD garbage collection freed %d nodes; %d live", freed, size());
+  return freed;
+}
+
+void BinaryDecisionDiagram::RemoveReference(BddNodeIndex expr) {
+  if (--reference_counts_[Slot(expr)] != 0 || Slot(expr) == 0) {
+    return;
+  }
+  std::vector<int32_t> worklist = {Slot(expr)};
+  while (!worklist.empty()) {
+    int32_t slot = worklist.back();
+    worklist.pop_back();
+    BddNode& node = nodes_[slot];
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    for (BddNodeIndex child : {node.high, node.low}) {
+      if (--reference_counts_[Slot(child)] == 0 && Slot(child) != 0) {
+        worklist.push_back(Slot(child));
+      }
+    }
+    node = BddNode();
+    free_slots_.push_back(slot);
+    ++nodes_freed_;
+  }
+}
+
+absl::Span<const int32_t> BinaryDecisionDiagram::GetVariableNodes(
+    BddVariable variable) {
+  std::vector<int32_t>& slots = variable_nodes_[variable.value()];
+  std::sort(slots.begin(), slots.end());
+  slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+  std::erase_if(slots, [&](int32_t slot) {
+    return nodes_[slot].path_count == 0 || nodes_[slot].variable != variable;
+  });
+  return slots;
+}
+
+void BinaryDecisionDiagram::SwapLevels(int64_t level) {
+  const BddVariable x = level_variables_[level];
+  const BddVariable y = level_variables_[level + 1];
+  auto depends_on_y = [&](BddNodeIndex expr) {
+    return Slot(expr) != 0 && nodes_[Slot(expr)].variable == y;
+  };
+  // Returns the cofactors of `expr` with respect to `y`.
+  auto cofactors = [&](BddNodeIndex expr) {
+    if (!depends_on_y(expr)) {
+      return std::make_pair(expr, expr);
+    }
+    BddNode node = GetNode(expr);
+    return std::make_pair(node.high, node.low);
+  };
+
+  // The nodes labelled with `x` which do not depend on `y` simply move down a
+  // level. The others are rewritten in place as nodes labelled with `y`, so
+  // that the indices referring to them remain valid.
+  absl::Span<const int32_t> live_x_nodes = GetVariableNodes(x);
+  std::vector<int32_t> x_nodes(live_x_nodes.begin(), live_x_nodes.end());
+  std::vector<int32_t> y_dependent_nodes;
+  variable_nodes_[x.value()].clear();
+  for (int32_t slot : x_nodes) {
+    if (depends_on_y(nodes_[slot].high) || depends_on_y(nodes_[slot].low)) {
+      y_dependent_nodes.push_back(slot);
+    } else {
+      variable_nodes_[x.value()].push_back(slot);
+    }
+  }
+
+  std::swap(level_variables_[level], level_variables_[level + 1]);
+  variable_levels_[x.value()] = level + 1;
+  variable_levels_[y.value()] = level;
+
+  for (int32_t slot : y_dependent_nodes) {
+    const BddNode node = nodes_[slot];
+    auto [f11, f10] = cofactors(node.high);
+    auto [f01, f00] = cofactors(node.low);
+    // The high child of `node` and hence `f11` are not complemented, so
+    // neither is `high` and the rewritten node remains canonical.
+    BddNodeIndex high = GetOrCreateNode(x, f11, f01);
+    BddNodeIndex low = GetOrCreateNode(x, f10, f00);
+    DCHECK(!IsComplemented(high));
+    AddReference(high);
+    AddReference(low);
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    nodes_[slot] = BddNode(y, high, low, node.path_count);
+    node_map_.emplace(std::make_tuple(y, high, low),
+                      MakeIndex(slot, /*complemented=*/false));
+    variable_nodes_[y.value()].push_back(slot);
+    RemoveReference(node.high);
+    RemoveReference(node.low);
+  }
+  ++reordering_swaps_;
+}
+
+void BinaryDecisionDiagram::SiftVariable(BddVariable variable,
+                                         double max_growth,
+                                         int64_t* swap_budget) {
+  const int64_t bottom = level_variables_.size() - 1;
+  const int64_t size_limit = static_cast<int64_t>(size() * max_growth);
+  int64_t best_size = size();
+  int64_t best_level = GetLevel(variable);
+  auto move_to = [&](int64_t target) {
+    while (GetLevel(variable) < target) {
+      SwapLevels(GetLevel(variable));
+      --*swap_budget;
+    }
+    while (GetLevel(variable) > target) {
+      SwapLevels(GetLevel(variable) - 1);
+      --*swap_budget;
+    }
+  };
+
+  // Move the variable towards the nearer end first, then towards the other
+  // end, giving up on a direction once the BDD grows too much.
+  const bool down_first = GetLevel(variable) > bottom / 2;
+  for (bool down : {down_first, !down_first}) {
+    move_to(best_level);
+    while (*swap_budget > 0 &&
+           (down ? GetLevel(variable) < bottom : GetLevel(variable) > 0)) {
+      move_to(GetLevel(variable) + (down ? 1 : -1));
+      if (size() < best_size) {
+        best_size = size();
+        best_level = GetLevel(variable);
+      }
+      if (size() > size_limit) {
+        break;
+      }
+    }
+  }
+  move_to(best_level);
+}
+
+int64_t BinaryDecisionDiagram::ReorderVariables(
+    absl::Span<const BddNodeIndex> roots, const BddReorderingOptions& options) {
+  GarbageCollect(roots);
+  const int64_t size_before = size();
+
+  reordering_ = true;
+  reference_counts_.assign(nodes_.size(), 0);
+  variable_nodes_.assign(variable_count(), {});
+  // The terminal node is never freed.
+  reference_counts_[0] = 1;
+  for (int32_t slot = 1; slot < nodes_.size(); ++slot) {
+    const BddNode& node = nodes_[slot];
+    if (node.path_count == 0) {
+      continue;
+    }
+    AddReference(node.high);
+    AddReference(node.low);
+    variable_nodes_[node.variable.value()].push_back(slot);
+  }
+  for (BddNodeIndex variable : variable_base_nodes_) {
+    AddReference(variable);
+  }
+  for (BddNodeIndex root : roots) {
+    AddReference(root);
+  }
+
+  // Sift the variables labelling the most nodes first.
+  std::vector<std::pair<int64_t, BddVariable>> variables;
+  variables.reserve(variable_count());
+  for (int64_t i = 0; i < variable_count(); ++i) {
+    BddVariable variable(i);
+    variables.push_back({GetVariableNodes(variable).size(), variable});
+  }
+  std::stable_sort(
+      variables.begin(), variables.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+  if (variables.size() > options.max_variables) {
+    variables.resize(options.max_variables);
+  }
+  int64_t swap_budget = options.max_swaps;
+  for (const auto& [_, variable] : variables) {
+    if (swap_budget <= 0) {
+      break;
+    }
+    SiftVariable(variable, options.max_growth, &swap_budget);
+  }
+
+  // Path counts depend on the variable order, so recompute them from the
+  // bottom level up.
+  for (int64_t level = level_variables_.size() - 1; level >= 0; --level) {
+    for (int32_t slot : GetVariableNodes(level_variables_[level])) {
+      BddNode& node = nodes_[slot];
+      node.path_count = static_cast<int32_t>(
+          std::min(static_cast<int64_t>(GetNode(node.high).path_count) +
+                       GetNode(node.low).path_count,
+                   static_cast<int64_t>(std::numeric_limits<int32_t>::max())));
+    }
+  }
+
+  reordering_ = false;
+  reference_counts_.clear();
+  variable_nodes_.clear();
+  // The computed table may refer to nodes freed while reordering.
+  std::fill(computed_table_.begin(), computed_table_.end(), ComputedEntry());
+
+  ++reorderings_;
+  VLOG(2) << absl::StreamFormat("BDD reordering reduced %d nodes to %d",
+                                size_before, size());
+  return size();
+}
+
+BddStats BinaryDecisionDiagram::GetStats() const {
+  return BddStats{
+      .node_count = size(),
+      .peak_node_count = peak_node_count_,
+      .variable_count = variable_count(),
+      .garbage_collections = garbage_collections_,
+      .nodes_freed = nodes_freed_,
+      .computed_table_size = static_cast<int64_t>(computed_table_.size()),
+      .computed_table_lookups = computed_table_lookups_,
+      .computed_table_hits = computed_table_hits_,
+      .reorderings = reorderings_,
+      .reordering_swaps = reordering_swaps_,
+      .memory_bytes = static_cast<int64_t>(
+          nodes_.capacity() * sizeof(BddNode) +
+          free_slots_.capacity() * sizeof(int32_t) +
+          variable_base_nodes_.capacity() * sizeof(BddNodeIndex) +
+          variable_levels_.capacity() * sizeof(int32_t) +
+          level_variables_.capacity() * sizeof(BddVariable) +
+          computed_table_.capacity() * sizeof(ComputedEntry) +
+          node_map_.capacity() *
+              (sizeof(std::pair<const NodeKey, BddNodeIndex>) + 1)),
+  };
 }
 
 template <typename T>
@@ -166,6 +534,11 @@ BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   // comment in NewVariables for details.
   ReserveVector(variable_base_nodes_.size() + 1, variable_base_nodes_);
   variable_base_nodes_.push_back(index);
+  // New variables are placed below all existing ones.
+  ReserveVector(variable_levels_.size() + 1, variable_levels_);
+  ReserveVector(level_variables_.size() + 1, level_variables_);
+  variable_levels_.push_back(level_variables_.size());
+  level_variables_.push_back(var);
   return index;
 }
 
@@ -189,20 +562,25 @@ std::vector<BddNodeIndex> BinaryDecisionDiagram::NewVariables(int64_t count) {
   // [0] https://en.cppreference.com/w/cpp/container/vector/reserve
   ReserveVector(nodes_.size() + count, nodes_);
   ReserveVector(variable_base_nodes_.size() + count, variable_base_nodes_);
+  ReserveVector(variable_levels_.size() + count, variable_levels_);
+  ReserveVector(level_variables_.size() + count, level_variables_);
 
   std::vector<BddNodeIndex> indexes;
   indexes.reserve(count);
   int64_t next_var = variable_base_nodes_.size();
   for (int64_t i = 0; i < count; ++i) {
-    BddNodeIndex index = CreateVariableBaseNode(BddVariable(next_var++));
+    BddVariable var(next_var++);
+    BddNodeIndex index = CreateVariableBaseNode(var);
     variable_base_nodes_.push_back(index);
+    variable_levels_.push_back(level_variables_.size());
+    level_variables_.push_back(var);
     indexes.push_back(index);
   }
   return indexes;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
-  return IfThenElse(expr, zero(), one());
+  return Complement(expr);
 }
 
 BddNodeIndex BinaryDecisionDiagram::Or(BddNodeIndex a, BddNodeIndex b) {
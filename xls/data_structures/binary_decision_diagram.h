@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -34,15 +35,31 @@ namespace xls {
 //   K.S. Brace, R.L. Rudell, and R.E. Bryant,
 //   "Efficient Implementation of a BDD package"
 //   https://ieeexplore.ieee.org/document/114826
+//
+// As in that paper, the BDD uses complement edges: an expression and its
+// inverse share the same nodes, so Not() is free and the BDD holds roughly
+// half as many nodes as one without complement edges. If-then-else results
+// are memoized in a fixed-size lossy table rather than an unbounded map, and
+// nodes which are no longer referenced can be reclaimed with GarbageCollect().
+//
+// Variables are ordered by their level, which is initially the order in which
+// they were created. The size of a BDD depends heavily on the variable order,
+// and ReorderVariables() improves the order in place by sifting:
+//   R. Rudell, "Dynamic variable ordering for ordered binary decision diagrams"
+//   https://ieeexplore.ieee.org/document/580029
 
 // For efficiency variables and nodes are referred to by indices into vector
-// data members in the BDD.
+// data members in the BDD. A BddNodeIndex also carries a flag (its low bit)
+// indicating whether it refers to the node's expression or to its complement,
+// so BddNodeIndex values should be treated as opaque.
 XLS_DEFINE_STRONG_INT_TYPE(BddVariable, int32_t);
 XLS_DEFINE_STRONG_INT_TYPE(BddNodeIndex, int32_t);
 
 // A node in the BDD. The node is associated with a single variable and has
 // children corresponding to when the variable is true (high) and when it is
-// false (low).
+// false (low). As returned by BinaryDecisionDiagram::GetNode the children are
+// those of the expression referred to by the given index, i.e., they are
+// already complemented if the index refers to a complemented node.
 struct BddNode {
   BddNode() : variable(0), high(0), low(0), path_count(0) {}
   BddNode(BddVariable v, BddNodeIndex h, BddNodeIndex l, int32_t p)
@@ -58,6 +75,51 @@ struct BddNode {
   int32_t path_count;
 };
 
+// Statistics about the size and memory use of a BDD.
+struct BddStats {
+  // Number of live nodes including the terminal and the variable base nodes.
+  int64_t node_count = 0;
+  // Largest number of nodes which were live at the same time.
+  int64_t peak_node_count = 0;
+  int64_t variable_count = 0;
+
+  // Number of garbage collections and the total number of nodes they freed.
+  int64_t garbage_collections = 0;
+  int64_t nodes_freed = 0;
+
+  // Number of entries in the computed (if-then-else) table, and the number of
+  // lookups in it and how many of them found the result.
+  int64_t computed_table_size = 0;
+  int64_t computed_table_lookups = 0;
+  int64_t computed_table_hits = 0;
+
+  // Number of times the variables were reordered and the total number of
+  // swaps of adjacent levels performed.
+  int64_t reorderings = 0;
+  int64_t reordering_swaps = 0;
+
+  // Approximate number of bytes of memory held by the BDD.
+  int64_t memory_bytes = 0;
+
+  std::string ToString() const;
+};
+
+// Options for BinaryDecisionDiagram::ReorderVariables.
+struct BddReorderingOptions {
+  // The maximum number of variables to sift. Variables labelling the most nodes
+  // are sifted first.
+  int64_t max_variables = 256;
+
+  // The maximum total number of swaps of adjacent levels. Each swap costs time
+  // proportional to the number of nodes in the two levels, so this bounds the
+  // time spent reordering.
+  int64_t max_swaps = 100'000;
+
+  // A variable stops moving in one direction once the BDD has grown by more
+  // than this factor compared to its size before the variable was moved.
+  double max_growth = 1.2;
+};
+
 class BinaryDecisionDiagram {
  public:
   // Creates an empty BDD. Initialize the BDD contains only the nodes
@@ -84,9 +146,10 @@ class BinaryDecisionDiagram {
   // Returns the expression a -> b (i.e., (!a || b))
   BddNodeIndex Implies(BddNodeIndex a, BddNodeIndex b);
 
-  // Returns the leaf node corresponding to zero or one.
-  BddNodeIndex zero() const { return BddNodeIndex(0); }
-  BddNodeIndex one() const { return BddNodeIndex(1); }
+  // Returns the leaf node corresponding to zero or one. There is a single
+  // terminal node; zero is its complement.
+  BddNodeIndex zero() const { return BddNodeIndex(1); }
+  BddNodeIndex one() const { return BddNodeIndex(0); }
 
   // Evaluates the given expression with the given variable values. The keys in
   // the map are the *node* indices of the respective variable (value returned
@@ -97,16 +160,27 @@ class BinaryDecisionDiagram {
       const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const;
 
   // Returns the BDD node with the given index.
-  const BddNode& GetNode(BddNodeIndex node_index) const {
-    return nodes_.at(node_index.value());
+  BddNode GetNode(BddNodeIndex node_index) const {
+    BddNode node = nodes_.at(Slot(node_index));
+    if (IsComplemented(node_index) && Slot(node_index) != 0) {
+      node.high = Complement(node.high);
+      node.low = Complement(node.low);
+    }
+    return node;
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of live nodes in the graph.
+  int64_t size() const { return nodes_.size() - free_slots_.size(); }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return variable_base_nodes_.size(); }
 
+  // Returns the position of the given variable in the variable order. Level
+  // zero is closest to the root of every expression.
+  int64_t GetLevel(BddVariable variable) const {
+    return variable_levels_.at(variable.value());
+  }
+
   // Returns the number of paths in the given expression.
   int64_t path_count(BddNodeIndex expr) const {
     return GetNode(expr).path_count;
@@ -128,7 +202,38 @@ class BinaryDecisionDiagram {
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Frees every node which is not reachable from `roots` or from a variable,
+  // and returns the number of nodes freed. The remaining nodes keep their
+  // indices, while the indices of freed nodes are reused by later operations,
+  // so any BddNodeIndex not reachable from `roots` is invalid after this call.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
+  // Reorders the variables by sifting to reduce the number of nodes. First
+  // frees the nodes not reachable from `roots` as GarbageCollect does; every
+  // index reachable from `roots` keeps its value and still refers to the same
+  // expression afterwards, although its path count may change. Returns the
+  // number of live nodes after reordering.
+  int64_t ReorderVariables(
+      absl::Span<const BddNodeIndex> roots,
+      const BddReorderingOptions& options = BddReorderingOptions());
+
+  // Returns statistics about the size and memory use of the BDD.
+  BddStats GetStats() const;
+
  private:
+  // Helpers for decoding and building node indices. The low bit of an index
+  // is the complement flag; the remaining bits are the slot of the node in
+  // `nodes_`.
+  static int32_t Slot(BddNodeIndex index) { return index.value() >> 1; }
+  static bool IsComplemented(BddNodeIndex index) {
+    return (index.value() & 1) != 0;
+  }
+  static BddNodeIndex Complement(BddNodeIndex index) {
+    return BddNodeIndex(index.value() ^ 1);
+  }
+  static BddNodeIndex MakeIndex(int32_t slot, bool complemented) {
+    return BddNodeIndex((slot << 1) | (complemented ? 1 : 0));
+  }
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
                          std::vector<std::string>* terms,
@@ -151,12 +256,49 @@ class BinaryDecisionDiagram {
   // Creates the base BddNode corresponding to the given variable.
   BddNodeIndex CreateVariableBaseNode(BddVariable var);
 
+  // Stores `node` in a free slot and returns a (non-complemented) index to it.
+  BddNodeIndex AllocateNode(const BddNode& node);
+
+  // Returns the slot of the computed table in which the given if-then-else
+  // expression is cached.
+  int64_t ComputedTableSlot(BddNodeIndex cond, BddNodeIndex if_true,
+                            BddNodeIndex if_false) const;
+
+  // Returns the level of the variable of the given non-terminal expression.
+  int64_t GetLevel(BddNodeIndex expr) const {
+    return variable_levels_[nodes_[Slot(expr)].variable.value()];
+  }
+
+  // Helpers for ReorderVariables. While reordering, the BDD keeps a reference
+  // count for each node and the list of the nodes labelled with each variable,
+  // and frees nodes as soon as they are no longer referenced.
+  void AddReference(BddNodeIndex expr) { ++reference_counts_[Slot(expr)]; }
+  void RemoveReference(BddNodeIndex expr);
+  // Returns the live nodes labelled with `variable`, removing stale entries
+  // from its node list.
+  absl::Span<const int32_t> GetVariableNodes(BddVariable variable);
+  // Swaps the variables at `level` and `level + 1`.
+  void SwapLevels(int64_t level);
+  // Moves `variable` to the level which minimizes the number of nodes, using
+  // at most about `*swap_budget` swaps and decrementing it accordingly.
+  void SiftVariable(BddVariable variable, double max_growth,
+                    int64_t* swap_budget);
+
   // NodeIndexes corresponding to the base nodes (var, one, zero) for each
   // variable.
   std::vector<BddNodeIndex> variable_base_nodes_;
 
-  // The vector of all the nodes in the BDD.
+  // The level of each variable and the variable at each level. On every path
+  // through the BDD the levels of the variables are strictly increasing.
+  std::vector<int32_t> variable_levels_;
+  std::vector<BddVariable> level_variables_;
+
+  // The vector of all the nodes in the BDD, indexed by slot. Slot 0 holds the
+  // terminal node. The high child of every stored node is a non-complemented
+  // index, which makes the representation of each expression unique. Freed
+  // slots have a path count of zero and are listed in `free_slots_`.
   std::vector<BddNode> nodes_;
+  std::vector<int32_t> free_slots_;
 
   // A map from BDD node content (variable id, high child, low child) to the
   // index of the respective node. This map is used to ensure that no duplicate
@@ -164,11 +306,31 @@ class BinaryDecisionDiagram {
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // A direct-mapped cache from if-then-else expression (condition, if-true,
+  // if-false) to the node corresponding to that expression. Colliding entries
+  // overwrite each other, so memory use is bounded. The table grows with the
+  // number of nodes up to a fixed maximum size.
+  struct ComputedEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true;
+    BddNodeIndex if_false;
+    BddNodeIndex result;
+  };
+  std::vector<ComputedEntry> computed_table_;
+
+  int64_t peak_node_count_ = 0;
+  int64_t garbage_collections_ = 0;
+  int64_t nodes_freed_ = 0;
+  int64_t computed_table_lookups_ = 0;
+  int64_t computed_table_hits_ = 0;
+  int64_t reorderings_ = 0;
+  int64_t reordering_swaps_ = 0;
+
+  // State which is only maintained during ReorderVariables. The node lists may
+  // contain duplicate and stale entries, which GetVariableNodes removes.
+  bool reordering_ = false;
+  std::vector<int32_t> reference_counts_;
+  std::vector<std::vector<int32_t>> variable_nodes_;
 };
 
 }  // namespace xls
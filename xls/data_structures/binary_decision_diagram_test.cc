@@ -88,6 +88,127 @@ TEST(BinaryDecisionDiagramTest, BddSize) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, ComplementEdgesShareNodes) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars = bdd.NewVariables(3);
+  BddNodeIndex x0_and_x1 = bdd.And(vars[0], vars[1]);
+  BddNodeIndex f = bdd.Or(x0_and_x1, vars[2]);
+  int64_t size = bdd.size();
+
+  // The inverse of an expression is represented by the same nodes.
+  BddNodeIndex not_f = bdd.Not(f);
+  EXPECT_NE(f, not_f);
+  EXPECT_EQ(bdd.Not(not_f), f);
+  EXPECT_EQ(bdd.path_count(not_f), bdd.path_count(f));
+  EXPECT_EQ(bdd.And(f, not_f), bdd.zero());
+  EXPECT_EQ(bdd.Or(f, not_f), bdd.one());
+  EXPECT_EQ(bdd.Or(bdd.Not(vars[0]), bdd.Not(vars[1])), bdd.Not(x0_and_x1));
+  EXPECT_EQ(bdd.size(), size);
+
+  EXPECT_THAT(
+      bdd.Evaluate(not_f, {{vars[0], true}, {vars[1], true}, {vars[2], false}}),
+      IsOkAndHolds(false));
+  EXPECT_THAT(
+      bdd.Evaluate(not_f,
+                   {{vars[0], true}, {vars[1], false}, {vars[2], false}}),
+      IsOkAndHolds(true));
+  EXPECT_EQ(bdd.ToStringDnf(bdd.Not(x0_and_x1)), "x0.!x1 + !x0");
+}
+
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars = bdd.NewVariables(8);
+  auto build_parity = [&]() {
+    BddNodeIndex parity = bdd.zero();
+    for (BddNodeIndex var : vars) {
+      parity = bdd.Or(bdd.And(parity, bdd.Not(var)),
+                      bdd.And(bdd.Not(parity), var));
+    }
+    return parity;
+  };
+  BddNodeIndex x0_and_x1 = bdd.And(vars[0], vars[1]);
+  build_parity();
+  int64_t size = bdd.size();
+
+  // Only the variables and the expressions reachable from the roots survive.
+  EXPECT_GT(bdd.GarbageCollect({x0_and_x1}), 0);
+  EXPECT_LT(bdd.size(), size);
+  EXPECT_EQ(bdd.size(), 1 + vars.size() + 1);
+  EXPECT_THAT(bdd.Evaluate(x0_and_x1, {{vars[0], true}, {vars[1], true}}),
+              IsOkAndHolds(true));
+  EXPECT_EQ(bdd.And(vars[1], vars[0]), x0_and_x1);
+
+  // Freed nodes are reused.
+  BddNodeIndex parity = build_parity();
+  EXPECT_EQ(bdd.size(), size);
+  absl::flat_hash_map<BddNodeIndex, bool> values;
+  for (int64_t i = 0; i < vars.size(); ++i) {
+    values[vars[i]] = i == 3;
+  }
+  EXPECT_THAT(bdd.Evaluate(parity, values), IsOkAndHolds(true));
+
+  BddStats stats = bdd.GetStats();
+  EXPECT_EQ(stats.node_count, size);
+  EXPECT_EQ(stats.peak_node_count, size);
+  EXPECT_EQ(stats.variable_count, vars.size());
+  EXPECT_EQ(stats.garbage_collections, 1);
+  EXPECT_EQ(stats.nodes_freed, size - (1 + vars.size() + 1));
+  EXPECT_GT(stats.computed_table_hits, 0);
+  EXPECT_GT(stats.memory_bytes, 0);
+}
+
+TEST(BinaryDecisionDiagramTest, ReorderVariables) {
+  // (a0 & b0) | (a1 & b1) | ... has a number of nodes exponential in the
+  // number of pairs when all of the a variables come before all of the b
+  // variables, and linear when each a variable is next to its b variable.
+  constexpr int64_t kPairs = 8;
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> a = bdd.NewVariables(kPairs);
+  std::vector<BddNodeIndex> b = bdd.NewVariables(kPairs);
+  auto build = [&]() {
+    BddNodeIndex result = bdd.zero();
+    for (int64_t i = 0; i < kPairs; ++i) {
+      result = bdd.Or(result, bdd.And(a[i], b[i]));
+    }
+    return result;
+  };
+  BddNodeIndex f = build();
+  BddNodeIndex not_f = bdd.Not(f);
+  bdd.GarbageCollect({f});
+  int64_t size_before = bdd.size();
+
+  EXPECT_LT(bdd.ReorderVariables({f, not_f}), size_before / 4);
+  EXPECT_EQ(bdd.GetStats().reorderings, 1);
+  EXPECT_GT(bdd.GetStats().reordering_swaps, 0);
+
+  // The roots still refer to the same expressions, and the BDD is still
+  // canonical.
+  EXPECT_EQ(bdd.Not(f), not_f);
+  EXPECT_EQ(build(), f);
+  EXPECT_EQ(bdd.And(f, not_f), bdd.zero());
+  for (int64_t values = 0; values < (1 << (2 * kPairs)); values += 97) {
+    absl::flat_hash_map<BddNodeIndex, bool> variable_values;
+    bool expected = false;
+    for (int64_t i = 0; i < kPairs; ++i) {
+      bool a_value = (values >> i) & 1;
+      bool b_value = (values >> (kPairs + i)) & 1;
+      variable_values[a[i]] = a_value;
+      variable_values[b[i]] = b_value;
+      expected = expected || (a_value && b_value);
+    }
+    EXPECT_THAT(bdd.Evaluate(f, variable_values), IsOkAndHolds(expected));
+  }
+
+  // The levels are a permutation of the variables.
+  std::vector<bool> levels_seen(2 * kPairs, false);
+  for (int64_t i = 0; i < 2 * kPairs; ++i) {
+    int64_t level = bdd.GetLevel(BddVariable(i));
+    ASSERT_LT(level, 2 * kPairs);
+    EXPECT_FALSE(levels_seen[level]);
+    levels_seen[level] = true;
+  }
+}
+
 TEST(BinaryDecisionDiagramTest, ToString) {
   BinaryDecisionDiagram bdd;
   std::vector<BddNodeIndex> vars = bdd.NewVariables(4);
@@ -42,6 +42,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/query_engine.h"
 
 static constexpr std::string_view kUsage = R"(
 Builds a BDD from XLS IR and prints various metrics about the BDD. Usage:
@@ -57,6 +58,8 @@ To gather BDD stats of a set of benchmarks:
 ABSL_FLAG(int64_t, bdd_path_limit, 0,
           "Maximum number of paths before truncating the BDD subgraph "
           "and declaring a new variable. If zero, then no limit.");
+ABSL_FLAG(bool, bdd_reordering, true,
+          "Whether to reorder the BDD variables as the BDD grows.");
 ABSL_FLAG(std::vector<std::string>, benchmarks, {},
           "Comma-separated list of benchmarks gather BDD stats about.");
 
@@ -117,31 +120,53 @@ absl::Status RealMain(std::string_view input_path) {
           "Top entity not set for package: %s.", package->name()));
     }
     BddQueryEngine query_engine(absl::GetFlag(FLAGS_bdd_path_limit));
+    if (!absl::GetFlag(FLAGS_bdd_reordering)) {
+      query_engine.set_reordering_options(std::nullopt);
+    }
     Stopwatch bdd_stopwatch;
     XLS_RETURN_IF_ERROR(query_engine.EagerlyPopulate(top.value()));
     absl::Duration bdd_time = bdd_stopwatch.GetElapsedTime();
     total_time += bdd_time;
     std::cout << "BDD construction time: " << bdd_time << "\n";
-    std::cout << "BDD node count: " << query_engine.bdd().size() << "\n";
-    std::cout << "BDD variable count: " << query_engine.bdd().variable_count()
-              << "\n";
+    std::cout << "BDD stats after construction: "
+              << query_engine.bdd().GetStats().ToString() << "\n";
 
     int64_t number_bits = 0;
+    int64_t known_bits = 0;
+    int64_t max_paths = 0;
     for (Node* node : top.value()->nodes()) {
       number_bits += node->GetType()->GetFlatBitCount();
+      if (!node->GetType()->IsBits()) {
+        continue;
+      }
+      for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+        std::optional<BddNodeIndex> bdd_node =
+            query_engine.GetBddNode(TreeBitLocation(node, i));
+        if (bdd_node.has_value()) {
+          max_paths =
+              std::max(max_paths, query_engine.bdd().path_count(*bdd_node));
+          if (*bdd_node == query_engine.bdd().zero() ||
+              *bdd_node == query_engine.bdd().one()) {
+            ++known_bits;
+          }
+        }
+      }
     }
     std::cout << "Bits in graph: " << number_bits << "\n";
-
-    int64_t max_paths = 0;
-    for (int64_t i = 0; i < query_engine.bdd().size(); ++i) {
-      max_paths =
-          std::max(max_paths, query_engine.bdd().path_count(BddNodeIndex(i)));
-    }
+    std::cout << "Bits known to be constant: " << known_bits << "\n";
     if (max_paths == std::numeric_limits<int32_t>::max()) {
       std::cout << "Maximum paths of any expression: INT32_MAX\n";
     } else {
       std::cout << "Maximum paths of any expression: " << max_paths << "\n";
     }
+
+    Stopwatch gc_stopwatch;
+    int64_t nodes_freed = query_engine.CollectGarbage();
+    std::cout << "BDD garbage collection time: "
+              << gc_stopwatch.GetElapsedTime() << "\n";
+    std::cout << "BDD nodes freed: " << nodes_freed << "\n";
+    std::cout << "BDD stats after garbage collection: "
+              << query_engine.bdd().GetStats().ToString() << "\n";
   }
 
   if (packages.size() > 1) {
@@ -190,6 +190,7 @@ absl::Status RealMain(std::string_view opt_ir_path,
       XLS_RETURN_IF_ERROR(
           PrintPipelinedCodegenInfo(*top, schedule, codegen_options));
     }
+    XLS_RETURN_IF_ERROR(SaveDelayEstimateCache(scheduling_options_flags_proto));
   }
 
   XLS_ASSIGN_OR_RETURN(Block * top, GetTopBlock(block_package.get()));
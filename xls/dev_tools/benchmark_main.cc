@@ -52,6 +52,7 @@
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/fdo/grpc_synthesizer.h"
 #include "xls/fdo/synthesized_delay_diff_utils.h"
 #include "xls/fdo/synthesizer.h"
@@ -316,12 +317,10 @@ absl::Status PrintCriticalPath(
   return absl::OkStatus();
 }
 
-absl::Status PrintTotalDelay(FunctionBase* f,
-                             const DelayEstimator& delay_estimator) {
+absl::Status PrintTotalDelay(FunctionBase* f, TimingAnalysis& timing_analysis) {
   int64_t total_delay = 0;
   for (Node* node : f->nodes()) {
-    XLS_ASSIGN_OR_RETURN(int64_t op_delay,
-                         delay_estimator.GetOperationDelayInPs(node));
+    XLS_ASSIGN_OR_RETURN(int64_t op_delay, timing_analysis.GetNodeDelay(node));
     total_delay += op_delay;
   }
   std::cout << absl::StrFormat("Total delay: %dps\n", total_delay);
@@ -735,13 +734,21 @@ absl::Status RunInterpreterAndJit(FunctionBase* function_base,
   return RunProcInterpreterAndJit(proc, description, rng_engine);
 }
 
+// Without a clock period the critical path comes straight from
+// `timing_analysis`, which also supplies the total delay.
 absl::Status AnalyzeAndPrintCriticalPath(
     FunctionBase* f, std::optional<int64_t> effective_clock_period_ps,
-    const DelayEstimator& delay_estimator, const QueryEngine& query_engine,
+    TimingAnalysis& timing_analysis, const QueryEngine& query_engine,
     PipelineScheduleOrGroup* schedules, synthesis::Synthesizer* synthesizer) {
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<CriticalPathEntry> critical_path,
-      AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
+  const DelayEstimator& delay_estimator = timing_analysis.delay_estimator();
+  std::vector<CriticalPathEntry> critical_path;
+  if (effective_clock_period_ps.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        critical_path,
+        AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
+  } else {
+    XLS_ASSIGN_OR_RETURN(critical_path, timing_analysis.GetCriticalPath());
+  }
   synthesis::SynthesizedDelayDiffByStage delay_diff;
   if (synthesizer) {
     if (schedules) {
@@ -759,7 +766,7 @@ absl::Status AnalyzeAndPrintCriticalPath(
     delay_diff.total_diff.critical_path = std::move(critical_path);
   }
   XLS_RETURN_IF_ERROR(PrintCriticalPath(f, query_engine, delay_diff));
-  XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator));
+  XLS_RETURN_IF_ERROR(PrintTotalDelay(f, timing_analysis));
   return absl::OkStatus();
 }
 
@@ -814,11 +821,13 @@ absl::Status RealMain(std::string_view path) {
   if (!delay_model_flag_passed) {
     pdelay_estimator = &GetStandardDelayEstimator();
   } else {
-    XLS_ASSIGN_OR_RETURN(
-        pdelay_estimator,
-        GetDelayEstimator(scheduling_options_flags_proto.delay_model()));
+    XLS_ASSIGN_OR_RETURN(pdelay_estimator,
+                         SetUpDelayEstimator(scheduling_options_flags_proto));
   }
   const auto& delay_estimator = *pdelay_estimator;
+  // Node delays are estimated once, tracked through any IR changes made by
+  // scheduling, and shared by the scheduler and the reports below.
+  TimingAnalysis timing_analysis(f, delay_estimator);
   std::unique_ptr<synthesis::Synthesizer> synthesizer;
   if (absl::GetFlag(FLAGS_compare_delay_to_synthesis)) {
     synthesis::GrpcSynthesizerParameters parameters(
@@ -836,7 +845,7 @@ absl::Status RealMain(std::string_view path) {
       scheduling_options_flags_proto.pipeline_stages() > 0;
   if (!f->IsProc() && !benchmark_codegen) {
     XLS_RETURN_IF_ERROR(AnalyzeAndPrintCriticalPath(
-        f, effective_clock_period_ps, delay_estimator, query_engine,
+        f, effective_clock_period_ps, timing_analysis, query_engine,
         /*schedules=*/nullptr, synthesizer.get()));
   } else if (benchmark_codegen) {
     PipelineScheduleOrGroup schedules = PackagePipelineSchedules();
@@ -845,13 +854,14 @@ absl::Status RealMain(std::string_view path) {
                            SetUpSchedulingOptions(
                                scheduling_options_flags_proto, package.get()));
       absl::Duration scheduling_time;
-      XLS_ASSIGN_OR_RETURN(schedules,
-                           Schedule(package.get(), scheduling_options,
-                                    &delay_estimator, &scheduling_time));
+      XLS_ASSIGN_OR_RETURN(
+          schedules,
+          Schedule(package.get(), scheduling_options, &delay_estimator,
+                   &scheduling_time, &timing_analysis));
       std::cout << absl::StreamFormat("Scheduling time: %dms\n",
                                       scheduling_time / absl::Milliseconds(1));
       XLS_RETURN_IF_ERROR(AnalyzeAndPrintCriticalPath(
-          f, effective_clock_period_ps, delay_estimator, query_engine,
+          f, effective_clock_period_ps, timing_analysis, query_engine,
           &schedules, synthesizer.get()));
 
       XLS_RETURN_IF_ERROR(PrintScheduleInfo(
@@ -886,7 +896,7 @@ absl::Status RealMain(std::string_view path) {
     }
   }
 
-  return absl::OkStatus();
+  return SaveDelayEstimateCache(scheduling_options_flags_proto);
 }
 
 }  // namespace
@@ -20,13 +20,16 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/base/no_destructor.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/node.h"
 
 namespace xls {
 
@@ -37,6 +40,44 @@ absl::StatusOr<double> AreaEstimator::GetRegisterAreaInSquareMicrons(
   return one_bit_register_area * static_cast<double>(register_width);
 }
 
+absl::StatusOr<std::vector<double>>
+AreaEstimator::GetOperationAreasInSquareMicrons(
+    absl::Span<Node* const> nodes) const {
+  std::vector<double> areas;
+  areas.reserve(nodes.size());
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(double area, GetOperationAreaInSquareMicrons(node));
+    areas.push_back(area);
+  }
+  return areas;
+}
+
+MemoizingAreaEstimator::MemoizingAreaEstimator(std::string_view name,
+                                               const AreaEstimator& memoized)
+    : AreaEstimator(name),
+      memoized_(memoized),
+      cache_(memoized.name(), memoized.GetFingerprint()) {}
+
+absl::StatusOr<double> MemoizingAreaEstimator::GetOperationAreaInSquareMicrons(
+    Node* node) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<double> areas,
+                       GetOperationAreasInSquareMicrons({node}));
+  return areas.front();
+}
+
+absl::StatusOr<std::vector<double>>
+MemoizingAreaEstimator::GetOperationAreasInSquareMicrons(
+    absl::Span<Node* const> nodes) const {
+  return cache_.Estimate(nodes, [&](absl::Span<Node* const> to_estimate) {
+    return memoized_.GetOperationAreasInSquareMicrons(to_estimate);
+  });
+}
+
+absl::StatusOr<double>
+MemoizingAreaEstimator::GetOneBitRegisterAreaInSquareMicrons() const {
+  return memoized_.GetRegisterAreaInSquareMicrons(1);
+}
+
 AreaEstimatorManager& GetAreaEstimatorManagerSingleton() {
   static absl::NoDestructor<AreaEstimatorManager> manager;
   return *manager;
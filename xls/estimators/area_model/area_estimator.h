@@ -25,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -44,10 +45,20 @@ class AreaEstimator {
 
   const std::string& name() const { return name_; }
 
+  // Returns a string which changes whenever the areas made by this estimator
+  // may change (e.g., a hash of its model data), so that persisted estimates
+  // from another version of the model are not reused. Empty if unknown.
+  virtual std::string GetFingerprint() const { return ""; }
+
   // Returns the estimated area of the given node in square micrometers.
   virtual absl::StatusOr<double> GetOperationAreaInSquareMicrons(
       Node* node) const = 0;
 
+  // Returns the estimated areas of the given nodes in square micrometers, in
+  // the same order. By default this simply queries each node in turn.
+  virtual absl::StatusOr<std::vector<double>> GetOperationAreasInSquareMicrons(
+      absl::Span<Node* const> nodes) const;
+
   // Returns the estimated area of n-bit register
   absl::StatusOr<double> GetRegisterAreaInSquareMicrons(
       const uint64_t& register_width) const;
@@ -56,6 +67,33 @@ class AreaEstimator {
   std::string name_;
 };
 
+// Memoizes the areas of an underlying area estimator by estimation signature
+// (see GetEstimationSignature), so that structurally identical nodes are only
+// estimated once, across functions and packages. The memoized areas can be
+// saved to and loaded from disk so they are shared across invocations. This
+// class is safe for concurrent access.
+class MemoizingAreaEstimator : public AreaEstimator {
+ public:
+  MemoizingAreaEstimator(std::string_view name, const AreaEstimator& memoized);
+
+  std::string GetFingerprint() const override {
+    return memoized_.GetFingerprint();
+  }
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override;
+  absl::StatusOr<std::vector<double>> GetOperationAreasInSquareMicrons(
+      absl::Span<Node* const> nodes) const override;
+
+  // The memoized areas; use to load or save them, or for statistics.
+  EstimateCache<double>& cache() const { return cache_; }
+
+ private:
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override;
+
+  const AreaEstimator& memoized_;
+  mutable EstimateCache<double> cache_;
+};
+
 // A manager holding multiple Area Estimator singletons
 class AreaEstimatorManager {
  public:
@@ -24,6 +24,7 @@
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/op.h"
@@ -83,5 +84,31 @@ TEST_F(AreaEstimatorTest, AreaEstimatorManager) {
               absl_testing::IsOkAndHolds(420.0));
 }
 
+TEST_F(AreaEstimatorTest, MemoizingAreaEstimator) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1("f1", p.get());
+  BValue a = fb1.Param("a", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1,
+                           fb1.BuildWithReturnValue(fb1.Negate(a)));
+  FunctionBuilder fb2("f2", p.get());
+  BValue b = fb2.Param("b", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2,
+                           fb2.BuildWithReturnValue(fb2.Negate(b)));
+
+  FakeAreaEstimator ten("ten_area", 10.0);
+  MemoizingAreaEstimator memoizing("memoizing", ten);
+  EXPECT_EQ(memoizing.cache().estimator_name(), "ten_area");
+  EXPECT_THAT(memoizing.GetOperationAreaInSquareMicrons(f1->return_value()),
+              absl_testing::IsOkAndHolds(10.0));
+  // The negate in `f2` is the same operation, so it is not estimated again.
+  EXPECT_THAT(memoizing.GetOperationAreasInSquareMicrons(
+                  {f2->return_value(), a.node()}),
+              absl_testing::IsOkAndHolds(testing::ElementsAre(10.0, 10.0)));
+  EXPECT_EQ(memoizing.cache().hits(), 1);
+  EXPECT_EQ(memoizing.cache().misses(), 2);
+  EXPECT_THAT(memoizing.GetRegisterAreaInSquareMicrons(3),
+              absl_testing::IsOkAndHolds(30.0));
+}
+
 }  // namespace
 }  // namespace xls
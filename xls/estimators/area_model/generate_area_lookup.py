@@ -15,6 +15,8 @@
 
 """Extracts area model from a text proto, constructs C++ lookup code."""
 
+import hashlib
+
 from absl import app
 from absl import flags
 import jinja2
@@ -40,9 +42,11 @@ def main(argv):
     raise app.UsageError('Too many command-line arguments.')
 
   with open(argv[1], 'rb') as f:
-    area_model = estimator_model.EstimatorModel(
-        text_format.Parse(f.read(), estimator_model_pb2.EstimatorModel())
-    )
+    contents = f.read()
+
+  area_model = estimator_model.EstimatorModel(
+      text_format.Parse(contents, estimator_model_pb2.EstimatorModel())
+  )
 
   one_bit_register_area = area_model_utils.get_one_bit_register_area(area_model)
 
@@ -58,6 +62,7 @@ def main(argv):
           s.capitalize() for s in FLAGS.model_name.split('_')
       ),
       one_bit_register_area=one_bit_register_area,
+      fingerprint=hashlib.sha256(contents).hexdigest(),
   )
   print(
       '// DO NOT EDIT: this file is AUTOMATICALLY GENERATED by'
@@ -30,6 +30,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -249,6 +250,17 @@ absl::StatusOr<int64_t> FirstMatchDelayEstimator::GetOperationDelayInPs(
   return result;
 }
 
+absl::StatusOr<std::vector<int64_t>> DelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<int64_t> delays;
+  delays.reserve(nodes.size());
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay, GetOperationDelayInPs(node));
+    delays.push_back(delay);
+  }
+  return delays;
+}
+
 CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
                                              const DelayEstimator& cached)
     : DelayEstimator(name), cached_(cached) {}
@@ -264,6 +276,27 @@ absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
   return delay;
 }
 
+MemoizingDelayEstimator::MemoizingDelayEstimator(
+    std::string_view name, const DelayEstimator& memoized)
+    : DelayEstimator(name),
+      memoized_(memoized),
+      cache_(memoized.name(), memoized.GetFingerprint()) {}
+
+absl::StatusOr<int64_t> MemoizingDelayEstimator::GetOperationDelayInPs(
+    Node* node) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       GetOperationDelaysInPs({node}));
+  return delays.front();
+}
+
+absl::StatusOr<std::vector<int64_t>>
+MemoizingDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  return cache_.Estimate(nodes, [&](absl::Span<Node* const> to_estimate) {
+    return memoized_.GetOperationDelaysInPs(to_estimate);
+  });
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
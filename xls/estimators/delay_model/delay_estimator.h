@@ -30,6 +30,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -42,9 +43,21 @@ class DelayEstimator {
 
   const std::string& name() const { return name_; }
 
+  // Returns a string which changes whenever the delays made by this estimator
+  // may change (e.g., a hash of its model data), so that persisted estimates
+  // from another version of the model are not reused. Empty if unknown.
+  virtual std::string GetFingerprint() const { return ""; }
+
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Returns the estimated delays of the given nodes in picoseconds, in the
+  // same order. Estimators which can share work between nodes (e.g., by
+  // memoizing estimates) override this; by default it simply queries each node
+  // in turn.
+  virtual absl::StatusOr<std::vector<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -96,6 +109,9 @@ class CachingDelayEstimator : public DelayEstimator {
 
   ~CachingDelayEstimator() override = default;
 
+  std::string GetFingerprint() const override {
+    return cached_.GetFingerprint();
+  }
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
  private:
@@ -122,6 +138,33 @@ class CachingDelayEstimator : public DelayEstimator {
       ABSL_GUARDED_BY(cache_mutex_);
 };
 
+// Memoizes the delays of an underlying delay estimator by estimation signature
+// (see GetEstimationSignature), so that structurally identical nodes are only
+// estimated once, across functions and packages. The memoized delays can be
+// saved to and loaded from disk so they are shared across invocations (see
+// SetUpDelayEstimator). This class is safe for concurrent access.
+class MemoizingDelayEstimator : public DelayEstimator {
+ public:
+  MemoizingDelayEstimator(std::string_view name,
+                          const DelayEstimator& memoized);
+
+  ~MemoizingDelayEstimator() override = default;
+
+  std::string GetFingerprint() const override {
+    return memoized_.GetFingerprint();
+  }
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+  absl::StatusOr<std::vector<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const override;
+
+  // The memoized delays; use to load or save them, or for statistics.
+  EstimateCache<int64_t>& cache() const { return cache_; }
+
+ private:
+  const DelayEstimator& memoized_;
+  mutable EstimateCache<int64_t> cache_;
+};
+
 enum class DelayEstimatorPrecedence {
   kLow = 1,
   kMedium = 2,
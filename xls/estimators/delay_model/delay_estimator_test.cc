@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -42,6 +43,8 @@ class FakeDelayEstimator : public DelayEstimator {
   explicit FakeDelayEstimator(int64_t delay, std::string_view name)
       : DelayEstimator(name), delay_(delay) {}
 
+  std::string GetFingerprint() const override { return "fake_model_v1"; }
+
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
     return delay_;
   }
@@ -304,6 +307,33 @@ TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
   EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
 }
 
+TEST_F(DelayEstimatorTest, MemoizingDelayEstimator) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1("f1", p.get());
+  BValue a = fb1.Param("a", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1,
+                           fb1.BuildWithReturnValue(fb1.Xor({a, a})));
+  FunctionBuilder fb2("f2", p.get());
+  BValue b = fb2.Param("b", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2,
+                           fb2.BuildWithReturnValue(fb2.Xor({b, b})));
+
+  FakeDelayEstimator one(1, "one");
+  MemoizingDelayEstimator memoizing("memoizing", one);
+  EXPECT_EQ(memoizing.cache().estimator_name(), "one");
+  EXPECT_EQ(memoizing.cache().model_fingerprint(), "fake_model_v1");
+  EXPECT_EQ(memoizing.GetFingerprint(), "fake_model_v1");
+  EXPECT_THAT(memoizing.GetOperationDelayInPs(f1->return_value()),
+              IsOkAndHolds(1));
+  // The xor in `f2` is the same operation, so it is not estimated again; nor
+  // is `b`, which differs from `a` only in name.
+  EXPECT_THAT(memoizing.GetOperationDelaysInPs(
+                  {f2->return_value(), a.node(), b.node()}),
+              IsOkAndHolds(ElementsAre(1, 1, 1)));
+  EXPECT_EQ(memoizing.cache().hits(), 2);
+  EXPECT_EQ(memoizing.cache().misses(), 2);
+}
+
 // A Delay Estimator that can only handle one kind of operation.
 class TestNodeMatchEstimator : public DelayEstimator {
  public:
@@ -15,6 +15,8 @@
 
 """Extracts delay model from a text proto, constructs C++ lookup code."""
 
+import hashlib
+
 from absl import app
 from absl import flags
 import jinja2
@@ -65,6 +67,7 @@ def main(argv):
       delay_model=em,
       name=FLAGS.model_name,
       precedence=FLAGS.precedence,
+      fingerprint=hashlib.sha256(contents).hexdigest(),
       camel_case_name=''.join(
           s.capitalize() for s in FLAGS.model_name.split('_')
       ),
@@ -0,0 +1,309 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/delay_model/timing_analysis.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/analyze_critical_path.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+
+TimingAnalysis::TimingAnalysis(FunctionBase* f,
+                               const DelayEstimator& delay_estimator)
+    : f_(f),
+      delay_estimator_(delay_estimator),
+      arrival_time_provider_(this),
+      delay_to_sinks_provider_(this),
+      distances_to_node_provider_(this),
+      arrival_times_(&arrival_time_provider_),
+      delays_to_sinks_(&delay_to_sinks_provider_),
+      distances_to_node_(&distances_to_node_provider_) {
+  node_delays_.reserve(f_->node_count());
+  stale_delays_.reserve(f_->node_count());
+  for (Node* node : f_->nodes()) {
+    stale_delays_.insert(node);
+  }
+  f_->RegisterChangeListener(this);
+}
+
+TimingAnalysis::~TimingAnalysis() { f_->UnregisterChangeListener(this); }
+
+absl::StatusOr<int64_t> TimingAnalysis::ArrivalTimeProvider::ComputeValue(
+    Node* const& node,
+    absl::Span<const int64_t* const> operand_arrival_times) const {
+  int64_t start = 0;
+  for (const int64_t* operand_arrival_time : operand_arrival_times) {
+    start = std::max(start, *operand_arrival_time);
+  }
+  return start + analysis_->node_delays_.at(node);
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::DelayToSinksProvider::ComputeValue(
+    Node* const& node,
+    absl::Span<const int64_t* const> user_delays_to_sinks) const {
+  int64_t delay = 0;
+  for (int64_t i = 0; i < node->users().size(); ++i) {
+    delay = std::max(delay, analysis_->node_delays_.at(node->users()[i]) +
+                                *user_delays_to_sinks[i]);
+  }
+  return delay;
+}
+
+absl::StatusOr<TimingAnalysis::DistanceMap>
+TimingAnalysis::DistancesToNodeProvider::ComputeValue(
+    Node* const& node,
+    absl::Span<const DistanceMap* const> operand_distances) const {
+  int64_t node_delay = analysis_->node_delays_.at(node);
+  DistanceMap distances;
+  distances[node] = node_delay;
+  // Extend the longest path from each ancestor to each operand by `node`.
+  for (const DistanceMap* distances_to_operand : operand_distances) {
+    for (const auto& [ancestor, distance] : *distances_to_operand) {
+      auto [it, inserted] =
+          distances.try_emplace(ancestor, distance + node_delay);
+      if (!inserted) {
+        it->second = std::max(it->second, distance + node_delay);
+      }
+    }
+  }
+  return distances;
+}
+
+absl::Status TimingAnalysis::UpdateNodeDelays() {
+  if (stale_delays_.empty()) {
+    return absl::OkStatus();
+  }
+  // Estimate the nodes in a deterministic order so errors are reproducible,
+  // and all at once so the estimator can share work between them.
+  std::vector<Node*> stale;
+  stale.reserve(stale_delays_.size());
+  for (Node* node : stale_delays_) {
+    if (!delay_overrides_.contains(node)) {
+      stale.push_back(node);
+    }
+  }
+  absl::c_sort(stale, [](Node* a, Node* b) {
+    return a->node_index() < b->node_index();
+  });
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       delay_estimator_.GetOperationDelaysInPs(stale));
+  stale_delays_.clear();
+  for (int64_t i = 0; i < stale.size(); ++i) {
+    auto [it, inserted] = node_delays_.try_emplace(stale[i], delays[i]);
+    if (!inserted && it->second != delays[i]) {
+      it->second = delays[i];
+      NodeDelayChanged(stale[i]);
+    }
+  }
+  return absl::OkStatus();
+}
+
+void TimingAnalysis::NodeDelayChanged(Node* node) {
+  arrival_times_.MarkUnverified(node);
+  distances_to_node_.MarkUnverified(node);
+  for (Node* operand : node->operands()) {
+    delays_to_sinks_.MarkUnverified(operand);
+  }
+}
+
+void TimingAnalysis::OperandsChanged(Node* node) {
+  // The node's delay may depend on its operands (e.g., their types).
+  stale_delays_.insert(node);
+  arrival_times_.MarkUnverified(node);
+  distances_to_node_.MarkUnverified(node);
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetNodeDelay(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_) << node->GetName();
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  return node_delays_.at(node);
+}
+
+void TimingAnalysis::SetNodeDelay(Node* node, int64_t delay_ps) {
+  delay_overrides_.insert_or_assign(node, delay_ps);
+  stale_delays_.erase(node);
+  auto [it, inserted] = node_delays_.try_emplace(node, delay_ps);
+  if (!inserted && it->second != delay_ps) {
+    it->second = delay_ps;
+    NodeDelayChanged(node);
+  }
+}
+
+void TimingAnalysis::ClearNodeDelay(Node* node) {
+  if (delay_overrides_.erase(node) > 0) {
+    stale_delays_.insert(node);
+  }
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetArrivalTime(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_) << node->GetName();
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  return *arrival_times_.QueryValue(node);
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetDelayToSinks(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_) << node->GetName();
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  return *delays_to_sinks_.QueryValue(node);
+}
+
+absl::StatusOr<TimingAnalysis::DistanceMap>
+TimingAnalysis::GetDistancesToNode(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_) << node->GetName();
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  return *distances_to_node_.QueryValue(node);
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetPathDelayThrough(Node* node) {
+  XLS_ASSIGN_OR_RETURN(int64_t arrival_time, GetArrivalTime(node));
+  XLS_ASSIGN_OR_RETURN(int64_t delay_to_sinks, GetDelayToSinks(node));
+  return arrival_time + delay_to_sinks;
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetRequiredTime(Node* node,
+                                                        int64_t target_ps) {
+  XLS_ASSIGN_OR_RETURN(int64_t delay_to_sinks, GetDelayToSinks(node));
+  return target_ps - delay_to_sinks;
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetSlack(Node* node) {
+  XLS_ASSIGN_OR_RETURN(int64_t critical_path_delay, GetCriticalPathDelay());
+  XLS_ASSIGN_OR_RETURN(int64_t path_delay, GetPathDelayThrough(node));
+  return critical_path_delay - path_delay;
+}
+
+absl::StatusOr<int64_t> TimingAnalysis::GetCriticalPathDelay() {
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  int64_t critical_path_delay = 0;
+  for (Node* node : f_->nodes()) {
+    // Every path ends at a node with no users.
+    if (node->users().empty()) {
+      critical_path_delay =
+          std::max(critical_path_delay, *arrival_times_.QueryValue(node));
+    }
+  }
+  return critical_path_delay;
+}
+
+absl::StatusOr<std::vector<CriticalPathEntry>>
+TimingAnalysis::GetCriticalPath() {
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  // As in AnalyzeCriticalPath, ties go to the later node.
+  std::optional<Node*> last;
+  int64_t critical_path_delay = 0;
+  for (Node* node : f_->nodes()) {
+    if (!node->users().empty()) {
+      continue;
+    }
+    int64_t arrival_time = *arrival_times_.QueryValue(node);
+    if (!last.has_value() || arrival_time >= critical_path_delay) {
+      last = node;
+      critical_path_delay = arrival_time;
+    }
+  }
+
+  std::vector<CriticalPathEntry> critical_path;
+  std::optional<Node*> node = last;
+  while (node.has_value()) {
+    critical_path.push_back(CriticalPathEntry{
+        .node = *node,
+        .node_delay_ps = node_delays_.at(*node),
+        .path_delay_ps = *arrival_times_.QueryValue(*node),
+        .delayed_by_cycle_boundary = false});
+    std::optional<Node*> predecessor;
+    int64_t max_arrival_time = 0;
+    for (Node* operand : (*node)->operands()) {
+      int64_t arrival_time = *arrival_times_.QueryValue(operand);
+      if (arrival_time >= max_arrival_time) {
+        max_arrival_time = arrival_time;
+        predecessor = operand;
+      }
+    }
+    node = predecessor;
+  }
+  return critical_path;
+}
+
+void TimingAnalysis::NodeAdded(Node* node) {
+  stale_delays_.insert(node);
+  // The new node extends the paths through each of its operands.
+  for (Node* operand : node->operands()) {
+    delays_to_sinks_.MarkUnverified(operand);
+  }
+}
+
+void TimingAnalysis::NodeDeleted(Node* node) {
+  for (Node* operand : node->operands()) {
+    delays_to_sinks_.MarkUnverified(operand);
+  }
+  arrival_times_.Forget(node);
+  delays_to_sinks_.Forget(node);
+  distances_to_node_.Forget(node);
+  node_delays_.erase(node);
+  delay_overrides_.erase(node);
+  stale_delays_.erase(node);
+}
+
+void TimingAnalysis::OperandChanged(Node* node, Node* old_operand,
+                                    absl::Span<const int64_t> operand_nos) {
+  OperandsChanged(node);
+  delays_to_sinks_.MarkUnverified(old_operand);
+  for (int64_t operand_no : operand_nos) {
+    delays_to_sinks_.MarkUnverified(node->operand(operand_no));
+  }
+}
+
+void TimingAnalysis::OperandRemoved(Node* node, Node* old_operand) {
+  OperandsChanged(node);
+  delays_to_sinks_.MarkUnverified(old_operand);
+}
+
+void TimingAnalysis::OperandAdded(Node* node) {
+  OperandsChanged(node);
+  delays_to_sinks_.MarkUnverified(node->operands().back());
+}
+
+absl::Status TimingAnalysis::CheckConsistency() {
+  XLS_RETURN_IF_ERROR(UpdateNodeDelays());
+  for (Node* node : f_->nodes()) {
+    if (delay_overrides_.contains(node)) {
+      XLS_RET_CHECK_EQ(node_delays_.at(node), delay_overrides_.at(node))
+          << node->GetName();
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator_.GetOperationDelayInPs(node));
+    XLS_RET_CHECK_EQ(node_delays_.at(node), delay) << node->GetName();
+  }
+  std::vector<Node*> topo_sort = TopoSort(f_);
+  XLS_RETURN_IF_ERROR(arrival_times_.CheckConsistency(topo_sort));
+  XLS_RETURN_IF_ERROR(distances_to_node_.CheckConsistency(topo_sort));
+  return delays_to_sinks_.CheckConsistency(ReverseTopoSort(f_));
+}
+
+}  // namespace xls
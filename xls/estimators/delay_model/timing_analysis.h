@@ -0,0 +1,233 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_ESTIMATORS_DELAY_MODEL_TIMING_ANALYSIS_H_
+#define XLS_ESTIMATORS_DELAY_MODEL_TIMING_ANALYSIS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/estimators/delay_model/analyze_critical_path.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/lazy_dag_cache.h"
+
+namespace xls {
+
+// An incrementally-maintained combinational timing analysis of a FunctionBase,
+// ignoring any pipeline registers.
+//
+// For each node this tracks:
+//
+//  * the arrival time: the delay of the longest path ending at (and including)
+//    the node, and
+//  * the delay to sinks: the delay of the longest path starting just after the
+//    node's output, i.e., not including the node itself.
+//
+// The longest path through a node is the sum of the two, and the required time
+// of a node for a given target is the target minus its delay to sinks.
+//
+// For clients which constrain individual paths (e.g., the SDC scheduler and
+// the FDO DelayManager), it also tracks the distances to each node: the delay
+// of the longest path from each ancestor to the node. These take space
+// quadratic in the number of nodes, and are only computed when queried.
+//
+// All of these are computed lazily and cached. The analysis registers itself
+// as a ChangeListener on the FunctionBase, so nodes may be added, removed or
+// rewired between queries; only the affected fan-out cone (for arrival times
+// and distances) or fan-in cone (for delays to sinks) is recomputed, and
+// recomputation stops early wherever a value turns out not to have changed.
+// Node delays may also be overridden (e.g., with post-synthesis delays, or 0
+// for nodes which will not be synthesized) with the same incremental cost.
+//
+// Queries which touch every node (e.g., GetCriticalPathDelay) take time linear
+// in the number of nodes even when nothing has changed, but do not invoke the
+// delay estimator or recompute any paths.
+class TimingAnalysis : public ChangeListener {
+ public:
+  // A map from each ancestor of a node (including the node itself) to the
+  // delay of the longest path from the start of the ancestor to the end of the
+  // node, including the delays of both.
+  using DistanceMap = absl::flat_hash_map<Node*, int64_t>;
+
+  // `f` and `delay_estimator` must outlive the analysis.
+  TimingAnalysis(FunctionBase* f, const DelayEstimator& delay_estimator);
+  ~TimingAnalysis() override;
+
+  // The analysis is registered with its FunctionBase by address.
+  TimingAnalysis(const TimingAnalysis&) = delete;
+  TimingAnalysis& operator=(const TimingAnalysis&) = delete;
+
+  FunctionBase* function_base() const { return f_; }
+  const DelayEstimator& delay_estimator() const { return delay_estimator_; }
+
+  // Returns the delay of the given node; either the override set with
+  // SetNodeDelay or the delay estimator's estimate.
+  absl::StatusOr<int64_t> GetNodeDelay(Node* node);
+
+  // Overrides the delay of `node`, which otherwise comes from the delay
+  // estimator. The override is dropped if the node is removed.
+  void SetNodeDelay(Node* node, int64_t delay_ps);
+  void ClearNodeDelay(Node* node);
+  const absl::flat_hash_map<Node*, int64_t>& delay_overrides() const {
+    return delay_overrides_;
+  }
+
+  absl::StatusOr<int64_t> GetArrivalTime(Node* node);
+  absl::StatusOr<int64_t> GetDelayToSinks(Node* node);
+
+  // Returns the distance from every ancestor of `node` to `node`.
+  absl::StatusOr<DistanceMap> GetDistancesToNode(Node* node);
+
+  // Returns the longest path through `node`, including its own delay.
+  absl::StatusOr<int64_t> GetPathDelayThrough(Node* node);
+
+  // Returns the latest time at which `node`'s output can be available such that
+  // every path through it completes within `target_ps`.
+  absl::StatusOr<int64_t> GetRequiredTime(Node* node, int64_t target_ps);
+
+  // Returns the slack of `node` relative to the critical-path delay; nodes on a
+  // critical path have zero slack.
+  absl::StatusOr<int64_t> GetSlack(Node* node);
+
+  // Returns the delay of the longest combinational path in the function.
+  absl::StatusOr<int64_t> GetCriticalPathDelay();
+
+  // Returns a critical path in the same form as AnalyzeCriticalPath without a
+  // clock period: the last node of the path is at the front.
+  absl::StatusOr<std::vector<CriticalPathEntry>> GetCriticalPath();
+
+  // Implementation of ChangeListener.
+  void NodeAdded(Node* node) override;
+  void NodeDeleted(Node* node) override;
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override;
+  void OperandRemoved(Node* node, Node* old_operand) override;
+  void OperandAdded(Node* node) override;
+
+  // Verifies that the node delays and all cached paths are consistent with the
+  // current IR. This is an expensive operation, intended for use in tests.
+  absl::Status CheckConsistency();
+
+ private:
+  // Arrival times are computed over the IR graph...
+  class ArrivalTimeProvider
+      : public LazyDagCache<Node*, int64_t>::DagProvider {
+   public:
+    explicit ArrivalTimeProvider(const TimingAnalysis* analysis)
+        : analysis_(analysis) {}
+
+    std::string GetName(Node* const& node) const override {
+      return node->GetName();
+    }
+    absl::Span<Node* const> GetInputs(Node* const& node) const override {
+      return node->operands();
+    }
+    absl::Span<Node* const> GetUsers(Node* const& node) const override {
+      return node->users();
+    }
+    absl::StatusOr<int64_t> ComputeValue(
+        Node* const& node,
+        absl::Span<const int64_t* const> operand_arrival_times) const override;
+
+   private:
+    const TimingAnalysis* analysis_;
+  };
+
+  // ... and delays to sinks over the reversed graph.
+  class DelayToSinksProvider
+      : public LazyDagCache<Node*, int64_t>::DagProvider {
+   public:
+    explicit DelayToSinksProvider(const TimingAnalysis* analysis)
+        : analysis_(analysis) {}
+
+    std::string GetName(Node* const& node) const override {
+      return node->GetName();
+    }
+    absl::Span<Node* const> GetInputs(Node* const& node) const override {
+      return node->users();
+    }
+    absl::Span<Node* const> GetUsers(Node* const& node) const override {
+      return node->operands();
+    }
+    absl::StatusOr<int64_t> ComputeValue(
+        Node* const& node,
+        absl::Span<const int64_t* const> user_delays_to_sinks) const override;
+
+   private:
+    const TimingAnalysis* analysis_;
+  };
+
+  // ... as are the distances to each node.
+  class DistancesToNodeProvider
+      : public LazyDagCache<Node*, DistanceMap>::DagProvider {
+   public:
+    explicit DistancesToNodeProvider(const TimingAnalysis* analysis)
+        : analysis_(analysis) {}
+
+    std::string GetName(Node* const& node) const override {
+      return node->GetName();
+    }
+    absl::Span<Node* const> GetInputs(Node* const& node) const override {
+      return node->operands();
+    }
+    absl::Span<Node* const> GetUsers(Node* const& node) const override {
+      return node->users();
+    }
+    absl::StatusOr<DistanceMap> ComputeValue(
+        Node* const& node, absl::Span<const DistanceMap* const>
+                               operand_distances) const override;
+
+   private:
+    const TimingAnalysis* analysis_;
+  };
+
+  // Estimates the delay of every node whose delay may have changed, and
+  // invalidates the paths through any node whose delay did change. Must be
+  // called before querying either cache, which cannot report errors.
+  absl::Status UpdateNodeDelays();
+
+  // Invalidates the cached paths through `node` after its delay changed.
+  void NodeDelayChanged(Node* node);
+
+  // Invalidates the cached paths ending at `node` after its operands changed.
+  void OperandsChanged(Node* node);
+
+  FunctionBase* f_;
+  const DelayEstimator& delay_estimator_;
+
+  absl::flat_hash_map<Node*, int64_t> node_delays_;
+  absl::flat_hash_map<Node*, int64_t> delay_overrides_;
+  // Nodes whose estimated delay is missing or may be out of date.
+  absl::flat_hash_set<Node*> stale_delays_;
+
+  ArrivalTimeProvider arrival_time_provider_;
+  DelayToSinksProvider delay_to_sinks_provider_;
+  DistancesToNodeProvider distances_to_node_provider_;
+  LazyDagCache<Node*, int64_t> arrival_times_;
+  LazyDagCache<Node*, int64_t> delays_to_sinks_;
+  LazyDagCache<Node*, DistanceMap> distances_to_node_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_ESTIMATORS_DELAY_MODEL_TIMING_ANALYSIS_H_
@@ -0,0 +1,203 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/delay_model/timing_analysis.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/delay_model/analyze_critical_path.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+class TimingAnalysisTest : public IrTestBase {
+ protected:
+  const DelayEstimator* delay_estimator_ = GetDelayEstimator("unit").value();
+};
+
+TEST_F(TimingAnalysisTest, MultipathFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TimingAnalysis timing(f, *delay_estimator_);
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(3));
+
+  EXPECT_THAT(timing.GetArrivalTime(x.node()), IsOkAndHolds(0));
+  EXPECT_THAT(timing.GetArrivalTime(rev_neg_x.node()), IsOkAndHolds(2));
+  EXPECT_THAT(timing.GetArrivalTime(neg_y.node()), IsOkAndHolds(1));
+  EXPECT_THAT(timing.GetArrivalTime(sum.node()), IsOkAndHolds(3));
+
+  EXPECT_THAT(timing.GetDelayToSinks(x.node()), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetDelayToSinks(neg_y.node()), IsOkAndHolds(1));
+  EXPECT_THAT(timing.GetDelayToSinks(sum.node()), IsOkAndHolds(0));
+
+  EXPECT_THAT(timing.GetSlack(neg_x.node()), IsOkAndHolds(0));
+  EXPECT_THAT(timing.GetSlack(neg_y.node()), IsOkAndHolds(1));
+  EXPECT_THAT(timing.GetRequiredTime(neg_y.node(), /*target_ps=*/10),
+              IsOkAndHolds(9));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<CriticalPathEntry> expected,
+      AnalyzeCriticalPath(f, /*clock_period_ps=*/std::nullopt,
+                          *delay_estimator_));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<CriticalPathEntry> critical_path,
+                           timing.GetCriticalPath());
+  ASSERT_EQ(critical_path.size(), expected.size());
+  for (int64_t i = 0; i < critical_path.size(); ++i) {
+    EXPECT_EQ(critical_path[i].node, expected[i].node);
+    EXPECT_EQ(critical_path[i].node_delay_ps, expected[i].node_delay_ps);
+    EXPECT_EQ(critical_path[i].path_delay_ps, expected[i].path_delay_ps);
+  }
+  XLS_EXPECT_OK(timing.CheckConsistency());
+}
+
+TEST_F(TimingAnalysisTest, DistancesToNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TimingAnalysis timing(f, *delay_estimator_);
+  EXPECT_THAT(timing.GetDistancesToNode(sum.node()),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(x.node(), 3), Pair(neg_x.node(), 3),
+                  Pair(rev_neg_x.node(), 2), Pair(y.node(), 2),
+                  Pair(neg_y.node(), 2), Pair(sum.node(), 1))));
+  EXPECT_THAT(timing.GetDistancesToNode(neg_y.node()),
+              IsOkAndHolds(UnorderedElementsAre(Pair(y.node(), 1),
+                                                Pair(neg_y.node(), 1))));
+
+  // Overriding a delay updates the distances through the node.
+  timing.SetNodeDelay(neg_x.node(), 5);
+  EXPECT_THAT(timing.GetDistancesToNode(sum.node()),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(x.node(), 7), Pair(neg_x.node(), 7),
+                  Pair(rev_neg_x.node(), 2), Pair(y.node(), 2),
+                  Pair(neg_y.node(), 2), Pair(sum.node(), 1))));
+  XLS_EXPECT_OK(timing.CheckConsistency());
+}
+
+TEST_F(TimingAnalysisTest, TracksIrChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TimingAnalysis timing(f, *delay_estimator_);
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(2));
+  EXPECT_THAT(timing.GetDelayToSinks(y.node()), IsOkAndHolds(2));
+  EXPECT_THAT(timing.GetDistancesToNode(sum.node()),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(x.node(), 2), Pair(neg_x.node(), 2), Pair(y.node(), 2),
+                  Pair(neg_y.node(), 2), Pair(sum.node(), 1))));
+
+  // Lengthen the path through `y`.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg_neg_y,
+      f->MakeNode<UnOp>(SourceInfo(), neg_y.node(), Op::kNeg));
+  XLS_ASSERT_OK(neg_y.node()->ReplaceUsesWith(
+      neg_neg_y, [&](Node* user) { return user != neg_neg_y; }));
+  XLS_EXPECT_OK(timing.CheckConsistency());
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetArrivalTime(sum.node()), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetDelayToSinks(y.node()), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetSlack(neg_x.node()), IsOkAndHolds(1));
+  EXPECT_THAT(timing.GetDistancesToNode(sum.node()),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(x.node(), 2), Pair(neg_x.node(), 2), Pair(y.node(), 3),
+                  Pair(neg_y.node(), 3), Pair(neg_neg_y, 2),
+                  Pair(sum.node(), 1))));
+
+  // Bypass the new node and remove it again.
+  XLS_ASSERT_OK(
+      sum.node()->ReplaceOperandNumber(1, x.node(), /*type_must_match=*/true));
+  XLS_ASSERT_OK(f->RemoveNode(neg_neg_y));
+  XLS_ASSERT_OK(f->RemoveNode(neg_y.node()));
+  XLS_EXPECT_OK(timing.CheckConsistency());
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(2));
+  EXPECT_THAT(timing.GetArrivalTime(sum.node()), IsOkAndHolds(2));
+  EXPECT_THAT(timing.GetDelayToSinks(y.node()), IsOkAndHolds(0));
+  EXPECT_THAT(timing.GetDelayToSinks(x.node()), IsOkAndHolds(2));
+  EXPECT_THAT(timing.GetDistancesToNode(sum.node()),
+              IsOkAndHolds(UnorderedElementsAre(Pair(x.node(), 2),
+                                                Pair(neg_x.node(), 2),
+                                                Pair(sum.node(), 1))));
+  XLS_EXPECT_OK(timing.CheckConsistency());
+}
+
+TEST_F(TimingAnalysisTest, DelayOverrides) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto neg = fb.Negate(x);
+  auto rev = fb.Reverse(neg);
+  auto neg_x = fb.Negate(x);
+  fb.Concat({rev, neg_x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TimingAnalysis timing(f, *delay_estimator_);
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetSlack(neg_x.node()), IsOkAndHolds(1));
+
+  timing.SetNodeDelay(neg_x.node(), 5);
+  EXPECT_THAT(timing.GetNodeDelay(neg_x.node()), IsOkAndHolds(5));
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(6));
+  EXPECT_THAT(timing.GetSlack(neg.node()), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetDelayToSinks(x.node()), IsOkAndHolds(6));
+  XLS_EXPECT_OK(timing.CheckConsistency());
+
+  timing.ClearNodeDelay(neg_x.node());
+  EXPECT_THAT(timing.GetNodeDelay(neg_x.node()), IsOkAndHolds(1));
+  EXPECT_THAT(timing.GetCriticalPathDelay(), IsOkAndHolds(3));
+  EXPECT_THAT(timing.GetDelayToSinks(x.node()), IsOkAndHolds(3));
+  XLS_EXPECT_OK(timing.CheckConsistency());
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,329 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/estimate_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/estimate_cache.pb.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+// Appends `field` to `signature`, prefixed by its length so that distinct
+// sequences of fields never produce the same signature.
+void AppendField(std::string* signature, std::string_view field) {
+  absl::StrAppend(signature, field.size(), ":", field, ";");
+}
+
+void AppendField(std::string* signature, int64_t field) {
+  AppendField(signature, absl::StrCat(field));
+}
+
+// Returns the attributes of `node` which are not implied by its op, type and
+// operands, in a fixed order; or std::nullopt if the node should not be
+// memoized. Every op is listed so that adding one is a compile error here
+// until its attributes are accounted for.
+std::optional<std::vector<std::string>> GetAttributes(Node* node) {
+  std::vector<std::string> attributes;
+  switch (node->op()) {
+    // The estimate of these depends on the body of another function.
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+    case Op::kInvoke:
+    case Op::kMap:
+      return std::nullopt;
+
+    case Op::kArrayIndex:
+      attributes.push_back(
+          absl::StrCat(node->As<ArrayIndex>()->assumed_in_bounds()));
+      break;
+    case Op::kArraySlice:
+      attributes.push_back(absl::StrCat(node->As<ArraySlice>()->width()));
+      break;
+    case Op::kArrayUpdate:
+      attributes.push_back(
+          absl::StrCat(node->As<ArrayUpdate>()->assumed_in_bounds()));
+      break;
+    case Op::kAssert:
+      attributes.push_back(node->As<Assert>()->message());
+      attributes.push_back(node->As<Assert>()->label().value_or(""));
+      break;
+    case Op::kBitSlice:
+      attributes.push_back(absl::StrCat(node->As<BitSlice>()->start()));
+      attributes.push_back(absl::StrCat(node->As<BitSlice>()->width()));
+      break;
+    case Op::kCover:
+      attributes.push_back(node->As<Cover>()->label());
+      break;
+    case Op::kDecode:
+      attributes.push_back(absl::StrCat(node->As<Decode>()->width()));
+      break;
+    case Op::kDynamicBitSlice:
+      attributes.push_back(absl::StrCat(node->As<DynamicBitSlice>()->width()));
+      break;
+    case Op::kInputPort:
+    case Op::kOutputPort:
+      // The port name is part of the interface, not just a node name.
+      attributes.push_back(node->GetName());
+      break;
+    case Op::kInstantiationInput: {
+      const InstantiationInput* port = node->As<InstantiationInput>();
+      attributes.push_back(std::string(port->instantiation()->name()));
+      attributes.push_back(port->port_name());
+      break;
+    }
+    case Op::kInstantiationOutput: {
+      const InstantiationOutput* port = node->As<InstantiationOutput>();
+      attributes.push_back(std::string(port->instantiation()->name()));
+      attributes.push_back(port->port_name());
+      break;
+    }
+    case Op::kLiteral:
+      attributes.push_back(node->As<Literal>()->value().ToString());
+      break;
+    case Op::kMinDelay:
+      attributes.push_back(absl::StrCat(node->As<MinDelay>()->delay()));
+      break;
+    case Op::kOneHot:
+      attributes.push_back(
+          node->As<OneHot>()->priority() == LsbOrMsb::kLsb ? "lsb" : "msb");
+      break;
+    case Op::kReceive:
+      attributes.push_back(node->As<Receive>()->channel_name());
+      attributes.push_back(absl::StrCat(node->As<Receive>()->is_blocking()));
+      break;
+    case Op::kRegisterRead:
+      attributes.push_back(node->As<RegisterRead>()->GetRegister()->name());
+      break;
+    case Op::kRegisterWrite: {
+      const RegisterWrite* write = node->As<RegisterWrite>();
+      attributes.push_back(write->GetRegister()->name());
+      attributes.push_back(absl::StrCat(write->load_enable().has_value()));
+      attributes.push_back(absl::StrCat(write->reset().has_value()));
+      break;
+    }
+    case Op::kSel:
+      attributes.push_back(
+          absl::StrCat(node->As<Select>()->default_value().has_value()));
+      break;
+    case Op::kSend:
+      attributes.push_back(node->As<Send>()->channel_name());
+      break;
+    case Op::kSignExt:
+    case Op::kZeroExt:
+      attributes.push_back(absl::StrCat(node->As<ExtendOp>()->new_bit_count()));
+      break;
+    case Op::kStateRead:
+      attributes.push_back(node->As<StateRead>()->state_element()->name());
+      break;
+    case Op::kTrace:
+      attributes.push_back(
+          StepsToXlsFormatString(node->As<Trace>()->format()));
+      attributes.push_back(absl::StrCat(node->As<Trace>()->verbosity()));
+      break;
+    case Op::kTupleIndex:
+      attributes.push_back(absl::StrCat(node->As<TupleIndex>()->index()));
+      break;
+
+    // These are fully described by their op, type and operands.
+    case Op::kAdd:
+    case Op::kAfterAll:
+    case Op::kAnd:
+    case Op::kAndReduce:
+    case Op::kArray:
+    case Op::kArrayConcat:
+    case Op::kBitSliceUpdate:
+    case Op::kConcat:
+    case Op::kEncode:
+    case Op::kEq:
+    case Op::kGate:
+    case Op::kIdentity:
+    case Op::kNand:
+    case Op::kNe:
+    case Op::kNeg:
+    case Op::kNext:
+    case Op::kNor:
+    case Op::kNot:
+    case Op::kOneHotSel:
+    case Op::kOr:
+    case Op::kOrReduce:
+    case Op::kParam:
+    case Op::kPrioritySel:
+    case Op::kReverse:
+    case Op::kSDiv:
+    case Op::kSGe:
+    case Op::kSGt:
+    case Op::kSLe:
+    case Op::kSLt:
+    case Op::kSMod:
+    case Op::kSMul:
+    case Op::kSMulp:
+    case Op::kShll:
+    case Op::kShra:
+    case Op::kShrl:
+    case Op::kSub:
+    case Op::kTuple:
+    case Op::kUDiv:
+    case Op::kUGe:
+    case Op::kUGt:
+    case Op::kULe:
+    case Op::kULt:
+    case Op::kUMod:
+    case Op::kUMul:
+    case Op::kUMulp:
+    case Op::kXor:
+    case Op::kXorReduce:
+      break;
+  }
+  return attributes;
+}
+
+absl::Status CheckEstimatorName(const EstimateCacheProto& proto,
+                                std::string_view estimator_name,
+                                const std::filesystem::path& path) {
+  if (proto.estimator_name() != estimator_name) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Estimate cache %s was written by estimator `%s`, not `%s`",
+        path.string(), proto.estimator_name(), estimator_name));
+  }
+  return absl::OkStatus();
+}
+
+// Returns whether the estimates in `proto` were made by the same version of
+// the model as `model_fingerprint`; if not, they must not be used.
+bool IsCurrentModel(const EstimateCacheProto& proto,
+                    std::string_view model_fingerprint,
+                    const std::filesystem::path& path) {
+  if (proto.model_fingerprint() == model_fingerprint) {
+    return true;
+  }
+  LOG(WARNING) << absl::StreamFormat(
+      "Ignoring estimate cache %s: it was written by model version `%s` of "
+      "estimator `%s`, not `%s`",
+      path.string(), proto.model_fingerprint(), proto.estimator_name(),
+      model_fingerprint);
+  return false;
+}
+
+}  // namespace
+
+std::optional<std::string> GetEstimationSignature(Node* node) {
+  std::optional<std::vector<std::string>> attributes = GetAttributes(node);
+  if (!attributes.has_value()) {
+    return std::nullopt;
+  }
+
+  std::string signature;
+  AppendField(&signature, OpToString(node->op()));
+  AppendField(&signature, node->GetType()->ToString());
+  AppendField(&signature, node->operand_count());
+  // Each operand is described by its type, the position of its first
+  // occurrence (so that repeated operands are distinguished from distinct
+  // ones), and its value if it is a literal.
+  absl::flat_hash_map<Node*, int64_t> first_occurrence;
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    auto [it, inserted] = first_occurrence.try_emplace(operand, i);
+    AppendField(&signature, operand->GetType()->ToString());
+    AppendField(&signature, it->second);
+    AppendField(&signature, operand->Is<Literal>()
+                                ? operand->As<Literal>()->value().ToString()
+                                : "");
+  }
+  AppendField(&signature, attributes->size());
+  for (const std::string& attribute : *attributes) {
+    AppendField(&signature, attribute);
+  }
+  return signature;
+}
+
+template <>
+absl::Status EstimateCache<int64_t>::Load(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(EstimateCacheProto proto,
+                       ParseTextProtoFile<EstimateCacheProto>(path));
+  XLS_RETURN_IF_ERROR(CheckEstimatorName(proto, estimator_name_, path));
+  if (!IsCurrentModel(proto, model_fingerprint_, path)) {
+    return absl::OkStatus();
+  }
+  absl::WriterMutexLock lock(&mutex_);
+  for (const auto& [signature, delay] : proto.delays_ps()) {
+    estimates_.insert_or_assign(signature, delay);
+  }
+  return absl::OkStatus();
+}
+
+template <>
+absl::Status EstimateCache<int64_t>::Save(
+    const std::filesystem::path& path) const {
+  EstimateCacheProto proto;
+  proto.set_estimator_name(estimator_name_);
+  proto.set_model_fingerprint(model_fingerprint_);
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    for (const auto& [signature, delay] : estimates_) {
+      (*proto.mutable_delays_ps())[signature] = delay;
+    }
+  }
+  return SetTextProtoFile(path, proto);
+}
+
+template <>
+absl::Status EstimateCache<double>::Load(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(EstimateCacheProto proto,
+                       ParseTextProtoFile<EstimateCacheProto>(path));
+  XLS_RETURN_IF_ERROR(CheckEstimatorName(proto, estimator_name_, path));
+  if (!IsCurrentModel(proto, model_fingerprint_, path)) {
+    return absl::OkStatus();
+  }
+  absl::WriterMutexLock lock(&mutex_);
+  for (const auto& [signature, area] : proto.areas_um2()) {
+    estimates_.insert_or_assign(signature, area);
+  }
+  return absl::OkStatus();
+}
+
+template <>
+absl::Status EstimateCache<double>::Save(
+    const std::filesystem::path& path) const {
+  EstimateCacheProto proto;
+  proto.set_estimator_name(estimator_name_);
+  proto.set_model_fingerprint(model_fingerprint_);
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    for (const auto& [signature, area] : estimates_) {
+      (*proto.mutable_areas_um2())[signature] = area;
+    }
+  }
+  return SetTextProtoFile(path, proto);
+}
+
+}  // namespace xls
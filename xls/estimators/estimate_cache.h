@@ -0,0 +1,197 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_ESTIMATORS_ESTIMATE_CACHE_H_
+#define XLS_ESTIMATORS_ESTIMATE_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Returns a string identifying everything about `node` that a delay or area
+// estimator may depend on: its op, its type, the types of its operands (and
+// values of any literal operands), which operands are the same node, and any
+// op-specific attributes. Node names and ids are not included, so
+// structurally identical nodes in different functions, packages or
+// invocations have the same signature.
+//
+// Returns std::nullopt if the estimate of the node may depend on more than the
+// node itself (e.g., on the body of an invoked function); such nodes should
+// not be memoized.
+std::optional<std::string> GetEstimationSignature(Node* node);
+
+// A thread-safe map from estimation signature to the estimate of type `T` made
+// by a single estimator, which can be saved to and loaded from disk.
+template <typename T>
+class EstimateCache {
+ public:
+  // `model_fingerprint` identifies the version of the estimator's model (see
+  // DelayEstimator::GetFingerprint); estimates persisted under a different
+  // fingerprint are not loaded.
+  explicit EstimateCache(std::string_view estimator_name,
+                         std::string_view model_fingerprint = "")
+      : estimator_name_(estimator_name),
+        model_fingerprint_(model_fingerprint) {}
+
+  const std::string& estimator_name() const { return estimator_name_; }
+  const std::string& model_fingerprint() const { return model_fingerprint_; }
+
+  std::optional<T> Find(std::string_view signature) const {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = estimates_.find(signature);
+    if (it == estimates_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  void Insert(std::string signature, T estimate) {
+    absl::WriterMutexLock lock(&mutex_);
+    estimates_.insert_or_assign(std::move(signature), estimate);
+  }
+
+  int64_t size() const {
+    absl::ReaderMutexLock lock(&mutex_);
+    return estimates_.size();
+  }
+
+  // Estimates each of `nodes`, in order, consulting and populating the cache.
+  // `estimate` is called once per distinct signature which is not yet cached
+  // (with all such nodes at once), and once per node with no signature. The
+  // lock is only taken twice per call, however many nodes there are.
+  absl::StatusOr<std::vector<T>> Estimate(
+      absl::Span<Node* const> nodes,
+      absl::FunctionRef<absl::StatusOr<std::vector<T>>(absl::Span<Node* const>)>
+          estimate);
+
+  // Merges the estimates in the file at `path`, which must have been written
+  // by an estimator of the same name, into the cache. If they were made by a
+  // different version of the model (their fingerprint differs), they are
+  // stale and are ignored, so every node is a miss.
+  absl::Status Load(const std::filesystem::path& path);
+
+  // Writes all cached estimates to the file at `path`.
+  absl::Status Save(const std::filesystem::path& path) const;
+
+  // Number of estimates served from the cache, and made by the estimator.
+  int64_t hits() const {
+    absl::ReaderMutexLock lock(&mutex_);
+    return hits_;
+  }
+  int64_t misses() const {
+    absl::ReaderMutexLock lock(&mutex_);
+    return misses_;
+  }
+
+ private:
+  const std::string estimator_name_;
+  const std::string model_fingerprint_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, T> estimates_ ABSL_GUARDED_BY(mutex_);
+  int64_t hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+template <typename T>
+absl::StatusOr<std::vector<T>> EstimateCache<T>::Estimate(
+    absl::Span<Node* const> nodes,
+    absl::FunctionRef<absl::StatusOr<std::vector<T>>(absl::Span<Node* const>)>
+        estimate) {
+  std::vector<std::optional<std::string>> signatures;
+  signatures.reserve(nodes.size());
+  for (Node* node : nodes) {
+    signatures.push_back(GetEstimationSignature(node));
+  }
+
+  std::vector<T> estimates(nodes.size());
+  // The nodes to pass to `estimate`: one per missing signature, plus every
+  // node without a signature. `pending[i]` lists the indices in `nodes` which
+  // take their estimate from `to_estimate[i]`.
+  std::vector<Node*> to_estimate;
+  std::vector<std::vector<int64_t>> pending;
+  {
+    absl::WriterMutexLock lock(&mutex_);
+    absl::flat_hash_map<std::string_view, int64_t> missing;
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      if (signatures[i].has_value()) {
+        if (auto it = estimates_.find(*signatures[i]); it != estimates_.end()) {
+          estimates[i] = it->second;
+          ++hits_;
+          continue;
+        }
+        auto [it, inserted] =
+            missing.try_emplace(*signatures[i], to_estimate.size());
+        if (!inserted) {
+          pending[it->second].push_back(i);
+          ++hits_;
+          continue;
+        }
+      }
+      to_estimate.push_back(nodes[i]);
+      pending.push_back({i});
+      ++misses_;
+    }
+  }
+  if (to_estimate.empty()) {
+    return estimates;
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<T> new_estimates, estimate(to_estimate));
+  XLS_RET_CHECK_EQ(new_estimates.size(), to_estimate.size());
+  absl::WriterMutexLock lock(&mutex_);
+  for (int64_t j = 0; j < to_estimate.size(); ++j) {
+    for (int64_t i : pending[j]) {
+      estimates[i] = new_estimates[j];
+    }
+    const std::optional<std::string>& signature = signatures[pending[j][0]];
+    if (signature.has_value()) {
+      estimates_.insert_or_assign(*signature, new_estimates[j]);
+    }
+  }
+  return estimates;
+}
+
+// Persistence is implemented for the kinds of estimate made by delay and area
+// estimators.
+template <>
+absl::Status EstimateCache<int64_t>::Load(const std::filesystem::path& path);
+template <>
+absl::Status EstimateCache<int64_t>::Save(
+    const std::filesystem::path& path) const;
+template <>
+absl::Status EstimateCache<double>::Load(const std::filesystem::path& path);
+template <>
+absl::Status EstimateCache<double>::Save(
+    const std::filesystem::path& path) const;
+
+}  // namespace xls
+
+#endif  // XLS_ESTIMATORS_ESTIMATE_CACHE_H_
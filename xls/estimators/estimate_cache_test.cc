@@ -0,0 +1,224 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/estimate_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Ne;
+using ::testing::Optional;
+
+class EstimateCacheTest : public IrTestBase {};
+
+TEST_F(EstimateCacheTest, SignatureIgnoresNames) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1("f1", p.get());
+  BValue add1 = fb1.Add(fb1.Param("a", p->GetBitsType(32)),
+                        fb1.Param("b", p->GetBitsType(32)));
+  BValue add_same = fb1.Add(add1, add1);
+  BValue shift_by_literal =
+      fb1.Shll(add1, fb1.Literal(UBits(3, 32)), SourceInfo(), "shifted");
+  XLS_ASSERT_OK(fb1.Build().status());
+
+  FunctionBuilder fb2("f2", p.get());
+  BValue add2 = fb2.Add(fb2.Param("x", p->GetBitsType(32)),
+                        fb2.Param("y", p->GetBitsType(32)), SourceInfo(),
+                        "sum");
+  BValue narrow_add = fb2.Add(fb2.Param("n", p->GetBitsType(8)),
+                              fb2.Param("m", p->GetBitsType(8)));
+  BValue shift_by_other_literal = fb2.Shll(add2, fb2.Literal(UBits(4, 32)));
+  XLS_ASSERT_OK(fb2.Build().status());
+
+  std::optional<std::string> signature = GetEstimationSignature(add1.node());
+  ASSERT_TRUE(signature.has_value());
+  EXPECT_THAT(GetEstimationSignature(add2.node()), Optional(Eq(*signature)));
+  EXPECT_THAT(GetEstimationSignature(narrow_add.node()),
+              Optional(Ne(*signature)));
+  // Adding a node to itself is not the same operation as adding two nodes.
+  EXPECT_THAT(GetEstimationSignature(add_same.node()),
+              Optional(Ne(*signature)));
+  // Literal operands are part of the signature.
+  EXPECT_THAT(GetEstimationSignature(shift_by_literal.node()),
+              Optional(Ne(*GetEstimationSignature(
+                  shift_by_other_literal.node()))));
+}
+
+TEST_F(EstimateCacheTest, SignatureIncludesAttributes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue low = fb.BitSlice(x, /*start=*/0, /*width=*/8);
+  BValue high = fb.BitSlice(x, /*start=*/24, /*width=*/8, SourceInfo(), "id");
+  BValue other_low = fb.BitSlice(fb.Param("start", p->GetBitsType(32)),
+                                 /*start=*/0, /*width=*/8);
+  BValue tuple = fb.Tuple({x, x});
+  BValue first = fb.TupleIndex(tuple, 0);
+  BValue second = fb.TupleIndex(tuple, 1);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EXPECT_THAT(GetEstimationSignature(low.node()),
+              Optional(Ne(*GetEstimationSignature(high.node()))));
+  EXPECT_THAT(GetEstimationSignature(low.node()),
+              Optional(Eq(*GetEstimationSignature(other_low.node()))));
+  EXPECT_THAT(GetEstimationSignature(first.node()),
+              Optional(Ne(*GetEstimationSignature(second.node()))));
+}
+
+TEST_F(EstimateCacheTest, InvokeHasNoSignature) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_builder("callee", p.get());
+  callee_builder.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, callee_builder.Build());
+
+  FunctionBuilder fb(TestName(), p.get());
+  BValue invoke = fb.Invoke({fb.Param("y", p->GetBitsType(32))}, callee);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EXPECT_EQ(GetEstimationSignature(invoke.node()), std::nullopt);
+}
+
+TEST_F(EstimateCacheTest, EstimatesEachSignatureOnce) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue neg_x = fb.Negate(x);
+  BValue neg_y = fb.Negate(y);
+  BValue sum = fb.Add(neg_x, neg_y);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EstimateCache<int64_t> cache("test");
+  int64_t estimated = 0;
+  auto estimate = [&](absl::Span<Node* const> nodes)
+      -> absl::StatusOr<std::vector<int64_t>> {
+    std::vector<int64_t> estimates;
+    for (Node* node : nodes) {
+      ++estimated;
+      estimates.push_back(node->operand_count());
+    }
+    return estimates;
+  };
+
+  std::vector<Node*> nodes = {neg_x.node(), neg_y.node(), sum.node()};
+  EXPECT_THAT(cache.Estimate(nodes, estimate),
+              IsOkAndHolds(ElementsAre(1, 1, 2)));
+  EXPECT_EQ(estimated, 2);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 2);
+
+  EXPECT_THAT(cache.Estimate({sum.node(), neg_x.node()}, estimate),
+              IsOkAndHolds(ElementsAre(2, 1)));
+  EXPECT_EQ(estimated, 2);
+  EXPECT_EQ(cache.hits(), 3);
+}
+
+TEST_F(EstimateCacheTest, SaveAndLoad) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue neg = fb.Negate(fb.Param("x", p->GetBitsType(32)));
+  XLS_ASSERT_OK(fb.Build().status());
+  std::string signature = *GetEstimationSignature(neg.node());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "cache.textproto";
+  EstimateCache<int64_t> cache("test");
+  cache.Insert(signature, 42);
+  XLS_ASSERT_OK(cache.Save(path));
+
+  EstimateCache<int64_t> loaded("test");
+  XLS_ASSERT_OK(loaded.Load(path));
+  EXPECT_THAT(loaded.Find(signature), Optional(42));
+
+  EstimateCache<int64_t> other("other");
+  EXPECT_THAT(other.Load(path), StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(EstimateCacheTest, SaveAndLoadAreas) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue neg = fb.Negate(fb.Param("x", p->GetBitsType(32)));
+  XLS_ASSERT_OK(fb.Build().status());
+  std::string signature = *GetEstimationSignature(neg.node());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "cache.textproto";
+  EstimateCache<double> cache("test");
+  cache.Insert(signature, 2.5);
+  XLS_ASSERT_OK(cache.Save(path));
+
+  EstimateCache<double> loaded("test");
+  XLS_ASSERT_OK(loaded.Load(path));
+  EXPECT_THAT(loaded.Find(signature), Optional(2.5));
+}
+
+TEST_F(EstimateCacheTest, LoadIgnoresOtherModelVersions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue neg = fb.Negate(fb.Param("x", p->GetBitsType(32)));
+  XLS_ASSERT_OK(fb.Build().status());
+  std::string signature = *GetEstimationSignature(neg.node());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "cache.textproto";
+  EstimateCache<int64_t> cache("test", "v1");
+  cache.Insert(signature, 42);
+  XLS_ASSERT_OK(cache.Save(path));
+
+  EstimateCache<int64_t> same_version("test", "v1");
+  XLS_ASSERT_OK(same_version.Load(path));
+  EXPECT_THAT(same_version.Find(signature), Optional(42));
+
+  // Estimates from another version of the model are stale: the node must be
+  // estimated again.
+  EstimateCache<int64_t> new_version("test", "v2");
+  XLS_ASSERT_OK(new_version.Load(path));
+  EXPECT_EQ(new_version.Find(signature), std::nullopt);
+  auto estimate = [](absl::Span<Node* const> nodes)
+      -> absl::StatusOr<std::vector<int64_t>> {
+    return std::vector<int64_t>(nodes.size(), 7);
+  };
+  EXPECT_THAT(new_version.Estimate({neg.node()}, estimate),
+              IsOkAndHolds(ElementsAre(7)));
+  EXPECT_EQ(new_version.misses(), 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -27,3 +27,14 @@ fn apply_stencil_float32_8x8(
     row_idx:u32, col_idx:u32, stencil: F32[3][3]) -> F32 {
   sobel_filter::apply_stencil_float32<u32:8, u32:8>(in_img, row_idx, col_idx, stencil)
 }
+
+// Thresholds an 8-bit grayscale image (e.g., edge magnitudes produced by the
+// sobel filter) into a black and white image. The per-pixel function is
+// element-wise so the JIT evaluates the map several pixels at a time.
+fn binarize_pixel(pixel: u8) -> u8 {
+  if pixel > u8:127 { u8:255 } else { u8:0 }
+}
+
+fn binarize_u8_64x64(in_img: u8[4096]) -> u8[4096] {
+  map(in_img, binarize_pixel)
+}
@@ -30,6 +30,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -49,20 +50,59 @@ DelayManager::DelayManager(FunctionBase *function,
           function_->node_count(),
           std::vector<Node *>(function_->node_count(), nullptr)),
       name_(delay_estimator.name()) {
-  // Get the mapping between function node and their index. Also, estimate the
-  // delay of each node.
+  TimingAnalysis timing_analysis(function_, delay_estimator);
+  CHECK_OK(Initialize(timing_analysis));
+}
+
+DelayManager::DelayManager(FunctionBase *function,
+                           TimingAnalysis &timing_analysis)
+    : function_(function),
+      index_to_node_(function_->node_count()),
+      indices_to_delay_(function_->node_count(),
+                        std::vector<int64_t>(function_->node_count(), -1)),
+      indices_to_critical_operand_(
+          function_->node_count(),
+          std::vector<Node *>(function_->node_count(), nullptr)),
+      name_(timing_analysis.delay_estimator().name()) {
+  CHECK_OK(Initialize(timing_analysis));
+}
+
+absl::Status DelayManager::Initialize(TimingAnalysis &timing_analysis) {
+  XLS_RET_CHECK_EQ(timing_analysis.function_base(), function_);
+  // Get the mapping between function node and their index.
   node_to_index_.reserve(function_->node_count());
   int32_t index = 0;
   for (Node *node : function_->nodes()) {
     node_to_index_[node] = index;
     index_to_node_[index] = node;
-    absl::StatusOr<int64_t> maybe_delay =
-        delay_estimator.GetOperationDelayInPs(node);
-    CHECK_OK(maybe_delay.status());
-    indices_to_delay_[index][index] = maybe_delay.value();
     index++;
   }
-  PropagateDelays();
+
+  // The critical-path delay from `a` to `node` comes straight from the
+  // analysis. The critical operand is the first operand of `node` on such a
+  // path, as PropagateDelays would choose it.
+  for (Node *node : TopoSort(function_)) {
+    int64_t node_index = node_to_index_.at(node);
+    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                         timing_analysis.GetNodeDelay(node));
+    XLS_ASSIGN_OR_RETURN(TimingAnalysis::DistanceMap distances,
+                         timing_analysis.GetDistancesToNode(node));
+    for (const auto &[a, distance] : distances) {
+      indices_to_delay_[node_to_index_.at(a)][node_index] = distance;
+    }
+    for (Node *operand : node->operands()) {
+      int64_t operand_index = node_to_index_.at(operand);
+      for (int64_t i = 0; i < function_->node_count(); ++i) {
+        int64_t to_operand_delay = indices_to_delay_[i][operand_index];
+        if (to_operand_delay != -1 &&
+            indices_to_critical_operand_[i][node_index] == nullptr &&
+            to_operand_delay + node_delay == indices_to_delay_[i][node_index]) {
+          indices_to_critical_operand_[i][node_index] = operand;
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
 }
 
 absl::StatusOr<int64_t> DelayManager::GetNodeDelay(Node *node) const {
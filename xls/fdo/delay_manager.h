@@ -25,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -77,6 +78,12 @@ class DelayManager {
   explicit DelayManager(FunctionBase *function,
                         const DelayEstimator &delay_estimator);
 
+  // Takes the node delays and the initial all-pairs delays from
+  // `timing_analysis`, which must analyze `function`, rather than estimating
+  // them again. Later updates made through this class do not affect the
+  // analysis.
+  DelayManager(FunctionBase *function, TimingAnalysis &timing_analysis);
+
   absl::StatusOr<int64_t> GetNodeDelay(Node *node) const;
 
   absl::StatusOr<int64_t> GetCriticalPathDelay(Node *from, Node *to) const;
@@ -133,6 +140,10 @@ class DelayManager {
   static float GetZeroScore(Node *from, Node *to) { return 0.0; }
   static bool GetFalse(Node *from, Node *to) { return false; }
 
+  // Fills in the node delays, all-pairs delays and critical operands from
+  // `timing_analysis`.
+  absl::Status Initialize(TimingAnalysis &timing_analysis);
+
   FunctionBase *function_;
 
   // A mapping from a node to its index in the function.
@@ -19,9 +19,12 @@
 #include <string>
 #include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status_matchers.h"
 #include "xls/common/status/matchers.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -31,6 +34,9 @@
 namespace xls {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+
 class DelayManagerTest : public IrTestBase {};
 
 // Smoke test.
@@ -176,5 +182,38 @@ fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
   EXPECT_EQ(new_udiv3_i0_delay, -1);
 }
 
+TEST_F(DelayManagerTest, FromTimingAnalysis) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  sub.2: bits[3] = sub(add.1, i1)
+  ret udiv.3: bits[3] = udiv(sub.2, add.1)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("main"));
+  Node *i0 = FindNode("i0", function);
+  Node *i1 = FindNode("i1", function);
+  Node *add1 = FindNode("add.1", function);
+  Node *sub2 = FindNode("sub.2", function);
+  Node *udiv3 = FindNode("udiv.3", function);
+
+  // Delays overridden in the analysis are seen by the manager.
+  TestDelayEstimator delay_estimator;
+  TimingAnalysis timing_analysis(function, delay_estimator);
+  timing_analysis.SetNodeDelay(sub2, 5);
+  DelayManager dm(function, timing_analysis);
+
+  EXPECT_THAT(dm.GetNodeDelay(sub2), IsOkAndHolds(5));
+  EXPECT_THAT(dm.GetCriticalPathDelay(i0, udiv3), IsOkAndHolds(8));
+  EXPECT_THAT(dm.GetCriticalPathDelay(i1, sub2), IsOkAndHolds(6));
+  EXPECT_THAT(dm.GetCriticalPathDelay(udiv3, i0), IsOkAndHolds(-1));
+  EXPECT_THAT(dm.GetFullCriticalPath(i0, udiv3),
+              IsOkAndHolds(ElementsAre(i0, add1, sub2, udiv3)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -27,6 +27,7 @@
 #include "xls/fdo/delay_manager.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/node.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/sdc_scheduler.h"
 
@@ -41,12 +42,14 @@ class IterativeSDCSchedulingModel : public SDCSchedulingModel {
   IterativeSDCSchedulingModel(FunctionBase* func,
                               absl::flat_hash_set<Node*> dead_after_synthesis,
                               const DelayManager& delay_manager)
-      : SDCSchedulingModel(func, std::move(dead_after_synthesis), DelayMap()),
+      : SDCSchedulingModel(func, std::move(dead_after_synthesis), DelayMap(),
+                           /*distances_to_node=*/{}),
         delay_manager_(delay_manager) {}
 
   // Overrides the original timing constraints builder. This method directly
   // call delay manager to extract the paths longer than the given clock period
-  // instead of recalculating them.
+  // instead of recalculating them. Calling it again after the delay manager's
+  // estimates are refined only adds and removes the constraints that changed.
   absl::Status AddTimingConstraints(int64_t clock_period_ps);
 
  private:
@@ -65,12 +68,15 @@ struct IterativeSDCSchedulingOptions {
 // Runs iterative SDC scheduling. Compared to the original SDC, the iterative
 // SDC scheduler will refine the delay estimations through low-level feedbacks,
 // e.g., from OpenROAD, and improve the scheduling results iteratively.
+//
+// If `metrics` is given, it is filled with statistics about the LP solves.
 absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     int64_t clock_period_ps, DelayManager& delay_manager,
     absl::Span<const SchedulingConstraint> constraints,
     const IterativeSDCSchedulingOptions& options,
-    SchedulingFailureBehavior failure_behavior = SchedulingFailureBehavior{});
+    SchedulingFailureBehavior failure_behavior = SchedulingFailureBehavior{},
+    SdcSolverMetricsProto* metrics = nullptr);
 
 }  // namespace xls
 
@@ -0,0 +1,123 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/bytecode_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/bytecode_program.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Evaluates the generic instructions of a function's bytecode program.
+class BytecodeFunctionVisitor final : public IrInterpreter {
+ public:
+  BytecodeFunctionVisitor(
+      absl::Span<const Value> args, std::optional<EvaluationObserver*> observer,
+      SlottedNodeValues& values,
+      absl::flat_hash_map<Function*,
+                          std::unique_ptr<BytecodeFunctionInterpreter>>*
+          callees)
+      : IrInterpreter(values, /*events=*/nullptr, observer),
+        args_(args),
+        callees_(callees) {}
+
+  absl::Status HandleParam(Param* param) override {
+    XLS_ASSIGN_OR_RETURN(int64_t index,
+                         param->function_base()->GetParamIndex(param));
+    if (index >= args_.size()) {
+      return absl::InternalError(absl::StrFormat(
+          "Parameter %s at index %d does not exist in args (of length %d)",
+          param->ToString(), index, args_.size()));
+    }
+    return SetValueResult(param, args_[index]);
+  }
+
+ protected:
+  absl::StatusOr<InterpreterResult<Value>> InterpretSubFunction(
+      Function* f, absl::Span<const Value> args) override {
+    std::unique_ptr<BytecodeFunctionInterpreter>& callee = (*callees_)[f];
+    if (callee == nullptr) {
+      XLS_ASSIGN_OR_RETURN(callee, BytecodeFunctionInterpreter::Create(f));
+    }
+    return callee->Run(args);
+  }
+
+ private:
+  absl::Span<const Value> args_;
+  absl::flat_hash_map<Function*, std::unique_ptr<BytecodeFunctionInterpreter>>*
+      callees_;
+};
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<BytecodeFunctionInterpreter>>
+BytecodeFunctionInterpreter::Create(Function* function) {
+  // Use the same node order as the IrInterpreter so side effects such as
+  // traces are recorded in the same order.
+  SlottedNodeValues order(function);
+  XLS_ASSIGN_OR_RETURN(
+      BytecodeProgram program,
+      BytecodeProgram::Compile(function, order.topo_order(),
+                               /*live_out=*/{function->return_value()}));
+  VLOG(3) << "Bytecode for function " << function->name() << ":\n"
+          << program.ToString();
+  return absl::WrapUnique(
+      new BytecodeFunctionInterpreter(function, std::move(program)));
+}
+
+absl::StatusOr<InterpreterResult<Value>> BytecodeFunctionInterpreter::Run(
+    absl::Span<const Value> args, std::optional<EvaluationObserver*> observer) {
+  VLOG(3) << "Interpreting bytecode for function " << function_->name();
+  XLS_RETURN_IF_ERROR(CheckFunctionArguments(function_, args));
+  frame_.Clear();
+  BytecodeFunctionVisitor visitor(args, observer, frame_.values(), &callees_);
+  XLS_ASSIGN_OR_RETURN(
+      int64_t end,
+      program_.Execute(
+          frame_, /*start=*/0,
+          [&](const BytecodeProgram::Instruction& instruction)
+              -> absl::StatusOr<BytecodeProgram::GenericResult> {
+            XLS_RETURN_IF_ERROR(instruction.node->VisitSingleNode(&visitor));
+            return BytecodeProgram::GenericResult::kContinue;
+          },
+          /*all_generic=*/observer.has_value()));
+  XLS_RET_CHECK_EQ(end, program_.end_index());
+  Value result = frame_.values().At(function_->return_value());
+  VLOG(2) << "Result = " << result;
+  return InterpreterResult<Value>{std::move(result),
+                                  std::move(visitor.GetInterpreterEvents())};
+}
+
+}  // namespace xls
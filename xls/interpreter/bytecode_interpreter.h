@@ -0,0 +1,74 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_BYTECODE_INTERPRETER_H_
+#define XLS_INTERPRETER_BYTECODE_INTERPRETER_H_
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/bytecode_program.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Evaluates a function by lowering it once to a BytecodeProgram and executing
+// the program on each call. Bits operations of at most 64 bits run directly on
+// machine words; all other operations use the IrInterpreter handlers. Compiling
+// is a single linear pass over the nodes so startup is much cheaper than the
+// JIT while evaluation of narrow datapaths is much faster than the
+// IrInterpreter. Functions called through invoke, map and counted_for nodes are
+// compiled on first use. The function must not be modified while the
+// interpreter exists. Not thread-safe.
+class BytecodeFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<BytecodeFunctionInterpreter>> Create(
+      Function* function);
+
+  Function* function() const { return function_; }
+  const BytecodeProgram& program() const { return program_; }
+
+  // Runs the function on the given arguments. Returns both the value and any
+  // events that happened while running. If an observer is given every node is
+  // evaluated by the IrInterpreter handlers so that the observer sees each
+  // node value.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args,
+      std::optional<EvaluationObserver*> observer = std::nullopt);
+
+ private:
+  BytecodeFunctionInterpreter(Function* function, BytecodeProgram program)
+      : function_(function),
+        program_(std::move(program)),
+        frame_(program_) {}
+
+  Function* function_;
+  BytecodeProgram program_;
+  BytecodeFrame frame_;
+  // Interpreters for the functions called by `function_`, created on first
+  // use.
+  absl::flat_hash_map<Function*, std::unique_ptr<BytecodeFunctionInterpreter>>
+      callees_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_BYTECODE_INTERPRETER_H_
@@ -0,0 +1,187 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/bytecode_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/bits_util.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::Field;
+
+absl::StatusOr<InterpreterResult<Value>> RunBytecode(
+    Function* function, absl::Span<const Value> args,
+    std::optional<EvaluationObserver*> observer) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunctionInterpreter> interpreter,
+                       BytecodeFunctionInterpreter::Create(function));
+  return interpreter->Run(args, observer);
+}
+
+// Instantiate and run all the tests in ir_evaluator_test_base.cc.
+INSTANTIATE_TEST_SUITE_P(
+    BytecodeInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args,
+           std::optional<EvaluationObserver*> obs) {
+          return RunBytecode(function, args, obs);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs,
+           std::optional<EvaluationObserver*> obs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                               KeywordArgsToPositional(*function, kwargs));
+          return RunBytecode(function, args, obs);
+        },
+        true, "BytecodeInterpreter")),
+    testing::PrintToStringParamName());
+
+class BytecodeInterpreterOnlyTest : public IrTestBase {};
+
+// Builds a function of two operands of the given widths which exercises every
+// fast-path opcode and returns all of the results in a tuple.
+absl::StatusOr<Function*> BuildNarrowOps(Package* p, int64_t width) {
+  FunctionBuilder fb("narrow_ops", p);
+  BValue x = fb.Param("x", p->GetBitsType(width));
+  BValue y = fb.Param("y", p->GetBitsType(width));
+  BValue amount = fb.Param("amount", p->GetBitsType(8));
+  BValue sel = fb.Param("sel", p->GetBitsType(2));
+  BValue k = fb.Literal(UBits(5, width));
+  std::vector<BValue> results = {
+      fb.Add(x, y),
+      fb.Subtract(x, k),
+      fb.UMul(x, y),
+      fb.SMul(x, y),
+      fb.UMul(x, y, /*result_width=*/width / 2),
+      fb.SMul(x, y, /*result_width=*/width / 2),
+      fb.UDiv(x, y),
+      fb.UMod(x, y),
+      fb.And({x, y, k}),
+      fb.Or({x, y}),
+      fb.Xor({x, y, k}),
+      fb.AddNaryOp(Op::kNand, {x, y}),
+      fb.AddNaryOp(Op::kNor, {x, y}),
+      fb.Not(x),
+      fb.Negate(y),
+      fb.Eq(x, y),
+      fb.Ne(x, y),
+      fb.ULt(x, y),
+      fb.ULe(x, y),
+      fb.UGt(x, y),
+      fb.UGe(x, y),
+      fb.SLt(x, y),
+      fb.SLe(x, y),
+      fb.SGt(x, y),
+      fb.SGe(x, y),
+      fb.Shll(x, amount),
+      fb.Shrl(x, amount),
+      fb.Shra(x, amount),
+      fb.SignExtend(x, 64),
+      fb.ZeroExtend(y, 64),
+      fb.BitSlice(x, 1, width - 2),
+      fb.Concat({fb.BitSlice(x, 0, 3), y, fb.BitSlice(y, 0, 1)}),
+      fb.Select(sel, {x, y, k}, /*default_value=*/fb.Not(k)),
+      fb.Gate(fb.Eq(sel, fb.Literal(UBits(1, 2))), x),
+      fb.AndReduce(x),
+      fb.OrReduce(y),
+      fb.XorReduce(x),
+      fb.Identity(x),
+  };
+  fb.Tuple(results);
+  return fb.Build();
+}
+
+TEST_F(BytecodeInterpreterOnlyTest, NarrowOpsMatchInterpreter) {
+  for (int64_t width : {4, 33, 60}) {
+    auto p = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildNarrowOps(p.get(), width));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BytecodeFunctionInterpreter> bc,
+                             BytecodeFunctionInterpreter::Create(f));
+    // Only the params and the tuple are evaluated by the generic handlers.
+    EXPECT_EQ(bc->program().generic_instruction_count(),
+              f->params().size() + 1);
+    const std::vector<uint64_t> samples = {
+        0, 1, 2, 3, 5, 7, 63, 12345, 0x5a5a5a5a, uint64_t{1} << 59,
+        ~uint64_t{0}};
+    for (uint64_t x : samples) {
+      for (uint64_t y : samples) {
+        for (int64_t amount : {0, 3, 59, 200}) {
+          std::vector<Value> args = {
+              Value(UBits(x & Mask(width), width)),
+              Value(UBits(y & Mask(width), width)),
+              Value(UBits(amount, 8)), Value(UBits((x + y) % 4, 2))};
+          XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                                   InterpretFunction(f, args));
+          XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                                   bc->Run(args));
+          ASSERT_EQ(actual.value, expected.value)
+              << "width=" << width << " x=" << x << " y=" << y
+              << " amount=" << amount;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(BytecodeInterpreterOnlyTest, WideValuesUseGenericPath) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(100));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  // A narrow result computed from a wide operand feeding narrow operations.
+  BValue narrow = fb.BitSlice(fb.Add(x, x), 90, 8);
+  fb.Add(fb.ZeroExtend(narrow, 32), y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BytecodeFunctionInterpreter> bc,
+                           BytecodeFunctionInterpreter::Create(f));
+  Bits wide = bits_ops::Concat({UBits(0x2a, 10), UBits(0, 90)});
+  std::vector<Value> args = {Value(wide), Value(UBits(3, 32))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                           InterpretFunction(f, args));
+  EXPECT_THAT(bc->Run(args),
+              IsOkAndHolds(
+                  Field(&InterpreterResult<Value>::value, expected.value)));
+}
+
+}  // namespace
+}  // namespace xls
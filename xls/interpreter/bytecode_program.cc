@@ -0,0 +1,649 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/bytecode_program.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/macros.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/bits_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+
+// Use computed gotos for instruction dispatch where the compiler supports
+// them. This gives each instruction its own indirect branch which predicts
+// much better than the single indirect branch of a switch.
+#if defined(__GNUC__)
+#define XLS_BYTECODE_THREADED_DISPATCH 1
+#else
+#define XLS_BYTECODE_THREADED_DISPATCH 0
+#endif
+
+namespace xls {
+namespace {
+
+using Op = BytecodeProgram::Op;
+using Operand = BytecodeProgram::Operand;
+using Instruction = BytecodeProgram::Instruction;
+
+// All opcodes in enum order.
+#define XLS_BYTECODE_OPS(X) \
+  X(kGeneric)               \
+  X(kToValue)               \
+  X(kLiteral)               \
+  X(kIdentity)              \
+  X(kAdd)                   \
+  X(kSub)                   \
+  X(kUMul)                  \
+  X(kSMul)                  \
+  X(kUDiv)                  \
+  X(kUMod)                  \
+  X(kAnd)                   \
+  X(kOr)                    \
+  X(kXor)                   \
+  X(kNand)                  \
+  X(kNor)                   \
+  X(kNot)                   \
+  X(kNeg)                   \
+  X(kEq)                    \
+  X(kNe)                    \
+  X(kULt)                   \
+  X(kULe)                   \
+  X(kUGt)                   \
+  X(kUGe)                   \
+  X(kSLt)                   \
+  X(kSLe)                   \
+  X(kSGt)                   \
+  X(kSGe)                   \
+  X(kShll)                  \
+  X(kShrl)                  \
+  X(kShra)                  \
+  X(kSignExt)               \
+  X(kBitSlice)              \
+  X(kConcat)                \
+  X(kSel)                   \
+  X(kGate)                  \
+  X(kAndReduce)             \
+  X(kOrReduce)              \
+  X(kXorReduce)             \
+  X(kEnd)
+
+#define XLS_BYTECODE_OP_ENUM(name) Op::name,
+constexpr Op kAllOps[] = {XLS_BYTECODE_OPS(XLS_BYTECODE_OP_ENUM)};
+#undef XLS_BYTECODE_OP_ENUM
+
+constexpr bool OpsAreInEnumOrder() {
+  for (int64_t i = 0; i < ABSL_ARRAYSIZE(kAllOps); ++i) {
+    if (static_cast<int64_t>(kAllOps[i]) != i) {
+      return false;
+    }
+  }
+  return ABSL_ARRAYSIZE(kAllOps) == BytecodeProgram::kOpCount;
+}
+static_assert(OpsAreInEnumOrder(),
+              "XLS_BYTECODE_OPS must list every opcode in enum order");
+
+std::string_view OpName(Op op) {
+#define XLS_BYTECODE_OP_NAME(name) #name,
+  static constexpr std::string_view kNames[] = {
+      XLS_BYTECODE_OPS(XLS_BYTECODE_OP_NAME)};
+#undef XLS_BYTECODE_OP_NAME
+  return kNames[static_cast<int64_t>(op)];
+}
+
+bool IsNarrowBits(Node* node) {
+  return node->GetType()->IsBits() && node->BitCountOrDie() <= 64;
+}
+
+int64_t SignExtend(uint64_t value, int64_t bit_count) {
+  if (bit_count == 0) {
+    return 0;
+  }
+  int64_t shift = 64 - bit_count;
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+uint64_t ToRegister(const Value& value) {
+  return value.bits().WordToUint64(0).value();
+}
+
+// Returns the fast-path opcode for `node` or std::nullopt if the node must be
+// evaluated by the generic handler. Assumes the node and all of its operands
+// are narrow bits.
+std::optional<Op> FastOp(Node* node) {
+  switch (node->op()) {
+    case xls::Op::kLiteral:
+      return Op::kLiteral;
+    case xls::Op::kIdentity:
+    case xls::Op::kZeroExt:
+      return Op::kIdentity;
+    case xls::Op::kAdd:
+      return Op::kAdd;
+    case xls::Op::kSub:
+      return Op::kSub;
+    case xls::Op::kUMul:
+      return Op::kUMul;
+    case xls::Op::kSMul:
+      return Op::kSMul;
+    case xls::Op::kUDiv:
+      return Op::kUDiv;
+    case xls::Op::kUMod:
+      return Op::kUMod;
+    case xls::Op::kAnd:
+      return Op::kAnd;
+    case xls::Op::kOr:
+      return Op::kOr;
+    case xls::Op::kXor:
+      return Op::kXor;
+    case xls::Op::kNand:
+      return Op::kNand;
+    case xls::Op::kNor:
+      return Op::kNor;
+    case xls::Op::kNot:
+      return Op::kNot;
+    case xls::Op::kNeg:
+      return Op::kNeg;
+    case xls::Op::kEq:
+      return Op::kEq;
+    case xls::Op::kNe:
+      return Op::kNe;
+    case xls::Op::kULt:
+      return Op::kULt;
+    case xls::Op::kULe:
+      return Op::kULe;
+    case xls::Op::kUGt:
+      return Op::kUGt;
+    case xls::Op::kUGe:
+      return Op::kUGe;
+    case xls::Op::kSLt:
+      return Op::kSLt;
+    case xls::Op::kSLe:
+      return Op::kSLe;
+    case xls::Op::kSGt:
+      return Op::kSGt;
+    case xls::Op::kSGe:
+      return Op::kSGe;
+    case xls::Op::kShll:
+      return Op::kShll;
+    case xls::Op::kShrl:
+      return Op::kShrl;
+    case xls::Op::kShra:
+      return Op::kShra;
+    case xls::Op::kSignExt:
+      return Op::kSignExt;
+    case xls::Op::kBitSlice:
+      return Op::kBitSlice;
+    case xls::Op::kConcat:
+      return Op::kConcat;
+    case xls::Op::kSel:
+      return Op::kSel;
+    case xls::Op::kGate:
+      return Op::kGate;
+    case xls::Op::kAndReduce:
+      return Op::kAndReduce;
+    case xls::Op::kOrReduce:
+      return Op::kOrReduce;
+    case xls::Op::kXorReduce:
+      return Op::kXorReduce;
+    default:
+      return std::nullopt;
+  }
+}
+
+}  // namespace
+
+BytecodeFrame::BytecodeFrame(const BytecodeProgram& program)
+    : registers_(program.register_count(), 0),
+      values_(program.function_base()) {}
+
+/* static */ absl::StatusOr<BytecodeProgram> BytecodeProgram::Compile(
+    FunctionBase* function_base, absl::Span<Node* const> order,
+    absl::Span<Node* const> live_out) {
+  XLS_RET_CHECK_EQ(order.size(), function_base->node_count());
+  BytecodeProgram program(function_base);
+
+  // Assign registers and choose the opcode of each node.
+  absl::flat_hash_map<Node*, Op> ops;
+  for (Node* node : order) {
+    if (!IsNarrowBits(node)) {
+      ops[node] = Op::kGeneric;
+      continue;
+    }
+    program.register_of_[node] =
+        Operand{.reg = static_cast<int32_t>(program.register_count_++),
+                .bit_count = static_cast<int32_t>(node->BitCountOrDie())};
+    std::optional<Op> op = FastOp(node);
+    for (Node* operand : node->operands()) {
+      if (!program.register_of_.contains(operand)) {
+        XLS_RET_CHECK(!IsNarrowBits(operand))
+            << "Nodes are not in topological order at " << node->GetName();
+        op = std::nullopt;
+      }
+    }
+    ops[node] = op.value_or(Op::kGeneric);
+  }
+
+  // Determine which nodes need their Value in addition to (or instead of) a
+  // register.
+  absl::flat_hash_set<Node*> needs_value(live_out.begin(), live_out.end());
+  for (Node* node : order) {
+    if (ops.at(node) == Op::kGeneric) {
+      needs_value.insert(node->operands().begin(), node->operands().end());
+    }
+  }
+
+  for (Node* node : order) {
+    Op op = ops.at(node);
+    Instruction instruction{.op = op, .node = node};
+    if (auto it = program.register_of_.find(node);
+        it != program.register_of_.end()) {
+      instruction.dst = it->second.reg;
+      instruction.bit_count = it->second.bit_count;
+    }
+    auto operand = [&](int64_t i) {
+      return program.register_of_.at(node->operand(i));
+    };
+    auto add_operands = [&](absl::Span<Node* const> nodes) {
+      instruction.operand_start =
+          static_cast<int32_t>(program.operands_.size());
+      instruction.operand_count = static_cast<int32_t>(nodes.size());
+      for (Node* n : nodes) {
+        program.operands_.push_back(program.register_of_.at(n));
+      }
+    };
+    switch (op) {
+      case Op::kGeneric:
+        ++program.generic_instruction_count_;
+        break;
+      case Op::kLiteral:
+        instruction.imm = ToRegister(node->As<Literal>()->value());
+        break;
+      case Op::kAnd:
+      case Op::kOr:
+      case Op::kXor:
+      case Op::kNand:
+      case Op::kNor:
+      case Op::kConcat:
+        add_operands(node->operands());
+        break;
+      case Op::kBitSlice:
+        instruction.a = operand(0);
+        instruction.imm = node->As<BitSlice>()->start();
+        break;
+      case Op::kSel: {
+        Select* sel = node->As<Select>();
+        instruction.a = program.register_of_.at(sel->selector());
+        add_operands(sel->cases());
+        if (sel->default_value().has_value()) {
+          instruction.b = program.register_of_.at(*sel->default_value());
+        }
+        break;
+      }
+      default:
+        instruction.a = operand(0);
+        if (node->operand_count() > 1) {
+          XLS_RET_CHECK_EQ(node->operand_count(), 2) << node->ToString();
+          instruction.b = operand(1);
+        }
+        break;
+    }
+    program.instructions_.push_back(instruction);
+
+    if (op != Op::kGeneric && needs_value.contains(node)) {
+      program.instructions_.push_back(Instruction{
+          .op = Op::kToValue,
+          .bit_count = instruction.bit_count,
+          .a = program.register_of_.at(node),
+          .node = node,
+      });
+    }
+  }
+  program.instructions_.push_back(Instruction{.op = Op::kEnd});
+  return program;
+}
+
+absl::StatusOr<int64_t> BytecodeProgram::Execute(BytecodeFrame& frame,
+                                                 int64_t start,
+                                                 GenericHandler generic,
+                                                 bool all_generic) const {
+  if (all_generic) {
+    return ExecuteAllGeneric(frame, start, generic);
+  }
+  uint64_t* const r = frame.registers().data();
+  SlottedNodeValues& values = frame.values();
+  const Operand* const operands = operands_.data();
+  const Instruction* const begin = instructions_.data();
+  const Instruction* pc = begin + start;
+
+#if XLS_BYTECODE_THREADED_DISPATCH
+#define XLS_BYTECODE_OP_LABEL(name) &&op_##name,
+  static const void* const kDispatch[] = {
+      XLS_BYTECODE_OPS(XLS_BYTECODE_OP_LABEL)};
+#undef XLS_BYTECODE_OP_LABEL
+  static_assert(ABSL_ARRAYSIZE(kDispatch) == kOpCount);
+#define XLS_BYTECODE_CASE(name) op_##name:
+#define XLS_BYTECODE_NEXT() \
+  ++pc;                     \
+  goto* kDispatch[static_cast<int64_t>(pc->op)]
+  goto* kDispatch[static_cast<int64_t>(pc->op)];
+#else
+#define XLS_BYTECODE_CASE(name) case Op::name:
+#define XLS_BYTECODE_NEXT() \
+  ++pc;                     \
+  continue
+  while (true) {
+    switch (pc->op) {
+#endif
+
+  XLS_BYTECODE_CASE(kGeneric) {
+    XLS_ASSIGN_OR_RETURN(GenericResult result, generic(*pc));
+    if (result == GenericResult::kStopBefore) {
+      return pc - begin;
+    }
+    if (pc->dst >= 0) {
+      r[pc->dst] = ToRegister(values.At(pc->node));
+    }
+    if (result == GenericResult::kStopAfter) {
+      return pc - begin + 1;
+    }
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kToValue) {
+    values.Set(pc->node, Value(UBits(r[pc->a.reg], pc->bit_count)));
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kLiteral) {
+    r[pc->dst] = pc->imm;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kIdentity) {
+    r[pc->dst] = r[pc->a.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kAdd) {
+    r[pc->dst] = (r[pc->a.reg] + r[pc->b.reg]) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSub) {
+    r[pc->dst] = (r[pc->a.reg] - r[pc->b.reg]) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kUMul) {
+    r[pc->dst] = (r[pc->a.reg] * r[pc->b.reg]) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSMul) {
+    uint64_t lhs = SignExtend(r[pc->a.reg], pc->a.bit_count);
+    uint64_t rhs = SignExtend(r[pc->b.reg], pc->b.bit_count);
+    r[pc->dst] = (lhs * rhs) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kUDiv) {
+    // Division by zero produces all ones.
+    uint64_t rhs = r[pc->b.reg];
+    r[pc->dst] = rhs == 0 ? Mask(pc->bit_count) : r[pc->a.reg] / rhs;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kUMod) {
+    // Modulus by zero produces zero.
+    uint64_t rhs = r[pc->b.reg];
+    r[pc->dst] = rhs == 0 ? 0 : r[pc->a.reg] % rhs;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kAnd) {
+    uint64_t result = Mask(pc->bit_count);
+    for (int64_t i = 0; i < pc->operand_count; ++i) {
+      result &= r[operands[pc->operand_start + i].reg];
+    }
+    r[pc->dst] = result;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kOr) {
+    uint64_t result = 0;
+    for (int64_t i = 0; i < pc->operand_count; ++i) {
+      result |= r[operands[pc->operand_start + i].reg];
+    }
+    r[pc->dst] = result;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kXor) {
+    uint64_t result = 0;
+    for (int64_t i = 0; i < pc->operand_count; ++i) {
+      result ^= r[operands[pc->operand_start + i].reg];
+    }
+    r[pc->dst] = result;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kNand) {
+    uint64_t result = Mask(pc->bit_count);
+    for (int64_t i = 0; i < pc->operand_count; ++i) {
+      result &= r[operands[pc->operand_start + i].reg];
+    }
+    r[pc->dst] = ~result & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kNor) {
+    uint64_t result = 0;
+    for (int64_t i = 0; i < pc->operand_count; ++i) {
+      result |= r[operands[pc->operand_start + i].reg];
+    }
+    r[pc->dst] = ~result & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kNot) {
+    r[pc->dst] = ~r[pc->a.reg] & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kNeg) {
+    r[pc->dst] = (uint64_t{0} - r[pc->a.reg]) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kEq) {
+    r[pc->dst] = r[pc->a.reg] == r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kNe) {
+    r[pc->dst] = r[pc->a.reg] != r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kULt) {
+    r[pc->dst] = r[pc->a.reg] < r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kULe) {
+    r[pc->dst] = r[pc->a.reg] <= r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kUGt) {
+    r[pc->dst] = r[pc->a.reg] > r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kUGe) {
+    r[pc->dst] = r[pc->a.reg] >= r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSLt) {
+    r[pc->dst] = SignExtend(r[pc->a.reg], pc->a.bit_count) <
+                 SignExtend(r[pc->b.reg], pc->b.bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSLe) {
+    r[pc->dst] = SignExtend(r[pc->a.reg], pc->a.bit_count) <=
+                 SignExtend(r[pc->b.reg], pc->b.bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSGt) {
+    r[pc->dst] = SignExtend(r[pc->a.reg], pc->a.bit_count) >
+                 SignExtend(r[pc->b.reg], pc->b.bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSGe) {
+    r[pc->dst] = SignExtend(r[pc->a.reg], pc->a.bit_count) >=
+                 SignExtend(r[pc->b.reg], pc->b.bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kShll) {
+    uint64_t amount = r[pc->b.reg];
+    r[pc->dst] = amount >= static_cast<uint64_t>(pc->bit_count)
+                     ? 0
+                     : (r[pc->a.reg] << amount) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kShrl) {
+    uint64_t amount = r[pc->b.reg];
+    r[pc->dst] = amount >= static_cast<uint64_t>(pc->bit_count)
+                     ? 0
+                     : r[pc->a.reg] >> amount;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kShra) {
+    int64_t value = SignExtend(r[pc->a.reg], pc->bit_count);
+    uint64_t amount = r[pc->b.reg];
+    int64_t shifted = amount >= static_cast<uint64_t>(pc->bit_count)
+                          ? (value < 0 ? -1 : 0)
+                          : value >> amount;
+    r[pc->dst] = static_cast<uint64_t>(shifted) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSignExt) {
+    r[pc->dst] = static_cast<uint64_t>(
+                     SignExtend(r[pc->a.reg], pc->a.bit_count)) &
+                 Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kBitSlice) {
+    // The slice is entirely within the operand so `imm` is less than 64 unless
+    // the slice is empty.
+    r[pc->dst] = pc->bit_count == 0
+                     ? 0
+                     : (r[pc->a.reg] >> pc->imm) & Mask(pc->bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kConcat) {
+    // Operand zero is the most significant.
+    uint64_t result = 0;
+    for (int64_t i = 0; i < pc->operand_count; ++i) {
+      const Operand& operand = operands[pc->operand_start + i];
+      result = operand.bit_count >= 64
+                   ? r[operand.reg]
+                   : (result << operand.bit_count) | r[operand.reg];
+    }
+    r[pc->dst] = result;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kSel) {
+    uint64_t selector = r[pc->a.reg];
+    r[pc->dst] = selector < static_cast<uint64_t>(pc->operand_count)
+                     ? r[operands[pc->operand_start + selector].reg]
+                     : r[pc->b.reg];
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kGate) {
+    r[pc->dst] = r[pc->a.reg] != 0 ? r[pc->b.reg] : 0;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kAndReduce) {
+    r[pc->dst] = r[pc->a.reg] == Mask(pc->a.bit_count);
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kOrReduce) {
+    r[pc->dst] = r[pc->a.reg] != 0;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kXorReduce) {
+    r[pc->dst] = absl::popcount(r[pc->a.reg]) & 1;
+    XLS_BYTECODE_NEXT();
+  }
+  XLS_BYTECODE_CASE(kEnd) { return pc - begin; }
+
+#if !XLS_BYTECODE_THREADED_DISPATCH
+    }
+  }
+#endif
+#undef XLS_BYTECODE_CASE
+#undef XLS_BYTECODE_NEXT
+}
+
+absl::StatusOr<int64_t> BytecodeProgram::ExecuteAllGeneric(
+    BytecodeFrame& frame, int64_t start, GenericHandler generic) const {
+  absl::Span<uint64_t> r = frame.registers();
+  SlottedNodeValues& values = frame.values();
+  for (int64_t i = start; i < end_index(); ++i) {
+    const Instruction& instruction = instructions_[i];
+    if (instruction.op == Op::kToValue) {
+      if (!values.Contains(instruction.node)) {
+        values.Set(instruction.node, Value(UBits(r[instruction.a.reg],
+                                                 instruction.bit_count)));
+      }
+      continue;
+    }
+    for (Node* operand : instruction.node->operands()) {
+      if (values.Contains(operand)) {
+        continue;
+      }
+      auto it = register_of_.find(operand);
+      XLS_RET_CHECK(it != register_of_.end())
+          << "No value for operand " << operand->GetName();
+      values.Set(operand,
+                 Value(UBits(r[it->second.reg], it->second.bit_count)));
+    }
+    XLS_ASSIGN_OR_RETURN(GenericResult result, generic(instruction));
+    if (result == GenericResult::kStopBefore) {
+      return i;
+    }
+    if (instruction.dst >= 0) {
+      r[instruction.dst] = ToRegister(values.At(instruction.node));
+    }
+    if (result == GenericResult::kStopAfter) {
+      return i + 1;
+    }
+  }
+  return end_index();
+}
+
+std::string BytecodeProgram::ToString() const {
+  std::string result;
+  for (int64_t i = 0; i < instructions_.size(); ++i) {
+    const Instruction& instruction = instructions_[i];
+    absl::StrAppendFormat(&result, "%4d: %-10s", i, OpName(instruction.op));
+    if (instruction.dst >= 0) {
+      absl::StrAppendFormat(&result, " r%d", instruction.dst);
+    }
+    if (instruction.node != nullptr) {
+      absl::StrAppend(&result, " ; ", instruction.node->GetName());
+    }
+    absl::StrAppend(&result, "\n");
+  }
+  return result;
+}
+
+}  // namespace xls
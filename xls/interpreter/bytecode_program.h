@@ -0,0 +1,211 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_BYTECODE_PROGRAM_H_
+#define XLS_INTERPRETER_BYTECODE_PROGRAM_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+class BytecodeProgram;
+
+// The mutable state of one evaluation of a BytecodeProgram: a uint64_t register
+// for every bits-typed node of at most 64 bits and a Value slot for every node.
+// A frame may be reused across evaluations of the same program; see Clear().
+class BytecodeFrame {
+ public:
+  explicit BytecodeFrame(const BytecodeProgram& program);
+
+  absl::Span<uint64_t> registers() { return absl::MakeSpan(registers_); }
+  SlottedNodeValues& values() { return values_; }
+
+  // Forgets the Value of every node. Registers need no clearing as they are
+  // always written before being read.
+  void Clear() { values_.Clear(); }
+
+ private:
+  std::vector<uint64_t> registers_;
+  SlottedNodeValues values_;
+};
+
+// A FunctionBase lowered to a linear sequence of register-based instructions.
+//
+// Every bits-typed node of at most 64 bits is assigned a uint64_t register.
+// Common operations whose result and operands all have registers are executed
+// directly on the registers. Everything else (wide bits, aggregates, tokens,
+// side-effecting and communication operations) is a "generic" instruction
+// which is evaluated by a caller-provided callback, typically by running the
+// IrInterpreter handler for the node against the Value slots of the frame.
+// Register values needed by generic instructions are copied into the Value
+// slots by explicit kToValue instructions, and narrow results of generic
+// instructions are copied back into registers.
+//
+// Instructions are emitted in the given node order with at most one kToValue
+// instruction following each node, so an instruction index can serve as a
+// resume point for procs which block part way through a tick.
+class BytecodeProgram {
+ public:
+  enum class Op : uint8_t {
+    kGeneric,
+    kToValue,
+    kLiteral,
+    kIdentity,
+    kAdd,
+    kSub,
+    kUMul,
+    kSMul,
+    kUDiv,
+    kUMod,
+    kAnd,
+    kOr,
+    kXor,
+    kNand,
+    kNor,
+    kNot,
+    kNeg,
+    kEq,
+    kNe,
+    kULt,
+    kULe,
+    kUGt,
+    kUGe,
+    kSLt,
+    kSLe,
+    kSGt,
+    kSGe,
+    kShll,
+    kShrl,
+    kShra,
+    kSignExt,
+    kBitSlice,
+    kConcat,
+    kSel,
+    kGate,
+    kAndReduce,
+    kOrReduce,
+    kXorReduce,
+    // Marks the end of the program. Always the last instruction.
+    kEnd,
+  };
+  static constexpr int64_t kOpCount = static_cast<int64_t>(Op::kEnd) + 1;
+
+  // A register operand along with the bit count of the node it holds.
+  struct Operand {
+    int32_t reg;
+    int32_t bit_count;
+  };
+
+  struct Instruction {
+    Op op;
+    // Bit count of the result.
+    int32_t bit_count = 0;
+    // Register holding the result, or -1 if the result has no register.
+    int32_t dst = -1;
+    // Unary and binary operands. `b` is the default case of a select (-1 if
+    // there is none).
+    Operand a = {-1, 0};
+    Operand b = {-1, 0};
+    // Operands of n-ary operations and cases of selects as a range of
+    // `operands()`.
+    int32_t operand_start = 0;
+    int32_t operand_count = 0;
+    // The literal value or the start of a bit slice.
+    uint64_t imm = 0;
+    Node* node = nullptr;
+  };
+
+  // Result of evaluating a generic instruction.
+  enum class GenericResult : uint8_t {
+    // Continue with the next instruction.
+    kContinue,
+    // Stop execution without having evaluated the instruction (e.g., a receive
+    // on an empty channel). Execution resumes at the same instruction.
+    kStopBefore,
+    // Stop execution after having evaluated the instruction (e.g., a send).
+    // Execution resumes at the following instruction.
+    kStopAfter,
+  };
+  using GenericHandler =
+      absl::FunctionRef<absl::StatusOr<GenericResult>(const Instruction&)>;
+
+  // Lowers the nodes of `function_base` which must be given in a topological
+  // order. `live_out` are nodes whose Value is needed after execution in
+  // addition to the operands of generic instructions (e.g., the return value
+  // of a function).
+  static absl::StatusOr<BytecodeProgram> Compile(
+      FunctionBase* function_base, absl::Span<Node* const> order,
+      absl::Span<Node* const> live_out);
+
+  FunctionBase* function_base() const { return function_base_; }
+  absl::Span<const Instruction> instructions() const { return instructions_; }
+  absl::Span<const Operand> operands() const { return operands_; }
+  int64_t register_count() const { return register_count_; }
+
+  // Index of the kEnd instruction. Execution is complete when Execute returns
+  // this index.
+  int64_t end_index() const {
+    return static_cast<int64_t>(instructions_.size()) - 1;
+  }
+
+  // Number of instructions (excluding kEnd) which are evaluated by the
+  // generic handler.
+  int64_t generic_instruction_count() const {
+    return generic_instruction_count_;
+  }
+
+  // Executes the program in `frame` starting at instruction index `start`
+  // until the end of the program or until `generic` requests a stop. Returns
+  // the index at which to resume execution.
+  //
+  // If `all_generic` is true every node is evaluated by `generic`. This is
+  // used when every node must be visited by the IrInterpreter handlers, for
+  // example to notify an evaluation observer. Operand Values missing from the
+  // frame are materialized from the registers in this mode, so the two modes
+  // may be mixed within an evaluation.
+  absl::StatusOr<int64_t> Execute(BytecodeFrame& frame, int64_t start,
+                                  GenericHandler generic,
+                                  bool all_generic = false) const;
+
+  std::string ToString() const;
+
+ private:
+  explicit BytecodeProgram(FunctionBase* function_base)
+      : function_base_(function_base) {}
+
+  absl::StatusOr<int64_t> ExecuteAllGeneric(BytecodeFrame& frame,
+                                            int64_t start,
+                                            GenericHandler generic) const;
+
+  FunctionBase* function_base_;
+  std::vector<Instruction> instructions_;
+  std::vector<Operand> operands_;
+  int64_t register_count_ = 0;
+  int64_t generic_instruction_count_ = 0;
+  absl::flat_hash_map<Node*, Operand> register_of_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_BYTECODE_PROGRAM_H_
@@ -42,10 +42,31 @@ class EvaluatorOptions {
   }
   bool support_observers() const { return support_observers_; }
 
+  // When set, JIT-based proc runtimes keep proc state and channel payloads in
+  // a bit-packed layout rather than the native LLVM layout, trading conversion
+  // work at the boundary of the jitted code for a smaller memory footprint.
+  // Ignored by the interpreter.
+  EvaluatorOptions& set_packed_jit_layout(bool value) {
+    packed_jit_layout_ = value;
+    return *this;
+  }
+  bool packed_jit_layout() const { return packed_jit_layout_; }
+
+  // When set, interpreter-based proc runtimes compile each proc to bytecode
+  // (see ProcBytecodeInterpreter) rather than walking the IR each tick. Ignored
+  // by the JIT.
+  EvaluatorOptions& set_bytecode_interpreter(bool value) {
+    bytecode_interpreter_ = value;
+    return *this;
+  }
+  bool bytecode_interpreter() const { return bytecode_interpreter_; }
+
  private:
   bool trace_channels_ = false;
   FormatPreference format_preference_ = FormatPreference::kDefault;
   bool support_observers_ = false;
+  bool packed_jit_layout_ = false;
+  bool bytecode_interpreter_ = false;
 };
 
 }  // namespace xls
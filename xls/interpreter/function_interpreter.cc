@@ -15,6 +15,7 @@
 #include "xls/interpreter/function_interpreter.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -30,7 +31,9 @@
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/observer.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function.h"
 #include "xls/ir/keyword_args.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -43,7 +46,19 @@ class FunctionInterpreter final : public IrInterpreter {
  public:
   FunctionInterpreter(absl::Span<const Value> args,
                       std::optional<EvaluationObserver*> observer)
-      : IrInterpreter(observer), args_(args.begin(), args.end()) {}
+      : IrInterpreter(observer), args_(args) {}
+
+  // Interpreter storing node values in `slotted_values` which evaluates called
+  // functions with the interpreters in `callees`.
+  FunctionInterpreter(
+      absl::Span<const Value> args, std::optional<EvaluationObserver*> observer,
+      SlottedNodeValues* slotted_values,
+      absl::flat_hash_map<Function*,
+                          std::unique_ptr<PrecompiledFunctionInterpreter>>*
+          callees)
+      : IrInterpreter(*slotted_values, /*events=*/nullptr, observer),
+        args_(args),
+        callees_(callees) {}
 
   absl::Status HandleParam(Param* param) override {
     XLS_ASSIGN_OR_RETURN(int64_t index,
@@ -56,17 +71,31 @@ class FunctionInterpreter final : public IrInterpreter {
     return SetValueResult(param, args_[index]);
   }
 
+ protected:
+  absl::StatusOr<InterpreterResult<Value>> InterpretSubFunction(
+      Function* f, absl::Span<const Value> args) override {
+    if (callees_ == nullptr) {
+      return IrInterpreter::InterpretSubFunction(f, args);
+    }
+    std::unique_ptr<PrecompiledFunctionInterpreter>& callee = (*callees_)[f];
+    if (callee == nullptr) {
+      callee = std::make_unique<PrecompiledFunctionInterpreter>(f);
+    }
+    return callee->Run(args);
+  }
+
  private:
-  // The arguments to the Function being evaluated indexed by parameter name.
-  std::vector<Value> args_;
+  // The arguments to the Function being evaluated indexed by parameter number.
+  absl::Span<const Value> args_;
+  absl::flat_hash_map<Function*,
+                      std::unique_ptr<PrecompiledFunctionInterpreter>>*
+      callees_ = nullptr;
 };
 
 }  // namespace
 
-absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
-    Function* function, absl::Span<const Value> args,
-    std::optional<EvaluationObserver*> observer) {
-  VLOG(3) << "Interpreting function " << function->name();
+absl::Status CheckFunctionArguments(Function* function,
+                                    absl::Span<const Value> args) {
   if (args.size() != function->params().size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Function `%s` (type: `%s`) wants %d arguments, got %d.",
@@ -84,6 +113,14 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
           value.ToString(), argno, param_type->ToString()));
     }
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
+    Function* function, absl::Span<const Value> args,
+    std::optional<EvaluationObserver*> observer) {
+  VLOG(3) << "Interpreting function " << function->name();
+  XLS_RETURN_IF_ERROR(CheckFunctionArguments(function, args));
   FunctionInterpreter visitor(args, observer);
   XLS_RETURN_IF_ERROR(function->Accept(&visitor));
   Value result = visitor.ResolveAsValue(function->return_value());
@@ -101,4 +138,23 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
   return InterpretFunction(function, positional_args, observer);
 }
 
+PrecompiledFunctionInterpreter::PrecompiledFunctionInterpreter(
+    Function* function)
+    : function_(function), values_(function) {}
+
+absl::StatusOr<InterpreterResult<Value>> PrecompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args, std::optional<EvaluationObserver*> observer) {
+  VLOG(3) << "Interpreting precompiled function " << function_->name();
+  XLS_RETURN_IF_ERROR(CheckFunctionArguments(function_, args));
+  values_.Clear();
+  FunctionInterpreter visitor(args, observer, &values_, &callees_);
+  for (Node* node : values_.topo_order()) {
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+  }
+  Value result = visitor.ResolveAsValue(function_->return_value());
+  VLOG(2) << "Result = " << result;
+  return InterpreterResult<Value>{std::move(result),
+                                  std::move(visitor.GetInterpreterEvents())};
+}
+
 }  // namespace xls
@@ -15,12 +15,15 @@
 #ifndef XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
 #define XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
 
+#include <memory>
 #include <optional>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/observer.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
@@ -41,6 +44,39 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunctionKwargs(
     Function* function, const absl::flat_hash_map<std::string, Value>& args,
     std::optional<EvaluationObserver*> observer = std::nullopt);
 
+// Returns an error if `args` do not match the number and types of the
+// parameters of `function`.
+absl::Status CheckFunctionArguments(Function* function,
+                                    absl::Span<const Value> args);
+
+// Interpreter for evaluating the same function many times. Every node of the
+// function is assigned a dense slot once at construction and node values are
+// kept in slot-indexed storage which is reused across calls, avoiding the
+// per-call hash map and DFS bookkeeping of InterpretFunction. Functions called
+// through invoke, map and counted_for nodes are evaluated the same way. The
+// function must not be modified while the interpreter exists. Not thread-safe.
+class PrecompiledFunctionInterpreter {
+ public:
+  explicit PrecompiledFunctionInterpreter(Function* function);
+
+  Function* function() const { return function_; }
+
+  // Runs the function on the given arguments. Returns both the value and any
+  // events that happened while running.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args,
+      std::optional<EvaluationObserver*> observer = std::nullopt);
+
+ private:
+  Function* function_;
+  SlottedNodeValues values_;
+  // Interpreters for the functions called by `function_`, created on first
+  // use.
+  absl::flat_hash_map<Function*,
+                      std::unique_ptr<PrecompiledFunctionInterpreter>>
+      callees_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
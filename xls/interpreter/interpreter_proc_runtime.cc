@@ -22,6 +22,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_bytecode_interpreter.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/serial_proc_runtime.h"
@@ -39,9 +40,16 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
                        ChannelQueueManager::Create(std::move(elaboration)));
 
-  // Create a ProcInterpreter for each Proc.
+  // Create a ProcInterpreter (or ProcBytecodeInterpreter) for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
   for (Proc* proc : queue_manager->elaboration().procs()) {
+    if (options.bytecode_interpreter()) {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<ProcBytecodeInterpreter> interpreter,
+          ProcBytecodeInterpreter::Create(proc, queue_manager.get()));
+      proc_interpreters.push_back(std::move(interpreter));
+      continue;
+    }
     proc_interpreters.push_back(
         std::make_unique<ProcInterpreter>(proc, queue_manager.get()));
   }
@@ -24,8 +24,9 @@
 
 namespace xls {
 
-// Create a SerialProcRuntime composed of ProcInterpreters. Supports old-style
-// procs.
+// Create a SerialProcRuntime composed of ProcInterpreters (or
+// ProcBytecodeInterpreters if `options.bytecode_interpreter()` is set).
+// Supports old-style procs.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
 CreateInterpreterSerialProcRuntime(
     Package* package, const EvaluatorOptions& options = EvaluatorOptions());
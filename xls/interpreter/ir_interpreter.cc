@@ -35,10 +35,12 @@
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -89,6 +91,43 @@ absl::StatusOr<Value> InterpretNode(Node* node,
   return visitor.ResolveAsValue(node);
 }
 
+namespace {
+
+// Records the order in which FunctionBase::Accept visits nodes.
+class VisitOrderRecorder final : public DfsVisitorWithDefault {
+ public:
+  absl::Status DefaultHandler(Node* node) override {
+    order_.push_back(node);
+    return absl::OkStatus();
+  }
+
+  std::vector<Node*>& order() { return order_; }
+
+ private:
+  std::vector<Node*> order_;
+};
+
+}  // namespace
+
+SlottedNodeValues::SlottedNodeValues(FunctionBase* f) : function_base_(f) {
+  // Use the same order as the DFS-driven interpreters so side-effecting
+  // operations (e.g., traces) are evaluated in the same order.
+  VisitOrderRecorder recorder;
+  CHECK_OK(f->Accept(&recorder));
+  topo_order_ = std::move(recorder.order());
+  slot_by_node_index_.resize(f->node_index_limit(), -1);
+  for (int64_t slot = 0; slot < topo_order_.size(); ++slot) {
+    slot_by_node_index_[topo_order_[slot]->node_index()] = slot;
+  }
+  values_.resize(topo_order_.size());
+  present_.resize(topo_order_.size(), false);
+}
+
+absl::StatusOr<InterpreterResult<Value>> IrInterpreter::InterpretSubFunction(
+    Function* f, absl::Span<const Value> args) {
+  return InterpretFunction(f, args);
+}
+
 absl::Status IrInterpreter::AddInterpreterEvents(
     const InterpreterEvents& events) {
   for (const TraceMessage& trace_msg : events.trace_msgs) {
@@ -281,7 +320,7 @@ absl::Status IrInterpreter::HandleCountedFor(CountedFor* counted_for) {
       args_for_body.push_back(value);
     }
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> loop_result,
-                         InterpretFunction(body, args_for_body));
+                         InterpretSubFunction(body, args_for_body));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(loop_result.events));
     loop_state = loop_result.value;
   }
@@ -333,7 +372,7 @@ absl::Status IrInterpreter::HandleDynamicCountedFor(
       args_for_body.push_back(value);
     }
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> loop_result,
-                         InterpretFunction(body, args_for_body));
+                         InterpretSubFunction(body, args_for_body));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(loop_result.events));
     loop_state = loop_result.value;
     index = bits_ops::Add(index, extended_stride);
@@ -412,33 +451,6 @@ absl::Status IrInterpreter::HandleIdentity(UnOp* identity) {
 // of bits. 'value' is what to assign at the array element at the particular
 // index. 'elements' is a vector of the outer-most elements of the array being
 // indexed into.
-static absl::Status SetArrayElement(absl::Span<const Bits> indices,
-                                    const Value& value,
-                                    std::vector<Value>* elements) {
-  XLS_RET_CHECK(!indices.empty());
-  uint64_t index = BitsToBoundedUint64(indices.front(), elements->size());
-  if (index >= elements->size()) {
-    // Out-of-bounds access it a no-op.
-    return absl::OkStatus();
-  }
-  if (indices.size() == 1) {
-    (*elements)[index] = value;
-    return absl::OkStatus();
-  }
-
-  // Index has multiple element. Peel off the first index and recurse into that
-  // element.
-  const Value& selected_element = (*elements)[index];
-  std::vector<Value> subelements(selected_element.elements().begin(),
-                                 selected_element.elements().end());
-  XLS_RETURN_IF_ERROR(SetArrayElement(indices.subspan(1), value, &subelements));
-  // Reconstruct the affected element as an array and assign it to the indexed
-  // slot.
-  XLS_ASSIGN_OR_RETURN(Value array_element, Value::Array(subelements));
-  (*elements)[index] = array_element;
-  return absl::OkStatus();
-}
-
 absl::Status IrInterpreter::HandleArrayIndex(ArrayIndex* index) {
   const Value* array = &ResolveAsValue(index->array());
   for (Node* index_operand : index->indices()) {
@@ -469,21 +481,30 @@ absl::Status IrInterpreter::HandleArrayUpdate(ArrayUpdate* update) {
   const Value& input_array = ResolveAsValue(update->array_to_update());
   const Value& update_value = ResolveAsValue(update->update_value());
 
-  if (update->indices().empty()) {
-    // Index is empty. The *entire* array is replaced with the update value.
-    return SetValueResult(update, update_value);
+  // Resolve the indices first; an out-of-bounds access at any level makes the
+  // update a no-op.
+  std::vector<int64_t> indices;
+  indices.reserve(update->indices().size());
+  const Value* element = &input_array;
+  for (Node* index_operand : update->indices()) {
+    uint64_t index =
+        BitsToBoundedUint64(ResolveAsBits(index_operand), element->size());
+    if (index >= element->size()) {
+      return SetValueResult(update, input_array);
+    }
+    indices.push_back(static_cast<int64_t>(index));
+    element = &element->element(index);
   }
 
-  XLS_ASSIGN_OR_RETURN(std::vector<Value> array_elements,
-                       input_array.GetElements());
-  std::vector<Bits> index_vector;
-  for (Node* index_operand : update->indices()) {
-    index_vector.push_back(ResolveAsBits(index_operand));
+  // Copying the array shares its elements, so only the aggregates along the
+  // indexed path are copied when they are modified below.
+  Value result = input_array;
+  Value* target = &result;
+  for (int64_t index : indices) {
+    target = &target->mutable_element(index);
   }
-  XLS_RETURN_IF_ERROR(
-      SetArrayElement(index_vector, update_value, &array_elements));
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(array_elements));
-  return SetValueResult(update, result);
+  *target = update_value;
+  return SetValueResult(update, std::move(result));
 }
 
 absl::Status IrInterpreter::HandleArrayConcat(ArrayConcat* concat) {
@@ -568,7 +589,7 @@ absl::Status IrInterpreter::HandleInvoke(Invoke* invoke) {
     args.push_back(ResolveAsValue(invoke->operand(i)));
   }
   XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
-                       InterpretFunction(to_apply, args));
+                       InterpretSubFunction(to_apply, args));
   XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
   return SetValueResult(invoke, result.value);
 }
@@ -619,7 +640,7 @@ absl::Status IrInterpreter::HandleMap(Map* map) {
   for (const Value& operand_element :
        ResolveAsValue(map->operand(0)).elements()) {
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
-                         InterpretFunction(to_apply, {operand_element}));
+                         InterpretSubFunction(to_apply, {operand_element}));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
     results.push_back(result.value);
   }
@@ -840,11 +861,11 @@ absl::Status IrInterpreter::VerifyAllBitsTypes(Node* node) {
 }
 
 const Bits& IrInterpreter::ResolveAsBits(Node* node) {
-  return NodeValuesMap().at(node).bits();
+  return ResolveAsValue(node).bits();
 }
 
 bool IrInterpreter::ResolveAsBool(Node* node) {
-  const Bits& bits = NodeValuesMap().at(node).bits();
+  const Bits& bits = ResolveAsValue(node).bits();
   CHECK_EQ(bits.bit_count(), 1);
   return bits.IsAllOnes();
 }
@@ -878,7 +899,7 @@ absl::Status IrInterpreter::SetBitsResult(Node* node, const Bits& result) {
 absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   if (VLOG_IS_ON(4) &&
       std::all_of(node->operands().begin(), node->operands().end(),
-                  [this](Node* o) { return NodeValuesMap().contains(o); })) {
+                  [this](Node* o) { return HasResult(o); })) {
     VLOG(4) << absl::StreamFormat("%s operands:", node->GetName());
     for (int64_t i = 0; i < node->operand_count(); ++i) {
       VLOG(4) << absl::StreamFormat(
@@ -889,7 +910,7 @@ absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   VLOG(3) << absl::StreamFormat("Result of %s: %s", node->ToString(),
                                 result.ToString());
 
-  XLS_RET_CHECK(!NodeValuesMap().contains(node));
+  XLS_RET_CHECK(!HasResult(node));
   if (!ValueConformsToType(result, node->GetType())) {
     return absl::InternalError(absl::StrFormat(
         "Expected value %s to match type %s of node %s", result.ToString(),
@@ -898,7 +919,11 @@ absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   if (observer_) {
     (*observer_)->NodeEvaluated(node, result);
   }
-  NodeValuesMap()[node] = std::move(result);
+  if (slotted_values_ != nullptr) {
+    slotted_values_->Set(node, std::move(result));
+  } else {
+    NodeValuesMap()[node] = std::move(result);
+  }
   return absl::OkStatus();
 }
 
@@ -15,11 +15,14 @@
 #ifndef XLS_INTERPRETER_IR_INTERPRETER_H_
 #define XLS_INTERPRETER_IR_INTERPRETER_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -27,6 +30,8 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
@@ -39,6 +44,55 @@ namespace xls {
 absl::StatusOr<Value> InterpretNode(Node* node,
                                     absl::Span<const Value> operand_values);
 
+// Storage for the values of the nodes of a FunctionBase indexed by a dense
+// slot number rather than by hashing the node. Slots are assigned once in
+// evaluation (topological) order when the storage is created and are found
+// through a table indexed by Node::node_index(), so the storage is proportional
+// to the number of nodes in the FunctionBase. The storage is reused across
+// evaluations by calling Clear(). The FunctionBase must not be modified while
+// the storage exists.
+class SlottedNodeValues {
+ public:
+  explicit SlottedNodeValues(FunctionBase* f);
+
+  // The nodes of the FunctionBase in slot (topological) order.
+  absl::Span<Node* const> topo_order() const { return topo_order_; }
+
+  bool Contains(const Node* node) const { return present_[Slot(node)]; }
+  const Value& At(const Node* node) const {
+    int64_t slot = Slot(node);
+    CHECK(present_[slot]) << "No value for node " << node->GetName();
+    return values_[slot];
+  }
+  void Set(const Node* node, Value value) {
+    int64_t slot = Slot(node);
+    values_[slot] = std::move(value);
+    present_[slot] = true;
+  }
+
+  // Marks every node as having no value.
+  void Clear() { std::fill(present_.begin(), present_.end(), false); }
+
+ private:
+  int64_t Slot(const Node* node) const {
+    CHECK_EQ(node->function_base(), function_base_)
+        << node->GetName() << " is not in " << function_base_->name();
+    CHECK_LT(node->node_index(), slot_by_node_index_.size())
+        << node->GetName() << " was added after the storage was created";
+    int64_t slot = slot_by_node_index_[node->node_index()];
+    CHECK_GE(slot, 0) << node->GetName() << " has no slot";
+    return slot;
+  }
+
+  FunctionBase* function_base_;
+  std::vector<Node*> topo_order_;
+  // Slot of each node indexed by Node::node_index(); -1 for indices of removed
+  // nodes.
+  std::vector<int64_t> slot_by_node_index_;
+  std::vector<Value> values_;
+  std::vector<bool> present_;
+};
+
 // A visitor for traversing and evaluating XLS IR.
 class IrInterpreter : public DfsVisitor {
  public:
@@ -46,6 +100,16 @@ class IrInterpreter : public DfsVisitor {
   explicit IrInterpreter(std::optional<EvaluationObserver*> observer)
       : node_values_ptr_(nullptr), events_ptr_(nullptr), observer_(observer) {}
 
+  // Constructor which stores node values in `slotted_values` instead of a hash
+  // map. Used to evaluate a FunctionBase repeatedly without rebuilding the
+  // value storage. If `events` is null a fresh events object is used.
+  IrInterpreter(SlottedNodeValues& slotted_values, InterpreterEvents* events,
+                std::optional<EvaluationObserver*> observer)
+      : node_values_ptr_(nullptr),
+        slotted_values_(&slotted_values),
+        events_ptr_(events),
+        observer_(observer) {}
+
   // Constructor which takes an existing map of node values and events. Used for
   // continuations to enable stopping and restarting execution of a
   // FunctionBase.
@@ -64,6 +128,9 @@ class IrInterpreter : public DfsVisitor {
 
   // Returns the previously evaluated value of 'node' as a Value.
   const Value& ResolveAsValue(Node* node) const {
+    if (slotted_values_ != nullptr) {
+      return slotted_values_->At(node);
+    }
     return NodeValuesMap().at(node);
   }
 
@@ -77,7 +144,12 @@ class IrInterpreter : public DfsVisitor {
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
   // Returns true if a value has been set for the result of the given node.
-  bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
+  bool HasResult(Node* node) const {
+    if (slotted_values_ != nullptr) {
+      return slotted_values_->Contains(node);
+    }
+    return NodeValuesMap().contains(node);
+  }
 
   absl::Status HandleAdd(BinOp* add) override;
   absl::Status HandleAfterAll(AfterAll* after_all) override;
@@ -195,6 +267,11 @@ class IrInterpreter : public DfsVisitor {
   absl::StatusOr<Value> DeepOr(Type* input_type,
                                absl::Span<const Value* const> inputs);
 
+  // Evaluates `f` with the given arguments on behalf of an invoke, map or loop
+  // node.
+  virtual absl::StatusOr<InterpreterResult<Value>> InterpretSubFunction(
+      Function* f, absl::Span<const Value> args);
+
   // Returns the map which maps Node* to the Value computed for that node.
   absl::flat_hash_map<Node*, Value>& NodeValuesMap() {
     return node_values_ptr_ != nullptr ? *node_values_ptr_ : node_values_;
@@ -209,6 +286,8 @@ class IrInterpreter : public DfsVisitor {
   // (`node_values_ptr` is null).
   absl::flat_hash_map<Node*, Value>* node_values_ptr_;
   absl::flat_hash_map<Node*, Value> node_values_;
+  // If not null, node values are stored here instead of either map above.
+  SlottedNodeValues* slotted_values_ = nullptr;
 
   // Events observed while interpreting (currently only trace messages). To
   // support continuations, an existing events object can either be passed in at
@@ -0,0 +1,184 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "xls/common/benchmark_support.h"
+#include "xls/common/init_xls.h"
+#include "xls/interpreter/bytecode_interpreter.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Compares InterpretFunction, which builds a node value hash map on every
+// call, against PrecompiledFunctionInterpreter, which assigns node slots once
+// and reuses its storage across calls, and BytecodeFunctionInterpreter, which
+// additionally evaluates narrow bits operations on machine words.
+
+// Returns a function which mixes its two arguments with a chain of `depth`
+// add/shift/xor rounds.
+Function* BuildMixChain(Package* p, int64_t depth) {
+  FunctionBuilder fb("mix", p);
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue acc = x;
+  for (int64_t i = 0; i < depth; ++i) {
+    BValue shift = fb.Literal(UBits(i % 31 + 1, 32));
+    acc = fb.Xor(fb.Add(acc, y), fb.Shrl(acc, shift));
+  }
+  return fb.Build().value();
+}
+
+// A loop over an array which updates each element in turn.
+constexpr char kLoopIr[] = R"(
+package loop
+
+fn body(i: bits[32], acc: bits[32][16]) -> bits[32][16] {
+  index: bits[4] = bit_slice(i, start=0, width=4)
+  element: bits[32] = array_index(acc, indices=[index])
+  one: bits[32] = literal(value=1)
+  shifted: bits[32] = shll(element, one)
+  sum: bits[32] = add(shifted, i)
+  ret update: bits[32][16] = array_update(acc, sum, indices=[index])
+}
+
+top fn loop(init: bits[32][16]) -> bits[32][16] {
+  ret result: bits[32][16] = counted_for(init, trip_count=64, stride=1, body=body)
+}
+)";
+
+static void BM_InterpretMixChain(benchmark::State& state) {
+  Package p("benchmark");
+  Function* f = BuildMixChain(&p, state.range(0));
+  std::vector<Value> args = {Value(UBits(0x12345678, 32)),
+                             Value(UBits(0x9abcdef0, 32))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(InterpretFunction(f, args).value());
+  }
+}
+
+static void BM_PrecompiledMixChain(benchmark::State& state) {
+  Package p("benchmark");
+  Function* f = BuildMixChain(&p, state.range(0));
+  PrecompiledFunctionInterpreter interpreter(f);
+  std::vector<Value> args = {Value(UBits(0x12345678, 32)),
+                             Value(UBits(0x9abcdef0, 32))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interpreter.Run(args).value());
+  }
+}
+
+static void BM_BytecodeMixChain(benchmark::State& state) {
+  Package p("benchmark");
+  Function* f = BuildMixChain(&p, state.range(0));
+  std::unique_ptr<BytecodeFunctionInterpreter> interpreter =
+      BytecodeFunctionInterpreter::Create(f).value();
+  std::vector<Value> args = {Value(UBits(0x12345678, 32)),
+                             Value(UBits(0x9abcdef0, 32))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interpreter->Run(args).value());
+  }
+}
+
+// Measures the startup cost of the bytecode interpreter.
+static void BM_BytecodeCompileMixChain(benchmark::State& state) {
+  Package p("benchmark");
+  Function* f = BuildMixChain(&p, state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BytecodeFunctionInterpreter::Create(f).value());
+  }
+}
+
+// Updates one element of an array of `size` tuples. Aggregate Values share
+// their elements, so this should cost O(size) shallow copies rather than a
+// deep copy of the whole array.
+static void BM_InterpretArrayUpdate(benchmark::State& state) {
+  auto p = std::make_unique<Package>("array_update");
+  Type* element_type = p->GetTupleType(
+      {p->GetBitsType(32), p->GetArrayType(8, p->GetBitsType(32))});
+  Type* array_type = p->GetArrayType(state.range(0), element_type);
+  FunctionBuilder fb("update", p.get());
+  fb.ArrayUpdate(fb.Param("a", array_type), fb.Param("v", element_type),
+                 {fb.Param("i", p->GetBitsType(32))});
+  Function* f = fb.Build().value();
+  std::vector<Value> args = {ZeroOfType(array_type),
+                             AllOnesOfType(element_type),
+                             Value(UBits(state.range(0) / 2, 32))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(InterpretFunction(f, args).value());
+  }
+}
+
+static void BM_InterpretLoop(benchmark::State& state) {
+  std::unique_ptr<Package> p = Parser::ParsePackage(kLoopIr).value();
+  Function* f = p->GetTopAsFunction().value();
+  std::vector<Value> args = {Value::UBitsArray(std::vector<uint64_t>(16, 1), 32)
+                                 .value()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(InterpretFunction(f, args).value());
+  }
+}
+
+static void BM_PrecompiledLoop(benchmark::State& state) {
+  std::unique_ptr<Package> p = Parser::ParsePackage(kLoopIr).value();
+  Function* f = p->GetTopAsFunction().value();
+  PrecompiledFunctionInterpreter interpreter(f);
+  std::vector<Value> args = {Value::UBitsArray(std::vector<uint64_t>(16, 1), 32)
+                                 .value()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interpreter.Run(args).value());
+  }
+}
+
+static void BM_BytecodeLoop(benchmark::State& state) {
+  std::unique_ptr<Package> p = Parser::ParsePackage(kLoopIr).value();
+  Function* f = p->GetTopAsFunction().value();
+  std::unique_ptr<BytecodeFunctionInterpreter> interpreter =
+      BytecodeFunctionInterpreter::Create(f).value();
+  std::vector<Value> args = {Value::UBitsArray(std::vector<uint64_t>(16, 1), 32)
+                                 .value()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(interpreter->Run(args).value());
+  }
+}
+
+BENCHMARK(BM_InterpretMixChain)->Range(8, 1024);
+BENCHMARK(BM_PrecompiledMixChain)->Range(8, 1024);
+BENCHMARK(BM_BytecodeMixChain)->Range(8, 1024);
+BENCHMARK(BM_BytecodeCompileMixChain)->Range(8, 1024);
+BENCHMARK(BM_InterpretArrayUpdate)->Range(8, 4096);
+BENCHMARK(BM_InterpretLoop);
+BENCHMARK(BM_PrecompiledLoop);
+BENCHMARK(BM_BytecodeLoop);
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char* argv[]) {
+  xls::InitXls(argv[0], argc, argv);
+  xls::RunSpecifiedBenchmarks(/*default_spec=*/"all");
+  return 0;
+}
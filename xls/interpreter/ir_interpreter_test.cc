@@ -16,14 +16,17 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/observer.h"
@@ -32,6 +35,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/keyword_args.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/ir/verifier.h"
@@ -62,6 +66,24 @@ INSTANTIATE_TEST_SUITE_P(
         true, "IrInterpreter")),
     testing::PrintToStringParamName());
 
+INSTANTIATE_TEST_SUITE_P(
+    PrecompiledIrInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args,
+           std::optional<EvaluationObserver*> obs) {
+          return PrecompiledFunctionInterpreter(function).Run(args, obs);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs,
+           std::optional<EvaluationObserver*> obs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                               KeywordArgsToPositional(*function, kwargs));
+          return PrecompiledFunctionInterpreter(function).Run(args, obs);
+        },
+        true, "PrecompiledIrInterpreter")),
+    testing::PrintToStringParamName());
+
 // Fixture for IrInterpreter-only tests (i.e., those that aren't common to all
 // IR evaluators).
 class IrInterpreterOnlyTest : public IrTestBase {};
@@ -194,6 +216,73 @@ fn accum_dynamic(trips: bits[8]) -> bits[32] {
                   FieldsAre("accum is 15", 0)));
 }
 
+// The precompiled interpreter reuses its storage (including that of the loop
+// body) across calls; results and events must not leak between calls.
+TEST_F(IrInterpreterOnlyTest, PrecompiledInterpreterReuse) {
+  const std::string pkg_text = R"(
+package precompiled_reuse_test
+
+fn accum_body(i: bits[32], accum: bits[32]) -> bits[32] {
+  after_all.0: token = after_all()
+  literal.1: bits[1] = literal(value=1)
+  trace.2: token = trace(after_all.0, literal.1, format = "accum is {}", data_operands=[accum])
+  ret add.3: bits[32] = add(accum, i)
+}
+
+fn accum_dynamic(trips: bits[8]) -> bits[32] {
+    literal.6: bits[32] = literal(value=0)
+    literal.7: bits[32] = literal(value=1)
+    ret dynamic_counted_for.8: bits[32] = dynamic_counted_for(literal.6, trips, literal.7, body=accum_body)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(pkg_text));
+  PrecompiledFunctionInterpreter interpreter(
+      FindFunction("accum_dynamic", package.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           interpreter.Run({Value(UBits(3, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(3, 32)));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(FieldsAre("accum is 0", 0), FieldsAre("accum is 0", 0),
+                          FieldsAre("accum is 1", 0)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, interpreter.Run({Value(UBits(0, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(0, 32)));
+  EXPECT_THAT(result.events.trace_msgs, ElementsAre());
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, interpreter.Run({Value(UBits(5, 8))}));
+  EXPECT_EQ(result.value, Value(UBits(10, 32)));
+  EXPECT_EQ(result.events.trace_msgs.size(), 5);
+
+  EXPECT_THAT(interpreter.Run({Value(UBits(5, 32))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not of type bits[8]")));
+}
+
+TEST_F(IrInterpreterOnlyTest, SlottedNodeValuesChecksNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder other_fb("other", p.get());
+  BValue other_x = other_fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK(other_fb.Build().status());
+
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue neg = fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  SlottedNodeValues values(f);
+  EXPECT_THAT(values.topo_order(), ElementsAre(x.node(), neg.node()));
+  EXPECT_FALSE(values.Contains(neg.node()));
+  values.Set(neg.node(), Value(UBits(1, 32)));
+  EXPECT_EQ(values.At(neg.node()), Value(UBits(1, 32)));
+  values.Clear();
+  EXPECT_FALSE(values.Contains(neg.node()));
+
+  // Nodes of other functions have no slot, even in optimized builds.
+  EXPECT_DEATH(values.Contains(other_x.node()), "is not in");
+}
+
 // Test collecting traces across a map.
 TEST_F(IrInterpreterOnlyTest, TraceMap) {
   const std::string pkg_text = R"(
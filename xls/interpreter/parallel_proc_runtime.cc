@@ -0,0 +1,308 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/events.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+namespace {
+
+// Returns true if the behavior of some proc in the elaboration can depend on
+// when other procs execute, i.e., the network is not a Kahn process network.
+bool HasTimingDependentCommunication(const ProcElaboration& elaboration) {
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming) {
+      return true;
+    }
+  }
+  for (Proc* proc : elaboration.procs()) {
+    for (Node* node : proc->nodes()) {
+      if (node->Is<Receive>() && !node->As<Receive>()->is_blocking()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    const EvaluatorOptions& options, std::optional<int64_t> thread_count) {
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(),
+                   queue_manager->elaboration().procs().size())
+      << "More evaluators than procs given.";
+  if (thread_count.has_value()) {
+    XLS_RET_CHECK_GT(*thread_count, 0) << "Thread count must be positive.";
+  }
+  int64_t num_threads =
+      thread_count.value_or(std::max<int64_t>(AvailableCPUs(), 1));
+  // There is no point in having more threads than proc instances.
+  num_threads = std::min<int64_t>(
+      num_threads, std::max<int64_t>(
+                       queue_manager->elaboration().proc_instances().size(), 1));
+  return absl::WrapUnique(
+      new ParallelProcRuntime(std::move(evaluator_map),
+                              std::move(queue_manager), options, num_threads));
+}
+
+ParallelProcRuntime::ParallelProcRuntime(
+    absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    const EvaluatorOptions& options, int64_t thread_count)
+    : ProcRuntime(std::move(evaluators), std::move(queue_manager), options) {
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    ProcEvaluator* evaluator = evaluators_.at(instance->proc()).get();
+    instances_.push_back(
+        InstanceState{.instance = instance,
+                      .evaluator = evaluator,
+                      .continuation = continuations_.at(instance).get(),
+                      .has_io = evaluator->ProcHasIoOperations()});
+  }
+  has_timing_dependent_channels_ =
+      HasTimingDependentCommunication(elaboration());
+  // The thread calling Tick also executes procs so only `thread_count - 1`
+  // additional threads are needed.
+  for (int64_t i = 1; i < thread_count; ++i) {
+    workers_.push_back(std::make_unique<Thread>([this]() { WorkerLoop(); }));
+  }
+}
+
+ParallelProcRuntime::~ParallelProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+bool ParallelProcRuntime::RequiresSerialExecution() const {
+  return has_timing_dependent_channels_ || options_.trace_channels() ||
+         observer_.has_value();
+}
+
+void ParallelProcRuntime::WorkerLoop() {
+  absl::MutexLock lock(&mutex_);
+  while (true) {
+    mutex_.Await(absl::Condition(
+        +[](ParallelProcRuntime* self) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+             self->mutex_) {
+          return self->shutdown_ ||
+                 (self->use_workers_ && !self->error_.has_value() &&
+                  !self->ready_.empty());
+        },
+        this));
+    if (shutdown_) {
+      return;
+    }
+    int64_t index = ready_.front();
+    ready_.pop_front();
+    RunInstance(index);
+  }
+}
+
+void ParallelProcRuntime::DrainReadyList() {
+  absl::MutexLock lock(&mutex_);
+  while (true) {
+    // Wait until there is something to run or every other thread has finished
+    // with the instance it was running.
+    mutex_.Await(absl::Condition(
+        +[](ParallelProcRuntime* self) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+             self->mutex_) {
+          return self->running_ == 0 ||
+                 (!self->error_.has_value() && !self->ready_.empty());
+        },
+        this));
+    if (error_.has_value() || ready_.empty()) {
+      if (running_ == 0) {
+        return;
+      }
+      continue;
+    }
+    int64_t index = ready_.front();
+    ready_.pop_front();
+    RunInstance(index);
+  }
+}
+
+void ParallelProcRuntime::RunInstance(int64_t index) {
+  const InstanceState& state = instances_[index];
+  ++running_;
+  bool tick_again = true;
+  while (tick_again) {
+    mutex_.Unlock();
+    VLOG(3) << absl::StreamFormat("Ticking proc instance `%s`",
+                                  state.instance->GetName());
+    absl::StatusOr<TickResult> tick_result =
+        state.evaluator->Tick(*state.continuation);
+    if (tick_result.ok()) {
+      absl::Status events_status =
+          InterpreterEventsToStatus(GetInterpreterEvents(state.instance));
+      if (!events_status.ok()) {
+        tick_result = events_status;
+      }
+    }
+    mutex_.Lock();
+    tick_again = HandleTickResult(index, tick_result);
+  }
+  --running_;
+}
+
+bool ParallelProcRuntime::HandleTickResult(
+    int64_t index, const absl::StatusOr<TickResult>& tick_result) {
+  const InstanceState& state = instances_[index];
+  if (!tick_result.ok()) {
+    if (!error_.has_value() || error_->first > index) {
+      error_ = std::make_pair(index, tick_result.status());
+    }
+    return false;
+  }
+  VLOG(3) << "Tick result: " << *tick_result;
+
+  progress_made_ |= tick_result->progress_made;
+  progress_made_on_io_procs_ |= tick_result->progress_made && state.has_io;
+  switch (tick_result->execution_state) {
+    case TickExecutionState::kCompleted:
+      return false;
+    case TickExecutionState::kSentOnChannel: {
+      ChannelInstance* channel_instance = *tick_result->channel_instance;
+      auto it = blocked_.find(channel_instance);
+      if (it != blocked_.end()) {
+        VLOG(3) << absl::StreamFormat(
+            "Unblocking proc instance `%s` and adding to ready list",
+            instances_[it->second].instance->GetName());
+        ready_.push_back(it->second);
+        blocked_.erase(it);
+      }
+      if (error_.has_value()) {
+        return false;
+      }
+      if (use_workers_) {
+        // Keep running this instance on the current thread rather than paying
+        // for a round trip through the ready list.
+        return true;
+      }
+      // Matches the order used by SerialProcRuntime.
+      ready_.push_back(index);
+      return false;
+    }
+    case TickExecutionState::kBlockedOnReceive: {
+      ChannelInstance* channel_instance = *tick_result->channel_instance;
+      // A sender may have written to the channel after the proc observed it as
+      // empty but before this thread acquired the lock, in which case the
+      // sender did not see this instance as blocked. Checking the queue under
+      // the lock avoids losing the wakeup.
+      if (!queue_manager().GetQueue(channel_instance).IsEmpty()) {
+        if (error_.has_value()) {
+          return false;
+        }
+        ready_.push_back(index);
+        return false;
+      }
+      VLOG(3) << absl::StreamFormat(
+          "Proc instance `%s` is now blocked on channel instance `%s`",
+          state.instance->GetName(), channel_instance->ToString());
+      blocked_[channel_instance] = index;
+      return false;
+    }
+  }
+  LOG(FATAL) << "Invalid tick execution state";
+}
+
+absl::StatusOr<ParallelProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                package()->name());
+  {
+    absl::MutexLock lock(&mutex_);
+    XLS_RET_CHECK(ready_.empty());
+    XLS_RET_CHECK_EQ(running_, 0);
+    blocked_.clear();
+    progress_made_ = false;
+    progress_made_on_io_procs_ = false;
+    error_.reset();
+    // Put all proc instances on the ready list.
+    for (int64_t i = 0; i < instances_.size(); ++i) {
+      ready_.push_back(i);
+    }
+    use_workers_ = !workers_.empty() && !RequiresSerialExecution();
+  }
+
+  DrainReadyList();
+
+  absl::MutexLock lock(&mutex_);
+  use_workers_ = false;
+  ready_.clear();
+  if (error_.has_value()) {
+    absl::Status status = std::move(error_->second);
+    error_.reset();
+    return status;
+  }
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    if (blocked_.contains(instance)) {
+      blocked_channel_instances.push_back(instance);
+    }
+  }
+  return NetworkTickResult{
+      .progress_made = progress_made_,
+      .progress_made_on_io_procs = progress_made_on_io_procs_,
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,142 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Class for evaluating a network of procs using a pool of worker threads.
+//
+// Each network tick every proc instance is placed on a shared ready list and
+// workers tick instances concurrently. An instance which blocks on a receive is
+// parked on the channel instance it is waiting for and is moved back to the
+// ready list when a sender writes to that channel. The tick ends once the
+// ready list is empty and no worker is running an instance.
+//
+// For networks whose procs only communicate through blocking receives on
+// streaming channels the observable results (channel contents, proc state and
+// per-instance events) are the same as those of SerialProcRuntime regardless of
+// the thread count or the interleaving chosen by the workers. Non-blocking
+// receives and single-value channels expose the relative timing of procs, as
+// do channel traces and evaluation observers, so networks using any of these
+// are evaluated on the calling thread in SerialProcRuntime order instead.
+//
+// The channel queues must be thread-safe (e.g., created by
+// JitChannelQueueManager::CreateThreadSafe or ChannelQueueManager::Create).
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a proc network evaluator for the given evaluators
+  // which uses up to `thread_count` threads (including the thread calling
+  // Tick). If `thread_count` is not given the number of available CPUs is used.
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options = EvaluatorOptions(),
+      std::optional<int64_t> thread_count = std::nullopt);
+
+  ~ParallelProcRuntime() override;
+
+  // The number of threads (including the calling thread) used to tick procs.
+  int64_t thread_count() const {
+    return static_cast<int64_t>(workers_.size()) + 1;
+  }
+
+  // Whether the network must be evaluated serially to produce deterministic
+  // results. See class comment.
+  bool RequiresSerialExecution() const;
+
+ private:
+  ParallelProcRuntime(
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options, int64_t thread_count);
+
+  // Proc instance in elaboration order along with everything needed to tick
+  // it. Instances are referred to by their index in `instances_`.
+  struct InstanceState {
+    ProcInstance* instance;
+    ProcEvaluator* evaluator;
+    ProcContinuation* continuation;
+    bool has_io;
+  };
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  // Body of the pool threads.
+  void WorkerLoop();
+
+  // Ticks instances from the ready list until the network tick is complete.
+  // Run by the thread calling TickInternal.
+  void DrainReadyList() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Ticks the given instance until it completes its iteration or blocks. The
+  // lock is released while the proc is executing.
+  void RunInstance(int64_t index) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Updates the scheduler state with the result of ticking instance `index`.
+  // Returns true if the caller should immediately tick the same instance
+  // again.
+  bool HandleTickResult(int64_t index,
+                        const absl::StatusOr<TickResult>& tick_result)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::vector<InstanceState> instances_;
+  bool has_timing_dependent_channels_ = false;
+
+  absl::Mutex mutex_;
+  // Indices of the instances which are ready to be ticked.
+  std::deque<int64_t> ready_ ABSL_GUARDED_BY(mutex_);
+  // Instances blocked on an empty channel instance, keyed by that channel
+  // instance.
+  absl::flat_hash_map<ChannelInstance*, int64_t> blocked_
+      ABSL_GUARDED_BY(mutex_);
+  // Number of instances currently being ticked.
+  int64_t running_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Whether pool threads may pick up work during the current tick.
+  bool use_workers_ ABSL_GUARDED_BY(mutex_) = false;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  bool progress_made_on_io_procs_ ABSL_GUARDED_BY(mutex_) = false;
+  // First error (in elaboration order of the failing instance) encountered
+  // during the current tick.
+  std::optional<std::pair<int64_t, absl::Status>> error_
+      ABSL_GUARDED_BY(mutex_);
+
+  std::vector<std::unique_ptr<Thread>> workers_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
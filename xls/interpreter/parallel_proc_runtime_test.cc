@@ -0,0 +1,218 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+class ParallelProcRuntimeTest : public IrTestBase {
+ public:
+  // Builds a network which fans the values received on `in` out to
+  // `kBranches` chains of `kDepth` accumulating procs and sums the results of
+  // every chain onto `out`.
+  static constexpr int64_t kBranches = 4;
+  static constexpr int64_t kDepth = 3;
+
+  absl::Status BuildNetwork(Package* p) {
+    Type* u32 = p->GetBitsType(32);
+    XLS_ASSIGN_OR_RETURN(
+        Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                                u32));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * out,
+        p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+    std::vector<Channel*> heads;
+    std::vector<Channel*> tails;
+    for (int64_t b = 0; b < kBranches; ++b) {
+      Channel* prev = nullptr;
+      for (int64_t d = 0; d <= kDepth; ++d) {
+        XLS_ASSIGN_OR_RETURN(
+            Channel * ch,
+            p->CreateStreamingChannel(absl::StrFormat("ch_%d_%d", b, d),
+                                      ChannelOps::kSendReceive, u32));
+        if (prev == nullptr) {
+          heads.push_back(ch);
+        } else {
+          // Accumulate and scale so that the result depends on the order of
+          // the values on each channel.
+          ProcBuilder pb(absl::StrFormat("accum_%d_%d", b, d), p);
+          BValue accum = pb.StateElement("accum", Value(UBits(b + d, 32)));
+          BValue recv = pb.Receive(prev, pb.Literal(Value::Token()));
+          BValue next = pb.Add(pb.UMul(accum, pb.Literal(UBits(3, 32))),
+                               pb.TupleIndex(recv, 1));
+          pb.Send(ch, pb.TupleIndex(recv, 0), next);
+          XLS_RETURN_IF_ERROR(pb.Build({next}).status());
+        }
+        prev = ch;
+      }
+      tails.push_back(prev);
+    }
+
+    {
+      ProcBuilder pb("fan_out", p);
+      BValue recv = pb.Receive(in, pb.Literal(Value::Token()));
+      for (Channel* head : heads) {
+        pb.Send(head, pb.TupleIndex(recv, 0), pb.TupleIndex(recv, 1));
+      }
+      XLS_RETURN_IF_ERROR(pb.Build().status());
+    }
+    {
+      ProcBuilder pb("fan_in", p);
+      BValue sum = pb.Literal(UBits(0, 32));
+      BValue token = pb.Literal(Value::Token());
+      for (Channel* tail : tails) {
+        BValue recv = pb.Receive(tail, token);
+        token = pb.TupleIndex(recv, 0);
+        sum = pb.Add(sum, pb.TupleIndex(recv, 1));
+      }
+      pb.Send(out, token, sum);
+      XLS_RETURN_IF_ERROR(pb.Build().status());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<std::vector<Value>> Run(ProcRuntime* runtime,
+                                         int64_t input_count) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * in,
+                         runtime->queue_manager().GetQueueByName("in"));
+    for (int64_t i = 0; i < input_count; ++i) {
+      XLS_RETURN_IF_ERROR(in->Write(Value(UBits(i * 7 + 1, 32))));
+    }
+    XLS_ASSIGN_OR_RETURN(Channel * out, runtime->package()->GetChannel("out"));
+    XLS_RETURN_IF_ERROR(
+        runtime->TickUntilOutput({{out, input_count}}, /*max_ticks=*/1000)
+            .status());
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                         runtime->queue_manager().GetQueueByName("out"));
+    std::vector<Value> result;
+    while (std::optional<Value> value = out_queue->Read()) {
+      result.push_back(*value);
+    }
+    return result;
+  }
+};
+
+TEST_F(ParallelProcRuntimeTest, MatchesSerialRuntime) {
+  constexpr int64_t kInputs = 200;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK(BuildNetwork(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> serial,
+                           CreateJitSerialProcRuntime(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> expected,
+                           Run(serial.get(), kInputs));
+  ASSERT_EQ(expected.size(), kInputs);
+
+  for (int64_t thread_count : {1, 2, 4, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ParallelProcRuntime> parallel,
+        CreateJitParallelProcRuntime(p.get(), EvaluatorOptions(),
+                                     thread_count));
+    EXPECT_FALSE(parallel->RequiresSerialExecution());
+    EXPECT_EQ(parallel->thread_count(), thread_count);
+    EXPECT_THAT(Run(parallel.get(), kInputs),
+                absl_testing::IsOkAndHolds(expected))
+        << "thread_count=" << thread_count;
+  }
+}
+
+TEST_F(ParallelProcRuntimeTest, NonBlockingReceiveRunsSerially) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                              p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  ProcBuilder pb("nb", p.get());
+  BValue recv = pb.ReceiveNonBlocking(in, pb.Literal(Value::Token()));
+  pb.Send(out, pb.TupleIndex(recv, 0), pb.TupleIndex(recv, 1));
+  XLS_ASSERT_OK(pb.Build().status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ParallelProcRuntime> runtime,
+      CreateJitParallelProcRuntime(p.get(), EvaluatorOptions(),
+                                   /*thread_count=*/4));
+  EXPECT_TRUE(runtime->RequiresSerialExecution());
+  XLS_ASSERT_OK(runtime->Tick());
+}
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using the
+// parallel runtime.
+INSTANTIATE_TEST_SUITE_P(
+    ParallelProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "single_thread",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package, options,
+                                                  /*thread_count=*/1)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(top, options,
+                                                  /*thread_count=*/1)
+                  .value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "multi_thread",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package, options,
+                                                  /*thread_count=*/4)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(top, options,
+                                                  /*thread_count=*/4)
+                  .value();
+            },
+            /*supports_observers=*/true)),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+}  // namespace
+}  // namespace xls
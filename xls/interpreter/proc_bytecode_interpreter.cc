@@ -0,0 +1,222 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/proc_bytecode_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/bytecode_program.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/state_element.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// A continuation used by the ProcBytecodeInterpreter. Holds the registers and
+// node values of the tick in progress.
+class ProcBytecodeContinuation : public ProcContinuation {
+ public:
+  ProcBytecodeContinuation(ProcInstance* proc_instance,
+                           const BytecodeProgram& program)
+      : ProcContinuation(proc_instance), frame_(program) {
+    state_.reserve(proc()->GetStateElementCount());
+    for (StateElement* state_element : proc()->StateElements()) {
+      state_.push_back(state_element->initial_value());
+    }
+  }
+
+  ~ProcBytecodeContinuation() override = default;
+
+  std::vector<Value> GetState() const override { return state_; }
+  absl::Span<const Value> state() const { return state_; }
+
+  absl::Status SetState(std::vector<Value> v) override {
+    XLS_RETURN_IF_ERROR(CheckConformsToStateType(v));
+    state_ = std::move(v);
+    return absl::OkStatus();
+  }
+
+  const InterpreterEvents& GetEvents() const override { return events_; }
+  InterpreterEvents& GetEvents() override { return events_; }
+  void ClearEvents() override { events_.Clear(); }
+  bool AtStartOfTick() const override { return instruction_index_ == 0; }
+
+  absl::flat_hash_map<StateElement*, std::vector<Next*>>&
+  GetActiveNextValues() {
+    return active_next_values_;
+  }
+
+  // Resets the continuation so it will start executing at the beginning of the
+  // proc with the given state values.
+  void NextTick(std::vector<Value>&& next_state) {
+    instruction_index_ = 0;
+    state_ = std::move(next_state);
+    frame_.Clear();
+    active_next_values_.clear();
+  }
+
+  // Gets/sets the index of the instruction to be executed next.
+  int64_t GetInstructionIndex() const { return instruction_index_; }
+  void SetInstructionIndex(int64_t index) { instruction_index_ = index; }
+
+  BytecodeFrame& frame() { return frame_; }
+
+ private:
+  int64_t instruction_index_ = 0;
+  std::vector<Value> state_;
+  BytecodeFrame frame_;
+
+  InterpreterEvents events_;
+  absl::flat_hash_map<StateElement*, std::vector<Next*>> active_next_values_;
+};
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ProcBytecodeInterpreter>>
+ProcBytecodeInterpreter::Create(Proc* proc,
+                                ChannelQueueManager* queue_manager) {
+  // Use the same node order as the ProcInterpreter so sends and receives are
+  // executed in the same order.
+  std::vector<Node*> order = TopoSort(proc);
+  XLS_ASSIGN_OR_RETURN(
+      BytecodeProgram program,
+      BytecodeProgram::Compile(proc, order, /*live_out=*/{}));
+  VLOG(3) << "Bytecode for proc " << proc->name() << ":\n"
+          << program.ToString();
+  return absl::WrapUnique(
+      new ProcBytecodeInterpreter(proc, queue_manager, std::move(program)));
+}
+
+ProcBytecodeInterpreter::ProcBytecodeInterpreter(
+    Proc* proc, ChannelQueueManager* queue_manager, BytecodeProgram program)
+    : ProcEvaluator(proc),
+      queue_manager_(queue_manager),
+      program_(std::move(program)) {}
+
+std::unique_ptr<ProcContinuation> ProcBytecodeInterpreter::NewContinuation(
+    ProcInstance* proc_instance) const {
+  return std::make_unique<ProcBytecodeContinuation>(proc_instance, program_);
+}
+
+absl::StatusOr<TickResult> ProcBytecodeInterpreter::Tick(
+    ProcContinuation& continuation) const {
+  ProcBytecodeContinuation* cont =
+      dynamic_cast<ProcBytecodeContinuation*>(&continuation);
+  XLS_RET_CHECK_NE(cont, nullptr)
+      << "ProcBytecodeInterpreter requires a continuation of type "
+         "ProcBytecodeContinuation";
+
+  ProcIrInterpreter ir_interpreter(
+      cont->proc_instance(), cont->state(), cont->frame().values(),
+      &cont->GetEvents(), queue_manager_, &cont->GetActiveNextValues(),
+      continuation.GetObserver());
+
+  std::optional<ChannelInstance*> sent_channel_instance;
+  std::optional<ChannelInstance*> blocked_channel_instance;
+  int64_t starting_index = cont->GetInstructionIndex();
+  XLS_ASSIGN_OR_RETURN(
+      int64_t index,
+      program_.Execute(
+          cont->frame(), starting_index,
+          [&](const BytecodeProgram::Instruction& instruction)
+              -> absl::StatusOr<BytecodeProgram::GenericResult> {
+            XLS_ASSIGN_OR_RETURN(ProcIrInterpreter::NodeResult result,
+                                 ir_interpreter.ExecuteNode(instruction.node));
+            if (result.sent_channel_instance.has_value()) {
+              // Execution should resume _after_ the send.
+              sent_channel_instance = result.sent_channel_instance;
+              return BytecodeProgram::GenericResult::kStopAfter;
+            }
+            if (result.blocked_channel_instance.has_value()) {
+              // Execution should resume at the receive.
+              blocked_channel_instance = result.blocked_channel_instance;
+              return BytecodeProgram::GenericResult::kStopBefore;
+            }
+            return BytecodeProgram::GenericResult::kContinue;
+          },
+          /*all_generic=*/continuation.GetObserver().has_value()));
+  cont->SetInstructionIndex(index);
+
+  if (sent_channel_instance.has_value() ||
+      blocked_channel_instance.has_value()) {
+    // Raise a status error if interpreter events indicate failure such as a
+    // failed assert.
+    XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(cont->GetEvents()));
+    return TickResult{
+        .execution_state = sent_channel_instance.has_value()
+                               ? TickExecutionState::kSentOnChannel
+                               : TickExecutionState::kBlockedOnReceive,
+        .channel_instance = sent_channel_instance.has_value()
+                                ? sent_channel_instance
+                                : blocked_channel_instance,
+        .progress_made = index != starting_index};
+  }
+  XLS_RET_CHECK_EQ(index, program_.end_index());
+
+  // Proc completed execution of the Tick. Let the active next values update
+  // the proc state, then pass it to the continuation.
+  std::vector<Value> next_state = cont->GetState();
+  for (const auto& [state_element, next_values] : cont->GetActiveNextValues()) {
+    if (next_values.size() > 1) {
+      return absl::AlreadyExistsError(absl::StrFormat(
+          "Multiple active next values for state element %d (\"%s\") in a "
+          "single activation: %s",
+          *proc()->GetStateElementIndex(state_element), state_element->name(),
+          absl::StrJoin(next_values, ", ", [](std::string* out, Next* next) {
+            absl::StrAppend(out, next->GetName());
+          })));
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t state_index,
+                         proc()->GetStateElementIndex(state_element));
+    next_state[state_index] =
+        ir_interpreter.ResolveAsValue(next_values[0]->value());
+  }
+  cont->NextTick(std::move(next_state));
+
+  // Raise a status error if interpreter events indicate failure such as a
+  // failed assert.
+  XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(cont->GetEvents()));
+
+  return TickResult{.execution_state = TickExecutionState::kCompleted,
+                    .channel_instance = std::nullopt,
+                    .progress_made = true};
+}
+
+}  // namespace xls
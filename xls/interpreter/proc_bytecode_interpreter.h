@@ -0,0 +1,62 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PROC_BYTECODE_INTERPRETER_H_
+#define XLS_INTERPRETER_PROC_BYTECODE_INTERPRETER_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "xls/interpreter/bytecode_program.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// An evaluator for an individual proc which executes a BytecodeProgram
+// compiled from the proc. Bits operations of at most 64 bits run directly on
+// machine words; all other operations, including sends and receives, use the
+// ProcInterpreter handlers. Execution order and blocking behavior match the
+// ProcInterpreter. ProcBytecodeInterpreters are thread-safe if called with
+// different continuations.
+class ProcBytecodeInterpreter : public ProcEvaluator {
+ public:
+  static absl::StatusOr<std::unique_ptr<ProcBytecodeInterpreter>> Create(
+      Proc* proc, ChannelQueueManager* queue_manager);
+
+  ProcBytecodeInterpreter(const ProcBytecodeInterpreter&) = delete;
+  ProcBytecodeInterpreter operator=(const ProcBytecodeInterpreter&) = delete;
+
+  ~ProcBytecodeInterpreter() override = default;
+
+  std::unique_ptr<ProcContinuation> NewContinuation(
+      ProcInstance* proc_instance) const override;
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override;
+
+  const BytecodeProgram& program() const { return program_; }
+
+ private:
+  ProcBytecodeInterpreter(Proc* proc, ChannelQueueManager* queue_manager,
+                          BytecodeProgram program);
+
+  ChannelQueueManager* queue_manager_;
+  BytecodeProgram program_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PROC_BYTECODE_INTERPRETER_H_
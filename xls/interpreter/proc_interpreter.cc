@@ -115,149 +115,129 @@ class ProcInterpreterContinuation : public ProcContinuation {
   absl::flat_hash_map<StateElement*, std::vector<Next*>> active_next_values_;
 };
 
-// A visitor for interpreting procs. Adds handlers for send and receive
-// communicate via ChannelQueues.
-class ProcIrInterpreter : public IrInterpreter {
- public:
-  // Constructor args:
-  //   proc_instance: the instance of the proc which is being interpreted.
-  //   state: is the value to use for the proc state in the tick being
-  //     interpreted.
-  //   node_values: map from Node to Value for already computed values in this
-  //     tick of the proc. Used for continuations.
-  //   events: events object to record events in (e.g, traces).
-  //   queue_manager: manager for channel queues.
-  ProcIrInterpreter(ProcInstance* proc_instance, absl::Span<const Value> state,
-                    absl::flat_hash_map<Node*, Value>* node_values,
-                    InterpreterEvents* events,
-                    ChannelQueueManager* queue_manager,
-                    absl::flat_hash_map<StateElement*, std::vector<Next*>>*
-                        active_next_values,
-                    std::optional<EvaluationObserver*> observer)
-      : IrInterpreter(node_values, events, observer),
-        proc_instance_(proc_instance),
-        state_(state.begin(), state.end()),
-        queue_manager_(queue_manager),
-        active_next_values_(active_next_values) {}
-
-  absl::Status HandleReceive(Receive* receive) override {
-    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
-                         GetChannelQueue(receive->channel_name()));
-
-    if (receive->predicate().has_value()) {
-      const Bits& pred = ResolveAsBits(receive->predicate().value());
-      if (pred.IsZero()) {
-        // If the predicate is false, nothing is read from the channel.
-        // Rather the result of the receive is the zero values of the
-        // respective type.
-        return SetValueResult(receive, ZeroOfType(receive->GetType()));
-      }
-    }
+}  // namespace
 
-    std::optional<Value> value = queue->Read();
-    if (!value.has_value()) {
-      if (receive->is_blocking()) {
-        // Record the channel this receive instruction is blocked on and exit.
-        blocked_channel_instance_ = queue->channel_instance();
-        return absl::OkStatus();
-      }
-      // A non-blocking receive returns a zero data value with a zero valid bit
-      // if the queue is empty.
+ProcIrInterpreter::ProcIrInterpreter(
+    ProcInstance* proc_instance, absl::Span<const Value> state,
+    absl::flat_hash_map<Node*, Value>* node_values, InterpreterEvents* events,
+    ChannelQueueManager* queue_manager,
+    absl::flat_hash_map<StateElement*, std::vector<Next*>>* active_next_values,
+    std::optional<EvaluationObserver*> observer)
+    : IrInterpreter(node_values, events, observer),
+      proc_instance_(proc_instance),
+      state_(state.begin(), state.end()),
+      queue_manager_(queue_manager),
+      active_next_values_(active_next_values) {}
+
+ProcIrInterpreter::ProcIrInterpreter(
+    ProcInstance* proc_instance, absl::Span<const Value> state,
+    SlottedNodeValues& node_values, InterpreterEvents* events,
+    ChannelQueueManager* queue_manager,
+    absl::flat_hash_map<StateElement*, std::vector<Next*>>* active_next_values,
+    std::optional<EvaluationObserver*> observer)
+    : IrInterpreter(node_values, events, observer),
+      proc_instance_(proc_instance),
+      state_(state.begin(), state.end()),
+      queue_manager_(queue_manager),
+      active_next_values_(active_next_values) {}
+
+absl::Status ProcIrInterpreter::HandleReceive(Receive* receive) {
+  XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                       GetChannelQueue(receive->channel_name()));
+
+  if (receive->predicate().has_value()) {
+    const Bits& pred = ResolveAsBits(receive->predicate().value());
+    if (pred.IsZero()) {
+      // If the predicate is false, nothing is read from the channel.
+      // Rather the result of the receive is the zero values of the
+      // respective type.
       return SetValueResult(receive, ZeroOfType(receive->GetType()));
     }
+  }
 
+  std::optional<Value> value = queue->Read();
+  if (!value.has_value()) {
     if (receive->is_blocking()) {
-      return SetValueResult(receive, Value::Tuple({Value::Token(), *value}));
+      // Record the channel this receive instruction is blocked on and exit.
+      blocked_channel_instance_ = queue->channel_instance();
+      return absl::OkStatus();
     }
-
-    return SetValueResult(
-        receive, Value::Tuple({Value::Token(), *value, Value(UBits(1, 1))}));
+    // A non-blocking receive returns a zero data value with a zero valid bit
+    // if the queue is empty.
+    return SetValueResult(receive, ZeroOfType(receive->GetType()));
   }
 
-  absl::Status HandleSend(Send* send) override {
-    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
-                         GetChannelQueue(send->channel_name()));
-    if (send->predicate().has_value()) {
-      const Bits& pred = ResolveAsBits(send->predicate().value());
-      if (pred.IsZero()) {
-        return SetValueResult(send, Value::Token());
-      }
-    }
-    // Indicate that data is sent on this channel.
-    sent_channel_instance_ = queue->channel_instance();
-
-    XLS_RETURN_IF_ERROR(queue->Write(ResolveAsValue(send->data())));
-
-    // The result of a send is simply a token.
-    return SetValueResult(send, Value::Token());
+  if (receive->is_blocking()) {
+    return SetValueResult(receive, Value::Tuple({Value::Token(), *value}));
   }
 
-  absl::Status HandleStateRead(StateRead* state_read) override {
-    XLS_ASSIGN_OR_RETURN(
-        int64_t index,
-        state_read->function_base()->AsProcOrDie()->GetStateElementIndex(
-            state_read->state_element()));
-    return SetValueResult(state_read, state_[index]);
-  }
+  return SetValueResult(
+      receive, Value::Tuple({Value::Token(), *value, Value(UBits(1, 1))}));
+}
 
-  absl::Status HandleNext(Next* next) override {
-    if (next->predicate().has_value()) {
-      Value predicate = ResolveAsValue(*next->predicate());
-      XLS_RET_CHECK(predicate.IsBits());
-      XLS_RET_CHECK_EQ(predicate.bits().bit_count(), 1);
-      if (predicate.bits().IsZero()) {
-        // No change.
-        return SetValueResult(next, Value::Tuple({}));
-      }
+absl::Status ProcIrInterpreter::HandleSend(Send* send) {
+  XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                       GetChannelQueue(send->channel_name()));
+  if (send->predicate().has_value()) {
+    const Bits& pred = ResolveAsBits(send->predicate().value());
+    if (pred.IsZero()) {
+      return SetValueResult(send, Value::Token());
     }
-    (*active_next_values_)[next->state_read()->As<StateRead>()->state_element()]
-        .push_back(next);
-    return SetValueResult(next, Value::Tuple({}));
   }
+  // Indicate that data is sent on this channel.
+  sent_channel_instance_ = queue->channel_instance();
 
-  // Executes a single node and return whether the node is blocked on a channel
-  // (for receive nodes) or whether data was sent on a channel (for send nodes).
-  struct NodeResult {
-    std::optional<ChannelInstance*> blocked_channel_instance;
-    std::optional<ChannelInstance*> sent_channel_instance;
-  };
-  absl::StatusOr<NodeResult> ExecuteNode(Node* node) {
-    // Send/Receive handlers might set these values so clear them before hand.
-    blocked_channel_instance_ = std::nullopt;
-    sent_channel_instance_ = std::nullopt;
-    XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
-    return NodeResult{.blocked_channel_instance = blocked_channel_instance_,
-                      .sent_channel_instance = sent_channel_instance_};
-  }
+  XLS_RETURN_IF_ERROR(queue->Write(ResolveAsValue(send->data())));
 
- private:
-  // Get the channel queue for the channel or channel reference of the given
-  // name.
-  absl::StatusOr<ChannelQueue*> GetChannelQueue(std::string_view name) {
-    if (proc_instance_->path().has_value()) {
-      // New-style proc-scoped channel.
-      XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
-                           queue_manager_->elaboration().GetChannelInstance(
-                               name, *proc_instance_->path()));
-      return &queue_manager_->GetQueue(channel_instance);
-    }
-    // Old-style global channel.
-    return queue_manager_->GetQueueByName(name);
-  }
+  // The result of a send is simply a token.
+  return SetValueResult(send, Value::Token());
+}
 
-  ProcInstance* proc_instance_;
-  std::vector<Value> state_;
-  ChannelQueueManager* queue_manager_;
+absl::Status ProcIrInterpreter::HandleStateRead(StateRead* state_read) {
+  XLS_ASSIGN_OR_RETURN(
+      int64_t index,
+      state_read->function_base()->AsProcOrDie()->GetStateElementIndex(
+          state_read->state_element()));
+  return SetValueResult(state_read, state_[index]);
+}
 
-  absl::flat_hash_map<StateElement*, std::vector<Next*>>* active_next_values_;
+absl::Status ProcIrInterpreter::HandleNext(Next* next) {
+  if (next->predicate().has_value()) {
+    Value predicate = ResolveAsValue(*next->predicate());
+    XLS_RET_CHECK(predicate.IsBits());
+    XLS_RET_CHECK_EQ(predicate.bits().bit_count(), 1);
+    if (predicate.bits().IsZero()) {
+      // No change.
+      return SetValueResult(next, Value::Tuple({}));
+    }
+  }
+  (*active_next_values_)[next->state_read()->As<StateRead>()->state_element()]
+      .push_back(next);
+  return SetValueResult(next, Value::Tuple({}));
+}
 
-  // Ephemeral values set by the send/receive handlers indicating the channel
-  // execution is blocked on or the channel on which data was sent.
-  std::optional<ChannelInstance*> blocked_channel_instance_;
-  std::optional<ChannelInstance*> sent_channel_instance_;
-};
+absl::StatusOr<ProcIrInterpreter::NodeResult> ProcIrInterpreter::ExecuteNode(
+    Node* node) {
+  // Send/Receive handlers might set these values so clear them before hand.
+  blocked_channel_instance_ = std::nullopt;
+  sent_channel_instance_ = std::nullopt;
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
+  return NodeResult{.blocked_channel_instance = blocked_channel_instance_,
+                    .sent_channel_instance = sent_channel_instance_};
+}
 
-}  // namespace
+absl::StatusOr<ChannelQueue*> ProcIrInterpreter::GetChannelQueue(
+    std::string_view name) {
+  if (proc_instance_->path().has_value()) {
+    // New-style proc-scoped channel.
+    XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                         queue_manager_->elaboration().GetChannelInstance(
+                             name, *proc_instance_->path()));
+    return &queue_manager_->GetQueue(channel_instance);
+  }
+  // Old-style global channel.
+  return queue_manager_->GetQueueByName(name);
+}
 
 ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager)
     : ProcEvaluator(proc),
@@ -16,17 +16,87 @@
 #define XLS_INTERPRETER_PROC_INTERPRETER_H_
 
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/events.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
+#include "xls/ir/state_element.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
+// A visitor for interpreting procs. Adds handlers for send and receive
+// communicate via ChannelQueues. Used by the proc evaluators which are built on
+// the IrInterpreter handlers.
+class ProcIrInterpreter : public IrInterpreter {
+ public:
+  // Constructor args:
+  //   proc_instance: the instance of the proc which is being interpreted.
+  //   state: is the value to use for the proc state in the tick being
+  //     interpreted.
+  //   node_values: map from Node to Value for already computed values in this
+  //     tick of the proc. Used for continuations.
+  //   events: events object to record events in (e.g, traces).
+  //   queue_manager: manager for channel queues.
+  ProcIrInterpreter(ProcInstance* proc_instance, absl::Span<const Value> state,
+                    absl::flat_hash_map<Node*, Value>* node_values,
+                    InterpreterEvents* events,
+                    ChannelQueueManager* queue_manager,
+                    absl::flat_hash_map<StateElement*, std::vector<Next*>>*
+                        active_next_values,
+                    std::optional<EvaluationObserver*> observer);
+
+  // As above but storing node values in slot-indexed storage.
+  ProcIrInterpreter(ProcInstance* proc_instance, absl::Span<const Value> state,
+                    SlottedNodeValues& node_values, InterpreterEvents* events,
+                    ChannelQueueManager* queue_manager,
+                    absl::flat_hash_map<StateElement*, std::vector<Next*>>*
+                        active_next_values,
+                    std::optional<EvaluationObserver*> observer);
+
+  absl::Status HandleReceive(Receive* receive) override;
+  absl::Status HandleSend(Send* send) override;
+  absl::Status HandleStateRead(StateRead* state_read) override;
+  absl::Status HandleNext(Next* next) override;
+
+  // Executes a single node and return whether the node is blocked on a channel
+  // (for receive nodes) or whether data was sent on a channel (for send nodes).
+  struct NodeResult {
+    std::optional<ChannelInstance*> blocked_channel_instance;
+    std::optional<ChannelInstance*> sent_channel_instance;
+  };
+  absl::StatusOr<NodeResult> ExecuteNode(Node* node);
+
+ private:
+  // Get the channel queue for the channel or channel reference of the given
+  // name.
+  absl::StatusOr<ChannelQueue*> GetChannelQueue(std::string_view name);
+
+  ProcInstance* proc_instance_;
+  std::vector<Value> state_;
+  ChannelQueueManager* queue_manager_;
+
+  absl::flat_hash_map<StateElement*, std::vector<Next*>>* active_next_values_;
+
+  // Ephemeral values set by the send/receive handlers indicating the channel
+  // execution is blocked on or the channel on which data was sent.
+  std::optional<ChannelInstance*> blocked_channel_instance_;
+  std::optional<ChannelInstance*> sent_channel_instance_;
+};
+
 // A interpreter for an individual proc. Incrementally executes Procs a single
 // tick at a time. Data is fed to the proc via ChannelQueues.  ProcInterpreters
 // are thread-safe if called with different continuations.
@@ -166,6 +166,25 @@ INSTANTIATE_TEST_SUITE_P(
               return CreateInterpreterSerialProcRuntime(top, options).value();
             },
             /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "bytecode",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_bytecode_interpreter(
+                             true))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterSerialProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_bytecode_interpreter(
+                             true))
+                  .value();
+            },
+            /*supports_observers=*/true),
         ProcRuntimeTestParam(
             "jit",
             [](Package* package, const EvaluatorOptions& options)
@@ -177,6 +196,23 @@ INSTANTIATE_TEST_SUITE_P(
               return CreateJitSerialProcRuntime(top, options).value();
             },
             /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "jit_packed_layout",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         package,
+                         EvaluatorOptions(options).set_packed_jit_layout(true))
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitSerialProcRuntime(
+                         top,
+                         EvaluatorOptions(options).set_packed_jit_layout(true))
+                  .value();
+            },
+            /*supports_observers=*/true),
         ProcRuntimeTestParam(
             "mixed",
             [](Package* package, const EvaluatorOptions& options)
@@ -17,12 +17,15 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <random>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 
@@ -170,5 +173,20 @@ absl::StatusOr<BValue> GenerateFullyConnectedLayerGraph(
                            fb, absl::MakeSpan(current_layer)));
   return return_value;
 }
+std::vector<Bits> GenerateRandomBits(int64_t bit_count, int64_t count,
+                                     uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<uint8_t> bytes(CeilOfRatio(bit_count, int64_t{8}));
+  std::vector<Bits> result;
+  result.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    for (uint8_t& byte : bytes) {
+      byte = static_cast<uint8_t>(rng());
+    }
+    result.push_back(Bits::FromBytes(bytes, bit_count));
+  }
+  return result;
+}
+
 }  // namespace benchmark_support
 }  // namespace xls
@@ -307,6 +307,14 @@ absl::StatusOr<BValue> ChainReduce(
     const strategy::NaryNode& interior_node_strategy,
     const strategy::NullaryNode& leaf_strategy, BValue previous_layer);
 
+// Returns `count` pseudo-random values of width `bit_count`. The values are a
+// deterministic function of `seed` so benchmark runs are comparable.
+//
+// Intended as operands for microbenchmarks of bits_ops, e.g. to compare
+// single-word and multi-word widths.
+std::vector<Bits> GenerateRandomBits(int64_t bit_count, int64_t count,
+                                     uint64_t seed = 0);
+
 }  // namespace benchmark_support
 }  // namespace xls
 
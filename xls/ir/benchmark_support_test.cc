@@ -249,6 +249,17 @@ TEST(Chain, Reduce) {
                          m::Literal(UBits(42, 8)), m::Literal(UBits(42, 8))},
                         m::Literal(UBits(42, 8))));
 }
+
+TEST(RandomBits, DeterministicForSeed) {
+  std::vector<Bits> values = GenerateRandomBits(37, 16, /*seed=*/5);
+  ASSERT_EQ(values.size(), 16);
+  for (const Bits& value : values) {
+    EXPECT_EQ(value.bit_count(), 37);
+  }
+  EXPECT_EQ(GenerateRandomBits(37, 16, /*seed=*/5), values);
+  EXPECT_NE(GenerateRandomBits(37, 16, /*seed=*/6), values);
+  EXPECT_THAT(GenerateRandomBits(0, 2), testing::ElementsAre(Bits(), Bits()));
+}
 }  // namespace
 }  // namespace benchmark_support
 }  // namespace xls
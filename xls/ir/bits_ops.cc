@@ -28,7 +28,6 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
-#include "xls/common/bits_util.h"
 #include "xls/common/math_util.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/big_int.h"
@@ -52,6 +51,34 @@ Bits TruncateOrSignExtend(Bits bits, int64_t bit_count) {
   return Truncate(std::move(bits), bit_count);
 }
 
+// Values of at most this many bits are held in a single word of the bitmap and
+// the operations below handle them with native integer arithmetic rather than
+// going through BigInt or BitsRope.
+constexpr int64_t kWordBits = 64;
+
+bool FitsInWord(const Bits& bits) { return bits.bit_count() <= kWordBits; }
+
+// Returns the value of the single-word `bits` interpreted as unsigned. Unlike
+// Bits::ToUint64 this does no validation.
+uint64_t ToWord(const Bits& bits) {
+  return bits.bit_count() == 0 ? 0 : bits.bitmap().GetWord(0);
+}
+
+// Returns the value of the single-word `bits` interpreted as signed.
+int64_t ToSignedWord(const Bits& bits) {
+  if (bits.bit_count() == 0) {
+    return 0;
+  }
+  const int64_t shift = kWordBits - bits.bit_count();
+  return static_cast<int64_t>(bits.bitmap().GetWord(0) << shift) >> shift;
+}
+
+// Returns the low `bit_count` bits of `word` as a Bits value. Unlike UBits this
+// does no validation; bits of `word` above `bit_count` are dropped.
+Bits FromWord(uint64_t word, int64_t bit_count) {
+  return Bits::FromBitmap(InlineBitmap::FromWord(word, bit_count));
+}
+
 }  // namespace
 
 std::optional<int64_t> TryUnsignedBitsToInt64(const Bits& bits) {
@@ -68,9 +95,8 @@ int64_t UnsignedBitsToSaturatedInt64(const Bits& bits) {
 
 Bits And(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
-                 lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(ToWord(lhs) & ToWord(rhs), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -90,11 +116,8 @@ Bits NaryAnd(absl::Span<const Bits> operands) {
 
 Bits Or(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int | rhs_int);
-    return UBits(result, lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(ToWord(lhs) | ToWord(rhs), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -114,11 +137,8 @@ Bits NaryOr(absl::Span<const Bits> operands) {
 
 Bits Xor(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int ^ rhs_int);
-    return UBits(result, lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(ToWord(lhs) ^ ToWord(rhs), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -138,10 +158,8 @@ Bits NaryXor(absl::Span<const Bits> operands) {
 
 Bits Nand(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() & rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(~(ToWord(lhs) & ToWord(rhs)), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -161,10 +179,8 @@ Bits NaryNand(absl::Span<const Bits> operands) {
 
 Bits Nor(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() | rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(~(ToWord(lhs) | ToWord(rhs)), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -183,9 +199,8 @@ Bits NaryNor(absl::Span<const Bits> operands) {
 }
 
 Bits Not(const Bits& bits) {
-  if (bits.bit_count() <= 64) {
-    return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
+  if (FitsInWord(bits)) {
+    return FromWord(~ToWord(bits), bits.bit_count());
   }
   std::vector<uint8_t> bytes = bits.ToBytes();
   for (uint8_t& byte : bytes) {
@@ -211,11 +226,8 @@ Bits XorReduce(const Bits& operand) {
 
 Bits Add(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int + rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(ToWord(lhs) + ToWord(rhs), lhs.bit_count());
   }
 
   Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
@@ -225,11 +237,8 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+  if (FitsInWord(lhs)) {
+    return FromWord(ToWord(lhs) - ToWord(rhs), lhs.bit_count());
   }
   Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
                   .ToSignedBits();
@@ -264,11 +273,12 @@ Bits Decrement(Bits x) {
 
 Bits SMul(const Bits& lhs, const Bits& rhs) {
   const int64_t result_width = lhs.bit_count() + rhs.bit_count();
-  if (result_width <= 64) {
-    int64_t lhs_int = lhs.ToInt64().value();
-    int64_t rhs_int = rhs.ToInt64().value();
-    int64_t result = lhs_int * rhs_int;
-    return SBits(result, result_width);
+  if (result_width <= kWordBits) {
+    // Multiply as unsigned to get wrapping semantics; the low `result_width`
+    // bits of the product are the same either way.
+    uint64_t result = static_cast<uint64_t>(ToSignedWord(lhs)) *
+                      static_cast<uint64_t>(ToSignedWord(rhs));
+    return FromWord(result, result_width);
   }
 
   BigInt product =
@@ -278,11 +288,8 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
 
 Bits UMul(const Bits& lhs, const Bits& rhs) {
   const int64_t result_width = lhs.bit_count() + rhs.bit_count();
-  if (result_width <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = lhs_int * rhs_int;
-    return UBits(result, result_width);
+  if (result_width <= kWordBits) {
+    return FromWord(ToWord(lhs) * ToWord(rhs), result_width);
   }
 
   BigInt product =
@@ -294,6 +301,9 @@ Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
+  if (FitsInWord(lhs) && FitsInWord(rhs)) {
+    return FromWord(ToWord(lhs) / ToWord(rhs), lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
@@ -303,6 +313,9 @@ Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (FitsInWord(lhs) && FitsInWord(rhs)) {
+    return FromWord(ToWord(lhs) % ToWord(rhs), rhs.bit_count());
+  }
   BigInt modulo =
       BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
@@ -322,6 +335,16 @@ Bits SDiv(const Bits& lhs, const Bits& rhs) {
     // 0b0111...111.
     return ZeroExtend(Bits::AllOnes(lhs.bit_count() - 1), lhs.bit_count());
   }
+  if (FitsInWord(lhs) && FitsInWord(rhs)) {
+    int64_t lhs_int = ToSignedWord(lhs);
+    int64_t rhs_int = ToSignedWord(rhs);
+    // Dividing the minimum int64_t by -1 overflows, so negate as unsigned
+    // instead; the result wraps exactly as truncating the BigInt would.
+    uint64_t quotient = rhs_int == -1
+                            ? uint64_t{0} - static_cast<uint64_t>(lhs_int)
+                            : static_cast<uint64_t>(lhs_int / rhs_int);
+    return FromWord(quotient, lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(quotient.ToSignedBits(), lhs.bit_count());
@@ -331,6 +354,13 @@ Bits SMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (FitsInWord(lhs) && FitsInWord(rhs)) {
+    // The remainder takes the sign of the dividend, as in BigInt::Mod. Avoid
+    // the overflowing minimum int64_t % -1.
+    int64_t rhs_int = ToSignedWord(rhs);
+    int64_t modulo = rhs_int == -1 ? 0 : ToSignedWord(lhs) % rhs_int;
+    return FromWord(static_cast<uint64_t>(modulo), rhs.bit_count());
+  }
   BigInt modulo = BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(modulo.ToSignedBits(), rhs.bit_count());
 }
@@ -409,6 +439,9 @@ bool ULessThan(const Bits& lhs, int64_t rhs) {
 }
 
 bool SEqual(const Bits& lhs, const Bits& rhs) {
+  if (FitsInWord(lhs) && FitsInWord(rhs)) {
+    return ToSignedWord(lhs) == ToSignedWord(rhs);
+  }
   return BigInt::MakeSigned(lhs) == BigInt::MakeSigned(rhs);
 }
 
@@ -432,8 +465,8 @@ bool SLessThanOrEqual(const Bits& lhs, const Bits& rhs) {
 }
 
 bool SLessThan(const Bits& lhs, const Bits& rhs) {
-  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
-    return lhs.ToInt64().value() < rhs.ToInt64().value();
+  if (FitsInWord(lhs) && FitsInWord(rhs)) {
+    return ToSignedWord(lhs) < ToSignedWord(rhs);
   }
   return BigInt::LessThan(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
 }
@@ -493,6 +526,17 @@ Bits Concat(absl::Span<const Bits> inputs) {
   for (const Bits& bits : inputs) {
     new_bit_count += bits.bit_count();
   }
+  if (new_bit_count <= kWordBits) {
+    uint64_t result = 0;
+    for (const Bits& bits : inputs) {
+      // A full-width input must be the only non-empty one; shifting by the
+      // word width is undefined.
+      result = bits.bit_count() == kWordBits
+                   ? ToWord(bits)
+                   : (result << bits.bit_count()) | ToWord(bits);
+    }
+    return FromWord(result, new_bit_count);
+  }
   // Iterate in reverse order because the first input becomes the
   // most-significant bits.
   BitsRope rope(new_bit_count);
@@ -503,9 +547,8 @@ Bits Concat(absl::Span<const Bits> inputs) {
 }
 
 Bits Negate(const Bits& bits) {
-  if (bits.bit_count() < 64) {
-    return UBits((-bits.ToInt64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
+  if (FitsInWord(bits)) {
+    return FromWord(uint64_t{0} - ToWord(bits), bits.bit_count());
   }
   Bits negated = BigInt::Negate(BigInt::MakeSigned(bits)).ToSignedBits();
   return TruncateOrSignExtend(std::move(negated), bits.bit_count());
@@ -518,6 +561,11 @@ Bits Abs(const Bits& bits) {
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
+  if (FitsInWord(bits)) {
+    return shift_amount == bits.bit_count()
+               ? Bits(bits.bit_count())
+               : FromWord(ToWord(bits) << shift_amount, bits.bit_count());
+  }
   return Concat(
       {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
 }
@@ -525,6 +573,11 @@ Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
+  if (FitsInWord(bits)) {
+    return shift_amount == bits.bit_count()
+               ? Bits(bits.bit_count())
+               : FromWord(ToWord(bits) >> shift_amount, bits.bit_count());
+  }
   return Concat({UBits(0, shift_amount),
                  bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
 }
@@ -532,6 +585,14 @@ Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
   shift_amount = std::min(shift_amount, bits.bit_count());
+  if (FitsInWord(bits)) {
+    // Shifting the sign-extended value by the full width leaves only copies
+    // of the sign bit, so clamp to the largest valid shift of a word.
+    return FromWord(static_cast<uint64_t>(
+                        ToSignedWord(bits) >>
+                        std::min(shift_amount, kWordBits - 1)),
+                    bits.bit_count());
+  }
   return Concat(
       {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
        bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
@@ -25,10 +25,12 @@
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_test_utils.h"
 #include "xls/ir/format_preference.h"
@@ -701,6 +703,78 @@ TEST(BitsOpsTest, Negate) {
   EXPECT_EQ(bits_ops::Negate(UBits(1, 1234)), SBits(-1, 1234));
 }
 
+// Operations on values of at most 64 bits take a single-word fast path. Check
+// them against the same operations on the values extended to a width which
+// takes the multi-word path.
+TEST(BitsOpsTest, SingleWordMatchesMultiWord) {
+  constexpr int64_t kWide = 130;
+  auto zext = [](const Bits& b) { return bits_ops::ZeroExtend(b, kWide); };
+  auto sext = [](const Bits& b) { return bits_ops::SignExtend(b, kWide); };
+  auto trunc = [](const Bits& b, int64_t width) {
+    return bits_ops::Truncate(b, width);
+  };
+  for (int64_t width : {1, 2, 7, 32, 63, 64}) {
+    std::vector<Bits> lhs_values =
+        benchmark_support::GenerateRandomBits(width, 64, /*seed=*/width);
+    std::vector<Bits> rhs_values =
+        benchmark_support::GenerateRandomBits(width, 64, /*seed=*/width + 100);
+    lhs_values.push_back(Bits::MinSigned(width));
+    rhs_values.push_back(Bits::AllOnes(width));
+    lhs_values.push_back(Bits::AllOnes(width));
+    rhs_values.push_back(Bits::MinSigned(width));
+    for (int64_t i = 0; i < lhs_values.size(); ++i) {
+      const Bits& a = lhs_values[i];
+      // Division by zero has width-dependent results.
+      const Bits b = rhs_values[i].IsZero() ? UBits(1, width) : rhs_values[i];
+      SCOPED_TRACE(absl::StrCat("a=", a.ToDebugString(),
+                                " b=", b.ToDebugString()));
+      EXPECT_EQ(bits_ops::Add(a, b),
+                trunc(bits_ops::Add(zext(a), zext(b)), width));
+      EXPECT_EQ(bits_ops::Sub(a, b),
+                trunc(bits_ops::Sub(zext(a), zext(b)), width));
+      EXPECT_EQ(bits_ops::Negate(a), trunc(bits_ops::Negate(zext(a)), width));
+      EXPECT_EQ(bits_ops::Not(a), trunc(bits_ops::Not(zext(a)), width));
+      EXPECT_EQ(bits_ops::And(a, b),
+                trunc(bits_ops::And(zext(a), zext(b)), width));
+      EXPECT_EQ(bits_ops::Nor(a, b),
+                trunc(bits_ops::Nor(zext(a), zext(b)), width));
+      if (2 * width <= 64) {
+        EXPECT_EQ(bits_ops::UMul(a, b),
+                  trunc(bits_ops::UMul(zext(a), zext(b)), 2 * width));
+        EXPECT_EQ(bits_ops::SMul(a, b),
+                  trunc(bits_ops::SMul(sext(a), sext(b)), 2 * width));
+      }
+      EXPECT_EQ(bits_ops::UDiv(a, b),
+                trunc(bits_ops::UDiv(zext(a), zext(b)), width));
+      EXPECT_EQ(bits_ops::UMod(a, b),
+                trunc(bits_ops::UMod(zext(a), zext(b)), width));
+      EXPECT_EQ(bits_ops::SDiv(a, b),
+                trunc(bits_ops::SDiv(sext(a), sext(b)), width));
+      EXPECT_EQ(bits_ops::SMod(a, b),
+                trunc(bits_ops::SMod(sext(a), sext(b)), width));
+      EXPECT_EQ(bits_ops::SEqual(a, b), bits_ops::SEqual(sext(a), sext(b)));
+      EXPECT_EQ(bits_ops::SLessThan(a, b),
+                bits_ops::SLessThan(sext(a), sext(b)));
+      for (int64_t shift : {int64_t{0}, int64_t{1}, width - 1, width,
+                            width + 1}) {
+        EXPECT_EQ(bits_ops::ShiftLeftLogical(a, shift),
+                  trunc(bits_ops::ShiftLeftLogical(zext(a), shift), width));
+        EXPECT_EQ(bits_ops::ShiftRightLogical(a, shift),
+                  trunc(bits_ops::ShiftRightLogical(zext(a), shift), width));
+        EXPECT_EQ(bits_ops::ShiftRightArith(a, shift),
+                  trunc(bits_ops::ShiftRightArith(sext(a), shift), width));
+      }
+      if (2 * width <= 64) {
+        Bits concat = bits_ops::Concat({a, Bits(), b});
+        EXPECT_EQ(concat.Slice(0, width), b);
+        EXPECT_EQ(concat.Slice(width, width), a);
+      }
+    }
+  }
+  Bits full = UBits(0x8000000000000001ULL, 64);
+  EXPECT_EQ(bits_ops::Concat({Bits(), full, Bits()}), full);
+}
+
 TEST(BitsOpsTest, OneHot) {
   EXPECT_EQ(bits_ops::OneHotLsbToMsb(Bits(0)), UBits(1, 1));
   EXPECT_EQ(bits_ops::OneHotMsbToLsb(Bits(0)), UBits(1, 1));
@@ -1228,5 +1302,76 @@ void BM_ZeroExtendMove(benchmark::State& state) {
 }
 BENCHMARK(BM_ZeroExtendMove)->Range(33, 1 << 20);
 
+// Benchmarks a binary operation on random operands of width `state.range(0)`.
+// Widths of at most 64 bits take the single-word fast path.
+template <Bits (*kOp)(const Bits&, const Bits&)>
+void BM_BinaryOp(benchmark::State& state) {
+  std::vector<Bits> lhs =
+      benchmark_support::GenerateRandomBits(state.range(0), 64, /*seed=*/1);
+  std::vector<Bits> rhs =
+      benchmark_support::GenerateRandomBits(state.range(0), 64, /*seed=*/2);
+  int64_t i = 0;
+  for (auto _ : state) {
+    auto v = kOp(lhs[i], rhs[i]);
+    benchmark::DoNotOptimize(v);
+    i = (i + 1) % lhs.size();
+  }
+}
+BENCHMARK_TEMPLATE(BM_BinaryOp, bits_ops::Add)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+BENCHMARK_TEMPLATE(BM_BinaryOp, bits_ops::Xor)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+BENCHMARK_TEMPLATE(BM_BinaryOp, bits_ops::UMul)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+BENCHMARK_TEMPLATE(BM_BinaryOp, bits_ops::SMul)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+BENCHMARK_TEMPLATE(BM_BinaryOp, bits_ops::UDiv)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+BENCHMARK_TEMPLATE(BM_BinaryOp, bits_ops::SMod)
+    ->RangeMultiplier(2)
+    ->Range(8, 256);
+
+void BM_ShiftLeftLogical(benchmark::State& state) {
+  std::vector<Bits> values =
+      benchmark_support::GenerateRandomBits(state.range(0), 64);
+  int64_t i = 0;
+  for (auto _ : state) {
+    auto v = bits_ops::ShiftLeftLogical(values[i], i % state.range(0));
+    benchmark::DoNotOptimize(v);
+    i = (i + 1) % values.size();
+  }
+}
+BENCHMARK(BM_ShiftLeftLogical)->RangeMultiplier(2)->Range(8, 256);
+
+void BM_ShiftRightArith(benchmark::State& state) {
+  std::vector<Bits> values =
+      benchmark_support::GenerateRandomBits(state.range(0), 64);
+  int64_t i = 0;
+  for (auto _ : state) {
+    auto v = bits_ops::ShiftRightArith(values[i], i % state.range(0));
+    benchmark::DoNotOptimize(v);
+    i = (i + 1) % values.size();
+  }
+}
+BENCHMARK(BM_ShiftRightArith)->RangeMultiplier(2)->Range(8, 256);
+
+// Concatenates two halves of width `state.range(0) / 2`.
+void BM_Concat(benchmark::State& state) {
+  std::vector<Bits> values =
+      benchmark_support::GenerateRandomBits(state.range(0) / 2, 64);
+  int64_t i = 0;
+  for (auto _ : state) {
+    auto v = bits_ops::Concat({values[i], values[(i + 1) % values.size()]});
+    benchmark::DoNotOptimize(v);
+    i = (i + 1) % values.size();
+  }
+}
+BENCHMARK(BM_Concat)->RangeMultiplier(2)->Range(8, 256);
+
 }  // namespace
 }  // namespace xls
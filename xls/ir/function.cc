@@ -49,6 +49,10 @@ absl::Status Function::set_return_value(Node* n) {
       n->GetName(), name(), n->function_base()->name());
   Node* old_return_value = return_value_;
   return_value_ = n;
+  if (old_return_value != nullptr) {
+    transform_metrics().RecordOpChange(old_return_value->op());
+  }
+  transform_metrics().RecordOpChange(n->op());
   for (ChangeListener* listener : change_listeners_) {
     listener->ReturnValueChanged(this, old_return_value);
   }
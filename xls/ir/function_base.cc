@@ -30,6 +30,8 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "google/protobuf/text_format.h"
@@ -139,15 +141,17 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
   VLOG(4) << absl::StrFormat("Removing node from FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_removed;
+  ++transform_metrics().nodes_removed;
   std::vector<Node*> unique_operands;
   for (Node* operand : node->operands()) {
     if (!absl::c_linear_search(unique_operands, operand)) {
       unique_operands.push_back(operand);
     }
   }
+  transform_metrics().RecordOpChange(node->op());
   for (Node* operand : unique_operands) {
     operand->RemoveUser(node);
+    transform_metrics().RecordOpChange(operand->op());
   }
   if (node->Is<Param>()) {
     params_.erase(std::remove(params_.begin(), params_.end(), node),
@@ -167,6 +171,8 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   for (ChangeListener* listener : change_listeners_) {
     listener->NodeDeleted(node);
   }
+  nodes_by_index_[node->node_index()] = nullptr;
+  ++node_removal_count_;
   auto node_it = node_iterators_.find(node);
   XLS_RET_CHECK(node_it != node_iterators_.end());
   nodes_.erase(node_it->second);
@@ -174,6 +180,103 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Returns `name` with each number in it which is in [`first_id`, `end_id`)
+// shifted by `id_offset`, or std::nullopt if there is no such number. Only
+// whole numbers following a '.' (as in a default node name) or a '_' (its
+// sanitized form) are considered.
+std::optional<std::string> RenumberIdsInName(std::string_view name,
+                                             int64_t first_id, int64_t end_id,
+                                             int64_t id_offset) {
+  std::string result;
+  bool renumbered = false;
+  int64_t i = 0;
+  while (i < name.size()) {
+    if (!absl::ascii_isdigit(name[i]) || i == 0 ||
+        (name[i - 1] != '.' && name[i - 1] != '_')) {
+      result.push_back(name[i++]);
+      continue;
+    }
+    int64_t start = i;
+    while (i < name.size() && absl::ascii_isdigit(name[i])) {
+      ++i;
+    }
+    std::string_view digits = name.substr(start, i - start);
+    int64_t id;
+    if (absl::SimpleAtoi(digits, &id) && id >= first_id && id < end_id) {
+      absl::StrAppend(&result, id + id_offset);
+      renumbered = true;
+    } else {
+      absl::StrAppend(&result, digits);
+    }
+  }
+  if (!renumbered) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+}  // namespace
+
+int64_t FunctionBase::GetNextNodeIdAndIncrement() {
+  if (isolation_.has_value()) {
+    return isolation_->next_node_id++;
+  }
+  return package()->GetNextNodeIdAndIncrement();
+}
+
+TransformMetrics& FunctionBase::transform_metrics() {
+  if (isolation_.has_value()) {
+    return isolation_->transform_metrics;
+  }
+  return package()->transform_metrics();
+}
+
+void FunctionBase::BeginIsolation(int64_t first_node_id) {
+  CHECK(!isolation_.has_value()) << name() << " is already isolated";
+  isolation_ = Isolation{.first_node_id = first_node_id,
+                         .next_node_id = first_node_id,
+                         .transform_metrics = {}};
+}
+
+int64_t FunctionBase::EndIsolation(int64_t final_first_node_id) {
+  CHECK(isolation_.has_value()) << name() << " is not isolated";
+  Isolation isolation = *std::move(isolation_);
+  isolation_.reset();
+  const int64_t id_offset = final_first_node_id - isolation.first_node_id;
+  // Nodes are stored in creation order, so this keeps the relative order of
+  // the new ids (and thus of id-sorted user lists) unchanged.
+  for (Node* node : nodes()) {
+    if (node->id() >= isolation.first_node_id &&
+        node->id() < isolation.next_node_id) {
+      node->SetId(node->id() + id_offset);
+    }
+  }
+  // Passes name new nodes after existing ones (e.g., "umul.42_narrowed"), and
+  // the default name of a node created while isolated has its temporary id.
+  // Rename such nodes as they would have been named outside isolation.
+  if (id_offset != 0) {
+    for (Node* node : nodes()) {
+      if (!node->HasAssignedName()) {
+        continue;
+      }
+      std::optional<std::string> renamed =
+          RenumberIdsInName(node->GetNameView(), isolation.first_node_id,
+                            isolation.next_node_id, id_offset);
+      if (renamed.has_value()) {
+        node->SetName(*renamed);
+      }
+    }
+  }
+  int64_t id_count = isolation.next_node_id - isolation.first_node_id;
+  package()->set_next_node_id(std::max(package()->next_node_id(),
+                                       final_first_node_id + id_count));
+  package()->transform_metrics() =
+      package()->transform_metrics() + isolation.transform_metrics;
+  return id_count;
+}
+
 absl::Status FunctionBase::Accept(DfsVisitor* visitor) {
   for (Node* node : nodes()) {
     if (node->users().empty()) {
@@ -246,7 +349,11 @@ Block* FunctionBase::AsBlockOrDie() {
 Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   VLOG(4) << absl::StrFormat("Adding node to FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_added;
+  ++transform_metrics().nodes_added;
+  transform_metrics().RecordOpChange(node->op());
+  for (Node* operand : node->operands()) {
+    transform_metrics().RecordOpChange(operand->op());
+  }
   if (node->Is<Param>()) {
     params_.push_back(node->As<Param>());
   }
@@ -260,6 +367,8 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
     next_values_by_state_read_.at(state_read).insert(next);
   }
   Node* ptr = node.get();
+  ptr->node_index_ = next_node_index_++;
+  nodes_by_index_.push_back(ptr);
   node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
   for (ChangeListener* listener : change_listeners_) {
     listener->NodeAdded(ptr);
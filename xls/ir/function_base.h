@@ -104,6 +104,23 @@ class FunctionBase {
 
   int64_t node_count() const { return nodes_.size(); }
 
+  // Returns one more than the largest Node::node_index() handed out by this
+  // FunctionBase, i.e., the size of a table indexed by node_index() which can
+  // hold every node. This is at least node_count() and grows as nodes are
+  // added even when others are removed.
+  int64_t node_index_limit() const { return next_node_index_; }
+
+  // Returns the node with the given node_index(), or nullptr if that node has
+  // been removed. `index` must be less than node_index_limit().
+  Node* GetNodeByIndex(int64_t index) const {
+    return nodes_by_index_.at(index);
+  }
+
+  // Returns the number of nodes removed from this FunctionBase so far. Tables
+  // keyed by node_index() (e.g., NodeMap) can compare this against a saved
+  // value to cheaply tell whether any of their keys may have been removed.
+  int64_t node_removal_count() const { return node_removal_count_; }
+
   // Expose Nodes, so that transformation passes can operate
   // on this function.
   xabsl::iterator_range<UnwrappingIterator<NodeList::iterator>> nodes() {
@@ -222,6 +239,32 @@ class FunctionBase {
     std::erase(change_listeners_, listener);
   }
 
+  // Returns the id to give to a new node of this FunctionBase. Ids come from
+  // the package-wide counter unless the FunctionBase is isolated (see
+  // BeginIsolation).
+  int64_t GetNextNodeIdAndIncrement();
+
+  // Returns the metrics to update when this FunctionBase is transformed. These
+  // are the package's unless the FunctionBase is isolated.
+  TransformMetrics& transform_metrics();
+
+  // Detaches this FunctionBase from the package-wide node id counter and
+  // transform metrics so that several FunctionBases of one package can be
+  // transformed concurrently, each by a single thread. While isolated, new
+  // nodes take consecutive ids starting at `first_node_id`, which must not
+  // collide with any other id in the package, and metrics are accumulated
+  // locally.
+  void BeginIsolation(int64_t first_node_id);
+
+  // Ends the isolation started by BeginIsolation. The nodes created while
+  // isolated are renumbered, in creation order, to consecutive ids starting at
+  // `final_first_node_id`, and the accumulated metrics are added to the
+  // package's. Node names which embed a temporary id (because they were
+  // derived from the default name of a new node) are updated to match.
+  // Returns the number of ids used. Must not be called concurrently with any
+  // other change to the package.
+  int64_t EndIsolation(int64_t final_first_node_id);
+
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const FunctionBase& fb) {
     absl::Format(&sink, "%s", fb.name());
@@ -256,6 +299,18 @@ class FunctionBase {
   // location in the list for fast lookup.
   NodeList nodes_;
   absl::flat_hash_map<const Node*, NodeList::iterator> node_iterators_;
+  int64_t next_node_index_ = 0;
+
+  // State of an active BeginIsolation.
+  struct Isolation {
+    int64_t first_node_id;
+    int64_t next_node_id;
+    TransformMetrics transform_metrics;
+  };
+  std::optional<Isolation> isolation_;
+  // Indexed by Node::node_index(); nullptr for removed nodes.
+  std::vector<Node*> nodes_by_index_;
+  int64_t node_removal_count_ = 0;
 
   std::vector<Param*> params_;
   std::vector<Next*> next_values_;
@@ -57,7 +57,7 @@ namespace xls {
 Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
            FunctionBase* function_base)
     : function_base_(function_base),
-      id_(function_base_->package()->GetNextNodeIdAndIncrement()),
+      id_(function_base_->GetNextNodeIdAndIncrement()),
       op_(op),
       type_(type),
       loc_(loc),
@@ -817,6 +817,14 @@ void Node::SetId(int64_t id) {
   package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
 }
 
+void Node::RecordChange() {
+  TransformMetrics& metrics = function_base()->transform_metrics();
+  metrics.RecordOpChange(op());
+  for (Node* user : users()) {
+    metrics.RecordOpChange(user->op());
+  }
+}
+
 bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   // The following test is necessary, because of the following scenario
   // during IR manipulation. Assume we want to replace a node 'sub' with
@@ -830,7 +838,7 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   if (this == new_operand) {
     return true;
   }
-  ++package()->transform_metrics().operands_replaced;
+  ++function_base()->transform_metrics().operands_replaced;
   std::vector<int64_t> replaced_operands;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
@@ -843,6 +851,11 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
     }
   }
   old_operand->RemoveUser(this);
+  RecordChange();
+  function_base()->transform_metrics().RecordOpChange(old_operand->op());
+  if (new_operand != nullptr) {
+    function_base()->transform_metrics().RecordOpChange(new_operand->op());
+  }
   for (ChangeListener* listener : GetChangeListeners(function_base_)) {
     listener->OperandChanged(this, old_operand, replaced_operands);
   }
@@ -857,7 +870,7 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
         << "old operand type: " << old_operand->GetType()->ToString()
         << " new operand type: " << new_operand->GetType()->ToString();
   }
-  ++package()->transform_metrics().operands_replaced;
+  ++function_base()->transform_metrics().operands_replaced;
 
   // AddUser is idempotent so even if the new operand is already used by this
   // node in another operand slot, it is safe to call.
@@ -870,6 +883,9 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
     // old_operand is no longer an operand of this node.
     old_operand->RemoveUser(this);
   }
+  RecordChange();
+  function_base()->transform_metrics().RecordOpChange(old_operand->op());
+  function_base()->transform_metrics().RecordOpChange(new_operand->op());
   for (ChangeListener* listener : GetChangeListeners(function_base_)) {
     listener->OperandChanged(this, old_operand, operand_no);
   }
@@ -879,7 +895,7 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
 absl::Status Node::RemoveOptionalOperand(int64_t operand_no) {
   XLS_RET_CHECK_LE(operand_no, operands_.size() - 1);
   Node* old_operand = operands_[operand_no];
-  ++package()->transform_metrics().operands_removed;
+  ++function_base()->transform_metrics().operands_removed;
 
   operands_.erase(operands_.begin() + operand_no);
 
@@ -889,6 +905,8 @@ absl::Status Node::RemoveOptionalOperand(int64_t operand_no) {
     // old_operand is no longer an operand of this node.
     old_operand->RemoveUser(this);
   }
+  RecordChange();
+  function_base()->transform_metrics().RecordOpChange(old_operand->op());
   for (ChangeListener* listener : GetChangeListeners(function_base_)) {
     listener->OperandRemoved(this, old_operand);
   }
@@ -902,7 +920,7 @@ absl::Status Node::ReplaceUsesWith(Node* replacement,
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  ++package()->transform_metrics().nodes_replaced;
+  ++function_base()->transform_metrics().nodes_replaced;
   bool all_replaced = true;
   std::vector<Node*> orig_users(users().begin(), users().end());
   for (Node* user : orig_users) {
@@ -963,6 +981,7 @@ void Node::SwapOperands(int64_t a, int64_t b) {
   for (ChangeListener* listener : GetChangeListeners(function_base_)) {
     listener->OperandChanged(this, old_a, a);
   }
+  RecordChange();
 }
 
 bool Node::OpIn(absl::Span<const Op> choices) const {
@@ -266,6 +266,13 @@ class Node {
 
   int64_t id() const { return id_; }
 
+  // Returns the index of this node within its FunctionBase. Indices are
+  // assigned densely from zero as nodes are added to the FunctionBase and are
+  // never reused, so they can key flat side tables (see NodeMap) in place of
+  // hash maps on Node*. Unlike id() the index is not unique across the
+  // package.
+  int64_t node_index() const { return node_index_; }
+
   // Sets the id of the node. Mutates the user sets of the operands of the node
   // because user sets are sorted by id.  Note: this should only be used by the
   // parser and ideally not even there.
@@ -303,6 +310,11 @@ class Node {
 
   std::string ToStringInternal(bool include_operand_types) const;
 
+  // Records in the transform metrics of the function that this node and its
+  // users, whose patterns may look through this node, were affected by a
+  // change to the IR. See TransformMetrics::op_changes.
+  void RecordChange();
+
   // Adds an operand to the operand list with a symmetric "user" link added to
   // those operands, noting that this node is a user.
   void AddOperand(Node* operand);
@@ -332,6 +344,8 @@ class Node {
 
   FunctionBase* function_base_;
   int64_t id_;
+  // Set by FunctionBase when the node is added.
+  int64_t node_index_ = -1;
   Op op_;
   Type* type_;
   SourceInfo loc_;
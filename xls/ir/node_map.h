@@ -0,0 +1,291 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_MAP_H_
+#define XLS_IR_NODE_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A map from the nodes of a single FunctionBase to values of type T, stored in
+// a flat vector indexed by Node::node_index(). Lookups are an index and a
+// pointer comparison rather than a hash, and the storage is contiguous, which
+// makes NodeMap a much cheaper replacement for absl::flat_hash_map<Node*, T>
+// in passes and analyses that touch most of the nodes of a function.
+//
+// The interface is a subset of absl::flat_hash_map's. Iteration visits
+// entries in node_index() order (i.e., the order in which the nodes were added
+// to the FunctionBase), so unlike a hash map it is deterministic.
+//
+// All keys must belong to the same FunctionBase, which must outlive the map.
+// Entries for nodes which are removed from the FunctionBase are dropped
+// lazily: lookups never match them (node indices are not reused), and size(),
+// empty() and iteration purge them the first time they are called after a
+// removal. Memory use is proportional to FunctionBase::node_index_limit()
+// rather than to the number of entries, so a hash map remains the better
+// choice for sparse maps over large functions.
+template <typename T>
+class NodeMap {
+ private:
+  using Slot = std::optional<std::pair<Node* const, T>>;
+
+  template <bool kConst>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<Node* const, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<kConst, const value_type&, value_type&>;
+    using pointer = std::conditional_t<kConst, const value_type*, value_type*>;
+    using SlotIterator =
+        std::conditional_t<kConst, typename std::vector<Slot>::const_iterator,
+                           typename std::vector<Slot>::iterator>;
+
+    Iterator() = default;
+    Iterator(SlotIterator it, SlotIterator end) : it_(it), end_(end) {
+      SkipEmpty();
+    }
+    // Allow conversion from iterator to const_iterator.
+    template <bool kOtherConst>
+      requires(kConst && !kOtherConst)
+    Iterator(const Iterator<kOtherConst>& other)  // NOLINT
+        : it_(other.it_), end_(other.end_) {}
+
+    reference operator*() const { return **it_; }
+    pointer operator->() const { return &**it_; }
+    Iterator& operator++() {
+      ++it_;
+      SkipEmpty();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+    bool operator==(const Iterator& other) const { return it_ == other.it_; }
+    bool operator!=(const Iterator& other) const { return it_ != other.it_; }
+
+   private:
+    friend class NodeMap;
+    friend class Iterator<!kConst>;
+
+    void SkipEmpty() {
+      while (it_ != end_ && !it_->has_value()) {
+        ++it_;
+      }
+    }
+
+    SlotIterator it_;
+    SlotIterator end_;
+  };
+
+ public:
+  using key_type = Node*;
+  using mapped_type = T;
+  using value_type = std::pair<Node* const, T>;
+  using iterator = Iterator</*kConst=*/false>;
+  using const_iterator = Iterator</*kConst=*/true>;
+
+  NodeMap() = default;
+  // Creates a map with room for every node currently in `function_base`.
+  explicit NodeMap(FunctionBase* function_base)
+      : function_base_(function_base),
+        removal_count_(function_base->node_removal_count()) {
+    slots_.reserve(function_base->node_index_limit());
+  }
+
+  NodeMap(const NodeMap&) = default;
+  // Entries have a const key so they cannot be assigned; copy and move the
+  // storage instead.
+  NodeMap& operator=(const NodeMap& other) {
+    if (this != &other) {
+      *this = NodeMap(other);
+    }
+    return *this;
+  }
+  NodeMap(NodeMap&&) = default;
+  NodeMap& operator=(NodeMap&&) = default;
+
+  bool empty() const { return size() == 0; }
+  int64_t size() const {
+    PurgeRemovedNodes();
+    return size_;
+  }
+
+  bool contains(const Node* node) const { return GetSlot(node) != nullptr; }
+  int64_t count(const Node* node) const { return contains(node) ? 1 : 0; }
+
+  iterator find(const Node* node) {
+    if (!contains(node)) {
+      return end();
+    }
+    return iterator(slots_.begin() + node->node_index(), slots_.end());
+  }
+  const_iterator find(const Node* node) const {
+    if (!contains(node)) {
+      return end();
+    }
+    return const_iterator(slots_.begin() + node->node_index(), slots_.end());
+  }
+
+  T& at(const Node* node) {
+    Slot* slot = GetSlot(node);
+    CHECK(slot != nullptr) << "Node not in map: " << node->GetName();
+    return (*slot)->second;
+  }
+  const T& at(const Node* node) const {
+    const Slot* slot = GetSlot(node);
+    CHECK(slot != nullptr) << "Node not in map: " << node->GetName();
+    return (*slot)->second;
+  }
+
+  // Returns the value for `node`, default-constructing it if not present.
+  T& operator[](Node* node) { return try_emplace(node).first->second; }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Node* node, Args&&... args) {
+    Slot& slot = GetOrCreateSlot(node);
+    bool inserted = !slot.has_value();
+    if (inserted) {
+      slot.emplace(std::piecewise_construct, std::forward_as_tuple(node),
+                   std::forward_as_tuple(std::forward<Args>(args)...));
+      ++size_;
+    }
+    return {iterator(slots_.begin() + node->node_index(), slots_.end()),
+            inserted};
+  }
+  template <typename V>
+  std::pair<iterator, bool> emplace(Node* node, V&& value) {
+    return try_emplace(node, std::forward<V>(value));
+  }
+  std::pair<iterator, bool> insert(value_type value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(Node* node, V&& value) {
+    auto [it, inserted] = try_emplace(node, std::forward<V>(value));
+    if (!inserted) {
+      it->second = std::forward<V>(value);
+    }
+    return {it, inserted};
+  }
+
+  int64_t erase(const Node* node) {
+    Slot* slot = GetSlot(node);
+    if (slot == nullptr) {
+      return 0;
+    }
+    slot->reset();
+    --size_;
+    return 1;
+  }
+  void erase(iterator it) { erase(it->first); }
+
+  // Removes all entries, keeping the storage.
+  void clear() {
+    for (Slot& slot : slots_) {
+      slot.reset();
+    }
+    size_ = 0;
+  }
+
+  iterator begin() {
+    PurgeRemovedNodes();
+    return iterator(slots_.begin(), slots_.end());
+  }
+  iterator end() { return iterator(slots_.end(), slots_.end()); }
+  const_iterator begin() const {
+    PurgeRemovedNodes();
+    return const_iterator(slots_.begin(), slots_.end());
+  }
+  const_iterator end() const {
+    return const_iterator(slots_.end(), slots_.end());
+  }
+
+ private:
+  const Slot* GetSlot(const Node* node) const {
+    int64_t index = node->node_index();
+    DCHECK_GE(index, 0) << "Node not added to a FunctionBase: "
+                        << node->GetName();
+    if (index >= static_cast<int64_t>(slots_.size()) ||
+        !slots_[index].has_value() || slots_[index]->first != node) {
+      return nullptr;
+    }
+    return &slots_[index];
+  }
+  Slot* GetSlot(const Node* node) {
+    return const_cast<Slot*>(std::as_const(*this).GetSlot(node));
+  }
+
+  Slot& GetOrCreateSlot(Node* node) {
+    int64_t index = node->node_index();
+    DCHECK_GE(index, 0) << "Node not added to a FunctionBase: "
+                        << node->GetName();
+    if (function_base_ == nullptr) {
+      function_base_ = node->function_base();
+      removal_count_ = function_base_->node_removal_count();
+    }
+    CHECK_EQ(node->function_base(), function_base_)
+        << "NodeMap keys must belong to a single FunctionBase: "
+        << node->GetName();
+    if (index >= static_cast<int64_t>(slots_.size())) {
+      slots_.resize(
+          std::max<int64_t>(index + 1, function_base_->node_index_limit()));
+    }
+    return slots_[index];
+  }
+
+  // Drops the entries of any nodes removed from the FunctionBase since the
+  // last call. This is a no-op unless a node has been removed.
+  void PurgeRemovedNodes() const {
+    if (function_base_ == nullptr ||
+        removal_count_ == function_base_->node_removal_count()) {
+      return;
+    }
+    for (int64_t i = 0; i < static_cast<int64_t>(slots_.size()); ++i) {
+      Slot& slot = slots_[i];
+      if (slot.has_value() && function_base_->GetNodeByIndex(i) == nullptr) {
+        slot.reset();
+        --size_;
+      }
+    }
+    removal_count_ = function_base_->node_removal_count();
+  }
+
+  FunctionBase* function_base_ = nullptr;
+  // Purging removed nodes does not change the logical contents of the map, so
+  // it is allowed from const methods.
+  mutable int64_t removal_count_ = 0;
+  mutable std::vector<Slot> slots_;
+  mutable int64_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_MAP_H_
@@ -0,0 +1,151 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_map.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+class NodeMapTest : public IrTestBase {};
+
+TEST_F(NodeMapTest, NodeIndicesAreDense) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  EXPECT_EQ(x.node()->node_index(), 0);
+  EXPECT_EQ(y.node()->node_index(), 1);
+  EXPECT_EQ(add.node()->node_index(), 2);
+  EXPECT_EQ(f->node_index_limit(), 3);
+
+  // Indices are not reused after removal.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(), Op::kSub));
+  EXPECT_EQ(sub->node_index(), 3);
+  XLS_ASSERT_OK(f->RemoveNode(sub));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  EXPECT_EQ(neg->node_index(), 4);
+  EXPECT_EQ(f->node_index_limit(), 5);
+}
+
+TEST_F(NodeMapTest, BasicOperations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  NodeMap<std::string> map(f);
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(x.node()));
+
+  map[add.node()] = "add";
+  EXPECT_TRUE(map.emplace(x.node(), "x").second);
+  EXPECT_FALSE(map.emplace(x.node(), "not x").second);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(x.node()), "x");
+  EXPECT_EQ(map.count(y.node()), 0);
+  EXPECT_EQ(map.find(y.node()), map.end());
+  ASSERT_NE(map.find(add.node()), map.end());
+  EXPECT_EQ(map.find(add.node())->second, "add");
+
+  // Iteration is in node index order.
+  EXPECT_THAT(map, ElementsAre(Pair(x.node(), "x"), Pair(add.node(), "add")));
+
+  EXPECT_FALSE(map.insert_or_assign(x.node(), "new x").second);
+  EXPECT_EQ(map.at(x.node()), "new x");
+
+  NodeMap<std::string> copy;
+  copy = map;
+  EXPECT_EQ(map.erase(x.node()), 1);
+  EXPECT_EQ(map.erase(x.node()), 0);
+  EXPECT_THAT(map, ElementsAre(Pair(add.node(), "add")));
+  EXPECT_THAT(copy,
+              ElementsAre(Pair(x.node(), "new x"), Pair(add.node(), "add")));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST_F(NodeMapTest, MoveOnlyValues) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  NodeMap<std::unique_ptr<int64_t>> map;
+  map.try_emplace(x.node(), std::make_unique<int64_t>(42));
+  NodeMap<std::unique_ptr<int64_t>> moved = std::move(map);
+  EXPECT_EQ(*moved.at(x.node()), 42);
+}
+
+TEST_F(NodeMapTest, RemovedNodesAreDropped) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * add,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(), Op::kAdd));
+  NodeMap<int64_t> map(f);
+  map[x.node()] = 1;
+  map[add] = 2;
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(f->GetNodeByIndex(add->node_index()), add);
+
+  int64_t add_index = add->node_index();
+  XLS_ASSERT_OK(f->RemoveNode(add));
+  EXPECT_EQ(f->GetNodeByIndex(add_index), nullptr);
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_THAT(map, ElementsAre(Pair(x.node(), 1)));
+
+  // A new node never aliases the removed node's entry.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(), Op::kSub));
+  EXPECT_FALSE(map.contains(sub));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,184 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_SET_H_
+#define XLS_IR_NODE_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A set of nodes of a single FunctionBase, stored as a flat vector indexed by
+// Node::node_index(). This is the set counterpart of NodeMap (see
+// xls/ir/node_map.h) and has the same properties: iteration is in
+// node_index() order, all members must belong to the same FunctionBase (which
+// must outlive the set), and members which are removed from the FunctionBase
+// are dropped lazily the next time size(), empty() or begin() is called.
+class NodeSet {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = std::ptrdiff_t;
+    using reference = Node* const&;
+    using pointer = Node* const*;
+
+    const_iterator() = default;
+    const_iterator(std::vector<Node*>::const_iterator it,
+                   std::vector<Node*>::const_iterator end)
+        : it_(it), end_(end) {
+      SkipEmpty();
+    }
+
+    reference operator*() const { return *it_; }
+    pointer operator->() const { return &*it_; }
+    const_iterator& operator++() {
+      ++it_;
+      SkipEmpty();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+    bool operator==(const const_iterator& other) const {
+      return it_ == other.it_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return it_ != other.it_;
+    }
+
+   private:
+    void SkipEmpty() {
+      while (it_ != end_ && *it_ == nullptr) {
+        ++it_;
+      }
+    }
+
+    std::vector<Node*>::const_iterator it_;
+    std::vector<Node*>::const_iterator end_;
+  };
+  using iterator = const_iterator;
+  using key_type = Node*;
+  using value_type = Node*;
+
+  NodeSet() = default;
+  // Creates a set with room for every node currently in `function_base`.
+  explicit NodeSet(FunctionBase* function_base)
+      : function_base_(function_base),
+        removal_count_(function_base->node_removal_count()) {
+    slots_.reserve(function_base->node_index_limit());
+  }
+
+  bool empty() const { return size() == 0; }
+  int64_t size() const {
+    PurgeRemovedNodes();
+    return size_;
+  }
+
+  bool contains(const Node* node) const {
+    int64_t index = node->node_index();
+    DCHECK_GE(index, 0) << "Node not added to a FunctionBase: "
+                        << node->GetName();
+    return index < static_cast<int64_t>(slots_.size()) &&
+           slots_[index] == node;
+  }
+  int64_t count(const Node* node) const { return contains(node) ? 1 : 0; }
+
+  std::pair<const_iterator, bool> insert(Node* node) {
+    int64_t index = node->node_index();
+    DCHECK_GE(index, 0) << "Node not added to a FunctionBase: "
+                        << node->GetName();
+    if (function_base_ == nullptr) {
+      function_base_ = node->function_base();
+      removal_count_ = function_base_->node_removal_count();
+    }
+    CHECK_EQ(node->function_base(), function_base_)
+        << "NodeSet members must belong to a single FunctionBase: "
+        << node->GetName();
+    if (index >= static_cast<int64_t>(slots_.size())) {
+      slots_.resize(
+          std::max<int64_t>(index + 1, function_base_->node_index_limit()));
+    }
+    bool inserted = slots_[index] == nullptr;
+    if (inserted) {
+      slots_[index] = node;
+      ++size_;
+    }
+    return {const_iterator(slots_.begin() + index, slots_.end()), inserted};
+  }
+
+  int64_t erase(const Node* node) {
+    if (!contains(node)) {
+      return 0;
+    }
+    slots_[node->node_index()] = nullptr;
+    --size_;
+    return 1;
+  }
+
+  // Removes all members, keeping the storage.
+  void clear() {
+    std::fill(slots_.begin(), slots_.end(), nullptr);
+    size_ = 0;
+  }
+
+  const_iterator begin() const {
+    PurgeRemovedNodes();
+    return const_iterator(slots_.begin(), slots_.end());
+  }
+  const_iterator end() const {
+    return const_iterator(slots_.end(), slots_.end());
+  }
+
+ private:
+  // Drops any members removed from the FunctionBase since the last call. This
+  // is a no-op unless a node has been removed.
+  void PurgeRemovedNodes() const {
+    if (function_base_ == nullptr ||
+        removal_count_ == function_base_->node_removal_count()) {
+      return;
+    }
+    for (int64_t i = 0; i < static_cast<int64_t>(slots_.size()); ++i) {
+      if (slots_[i] != nullptr &&
+          function_base_->GetNodeByIndex(i) == nullptr) {
+        slots_[i] = nullptr;
+        --size_;
+      }
+    }
+    removal_count_ = function_base_->node_removal_count();
+  }
+
+  FunctionBase* function_base_ = nullptr;
+  // Purging removed nodes does not change the logical contents of the set, so
+  // it is allowed from const methods.
+  mutable int64_t removal_count_ = 0;
+  mutable std::vector<Node*> slots_;
+  mutable int64_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_SET_H_
@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_set.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class NodeSetTest : public IrTestBase {};
+
+TEST_F(NodeSetTest, BasicOperations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  NodeSet set(f);
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.insert(add.node()).second);
+  EXPECT_TRUE(set.insert(x.node()).second);
+  EXPECT_FALSE(set.insert(x.node()).second);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.contains(x.node()));
+  EXPECT_EQ(set.count(y.node()), 0);
+
+  // Iteration is in node index order.
+  EXPECT_THAT(set, ElementsAre(x.node(), add.node()));
+
+  EXPECT_EQ(set.erase(x.node()), 1);
+  EXPECT_EQ(set.erase(x.node()), 0);
+  EXPECT_THAT(set, ElementsAre(add.node()));
+
+  set.clear();
+  EXPECT_THAT(set, IsEmpty());
+}
+
+TEST_F(NodeSetTest, RemovedNodesAreDropped) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  NodeSet set;
+  set.insert(x.node());
+  set.insert(neg);
+  XLS_ASSERT_OK(f->RemoveNode(neg));
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_THAT(set, ElementsAre(x.node()));
+}
+
+}  // namespace
+}  // namespace xls
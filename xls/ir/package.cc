@@ -878,24 +878,34 @@ absl::StatusOr<FunctionBase*> FindTop(Package* p,
 
 TransformMetrics TransformMetrics::operator+(
     const TransformMetrics& other) const {
-  return TransformMetrics{
+  TransformMetrics result{
       .nodes_added = nodes_added + other.nodes_added,
       .nodes_removed = nodes_removed + other.nodes_removed,
       .nodes_replaced = nodes_replaced + other.nodes_replaced,
       .operands_replaced = operands_replaced + other.operands_replaced,
       .operands_removed = operands_removed + other.operands_removed,
   };
+  for (Op op : kAllOps) {
+    int64_t i = static_cast<int64_t>(op);
+    result.op_changes[i] = op_changes[i] + other.op_changes[i];
+  }
+  return result;
 }
 
 TransformMetrics TransformMetrics::operator-(
     const TransformMetrics& other) const {
-  return TransformMetrics{
+  TransformMetrics result{
       .nodes_added = nodes_added - other.nodes_added,
       .nodes_removed = nodes_removed - other.nodes_removed,
       .nodes_replaced = nodes_replaced - other.nodes_replaced,
       .operands_replaced = operands_replaced - other.operands_replaced,
       .operands_removed = operands_removed - other.operands_removed,
   };
+  for (Op op : kAllOps) {
+    int64_t i = static_cast<int64_t>(op);
+    result.op_changes[i] = op_changes[i] - other.op_changes[i];
+  }
+  return result;
 }
 
 std::string TransformMetrics::ToString() const {
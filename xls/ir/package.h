@@ -15,6 +15,7 @@
 #ifndef XLS_IR_PACKAGE_H_
 #define XLS_IR_PACKAGE_H_
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -31,6 +32,7 @@
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/fileno.h"
+#include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/transform_metrics.pb.h"
 #include "xls/ir/type.h"
@@ -70,6 +72,14 @@ struct TransformMetrics {
   // Node::RemoveOptionalOperand).
   int64_t operands_removed = 0;
 
+  // Number of times a node of each op (indexed by the Op value) was added,
+  // removed, or had its operands or users changed. Consumers such as
+  // fixed-point compound passes compare snapshots of these counters to tell
+  // whether nodes a pass cares about were touched since it last ran.
+  std::array<int64_t, kAllOps.size()> op_changes = {};
+
+  void RecordOpChange(Op op) { ++op_changes[static_cast<int64_t>(op)]; }
+
   TransformMetrics operator+(const TransformMetrics& other) const;
   TransformMetrics operator-(const TransformMetrics& other) const;
   std::string ToString() const;
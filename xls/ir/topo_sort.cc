@@ -20,7 +20,6 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -57,15 +56,15 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
   //     v v v
   //     o o o  (users, all present in order)
   //
-  // We start by adding all nodes to the `remaining_users` mapping, and those
+  // We start by adding all nodes to the `remaining_users` table, and those
   // with no users to the `ready` stack (always putting the return value at the
-  // end of the stack). The `remaining_users` mapping is used to track how many
-  // users must be seen before a node is ready to be added to the order.
+  // end of the stack). The `remaining_users` table is indexed by
+  // Node::node_index() and is used to track how many users must be seen before
+  // a node is ready to be added to the order.
   //
   // NOTE: sorts reverse-topologically.  To sort topologically, reverse the
   // result.
-  absl::flat_hash_map<Node*, int64_t> remaining_users;
-  remaining_users.reserve(f->node_count());
+  std::vector<int64_t> remaining_users(f->node_index_limit());
 
   // Note: we special case the return value if it has no users, always putting
   // it on the `ready` queue first so it comes at the start of the order.
@@ -73,27 +72,26 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
       f->IsFunction() ? f->AsFunctionOrDie()->return_value() : nullptr;
   if (return_value != nullptr && return_value->users().empty()) {
     VLOG(5) << "Marking return value as ready: " << return_value;
-    CHECK(remaining_users.emplace(return_value, 0).second);
     result.push_back(return_value);
   }
   for (Node* node : f->nodes_reversed()) {
-    auto [it, inserted] = remaining_users.emplace(node, node->users().size());
-    CHECK(inserted || (node == return_value && return_value->users().empty()));
+    remaining_users[node->node_index()] = node->users().size();
     if (node == return_value) {
       continue;
     }
-    const int64_t& node_remaining_users = it->second;
 
-    if (node_remaining_users == 0) {
+    if (node->users().empty()) {
       VLOG(5) << "At start node was ready: " << node;
       result.push_back(node);
     }
   }
 
-  std::optional<absl::flat_hash_map<Node*, int64_t>> random_priority;
+  // Indexed by Node::node_index().
+  std::optional<std::vector<int64_t>> random_priority;
   auto random_comparator = [&](Node* a, Node* b) {
     CHECK(random_priority.has_value());
-    return random_priority->at(a) < random_priority->at(b);
+    return (*random_priority)[a->node_index()] <
+           (*random_priority)[b->node_index()];
   };
   if (randomizer.has_value()) {
     std::vector<Node*> random_order(f->nodes().begin(), f->nodes().end());
@@ -106,10 +104,9 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
       }
     }
 
-    random_priority.emplace();
-    random_priority->reserve(random_order.size());
+    random_priority.emplace(f->node_index_limit());
     for (int64_t i = 0; i < random_order.size(); ++i) {
-      CHECK(random_priority->emplace(random_order[i], i).second);
+      (*random_priority)[random_order[i]->node_index()] = i;
     }
 
     absl::Span<Node*> ready = ready_view();
@@ -160,7 +157,8 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
         // We've already seen this operand.
         continue;
       }
-      int64_t& operand_remaining_users = remaining_users.at(operand);
+      int64_t& operand_remaining_users =
+          remaining_users[operand->node_index()];
       DCHECK_GT(operand_remaining_users, 0);
       if (--operand_remaining_users == 0) {
         result.push_back(operand);
@@ -26,6 +26,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
@@ -39,6 +40,7 @@ TypeManager::TypeManager() {
   owned_types_.insert(token_type_.get());
 }
 BitsType* TypeManager::GetBitsType(int64_t bit_count) {
+  absl::MutexLock lock(mutex_.get());
   if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
     return &bit_count_to_type_.at(bit_count);
   }
@@ -49,11 +51,12 @@ BitsType* TypeManager::GetBitsType(int64_t bit_count) {
 }
 
 ArrayType* TypeManager::GetArrayType(int64_t size, Type* element_type) {
+  absl::MutexLock lock(mutex_.get());
   ArrayKey key{size, element_type};
   if (array_types_.find(key) != array_types_.end()) {
     return &array_types_.at(key);
   }
-  CHECK(IsOwnedType(element_type))
+  CHECK(IsOwnedTypeLocked(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -62,12 +65,13 @@ ArrayType* TypeManager::GetArrayType(int64_t size, Type* element_type) {
 }
 
 TupleType* TypeManager::GetTupleType(absl::Span<Type* const> element_types) {
+  absl::MutexLock lock(mutex_.get());
   TypeVec key(element_types.begin(), element_types.end());
   if (tuple_types_.find(key) != tuple_types_.end()) {
     return &tuple_types_.at(key);
   }
   for (const Type* element_type : element_types) {
-    CHECK(IsOwnedType(element_type))
+    CHECK(IsOwnedTypeLocked(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -114,12 +118,13 @@ absl::StatusOr<Type*> TypeManager::MapTypeFromOtherArena(
 
 FunctionType* TypeManager::GetFunctionType(absl::Span<Type* const> args_types,
                                            Type* return_type) {
+  absl::MutexLock lock(mutex_.get());
   std::string key = FunctionType(args_types, return_type).ToString();
   if (function_types_.find(key) != function_types_.end()) {
     return &function_types_.at(key);
   }
   for (Type* t : args_types) {
-    CHECK(IsOwnedType(t)) << "Parameter type is not owned by package: "
+    CHECK(IsOwnedTypeLocked(t)) << "Parameter type is not owned by package: "
                           << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
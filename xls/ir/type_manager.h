@@ -24,6 +24,7 @@
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -42,9 +43,11 @@ class TypeManager {
   TypeManager& operator=(const TypeManager&) = delete;
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
+    absl::MutexLock lock(mutex_.get());
+    return IsOwnedTypeLocked(type);
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) const {
+    absl::MutexLock lock(mutex_.get());
     return owned_function_types_.find(function_type) !=
            owned_function_types_.end();
   }
@@ -67,6 +70,15 @@ class TypeManager {
   Type* GetTypeForValue(const Value& value);
 
  private:
+  bool IsOwnedTypeLocked(const Type* type) const {
+    return owned_types_.find(type) != owned_types_.end();
+  }
+
+  // Guards the type tables below so that types can be looked up and created
+  // from several threads at once, e.g., while the FunctionBases of a package
+  // are optimized in parallel. Held by pointer to keep TypeManager movable.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
+
   // Set of owned types in this package.
   absl::flat_hash_set<const Type*> owned_types_;
 
@@ -14,14 +14,17 @@
 
 #include "xls/ir/value.h"
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/no_destructor.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -269,7 +272,7 @@ absl::Status Value::PopulateFrom(BitmapView bitmap) {
       //
       // Here we iterate through values in reverse order so that the bit slicing
       // can ascend from least significant bit up to most significant bit.
-      auto& values = std::get<std::vector<Value>>(payload_);
+      std::vector<Value>& values = MutableElements();
       int64_t bit_index = 0;
       for (int64_t i = values.size() - 1; i >= 0; --i) {
         int64_t element_bit_count = values[i].GetFlatBitCount();
@@ -289,8 +292,29 @@ absl::Status Value::PopulateFrom(BitmapView bitmap) {
   }
 }
 
+/* static */ const Value::ElementsPtr& Value::EmptyElements() {
+  static const absl::NoDestructor<ElementsPtr> kEmpty(
+      std::make_shared<std::vector<Value>>());
+  return *kEmpty;
+}
+
+std::vector<Value>& Value::MutableElements() {
+  ElementsPtr& elements = std::get<ElementsPtr>(payload_);
+  if (elements.use_count() > 1) {
+    elements = std::make_shared<std::vector<Value>>(*elements);
+    return *elements;
+  }
+  // A use count of one means no other Value holds the elements, but another
+  // thread may have read them through a copy it has just destroyed. use_count()
+  // is a relaxed load, so it does not order those reads before our writes;
+  // the fence pairs with the release in the other thread's decrement of the
+  // count.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return *elements;
+}
+
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (!std::holds_alternative<ElementsPtr>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
@@ -505,6 +529,11 @@ bool Value::operator==(const Value& other) const {
   }
 
   // All non-Bits types are container types -- should have a size attribute.
+  if (std::get<ElementsPtr>(payload_) ==
+      std::get<ElementsPtr>(other.payload_)) {
+    // Shared elements.
+    return true;
+  }
   if (size() != other.size()) {
     return false;
   }
@@ -17,6 +17,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -61,6 +62,12 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
 //
+// The elements of tuples and arrays are immutable once built and are shared
+// between copies of a Value, so copying an aggregate is constant time and
+// nested aggregates are never deep-copied. Mutation through SetElement() or
+// mutable_element() copies the (top-level) elements first if they are shared,
+// leaving every other Value unchanged.
+//
 // TODO(leary): 2019-04-04 Arrays are not currently multi-dimensional, we had
 // some discussion around this, maybe they should be?
 class Value {
@@ -69,7 +76,7 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
@@ -107,9 +114,7 @@ class Value {
     return Value(ValueKind::kArray, std::move(elements));
   }
 
-  static Value Token() {
-    return Value(ValueKind::kToken, std::vector<Value>({}));
-  }
+  static Value Token() { return Value(ValueKind::kToken, EmptyElements()); }
   static Value Bool(bool enabled) {
     return Value(
         UBits(/*value=*/static_cast<uint64_t>(enabled), /*bit_count=*/1));
@@ -148,9 +153,22 @@ class Value {
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
+    return *std::get<ElementsPtr>(payload_);
   }
   const Value& element(int64_t i) const { return elements().at(i); }
+
+  // Replaces the element at index `i` of this tuple or array. The new element
+  // must have the same type as the old one if this is an array. Only this
+  // Value is modified; see the class comment.
+  void SetElement(int64_t i, Value element) {
+    mutable_element(i) = std::move(element);
+  }
+  // Returns a mutable reference to the element at index `i`, unsharing the
+  // elements of this Value if needed. The reference is invalidated by copying
+  // this Value. Nested updates, e.g. a multi-dimensional array_update, can
+  // walk down through mutable_element() and only copy the aggregates along the
+  // path.
+  Value& mutable_element(int64_t i) { return MutableElements().at(i); }
   int64_t size() const { return elements().size(); }
   bool empty() const { return elements().empty(); }
 
@@ -195,19 +213,40 @@ class Value {
 
   template <typename H>
   friend H AbslHashValue(H h, const Value& v) {
-    return H::combine(std::move(h), v.kind_, v.payload_);
+    if (std::holds_alternative<Bits>(v.payload_)) {
+      return H::combine(std::move(h), v.kind_, v.bits());
+    }
+    if (std::holds_alternative<ElementsPtr>(v.payload_)) {
+      return H::combine(std::move(h), v.kind_, v.elements());
+    }
+    return H::combine(std::move(h), v.kind_);
   }
 
  private:
+  // Shared, copy-on-write storage for the elements of a tuple or array.
+  using ElementsPtr = std::shared_ptr<std::vector<Value>>;
+
   Value(ValueKind kind, absl::Span<const Value> elements)
       : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+        payload_(std::make_shared<std::vector<Value>>(elements.begin(),
+                                                      elements.end())) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
+      : kind_(kind),
+        payload_(std::make_shared<std::vector<Value>>(std::move(elements))) {}
+
+  Value(ValueKind kind, ElementsPtr elements)
       : kind_(kind), payload_(std::move(elements)) {}
 
+  // Returns the elements shared by all empty tuples and tokens.
+  static const ElementsPtr& EmptyElements();
+
+  // Returns the elements of this Value for modification, first copying them if
+  // they are shared with another Value.
+  std::vector<Value>& MutableElements();
+
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, ElementsPtr, Bits> payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
@@ -20,6 +20,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
+#include "absl/hash/hash.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
@@ -692,6 +693,48 @@ TEST(ValueTest, FromProtoMaxBitSize) {
   }
 }
 
+TEST(ValueTest, CopiesShareElements) {
+  Value inner = Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 8))});
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::Array({inner, inner, inner}));
+  Value copy = array;
+  EXPECT_EQ(copy.elements().data(), array.elements().data());
+  EXPECT_EQ(copy.element(1).elements().data(), inner.elements().data());
+  EXPECT_EQ(copy, array);
+  EXPECT_EQ(absl::HashOf(copy), absl::HashOf(array));
+}
+
+TEST(ValueTest, SetElementCopiesOnWrite) {
+  Value inner = Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 8))});
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::Array({inner, inner, inner}));
+  Value updated = array;
+  updated.mutable_element(2).SetElement(0, Value(UBits(42, 8)));
+
+  EXPECT_EQ(array.element(2), inner);
+  EXPECT_EQ(updated.element(2),
+            Value::Tuple({Value(UBits(42, 8)), Value(UBits(2, 8))}));
+  // Only the path to the modified element was copied.
+  EXPECT_NE(updated.elements().data(), array.elements().data());
+  EXPECT_EQ(updated.element(0).elements().data(),
+            array.element(0).elements().data());
+  EXPECT_NE(updated, array);
+
+  // Equal values built separately compare and hash equal to shared ones.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value rebuilt,
+      Value::Array({inner, inner,
+                    Value::Tuple({Value(UBits(42, 8)), Value(UBits(2, 8))})}));
+  EXPECT_EQ(updated, rebuilt);
+  EXPECT_EQ(absl::HashOf(updated), absl::HashOf(rebuilt));
+}
+
+TEST(ValueTest, PopulateFromDoesNotAffectCopies) {
+  Value tuple = Value::Tuple({Value(UBits(0, 4)), Value(UBits(0, 4))});
+  Value copy = tuple;
+  XLS_ASSERT_OK(copy.PopulateFrom(BitmapView(InlineBitmap::FromWord(0xab, 8))));
+  EXPECT_EQ(copy, Value::Tuple({Value(UBits(0xa, 4)), Value(UBits(0xb, 4))}));
+  EXPECT_EQ(tuple, Value::Tuple({Value(UBits(0, 4)), Value(UBits(0, 4))}));
+}
+
 // We need this functionality so that we can craft tokens to feed to function
 // signatures, e.g. in exhaustive quickchecks.
 TEST(ValueTest, CanPopulateTokenFromEmptyBitmap) {
@@ -23,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
@@ -36,6 +37,7 @@
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/Linker/Linker.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
@@ -46,10 +48,12 @@
 #include "llvm/include/llvm/TargetParser/Triple.h"
 #include "llvm/include/llvm/TargetParser/X86TargetParser.h"
 #include "llvm/include/llvm/Transforms/Utils/Cloning.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/jit/jit_emulated_tls.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
+#include "xls/jit/parallel_compile.h"
 
 namespace xls {
 
@@ -173,6 +177,43 @@ absl::Status AddWeakEmuTls(llvm::Module& module, llvm::LLVMContext* context) {
 }
 
 }  // namespace
+
+absl::StatusOr<std::unique_ptr<llvm::Module>>
+AotCompiler::OptimizeModuleInParallel(std::unique_ptr<llvm::Module> module) {
+  std::vector<std::string> partitions =
+      SplitModuleToBitcode(*module, compile_threads());
+  module.reset();
+  XLS_RET_CHECK(!partitions.empty());
+  XLS_RETURN_IF_ERROR(ParallelFor(
+      partitions.size(), compile_threads(), [&](int64_t i) -> absl::Status {
+        llvm::LLVMContext context;
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> partition,
+                             ParseModuleBitcode(partitions[i], context));
+        llvm::Error error = PerformStandardOptimization(partition.get());
+        if (error) {
+          return absl::InternalError(
+              absl::StrFormat("Error optimizing module partition: %s",
+                              llvm::toString(std::move(error))));
+        }
+        partitions[i] = WriteModuleBitcode(*partition);
+        return absl::OkStatus();
+      }));
+
+  // Code generation must produce a single object file so the partitions are
+  // linked back together. Calls between partitions are not re-optimized.
+  std::unique_ptr<llvm::Module> linked;
+  for (const std::string& bitcode : partitions) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> partition,
+                         ParseModuleBitcode(bitcode, *context_));
+    if (linked == nullptr) {
+      linked = std::move(partition);
+    } else if (llvm::Linker::linkModules(*linked, std::move(partition))) {
+      return absl::InternalError("Unable to link optimized module partitions");
+    }
+  }
+  return linked;
+}
+
 absl::Status AotCompiler::CompileModule(
     std::unique_ptr<llvm::Module>&& module) {
   JitObserverRequests notification;
@@ -182,12 +223,16 @@ absl::Status AotCompiler::CompileModule(
   if (notification.unoptimized_module) {
     jit_observer_->UnoptimizedModule(module.get());
   }
-  auto err = PerformStandardOptimization(module.get());
-  if (err) {
-    std::string mem;
-    llvm::raw_string_ostream oss(mem);
-    oss << err;
-    return absl::InternalError(oss.str());
+  if (ShouldCompileInParallel(*module)) {
+    XLS_ASSIGN_OR_RETURN(module, OptimizeModuleInParallel(std::move(module)));
+  } else {
+    auto err = PerformStandardOptimization(module.get());
+    if (err) {
+      std::string mem;
+      llvm::raw_string_ostream oss(mem);
+      oss << err;
+      return absl::InternalError(oss.str());
+    }
   }
   // To avoid the msan pass inserting stores to msan functions we only add it
   // after all the msan stuff is done.
@@ -40,6 +40,10 @@ class AotCompiler final : public LlvmCompiler {
   absl::StatusOr<AotCompiler*> AsAotCompiler() override { return this; }
 
   // Compiles the given LLVM module into object code.
+  //
+  // Large modules are split and the pieces are optimized concurrently using up
+  // to compile_threads() threads. The optimized pieces are then linked back
+  // together so that a single object file is produced.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
   // Return the underlying LLVM context.
@@ -73,6 +77,12 @@ class AotCompiler final : public LlvmCompiler {
                      /*include_observer_callbacks=*/false),
         jit_observer_(observer) {}
 
+  // Optimizes the given module by splitting it into up to compile_threads()
+  // partitions and optimizing each partition on its own thread. Returns the
+  // optimized partitions linked into a single module in `context_`.
+  absl::StatusOr<std::unique_ptr<llvm::Module>> OptimizeModuleInParallel(
+      std::unique_ptr<llvm::Module> module);
+
   std::unique_ptr<llvm::LLVMContext> context_ =
       std::make_unique<llvm::LLVMContext>();
 
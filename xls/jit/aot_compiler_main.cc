@@ -78,6 +78,11 @@ ABSL_FLAG(std::optional<std::string>, output_asm, std::nullopt,
           "Path at which to write the output optimized llvm file.");
 ABSL_FLAG(int64_t, llvm_opt_level, xls::LlvmCompiler::kDefaultOptLevel,
           "The optimization level to use for the LLVM optimizer.");
+ABSL_FLAG(std::optional<int64_t>, compile_threads, std::nullopt,
+          "Number of threads used to optimize large LLVM modules. Large "
+          "modules are split into this many pieces which are optimized "
+          "concurrently. A value of 1 disables parallel compilation. Defaults "
+          "to the number of available CPUs (up to a small limit).");
 
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
 static constexpr bool kHasMsan = true;
@@ -342,6 +347,12 @@ int main(int argc, char** argv) {
       absl::GetFlag(FLAGS_output_proto);
 
   bool include_msan = absl::GetFlag(FLAGS_include_msan);
+  if (std::optional<int64_t> compile_threads =
+          absl::GetFlag(FLAGS_compile_threads);
+      compile_threads.has_value()) {
+    QCHECK_GT(*compile_threads, 0) << "--compile_threads must be positive.";
+    xls::LlvmCompiler::SetDefaultCompileThreads(*compile_threads);
+  }
   absl::Status status = xls::RealMain(
       input_ir_path, top, output_object_path, output_proto_path, include_msan,
       absl::GetFlag(FLAGS_llvm_opt_level),
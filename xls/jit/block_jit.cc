@@ -14,8 +14,10 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <sstream>
@@ -25,6 +27,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -36,6 +39,7 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/maybe_materialize_fifos_pass.h"
+#include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
@@ -459,6 +463,127 @@ absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) {
   return absl::OkStatus();
 }
 
+absl::Status BlockJit::RunCycles(BlockJitContinuation& continuation,
+                                 int64_t cycle_count,
+                                 absl::Span<const uint8_t* const> input_ports,
+                                 absl::Span<uint8_t* const> output_ports) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  XLS_RET_CHECK_EQ(input_ports.size(), metadata_.InputPortCount());
+  XLS_RET_CHECK_EQ(output_ports.size(), metadata_.OutputPortCount());
+  if (cycle_count == 0) {
+    return absl::OkStatus();
+  }
+  auto cycle_input_ports = [&](int64_t cycle) {
+    std::vector<const uint8_t*> ptrs(input_ports.size());
+    for (int64_t i = 0; i < input_ports.size(); ++i) {
+      ptrs[i] = input_ports[i] + cycle * input_port_stride(i);
+    }
+    return ptrs;
+  };
+  if (!SupportsMultiCycle()) {
+    for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+      XLS_RETURN_IF_ERROR(continuation.SetInputPorts(cycle_input_ports(cycle)));
+      XLS_RETURN_IF_ERROR(RunOneCycle(continuation));
+      for (int64_t i = 0; i < output_ports.size(); ++i) {
+        memcpy(output_ports[i] + cycle * output_port_stride(i),
+               continuation.function_outputs()[i],
+               function_.output_buffer_sizes()[i]);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // The port pointers are those given by the caller while the register
+  // pointers are the continuation's current and next register buffers.
+  std::vector<const uint8_t*> inputs(input_ports.begin(), input_ports.end());
+  absl::c_copy(continuation.register_pointers(), std::back_inserter(inputs));
+  std::vector<uint8_t*> outputs(output_ports.begin(), output_ports.end());
+  absl::c_copy(
+      continuation.function_outputs().subspan(metadata_.OutputPortCount()),
+      std::back_inserter(outputs));
+  function_.RunBatchedJittedFunction(
+      inputs.data(), outputs.data(), continuation.temp_buffer_.get(),
+      &continuation.GetEvents(),
+      /*instance_context=*/&continuation.callbacks_, runtime_.get(),
+      cycle_count);
+  // The jitted code alternates between the two register buffers every cycle.
+  // After an odd number of cycles the final values are in the buffers which
+  // were passed as outputs.
+  if (cycle_count % 2 == 1) {
+    continuation.SwapRegisters();
+  }
+
+  // Leave the values of the final cycle in the continuation's ports so it is
+  // indistinguishable from one which ran the cycles one at a time.
+  XLS_RETURN_IF_ERROR(
+      continuation.SetInputPorts(cycle_input_ports(cycle_count - 1)));
+  for (int64_t i = 0; i < output_ports.size(); ++i) {
+    memcpy(continuation.function_outputs()[i],
+           output_ports[i] + (cycle_count - 1) * output_port_stride(i),
+           function_.output_buffer_sizes()[i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<std::vector<Value>>> BlockJit::RunCycles(
+    BlockJitContinuation& continuation,
+    absl::Span<const std::vector<Value>> input_ports) {
+  const int64_t cycle_count = input_ports.size();
+  auto allocate = [&](int64_t stride, int64_t alignment) {
+    int64_t size = std::max<int64_t>(cycle_count, 1) * stride;
+    return std::unique_ptr<uint8_t[], DeleteAligned>(
+        absl::bit_cast<uint8_t*>(AllocateAligned(alignment, size)));
+  };
+  std::vector<std::unique_ptr<uint8_t[], DeleteAligned>> input_memory;
+  std::vector<const uint8_t*> inputs;
+  for (int64_t i = 0; i < metadata_.InputPortCount(); ++i) {
+    input_memory.push_back(
+        allocate(input_port_stride(i),
+                 function_.input_buffer_preferred_alignments()[i]));
+    inputs.push_back(input_memory.back().get());
+  }
+  std::vector<std::unique_ptr<uint8_t[], DeleteAligned>> output_memory;
+  std::vector<uint8_t*> outputs;
+  for (int64_t i = 0; i < metadata_.OutputPortCount(); ++i) {
+    output_memory.push_back(
+        allocate(output_port_stride(i),
+                 function_.output_buffer_preferred_alignments()[i]));
+    outputs.push_back(output_memory.back().get());
+  }
+
+  std::vector<uint8_t*> cycle_ptrs(metadata_.InputPortCount());
+  for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+    XLS_RET_CHECK_EQ(input_ports[cycle].size(), metadata_.InputPortCount())
+        << "Wrong number of input port values for cycle " << cycle;
+    for (int64_t i = 0; i < metadata_.InputPortCount(); ++i) {
+      Type* type = metadata_.input_port_types[i];
+      XLS_RET_CHECK(ValueConformsToType(input_ports[cycle][i], type))
+          << "input port " << metadata_.input_port_names[i]
+          << " cannot be set to value of " << input_ports[cycle][i]
+          << " due to type mismatch with input port type of "
+          << type->ToString();
+      cycle_ptrs[i] = input_memory[i].get() + cycle * input_port_stride(i);
+    }
+    XLS_RETURN_IF_ERROR(runtime_->PackArgs(
+        input_ports[cycle], metadata_.input_port_types, cycle_ptrs));
+  }
+
+  XLS_RETURN_IF_ERROR(RunCycles(continuation, cycle_count, inputs, outputs));
+
+  std::vector<std::vector<Value>> result;
+  result.reserve(cycle_count);
+  for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+    std::vector<Value>& cycle_outputs = result.emplace_back();
+    cycle_outputs.reserve(metadata_.OutputPortCount());
+    for (int64_t i = 0; i < metadata_.OutputPortCount(); ++i) {
+      cycle_outputs.push_back(runtime_->UnpackBuffer(
+          outputs[i] + cycle * output_port_stride(i),
+          metadata_.output_port_types[i]));
+    }
+  }
+  return result;
+}
+
 absl::StatusOr<JitArgumentSet> BlockJitContinuation::CombineBuffers(
     const JittedFunctionBase& jit_func, const JitArgumentSet& left,
     int64_t left_count, const JitArgumentSet& rest, int64_t rest_start,
@@ -760,6 +885,50 @@ class BlockContinuationJitWrapper final : public BlockContinuation {
     return continuation_->SetRegisters(regs);
   }
 
+  // Runs one cycle for each element of `inputs` in a single call into the
+  // jitted code and returns the output ports of each cycle.
+  absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+  RunCycles(absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) {
+    temporary_outputs_.reset();
+    temporary_regs_.reset();
+    continuation_->ClearEvents();
+    absl::flat_hash_map<std::string, int64_t> input_indices =
+        continuation_->GetInputPortIndices();
+    std::vector<std::vector<Value>> input_values;
+    input_values.reserve(inputs.size());
+    for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+      if (input_set.size() != input_indices.size()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Expected %d input port values but got %d",
+                            input_indices.size(), input_set.size()));
+      }
+      std::vector<Value>& values =
+          input_values.emplace_back(input_indices.size());
+      for (const auto& [name, value] : input_set) {
+        auto it = input_indices.find(name);
+        if (it == input_indices.end()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Block has no input port '%s'", name));
+        }
+        values[it->second] = value;
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<std::vector<Value>> output_values,
+                         jit_->RunCycles(*continuation_, input_values));
+    absl::flat_hash_map<std::string, int64_t> output_indices =
+        continuation_->GetOutputPortIndices();
+    std::vector<absl::flat_hash_map<std::string, Value>> outputs;
+    outputs.reserve(output_values.size());
+    for (std::vector<Value>& values : output_values) {
+      absl::flat_hash_map<std::string, Value>& output_set =
+          outputs.emplace_back();
+      for (const auto& [name, index] : output_indices) {
+        output_set[name] = std::move(values[index]);
+      }
+    }
+    return outputs;
+  }
+
   void ClearObserver() override {
     continuation_->ClearObserver();
     eval_observer_.reset();
@@ -808,6 +977,16 @@ JitBlockEvaluator::MakeNewContinuation(
                                                        std::move(jit));
 }
 
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+JitBlockEvaluator::EvaluateSequentialBlock(
+    Block* block,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
+                       NewContinuation(block));
+  return down_cast<BlockContinuationJitWrapper*>(continuation.get())
+      ->RunCycles(inputs);
+}
+
 absl::StatusOr<JitRuntime*> JitBlockEvaluator::GetRuntime(
     BlockContinuation* cont) const {
   BlockContinuationJitWrapper* cont_wrap =
@@ -95,6 +95,46 @@ class BlockJit {
   // Runs a single cycle of a block with the given continuation.
   virtual absl::Status RunOneCycle(BlockJitContinuation& continuation);
 
+  // Runs `cycle_count` consecutive cycles of the block with the given
+  // continuation in a single call into the jitted code. `input_ports[i]` points
+  // to `cycle_count` native-layout values of the i-th input port, each
+  // `input_port_stride(i)` bytes after the previous one. The value of the j-th
+  // output port in each cycle is written to `output_ports[j]` with a stride of
+  // `output_port_stride(j)` bytes. The buffers must be aligned to the port
+  // type's preferred alignment.
+  //
+  // Afterwards the continuation is in the same state as if RunOneCycle had
+  // been called `cycle_count` times (with events from every cycle
+  // accumulated) and its input and output ports hold the values of the last
+  // cycle.
+  absl::Status RunCycles(BlockJitContinuation& continuation,
+                         int64_t cycle_count,
+                         absl::Span<const uint8_t* const> input_ports,
+                         absl::Span<uint8_t* const> output_ports);
+
+  // Runs one cycle for each element of `input_ports` (which must contain a
+  // value for every input port in port order) and returns the output port
+  // values of each cycle.
+  absl::StatusOr<std::vector<std::vector<Value>>> RunCycles(
+      BlockJitContinuation& continuation,
+      absl::Span<const std::vector<Value>> input_ports);
+
+  // Whether RunCycles executes all cycles in a single native call. If false
+  // (e.g., for AOT compiled blocks) RunCycles falls back to running the cycles
+  // one at a time.
+  bool SupportsMultiCycle() const { return function_.HasBatchedFunction(); }
+
+  // Distance in bytes between the values of consecutive cycles of input port
+  // `i` in the buffers passed to RunCycles.
+  int64_t input_port_stride(int64_t i) const {
+    return function_.input_batch_stride(i);
+  }
+  // Distance in bytes between the values of consecutive cycles of output port
+  // `i` in the buffers passed to RunCycles.
+  int64_t output_port_stride(int64_t i) const {
+    return function_.output_batch_stride(i);
+  }
+
   OrcJit& orc_jit() const { return *jit_; }
 
   JitRuntime* runtime() const { return runtime_.get(); }
@@ -322,6 +362,15 @@ class JitBlockEvaluator : public BlockEvaluator {
         supports_observer_(supports_observer) {}
   absl::StatusOr<JitRuntime*> GetRuntime(BlockContinuation* cont) const;
 
+  // Runs all cycles in a single call into the jitted code (see
+  // BlockJit::RunCycles) rather than one cycle at a time.
+  using BlockEvaluator::EvaluateSequentialBlock;
+  absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+  EvaluateSequentialBlock(
+      Block* block,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs)
+      const override;
+
  protected:
   absl::StatusOr<std::unique_ptr<BlockContinuation>> MakeNewContinuation(
       BlockElaboration&& elaboration,
@@ -14,10 +14,13 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -25,9 +28,11 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
 #include "xls/interpreter/block_interpreter.h"
 #include "xls/ir/bits.h"
@@ -357,6 +362,99 @@ FUZZ_TEST(BlockJitFuzz, RegisterResetBehavior)
                                         fuzztest::Arbitrary<bool>()))
                      .WithMaxSize(20));
 
+// Builds a block which accumulates `in` into `acc` when `en` is set and also
+// delays `in` by one cycle through `delay`.
+absl::StatusOr<Block*> BuildAccumulator(Package* p, std::string_view name) {
+  BlockBuilder bb(name, p);
+  XLS_ASSIGN_OR_RETURN(Register * acc,
+                       bb.block()->AddRegister("acc", p->GetBitsType(32)));
+  XLS_ASSIGN_OR_RETURN(Register * delay,
+                       bb.block()->AddRegister("delay", p->GetBitsType(8)));
+  XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+  BValue in = bb.InputPort("in", p->GetBitsType(8));
+  BValue en = bb.InputPort("en", p->GetBitsType(1));
+  BValue acc_read = bb.RegisterRead(acc);
+  BValue sum = bb.Add(acc_read, bb.ZeroExtend(in, 32));
+  bb.RegisterWrite(acc, sum, /*load_enable=*/en);
+  bb.RegisterWrite(delay, in);
+  bb.OutputPort("sum", sum);
+  bb.OutputPort("delayed", bb.RegisterRead(delay));
+  return bb.Build();
+}
+
+TEST_F(BlockJitTest, RunCyclesMatchesRunOneCycle) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, BuildAccumulator(p.get(), TestName()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  EXPECT_TRUE(jit->SupportsMultiCycle());
+
+  for (int64_t cycle_count : {0, 1, 2, 7, 10}) {
+    std::vector<std::vector<Value>> inputs;
+    for (int64_t i = 0; i < cycle_count; ++i) {
+      inputs.push_back({Value(UBits(3 * i + 1, 8)), Value(UBits(i % 3, 1))});
+    }
+
+    auto expected_cont = jit->NewContinuation();
+    XLS_ASSERT_OK(
+        expected_cont->SetRegisters({Value(UBits(5, 32)), Value(UBits(9, 8))}));
+    std::vector<std::vector<Value>> expected;
+    for (const std::vector<Value>& input : inputs) {
+      XLS_ASSERT_OK(expected_cont->SetInputPorts(input));
+      XLS_ASSERT_OK(jit->RunOneCycle(*expected_cont));
+      expected.push_back(expected_cont->GetOutputPorts());
+    }
+
+    auto cont = jit->NewContinuation();
+    XLS_ASSERT_OK(
+        cont->SetRegisters({Value(UBits(5, 32)), Value(UBits(9, 8))}));
+    EXPECT_THAT(jit->RunCycles(*cont, inputs),
+                absl_testing::IsOkAndHolds(expected))
+        << "cycle_count=" << cycle_count;
+    EXPECT_EQ(cont->GetRegisters(), expected_cont->GetRegisters())
+        << "cycle_count=" << cycle_count;
+    if (cycle_count > 0) {
+      EXPECT_EQ(cont->GetOutputPorts(), expected.back());
+    }
+
+    // The continuation keeps working one cycle at a time afterwards.
+    for (auto* c : {cont.get(), expected_cont.get()}) {
+      XLS_ASSERT_OK(
+          c->SetInputPorts({Value(UBits(100, 8)), Value(UBits(1, 1))}));
+      XLS_ASSERT_OK(jit->RunOneCycle(*c));
+    }
+    EXPECT_EQ(cont->GetOutputPorts(), expected_cont->GetOutputPorts());
+    EXPECT_EQ(cont->GetRegisters(), expected_cont->GetRegisters());
+  }
+}
+
+TEST_F(BlockJitTest, RunCyclesWithRawBuffers) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, BuildAccumulator(p.get(), TestName()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetRegisters({Value(UBits(0, 32)), Value(UBits(0, 8))}));
+
+  // Both input ports fit in a single byte and the outputs in at most 4 bytes
+  // so these arrays have the layout RunCycles expects.
+  constexpr int64_t kCycles = 5;
+  ASSERT_EQ(jit->input_port_stride(0), 1);
+  ASSERT_EQ(jit->input_port_stride(1), 1);
+  ASSERT_EQ(jit->output_port_stride(0), 4);
+  ASSERT_EQ(jit->output_port_stride(1), 1);
+  alignas(8) std::array<uint8_t, kCycles> in = {1, 2, 3, 4, 5};
+  alignas(8) std::array<uint8_t, kCycles> en = {1, 1, 0, 1, 1};
+  alignas(8) std::array<uint32_t, kCycles> sum;
+  alignas(8) std::array<uint8_t, kCycles> delayed;
+  std::array<const uint8_t*, 2> inputs = {in.data(), en.data()};
+  std::array<uint8_t*, 2> outputs = {reinterpret_cast<uint8_t*>(sum.data()),
+                                     delayed.data()};
+  XLS_ASSERT_OK(jit->RunCycles(*cont, kCycles, inputs, outputs));
+  EXPECT_THAT(sum, ElementsAre(1, 3, 6, 7, 12));
+  EXPECT_THAT(delayed, ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(cont->GetRegisters(),
+              ElementsAre(Value(UBits(12, 32)), Value(UBits(5, 8))));
+}
+
 inline constexpr BlockEvaluatorTestParam kJitTestParam = {
     .evaluator = &kObservableJitBlockEvaluator,
     .supports_fifos = true,
@@ -14,6 +14,7 @@
 #include "xls/jit/function_base_jit.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
@@ -44,11 +45,11 @@
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Instructions.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/Metadata.h"
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "llvm/include/llvm/Support/Alignment.h"
 #include "llvm/include/llvm/Support/Casting.h"
-#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
@@ -66,6 +67,7 @@
 #include "xls/jit/ir_builder_visitor.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
@@ -917,7 +919,24 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
                           partitions[i].early_exit_point->id),
           wrapper.function(),
           /*InsertBefore=*/nullptr);
-      builder->CreateCondBr(interrupt_execution, early_return, continue_block);
+      const JitProfileOptions& profile_options = jit_context.profile_options();
+      if (profile_options.instrument) {
+        jit_context.EmitEarlyExitProfileCount(
+            partitions[i].early_exit_point->id, interrupt_execution, *builder);
+      }
+      // With a profile the (typically rare) exit path is marked as cold so
+      // the common path is laid out straight-line and the partitions only
+      // reachable through it are not inlined into the hot path.
+      llvm::MDNode* weights = nullptr;
+      if (profile_options.profile != nullptr) {
+        if (std::optional<JitProfile::EarlyExitCounts> counts =
+                profile_options.profile->GetEarlyExitCounts(
+                    partitions[i].early_exit_point->id)) {
+          weights = jit_context.BranchWeights(counts->exited, counts->continued);
+        }
+      }
+      builder->CreateCondBr(interrupt_execution, early_return, continue_block,
+                            weights);
       builder = std::make_unique<llvm::IRBuilder<>>(continue_block);
     }
   }
@@ -946,219 +965,11 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
                              .partitions = std::move(partitions)};
 }
 
-// Unpacks the packed value in `packed_buffer` and writes it to
-// `unpacked_buffer`. `bit_offset` is a value maintained across recursive
-// calls of this function indicating the offset within `packed_buffer` to read
-// the packed value.
-// TODO(meheff): 2022/10/03 Consider loading values in granularity larger than
-// bytes when unpacking values.
-absl::Status UnpackValue(llvm::Value* packed_buffer,
-                         llvm::Value* unpacked_buffer, Type* xls_type,
-                         int64_t bit_offset,
-                         const LlvmTypeConverter& type_converter,
-                         llvm::IRBuilder<>* builder) {
-  switch (xls_type->kind()) {
-    case TypeKind::kBits: {
-      // Compute the byte offset into `packed_buffer` where first bit of data
-      // for this Bits value lives.
-      llvm::Type* byte_array_type =
-          llvm::ArrayType::get(llvm::Type::getInt8Ty(builder->getContext()), 0);
-      int64_t byte_offset = FloorOfRatio(bit_offset, int64_t{8});
-      llvm::Value* byte_ptr = builder->CreateGEP(
-          byte_array_type, packed_buffer,
-          {builder->getInt32(0), builder->getInt32(byte_offset)});
-
-      // Determine how many bytes need to be loaded to capture all of the bits
-      // for this Bits value.
-      int64_t remainder = bit_offset - byte_offset * 8;
-      int64_t bytes_to_load =
-          CeilOfRatio(xls_type->GetFlatBitCount() + remainder, int64_t{8});
-
-      // The packed interface has no alignment assumptions, so make accesses
-      // align(1).
-      llvm::Align packed_alignment(1);
-      // Load the bits and shift by the remainder.
-      llvm::Value* loaded_value = builder->CreateLShr(
-          builder->CreateAlignedLoad(
-              builder->getIntNTy(static_cast<unsigned int>(bytes_to_load * 8)),
-              byte_ptr, packed_alignment),
-          remainder);
-
-      // Convert to the native type and mask off any extra bits.
-      llvm::Value* value = builder->CreateAnd(
-          type_converter.PaddingMask(xls_type, *builder),
-          builder->CreateIntCast(loaded_value,
-                                 type_converter.ConvertToLlvmType(xls_type),
-                                 /*isSigned=*/false));
-      builder->CreateStore(value, unpacked_buffer);
-      return absl::OkStatus();
-    }
-    case TypeKind::kArray: {
-      ArrayType* array_type = xls_type->AsArrayOrDie();
-      Type* element_xls_type = array_type->element_type();
-      llvm::Type* array_llvm_type =
-          type_converter.ConvertToLlvmType(array_type);
-      for (uint32_t i = 0; i < array_type->size(); i++) {
-        llvm::Value* unpacked_element_ptr =
-            builder->CreateGEP(array_llvm_type, unpacked_buffer,
-                               {
-                                   builder->getInt32(0),
-                                   builder->getInt32(i),
-                               });
-        XLS_RETURN_IF_ERROR(UnpackValue(packed_buffer, unpacked_element_ptr,
-                                        element_xls_type, bit_offset,
-                                        type_converter, builder));
-        bit_offset += element_xls_type->GetFlatBitCount();
-      }
-      return absl::OkStatus();
-    }
-    case TypeKind::kTuple: {
-      TupleType* tuple_type = xls_type->AsTupleOrDie();
-      llvm::Type* tuple_llvm_type =
-          type_converter.ConvertToLlvmType(tuple_type);
-      for (int32_t i = tuple_type->size() - 1; i >= 0; i--) {
-        // Tuple elements are stored MSB -> LSB, so we need to extract in
-        // reverse order to match native layout.
-        Type* element_type = tuple_type->element_type(i);
-        llvm::Value* unpacked_element_ptr =
-            builder->CreateGEP(tuple_llvm_type, unpacked_buffer,
-                               {
-                                   builder->getInt32(0),
-                                   builder->getInt32(i),
-                               });
-        XLS_RETURN_IF_ERROR(UnpackValue(packed_buffer, unpacked_element_ptr,
-                                        element_type, bit_offset,
-                                        type_converter, builder));
-        bit_offset += element_type->GetFlatBitCount();
-      }
-      return absl::OkStatus();
-    }
-    default:
-      return absl::InvalidArgumentError(absl::StrCat(
-          "Unhandled type kind: ", TypeKindToString(xls_type->kind())));
-  }
-}
-
-// Loads the value in `unpacked_buffer`, packs it and writes it to
-// `packed_buffer`. `bit_offset` is a value maintained across recursive calls of
-// this function indicating the offset within `packed_buffer` to wite the packed
-// value.
-absl::Status PackValue(llvm::Value* unpacked_buffer, llvm::Value* packed_buffer,
-                       Type* xls_type, int64_t bit_offset,
-                       const LlvmTypeConverter& type_converter,
-                       llvm::IRBuilder<>* builder) {
-  if (xls_type->GetFlatBitCount() == 0) {
-    return absl::OkStatus();
-  }
-  switch (xls_type->kind()) {
-    case TypeKind::kBits: {
-      // Compute the byte offset into `packed_buffer` where this data should be
-      // written to.
-      llvm::Type* byte_array_type =
-          llvm::ArrayType::get(llvm::Type::getInt8Ty(builder->getContext()), 0);
-      int64_t byte_offset = FloorOfRatio(bit_offset, int64_t{8});
-      llvm::Value* byte_ptr = builder->CreateGEP(
-          byte_array_type, packed_buffer,
-          {builder->getInt32(0), builder->getInt32(byte_offset)});
-
-      // Determine how many bytes will be touched when writing this Bits value.
-      int64_t remainder = bit_offset - byte_offset * 8;
-      int64_t bytes_to_load =
-          CeilOfRatio(xls_type->GetFlatBitCount() + remainder, int64_t{8});
-      llvm::IntegerType* loaded_type = builder->getIntNTy(bytes_to_load * 8);
-
-      // Load the unpacked value and cast it to the type used for loading and
-      // storing to the packed buffer.
-      llvm::Value* unpacked_value = builder->CreateIntCast(
-          builder->CreateLoad(type_converter.ConvertToLlvmType(xls_type),
-                              unpacked_buffer),
-          loaded_type, /*isSigned=*/false);
-
-      // The packed interface has no alignment assumptions, so make accesses
-      // align(1).
-      llvm::Align packed_alignment(1);
-      if (remainder == 0) {
-        // The packed value is on a byte boundary. Just write the value into the
-        // buffer.
-        builder->CreateAlignedStore(unpacked_value, byte_ptr, packed_alignment);
-      } else {
-        // Packed value is not on a byte boundary. Load in the packed value at
-        // the location and do some masking and shifting. First load the packed
-        // bits in the location to be written to.
-        llvm::Value* loaded_packed_value =
-            builder->CreateAlignedLoad(loaded_type, byte_ptr, packed_alignment);
-
-        // Mask off any beyond the remainder bits.
-        llvm::Value* remainder_mask =
-            builder->CreateLShr(llvm::ConstantInt::getSigned(loaded_type, -1),
-                                loaded_type->getBitWidth() - remainder);
-        llvm::Value* masked_loaded_packed_value =
-            builder->CreateAnd(remainder_mask, loaded_packed_value);
-
-        // Shift the unpacked value over by the remainder.
-        llvm::Value* shifted_unpacked_value =
-            builder->CreateShl(unpacked_value, remainder);
-
-        // Or the value to write with the existing bits in the loaded value.
-        llvm::Value* value = builder->CreateOr(shifted_unpacked_value,
-                                               masked_loaded_packed_value);
-        builder->CreateAlignedStore(value, byte_ptr, packed_alignment);
-      }
-      return absl::OkStatus();
-    }
-    case TypeKind::kArray: {
-      ArrayType* array_type = xls_type->AsArrayOrDie();
-      Type* element_xls_type = array_type->element_type();
-      llvm::Type* array_llvm_type =
-          type_converter.ConvertToLlvmType(array_type);
-      for (uint32_t i = 0; i < array_type->size(); i++) {
-        llvm::Value* unpacked_element_ptr =
-            builder->CreateGEP(array_llvm_type, unpacked_buffer,
-                               {
-                                   builder->getInt32(0),
-                                   builder->getInt32(i),
-                               });
-        XLS_RETURN_IF_ERROR(PackValue(unpacked_element_ptr, packed_buffer,
-                                      element_xls_type, bit_offset,
-                                      type_converter, builder));
-        bit_offset += element_xls_type->GetFlatBitCount();
-      }
-      return absl::OkStatus();
-    }
-    case TypeKind::kTuple: {
-      // Write the unpacked elements into the buffer one-by-one.
-      TupleType* tuple_type = xls_type->AsTupleOrDie();
-      llvm::Type* tuple_llvm_type =
-          type_converter.ConvertToLlvmType(tuple_type);
-      for (int32_t i = tuple_type->size() - 1; i >= 0; i--) {
-        // Tuple elements are stored MSB -> LSB, so we need to extract in
-        // reverse order to match native layout.
-        Type* element_type = tuple_type->element_type(i);
-        llvm::Value* unpacked_element_ptr =
-            builder->CreateGEP(tuple_llvm_type, unpacked_buffer,
-                               {
-                                   builder->getInt32(0),
-                                   builder->getInt32(i),
-                               });
-        XLS_RETURN_IF_ERROR(PackValue(unpacked_element_ptr, packed_buffer,
-                                      element_type, bit_offset, type_converter,
-                                      builder));
-        bit_offset += element_type->GetFlatBitCount();
-      }
-      return absl::OkStatus();
-    }
-    case TypeKind::kToken: {
-      // Tokens are zero-bit constructs, so there's nothing to do!
-      return absl::OkStatus();
-    }
-    default:
-      return absl::InvalidArgumentError(absl::StrCat(
-          "Unhandled element kind: ", TypeKindToString(xls_type->kind())));
-  }
-}
-
 // Builds a wrapper around the jitted function `callee` which accepts inputs and
-// produces outputs in a packed data layout.
+// produces outputs in a packed data layout. For procs the outputs are also
+// unpacked before calling `callee` as the proc may exit early (or, for procs
+// using next-value nodes, not write a state element at all) in which case the
+// previous contents of the output buffers must be preserved.
 absl::StatusOr<llvm::Function*> BuildPackedWrapper(
     FunctionBase* xls_function, llvm::Function* callee,
     JitBuilderContext& jit_context) {
@@ -1216,6 +1027,14 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
             llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i),
         });
     wrapper.entry_builder().CreateStore(output_buffer, gep);
+
+    if (xls_function->IsProc() && OutputType(output)->GetFlatBitCount() > 0) {
+      llvm::Value* packed_buffer = LoadPointerFromPointerArray(
+          i, wrapper.GetOutputsArg(), &wrapper.entry_builder());
+      XLS_RETURN_IF_ERROR(UnpackValue(
+          packed_buffer, output_buffer, OutputType(output), /*bit_offset=*/0,
+          jit_context.type_converter(), &wrapper.entry_builder()));
+    }
   }
 
   std::vector<llvm::Value*> args;
@@ -1253,6 +1072,261 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
+// Builds a wrapper around the jitted function `callee` which evaluates `callee`
+// on a batch of argument sets in a single call. The wrapper has the usual
+// `JitFunctionType` signature but the `inputs`/`outputs` pointers point to the
+// first of `row_count` contiguous values in native layout (separated by
+// `JittedFunctionBase::BatchStride` bytes) and the final argument is the
+// number of rows rather than a continuation point. The temp buffer is shared
+// by every row. For example:
+//
+//   int64_t
+//   __f_batched(const uint8_t* const* inputs,
+//               uint8_t* const* outputs,
+//               void* temp_buffer,
+//               InterpreterEvents* events,
+//               InstanceContext* instance_context,
+//               JitRuntime* jit_runtime,
+//               int64_t row_count) {
+//     for (int64_t row = 0; row < row_count; ++row) {
+//       uint8_t* row_inputs[] = {inputs[0] + row * stride_0, ...};
+//       uint8_t* row_outputs[] = {outputs[0] + row * out_stride_0, ...};
+//       __f(row_inputs, row_outputs, temp_buffer, events, instance_context,
+//           jit_runtime, /*continuation_point=*/0);
+//     }
+//     return 0;
+//   }
+//
+// Exposing the loop to LLVM lets it inline the per-row work and hoist or
+// vectorize across rows where possible.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  XLS_RET_CHECK(xls_function->IsFunction())
+      << "Batched evaluation is only supported for functions";
+  llvm::LLVMContext* context = &jit_context.context();
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", callee->getName().str()), inputs, outputs,
+      llvm::Type::getInt64Ty(*context), jit_context,
+      LlvmFunctionWrapper::FunctionArg{
+          .name = "row_count", .type = llvm::Type::getInt64Ty(*context)});
+  const LlvmTypeConverter& type_converter = jit_context.type_converter();
+  llvm::IRBuilder<>& entry = wrapper.entry_builder();
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  llvm::Type* i8_type = llvm::Type::getInt8Ty(*context);
+  llvm::Type* pointer_array_type = llvm::ArrayType::get(ptr_type, 0);
+
+  // Load the base pointers of each batch once and allocate the per-row pointer
+  // arrays passed to `callee`.
+  auto load_bases = [&](absl::Span<Node* const> nodes, llvm::Value* array_arg,
+                        auto type_of) {
+    std::vector<std::pair<llvm::Value*, int64_t>> bases;
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      Type* type = type_of(nodes[i]);
+      bases.push_back(
+          {LoadPointerFromPointerArray(i, array_arg, &entry),
+           JittedFunctionBase::BatchStride(
+               type_converter.GetTypeByteSize(type),
+               type_converter.GetTypePreferredAlignment(type))});
+    }
+    return bases;
+  };
+  std::vector<std::pair<llvm::Value*, int64_t>> input_bases =
+      load_bases(inputs, wrapper.GetInputsArg(), InputType);
+  std::vector<std::pair<llvm::Value*, int64_t>> output_bases =
+      load_bases(outputs, wrapper.GetOutputsArg(), OutputType);
+  llvm::Value* row_inputs =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, inputs.size()));
+  llvm::Value* row_outputs =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, outputs.size()));
+
+  llvm::BasicBlock* loop_block =
+      llvm::BasicBlock::Create(*context, "row_loop", wrapper.function());
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  llvm::Value* row_count = wrapper.GetExtraArg().value();
+  entry.CreateCondBr(entry.CreateICmpSGT(row_count, entry.getInt64(0)),
+                     loop_block, exit_block);
+
+  llvm::IRBuilder<> loop(loop_block);
+  llvm::PHINode* row = loop.CreatePHI(loop.getInt64Ty(), 2, "row");
+  row->addIncoming(loop.getInt64(0), entry.GetInsertBlock());
+  auto fill_row_pointers =
+      [&](absl::Span<const std::pair<llvm::Value*, int64_t>> bases,
+          llvm::Value* row_array) {
+        for (int64_t i = 0; i < bases.size(); ++i) {
+          llvm::Value* offset =
+              loop.CreateMul(row, loop.getInt64(bases[i].second));
+          llvm::Value* row_ptr =
+              loop.CreateGEP(i8_type, bases[i].first, offset);
+          loop.CreateStore(
+              row_ptr, loop.CreateGEP(pointer_array_type, row_array,
+                                      {loop.getInt32(0), loop.getInt32(i)}));
+        }
+      };
+  fill_row_pointers(input_bases, row_inputs);
+  fill_row_pointers(output_bases, row_outputs);
+  loop.CreateCall(callee,
+                  {row_inputs, row_outputs, wrapper.GetTempBufferArg(),
+                   wrapper.GetInterpreterEventsArg(),
+                   wrapper.GetInstanceContextArg(), wrapper.GetJitRuntimeArg(),
+                   /*continuation_point=*/loop.getInt64(0)});
+  llvm::Value* next_row = loop.CreateAdd(row, loop.getInt64(1));
+  row->addIncoming(next_row, loop_block);
+  loop.CreateCondBr(loop.CreateICmpSLT(next_row, row_count), loop_block,
+                    exit_block);
+
+  llvm::IRBuilder<> exit(exit_block);
+  exit.CreateRet(exit.getInt64(0));
+  return wrapper.function();
+}
+
+// Builds a wrapper around the jitted block function `callee` which evaluates
+// `cycle_count` consecutive clock cycles of the block in a single call. The
+// wrapper has the usual `JitFunctionType` signature. The leading input (output)
+// pointers point to the first of `cycle_count` contiguous input (output) port
+// values in native layout separated by `JittedFunctionBase::BatchStride` bytes.
+// The trailing input pointers point to the current register values and the
+// trailing output pointers to a second set of register buffers. The two
+// register buffer sets swap roles after every cycle so after an odd number of
+// cycles the final register values are in the buffers passed as outputs. For
+// example:
+//
+//   int64_t
+//   __b_multi_cycle(const uint8_t* const* inputs,
+//                   uint8_t* const* outputs,
+//                   void* temp_buffer,
+//                   InterpreterEvents* events,
+//                   InstanceContext* instance_context,
+//                   JitRuntime* jit_runtime,
+//                   int64_t cycle_count) {
+//     for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+//       bool odd = cycle & 1;
+//       uint8_t* cycle_inputs[] = {inputs[0] + cycle * stride_0, ...,
+//                                  odd ? outputs[P] : inputs[N], ...};
+//       uint8_t* cycle_outputs[] = {outputs[0] + cycle * out_stride_0, ...,
+//                                   odd ? inputs[N] : outputs[P], ...};
+//       __b(cycle_inputs, cycle_outputs, temp_buffer, events, instance_context,
+//           jit_runtime, /*continuation_point=*/0);
+//     }
+//     return 0;
+//   }
+//
+// where N is the number of input ports and P the number of output ports.
+absl::StatusOr<llvm::Function*> BuildMultiCycleWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  XLS_RET_CHECK(xls_function->IsBlock())
+      << "Multi-cycle evaluation is only supported for blocks";
+  Block* block = xls_function->AsBlockOrDie();
+  llvm::LLVMContext* context = &jit_context.context();
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  const int64_t input_port_count = block->GetInputPorts().size();
+  const int64_t output_port_count = block->GetOutputPorts().size();
+  const int64_t register_count = block->GetRegisters().size();
+  XLS_RET_CHECK_EQ(inputs.size(), input_port_count + register_count);
+  XLS_RET_CHECK_EQ(outputs.size(), output_port_count + register_count);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_multi_cycle", callee->getName().str()), inputs,
+      outputs, llvm::Type::getInt64Ty(*context), jit_context,
+      LlvmFunctionWrapper::FunctionArg{
+          .name = "cycle_count", .type = llvm::Type::getInt64Ty(*context)});
+  const LlvmTypeConverter& type_converter = jit_context.type_converter();
+  llvm::IRBuilder<>& entry = wrapper.entry_builder();
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  llvm::Type* i8_type = llvm::Type::getInt8Ty(*context);
+  llvm::Type* pointer_array_type = llvm::ArrayType::get(ptr_type, 0);
+
+  // Load the base pointers of the port buffers and both register buffer sets
+  // once, and allocate the per-cycle pointer arrays passed to `callee`.
+  auto load_port_bases = [&](absl::Span<Node* const> ports,
+                             llvm::Value* array_arg, auto type_of) {
+    std::vector<std::pair<llvm::Value*, int64_t>> bases;
+    for (int64_t i = 0; i < ports.size(); ++i) {
+      Type* type = type_of(ports[i]);
+      bases.push_back(
+          {LoadPointerFromPointerArray(i, array_arg, &entry),
+           JittedFunctionBase::BatchStride(
+               type_converter.GetTypeByteSize(type),
+               type_converter.GetTypePreferredAlignment(type))});
+    }
+    return bases;
+  };
+  std::vector<std::pair<llvm::Value*, int64_t>> input_port_bases =
+      load_port_bases(absl::MakeConstSpan(inputs).first(input_port_count),
+                      wrapper.GetInputsArg(), InputType);
+  std::vector<std::pair<llvm::Value*, int64_t>> output_port_bases =
+      load_port_bases(absl::MakeConstSpan(outputs).first(output_port_count),
+                      wrapper.GetOutputsArg(), OutputType);
+  std::vector<llvm::Value*> current_registers;
+  std::vector<llvm::Value*> next_registers;
+  for (int64_t i = 0; i < register_count; ++i) {
+    current_registers.push_back(LoadPointerFromPointerArray(
+        input_port_count + i, wrapper.GetInputsArg(), &entry));
+    next_registers.push_back(LoadPointerFromPointerArray(
+        output_port_count + i, wrapper.GetOutputsArg(), &entry));
+  }
+  llvm::Value* cycle_inputs =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, inputs.size()));
+  llvm::Value* cycle_outputs =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, outputs.size()));
+
+  llvm::BasicBlock* loop_block =
+      llvm::BasicBlock::Create(*context, "cycle_loop", wrapper.function());
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  llvm::Value* cycle_count = wrapper.GetExtraArg().value();
+  entry.CreateCondBr(entry.CreateICmpSGT(cycle_count, entry.getInt64(0)),
+                     loop_block, exit_block);
+
+  llvm::IRBuilder<> loop(loop_block);
+  llvm::PHINode* cycle = loop.CreatePHI(loop.getInt64Ty(), 2, "cycle");
+  cycle->addIncoming(loop.getInt64(0), entry.GetInsertBlock());
+  auto store_pointer = [&](llvm::Value* ptr, llvm::Value* array, int64_t i) {
+    loop.CreateStore(ptr, loop.CreateGEP(pointer_array_type, array,
+                                         {loop.getInt32(0), loop.getInt32(i)}));
+  };
+  auto fill_port_pointers =
+      [&](absl::Span<const std::pair<llvm::Value*, int64_t>> bases,
+          llvm::Value* cycle_array) {
+        for (int64_t i = 0; i < bases.size(); ++i) {
+          llvm::Value* offset =
+              loop.CreateMul(cycle, loop.getInt64(bases[i].second));
+          store_pointer(loop.CreateGEP(i8_type, bases[i].first, offset),
+                        cycle_array, i);
+        }
+      };
+  fill_port_pointers(input_port_bases, cycle_inputs);
+  fill_port_pointers(output_port_bases, cycle_outputs);
+  // On odd cycles the register values written by the previous cycle live in
+  // the `next_registers` buffers so the two sets swap roles.
+  llvm::Value* odd = loop.CreateTrunc(cycle, loop.getInt1Ty(), "odd");
+  for (int64_t i = 0; i < register_count; ++i) {
+    store_pointer(
+        loop.CreateSelect(odd, next_registers[i], current_registers[i]),
+        cycle_inputs, input_port_count + i);
+    store_pointer(
+        loop.CreateSelect(odd, current_registers[i], next_registers[i]),
+        cycle_outputs, output_port_count + i);
+  }
+  loop.CreateCall(callee,
+                  {cycle_inputs, cycle_outputs, wrapper.GetTempBufferArg(),
+                   wrapper.GetInterpreterEventsArg(),
+                   wrapper.GetInstanceContextArg(), wrapper.GetJitRuntimeArg(),
+                   /*continuation_point=*/loop.getInt64(0)});
+  llvm::Value* next_cycle = loop.CreateAdd(cycle, loop.getInt64(1));
+  cycle->addIncoming(next_cycle, loop_block);
+  loop.CreateCondBr(loop.CreateICmpSLT(next_cycle, cycle_count), loop_block,
+                    exit_block);
+
+  llvm::IRBuilder<> exit(exit_block);
+  exit.CreateRet(exit.getInt64(0));
+  return wrapper.function();
+}
+
 }  // namespace
 
 JitArgumentSet JittedFunctionBase::CreateInputBuffer(bool zero) const {
@@ -1281,7 +1355,7 @@ JitTempBuffer JittedFunctionBase::CreateTempBuffer() const {
 // dependent xls::Functions which may be called by `xls_function`.
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
     FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
+    bool build_packed_wrapper, bool build_batched_wrapper) {
   std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
   BufferAllocator allocator(&jit_context.type_converter());
   llvm::Function* top_function = nullptr;
@@ -1319,12 +1393,42 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
         BuildPackedWrapper(xls_function, top_function, jit_context));
     packed_wrapper_name = packed_wrapper_function->getName().str();
   }
+  std::string batched_wrapper_name;
+  if (build_batched_wrapper) {
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * batched_wrapper_function,
+        xls_function->IsBlock()
+            ? BuildMultiCycleWrapper(xls_function, top_function, jit_context)
+            : BuildBatchedWrapper(xls_function, top_function, jit_context));
+    batched_wrapper_name = batched_wrapper_function->getName().str();
+  }
+
+  if (jit_context.profile_options().instrument) {
+    // The counters are read back from the process' memory.
+    XLS_RET_CHECK(jit_context.llvm_compiler().IsOrcJit())
+        << "Profiling instrumentation is only supported by the ORC JIT";
+    jit_context.FinalizeProfileCounters();
+  }
 
   XLS_RETURN_IF_ERROR(
       jit_context.llvm_compiler().CompileModule(jit_context.ConsumeModule()));
 
   JittedFunctionBase jitted_function;
 
+  if (jit_context.profile_options().instrument) {
+    jitted_function.profile_counter_layout_ =
+        jit_context.profile_counter_layout();
+    if (jit_context.profile_counter_layout().counter_count > 0) {
+      XLS_ASSIGN_OR_RETURN(auto* orc_jit,
+                           jit_context.llvm_compiler().AsOrcJit());
+      XLS_ASSIGN_OR_RETURN(
+          auto counters_address,
+          orc_jit->LoadSymbol(jit_context.ProfileCountersName()));
+      jitted_function.profile_counters_ =
+          counters_address.toPtr<int64_t*>();
+    }
+  }
+
   jitted_function.function_name_ = function_name;
   if (jit_context.llvm_compiler().IsOrcJit()) {
     XLS_ASSIGN_OR_RETURN(auto* orc_jit, jit_context.llvm_compiler().AsOrcJit());
@@ -1352,6 +1456,20 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
     }
   }
 
+  if (build_batched_wrapper) {
+    jitted_function.batched_function_name_ = batched_wrapper_name;
+    if (jit_context.llvm_compiler().IsOrcJit()) {
+      XLS_ASSIGN_OR_RETURN(auto* orc_jit,
+                           jit_context.llvm_compiler().AsOrcJit());
+      XLS_ASSIGN_OR_RETURN(auto batched_fn_address,
+                           orc_jit->LoadSymbol(batched_wrapper_name));
+      jitted_function.batched_function_ =
+          absl::bit_cast<JitFunctionType>(batched_fn_address);
+    } else {
+      jitted_function.batched_function_ = InvalidJitFunctionUse;
+    }
+  }
+
   for (const Node* input : GetJittedFunctionInputs(xls_function)) {
     Type* input_type = InputType(input);
     jitted_function.input_buffer_sizes_.push_back(
@@ -1392,24 +1510,32 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
-    Function* xls_function, LlvmCompiler& compiler) {
-  JitBuilderContext jit_context(compiler, xls_function);
+    Function* xls_function, LlvmCompiler& compiler,
+    const JitProfileOptions& profile_options) {
+  JitBuilderContext jit_context(compiler, xls_function, profile_options);
   return JittedFunctionBase::BuildInternal(xls_function, jit_context,
-                                           /*build_packed_wrapper=*/true);
+                                           /*build_packed_wrapper=*/true,
+                                           /*build_batched_wrapper=*/true);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
-    Proc* proc, LlvmCompiler& compiler) {
-  JitBuilderContext jit_context(compiler, proc);
-  return JittedFunctionBase::BuildInternal(proc, jit_context,
-                                           /*build_packed_wrapper=*/false);
+    Proc* proc, LlvmCompiler& compiler,
+    const JitProfileOptions& profile_options,
+    const JitProcLayoutOptions& layout_options) {
+  JitBuilderContext jit_context(compiler, proc, profile_options,
+                                layout_options.packed_channel_payloads);
+  return JittedFunctionBase::BuildInternal(
+      proc, jit_context,
+      /*build_packed_wrapper=*/layout_options.packed_state,
+      /*build_batched_wrapper=*/false);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
     Block* block, LlvmCompiler& compiler) {
   JitBuilderContext jit_context(compiler, block);
   return JittedFunctionBase::BuildInternal(block, jit_context,
-                                           /*build_packed_wrapper=*/false);
+                                           /*build_packed_wrapper=*/false,
+                                           /*build_batched_wrapper=*/true);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildFromAot(
@@ -1555,4 +1681,35 @@ std::optional<int64_t> JittedFunctionBase::RunPackedJittedFunction(
   }
   return std::nullopt;
 }
+
+JitProfile JittedFunctionBase::GetProfile() const {
+  if (!profile_counter_layout_.has_value() || profile_counters_ == nullptr) {
+    return JitProfile();
+  }
+  return profile_counter_layout_->Read(profile_counters_);
+}
+
+void JittedFunctionBase::ResetProfile() const {
+  if (!profile_counter_layout_.has_value() || profile_counters_ == nullptr) {
+    return;
+  }
+  for (int64_t i = 0; i < profile_counter_layout_->counter_count; ++i) {
+    std::atomic_ref<int64_t>(profile_counters_[i])
+        .store(0, std::memory_order_relaxed);
+  }
+}
+
+std::optional<int64_t> JittedFunctionBase::RunBatchedJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, InstanceContext* instance_context,
+    JitRuntime* jit_runtime, int64_t row_count) const {
+  if (!batched_function_) {
+    return std::nullopt;
+  }
+  DCHECK_OK(VerifyOffsetAlignments(inputs, input_buffer_abi_alignments()));
+  DCHECK_OK(VerifyOffsetAlignments(outputs, output_buffer_abi_alignments()));
+  DCHECK(IsAligned(temp_buffer, temp_buffer_alignment_));
+  return (*batched_function_)(inputs, outputs, temp_buffer, events,
+                              instance_context, jit_runtime, row_count);
+}
 }  // namespace xls
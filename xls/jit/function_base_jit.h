@@ -14,6 +14,7 @@
 #ifndef XLS_JIT_FUNCTION_BASE_JIT_H_
 #define XLS_JIT_FUNCTION_BASE_JIT_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -28,6 +29,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/math_util.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
@@ -39,6 +41,7 @@
 #include "xls/jit/ir_builder_visitor.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
 
@@ -75,6 +78,21 @@ using JitFunctionType = int64_t (*)(const uint8_t* const* inputs,
                                     JitRuntime* jit_runtime,
                                     int64_t continuation_point);
 
+// Options controlling the data layout a jitted proc uses at its boundaries.
+// By default state elements and channel payloads use the native LLVM layout in
+// which every bits leaf is rounded up to a byte-aligned integer. The packed
+// layout (see TypeLayout) stores leaves back-to-back at bit granularity which
+// reduces the memory footprint of state and queues holding many narrow values
+// at the cost of converting at the boundary of the jitted code.
+struct JitProcLayoutOptions {
+  // Build a packed wrapper (see RunPackedJittedFunction) which reads and writes
+  // the state elements in the packed layout.
+  bool packed_state = false;
+  // Send and receive payloads to and from the channel queues in the packed
+  // layout. Must match the layout used by the queues.
+  bool packed_channel_payloads = false;
+};
+
 // Abstraction holding function pointers and metadata about a jitted function
 // implementing a XLS Function, Proc, etc.
 //
@@ -83,14 +101,19 @@ class JittedFunctionBase {
  public:
   JittedFunctionBase() = default;
   // Builds and returns an LLVM IR function implementing the given XLS
-  // function.
-  static absl::StatusOr<JittedFunctionBase> Build(Function* xls_function,
-                                                  LlvmCompiler& compiler);
+  // function. `profile_options` controls profiling instrumentation and the
+  // use of an earlier profile.
+  static absl::StatusOr<JittedFunctionBase> Build(
+      Function* xls_function, LlvmCompiler& compiler,
+      const JitProfileOptions& profile_options = JitProfileOptions());
 
   // Builds and returns an LLVM IR function implementing the given XLS
-  // proc.
-  static absl::StatusOr<JittedFunctionBase> Build(Proc* proc,
-                                                  LlvmCompiler& compiler);
+  // proc. `layout_options` selects the layout of the state and channel
+  // payloads.
+  static absl::StatusOr<JittedFunctionBase> Build(
+      Proc* proc, LlvmCompiler& compiler,
+      const JitProfileOptions& profile_options = JitProfileOptions(),
+      const JitProcLayoutOptions& layout_options = JitProcLayoutOptions());
 
   // Builds and returns an LLVM IR function implementing the given XLS
   // block.
@@ -153,6 +176,56 @@ class JittedFunctionBase {
       InterpreterEvents* events, InstanceContext* instance_context,
       JitRuntime* jit_runtime, int64_t continuation_point) const;
 
+  // Executes the batched version of the function on `row_count` argument sets.
+  // `inputs[i]` points to `row_count` native-layout values of the i-th input,
+  // each `input_batch_stride(i)` bytes after the previous one (and similarly
+  // for `outputs`). The temp buffer is shared by all rows. Returns nullopt if
+  // there is no batched version of the function.
+  //
+  // For blocks `row_count` is the number of clock cycles to run. Only the
+  // input and output ports are batched; the register inputs and outputs are
+  // two sets of register buffers which alternate roles every cycle, so after
+  // an odd number of cycles the final register values are in the buffers
+  // passed as outputs.
+  std::optional<int64_t> RunBatchedJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, InstanceContext* instance_context,
+      JitRuntime* jit_runtime, int64_t row_count) const;
+
+  // Returns the distance in bytes between consecutive rows of a batch of
+  // values with the given native size and alignment.
+  static int64_t BatchStride(int64_t size, int64_t alignment) {
+    return RoundUpToNearest(std::max<int64_t>(size, 1), alignment);
+  }
+  int64_t input_batch_stride(int64_t i) const {
+    return BatchStride(input_buffer_sizes_[i],
+                       input_buffer_preferred_alignments_[i]);
+  }
+  int64_t output_batch_stride(int64_t i) const {
+    return BatchStride(output_buffer_sizes_[i],
+                       output_buffer_preferred_alignments_[i]);
+  }
+
+  // Checks if we have a batched version of the function. Only exists for
+  // jitted xls::Functions and xls::Blocks.
+  bool HasBatchedFunction() const { return batched_function_.has_value(); }
+  std::optional<std::string_view> batched_function_name() const {
+    return HasBatchedFunction()
+               ? std::make_optional<std::string_view>(*batched_function_name_)
+               : std::nullopt;
+  }
+
+  // Whether the function was built with profiling instrumentation (see
+  // JitProfileOptions::instrument).
+  bool HasProfileInstrumentation() const {
+    return profile_counter_layout_.has_value();
+  }
+  // Returns the counts gathered by the instrumented code so far. Returns an
+  // empty profile if the function is not instrumented.
+  JitProfile GetProfile() const;
+  // Sets all profile counters back to zero.
+  void ResetProfile() const;
+
   // Checks if we have a packed version of the function.
   bool HasPackedFunction() const { return packed_function_.has_value(); }
   std::optional<std::string_view> packed_function_name() const {
@@ -215,6 +288,10 @@ class JittedFunctionBase {
     JittedFunctionBase res = *this;
     res.function_ = entrypoint;
     res.packed_function_ = packed_entrypoint;
+    res.batched_function_name_.reset();
+    res.batched_function_.reset();
+    res.profile_counters_ = nullptr;
+    res.profile_counter_layout_.reset();
     return res;
   }
 
@@ -254,7 +331,7 @@ class JittedFunctionBase {
 
   static absl::StatusOr<JittedFunctionBase> BuildInternal(
       FunctionBase* function, JitBuilderContext& jit_context,
-      bool build_packed_wrapper);
+      bool build_packed_wrapper, bool build_batched_wrapper);
 
   // Name and function pointer for the jitted function which accepts/produces
   // arguments/results in LLVM native format.
@@ -263,10 +340,22 @@ class JittedFunctionBase {
 
   // Name and function pointer for the jitted function which accepts/produces
   // arguments/results in a packed format. Only exists for JITted
-  // xls::Functions, not procs.
+  // xls::Functions and for procs built with JitProcLayoutOptions::packed_state.
   std::optional<std::string> packed_function_name_;
   std::optional<JitFunctionType> packed_function_;
 
+  // Name and function pointer for the jitted function which evaluates a batch
+  // of argument sets (or, for blocks, of cycles) in one call. Only exists for
+  // JITted xls::Functions and xls::Blocks.
+  std::optional<std::string> batched_function_name_;
+  std::optional<JitFunctionType> batched_function_;
+
+  // Counters incremented by profiling-instrumented code and the nodes and
+  // early exit points they belong to. The counters live in the jitted code's
+  // data section.
+  int64_t* profile_counters_ = nullptr;
+  std::optional<JitProfileCounterLayout> profile_counter_layout_;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes_;
   std::vector<int64_t> output_buffer_sizes_;
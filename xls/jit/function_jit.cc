@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -30,6 +31,7 @@
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/events.h"
@@ -44,6 +46,8 @@
 #include "xls/jit/aot_compiler.h"
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
@@ -96,9 +100,9 @@ FunctionJit::InterfaceMetadata::CreateFromAotEntrypoint(
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
     Function* xls_function, int64_t opt_level, bool include_observer_callbacks,
-    JitObserver* jit_observer) {
+    JitObserver* jit_observer, const JitProfileOptions& profile_options) {
   return CreateInternal(xls_function, opt_level, include_observer_callbacks,
-                        jit_observer);
+                        jit_observer, profile_options);
 }
 
 // Returns an object containing an AOT-compiled version of the specified XLS
@@ -151,14 +155,15 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
     Function* xls_function, int64_t opt_level, bool include_observer_callbacks,
-    JitObserver* jit_observer) {
+    JitObserver* jit_observer, const JitProfileOptions& profile_options) {
   XLS_ASSIGN_OR_RETURN(
       auto orc_jit,
       OrcJit::Create(opt_level, include_observer_callbacks, jit_observer));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
                        orc_jit->CreateDataLayout());
-  XLS_ASSIGN_OR_RETURN(auto function_base,
-                       JittedFunctionBase::Build(xls_function, *orc_jit));
+  XLS_ASSIGN_OR_RETURN(
+      auto function_base,
+      JittedFunctionBase::Build(xls_function, *orc_jit, profile_options));
 
   XLS_ASSIGN_OR_RETURN(InterfaceMetadata metadata,
                        InterfaceMetadata::CreateFromFunction(xls_function));
@@ -233,6 +238,110 @@ template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/false>(
     absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
     InterpreterEvents* events);
 
+absl::Status FunctionJit::RunBatchedWithViews(
+    absl::Span<const uint8_t* const> args, absl::Span<uint8_t> result_buffer,
+    int64_t row_count, InterpreterEvents* events) {
+  XLS_RET_CHECK(jitted_function_base_.HasBatchedFunction());
+  if (args.size() != metadata_.ParamCount()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), metadata_.ParamCount()));
+  }
+  if (row_count < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid row count: %d", row_count));
+  }
+  if (row_count == 0) {
+    return absl::OkStatus();
+  }
+  int64_t result_size =
+      (row_count - 1) * GetReturnBatchStride() + GetReturnTypeSize();
+  if (result_buffer.size() < result_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!", result_size));
+  }
+  auto is_aligned = [](const uint8_t* ptr, int64_t alignment) {
+    return absl::bit_cast<uintptr_t>(ptr) % alignment == 0;
+  };
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (!is_aligned(args[i], GetArgTypeAlignment(i))) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Batch for argument %d is not aligned to %d bytes.", i,
+          GetArgTypeAlignment(i)));
+    }
+  }
+  if (!is_aligned(result_buffer.data(), GetReturnTypeAlignment())) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Result batch is not aligned to %d bytes.",
+                        GetReturnTypeAlignment()));
+  }
+
+  uint8_t* output_buffers[1] = {result_buffer.data()};
+  jitted_function_base_.RunBatchedJittedFunction(
+      args.data(), output_buffers, temp_buffer_.get(), events,
+      /*instance_context=*/&callbacks_, runtime(), row_count);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<std::vector<Value>>> FunctionJit::RunBatched(
+    absl::Span<const std::vector<Value>> args) {
+  int64_t row_count = args.size();
+  if (row_count == 0) {
+    return InterpreterResult<std::vector<Value>>{};
+  }
+
+  // Lay out each parameter's values contiguously, one row after another.
+  using AlignedBuffer = std::unique_ptr<uint8_t[], DeleteAligned>;
+  auto allocate_batch = [&](int64_t stride, int64_t alignment) {
+    return AlignedBuffer(absl::bit_cast<uint8_t*>(
+        AllocateAligned(alignment, RoundUpToNearest(stride * row_count,
+                                                    alignment))));
+  };
+  std::vector<AlignedBuffer> arg_batches;
+  std::vector<const uint8_t*> arg_pointers;
+  for (int64_t i = 0; i < metadata_.ParamCount(); ++i) {
+    arg_batches.push_back(
+        allocate_batch(GetArgBatchStride(i), GetArgTypeAlignment(i)));
+    arg_pointers.push_back(arg_batches.back().get());
+  }
+  std::vector<uint8_t*> row_pointers(metadata_.ParamCount());
+  for (int64_t row = 0; row < row_count; ++row) {
+    const std::vector<Value>& row_args = args[row];
+    if (row_args.size() != metadata_.ParamCount()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list %d to '%s' has the wrong size: %d vs expected %d.", row,
+          metadata_.name, row_args.size(), metadata_.ParamCount()));
+    }
+    for (int64_t i = 0; i < metadata_.ParamCount(); ++i) {
+      if (!ValueConformsToType(row_args[i], metadata_.param_types[i])) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d of row %d which is not of type "
+            "%s",
+            row_args[i].ToString(), i, row,
+            metadata_.param_types[i]->ToString()));
+      }
+      row_pointers[i] = arg_batches[i].get() + row * GetArgBatchStride(i);
+    }
+    XLS_RETURN_IF_ERROR(
+        jit_runtime_->PackArgs(row_args, metadata_.param_types, row_pointers));
+  }
+
+  AlignedBuffer result_batch =
+      allocate_batch(GetReturnBatchStride(), GetReturnTypeAlignment());
+  InterpreterResult<std::vector<Value>> result;
+  XLS_RETURN_IF_ERROR(RunBatchedWithViews(
+      arg_pointers,
+      absl::MakeSpan(result_batch.get(), GetReturnBatchStride() * row_count),
+      row_count, &result.events));
+  result.value.reserve(row_count);
+  for (int64_t row = 0; row < row_count; ++row) {
+    result.value.push_back(jit_runtime_->UnpackBuffer(
+        result_batch.get() + row * GetReturnBatchStride(),
+        metadata_.return_type));
+  }
+  return result;
+}
+
 template <bool kForceZeroCopy>
 void FunctionJit::InvokeUnalignedJitFunction(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
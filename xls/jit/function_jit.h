@@ -38,6 +38,7 @@
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
@@ -52,10 +53,15 @@ class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
   // function.
+  //
+  // `profile_options` can be used to instrument the code to gather a
+  // JitProfile (see jitted_function_base().GetProfile()) or to compile with
+  // the branch weights of an earlier profile.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
       Function* xls_function, int64_t opt_level = 3,
       bool include_observer_callbacks = false,
-      JitObserver* jit_observer = nullptr);
+      JitObserver* jit_observer = nullptr,
+      const JitProfileOptions& profile_options = JitProfileOptions());
 
   // Returns an object containing an AOT-compiled version of the specified XLS
   // function.
@@ -93,6 +99,26 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Executes the compiled function on `row_count` argument sets in a single
+  // jitted call. This avoids the per-call overhead of RunWithViews (argument
+  // checking, temp buffer setup, etc.) and lets LLVM optimize across rows.
+  //
+  // `args[i]` points to `row_count` values of the i-th parameter in the native
+  // LLVM data layout, each GetArgBatchStride(i) bytes after the previous one.
+  // `result_buffer` receives the `row_count` results, GetReturnBatchStride()
+  // bytes apart. All buffers must be aligned to the respective type's
+  // alignment (see GetArgTypeAlignment). Events from every row are accumulated
+  // into `events`.
+  absl::Status RunBatchedWithViews(absl::Span<const uint8_t* const> args,
+                                   absl::Span<uint8_t> result_buffer,
+                                   int64_t row_count,
+                                   InterpreterEvents* events);
+
+  // As above but takes and returns Values. `args[r]` is the argument list for
+  // row `r`. Events from all rows are combined in the result.
+  absl::StatusOr<InterpreterResult<std::vector<Value>>> RunBatched(
+      absl::Span<const std::vector<Value>> args);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -165,6 +191,16 @@ class FunctionJit {
     return jitted_function_base_.output_buffer_abi_alignments()[0];
   }
 
+  // Gets the distance in bytes between consecutive values of the given
+  // argument (or of the return value) in the buffers passed to
+  // RunBatchedWithViews.
+  int64_t GetArgBatchStride(int arg_index) const {
+    return jitted_function_base_.input_batch_stride(arg_index);
+  }
+  int64_t GetReturnBatchStride() const {
+    return jitted_function_base_.output_batch_stride(0);
+  }
+
   // Gets the size of the compiled function's arguments (or return value) in the
   // packed layout.
   int64_t GetPackedArgTypeSize(int arg_index) const {
@@ -240,7 +276,8 @@ class FunctionJit {
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
       Function* xls_function, int64_t opt_level,
-      bool include_observer_callbacks, JitObserver* jit_observer);
+      bool include_observer_callbacks, JitObserver* jit_observer,
+      const JitProfileOptions& profile_options);
 
   template <bool kForceZeroCopy, typename... ArgsT>
   absl::Status RunWithUnpackedViewsCommon(ArgsT... args) {
@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "xls/common/benchmark_support.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/init_xls.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/passes/map_inlining_pass.h"
+
+namespace xls {
+namespace {
+
+// Measures the JIT on the image binarization in sobel_filter_benchmark.x,
+// which maps an element-wise function over a 64x64 8-bit image. The map is
+// evaluated either as written (lowered to vector operations by the JIT) or
+// after map inlining, i.e., with one invocation of the function per pixel.
+constexpr char kIrPath[] = "xls/examples/sobel_filter_binarize.ir";
+constexpr int64_t kPixelCount = 64 * 64;
+
+std::unique_ptr<Package> LoadPackage() {
+  std::filesystem::path path = GetXlsRunfilePath(kIrPath).value();
+  std::string ir_text = GetFileContents(path).value();
+  return Parser::ParsePackage(ir_text).value();
+}
+
+static void BM_SobelBinarize(benchmark::State& state) {
+  bool inline_map = state.range(0) != 0;
+  std::unique_ptr<Package> package = LoadPackage();
+  Function* f = package->GetTopAsFunction().value();
+  if (inline_map) {
+    std::vector<Map*> maps;
+    for (Node* node : f->nodes()) {
+      if (node->Is<Map>()) {
+        maps.push_back(node->As<Map>());
+      }
+    }
+    for (Map* map : maps) {
+      CHECK_OK(MapInliningPass::InlineOneMap(map));
+    }
+  }
+  std::unique_ptr<FunctionJit> jit = FunctionJit::Create(f).value();
+
+  std::minstd_rand engine;
+  std::uniform_int_distribution<uint64_t> pixel(0, 255);
+  std::vector<uint64_t> pixels(kPixelCount);
+  for (uint64_t& p : pixels) {
+    p = pixel(engine);
+  }
+  std::vector<Value> args = {Value::UBitsArray(pixels, 8).value()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(jit->Run(args).value());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+
+BENCHMARK(BM_SobelBinarize)->ArgName("inline_map")->DenseRange(0, 1);
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char* argv[]) {
+  xls::InitXls(argv[0], argc, argv);
+  xls::RunSpecifiedBenchmarks(/*default_spec=*/"all");
+  return 0;
+}
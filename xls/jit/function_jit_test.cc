@@ -320,6 +320,94 @@ TEST(FunctionJitTest, ReuseTest) {
               IsOkAndHolds(Value(UBits(7, 8))));
 }
 
+TEST(FunctionJitTest, RunBatched) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(8));
+  BValue y = fb.Param("y", package.GetBitsType(16));
+  fb.Tuple({fb.Add(fb.ZeroExtend(x, 16), y), x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<std::vector<Value>> args;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 100; ++i) {
+    args.push_back({Value(UBits(i, 8)), Value(UBits(1000 * i, 16))});
+    expected.push_back(Value::Tuple(
+        {Value(UBits((1001 * i) & 0xffff, 16)), Value(UBits(i, 8))}));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> result,
+                           jit->RunBatched(args));
+  EXPECT_THAT(result.value, ElementsAreArray(expected));
+
+  // Each row matches the single-call result.
+  for (int64_t i = 0; i < args.size(); ++i) {
+    EXPECT_THAT(RunJitNoEvents(jit.get(), args[i]),
+                IsOkAndHolds(expected[i]));
+  }
+}
+
+TEST(FunctionJitTest, RunBatchedWithViews) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  fb.UMul(fb.Param("x", package.GetBitsType(32)),
+          fb.Param("y", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  ASSERT_EQ(jit->GetArgBatchStride(0), sizeof(uint32_t));
+  ASSERT_EQ(jit->GetReturnBatchStride(), sizeof(uint32_t));
+
+  constexpr int64_t kRows = 37;
+  std::vector<uint32_t> x(kRows);
+  std::vector<uint32_t> y(kRows);
+  std::vector<uint32_t> product(kRows);
+  for (int64_t i = 0; i < kRows; ++i) {
+    x[i] = i;
+    y[i] = 3 * i + 1;
+  }
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatchedWithViews(
+      {reinterpret_cast<uint8_t*>(x.data()),
+       reinterpret_cast<uint8_t*>(y.data())},
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(product.data()),
+                     kRows * sizeof(uint32_t)),
+      kRows, &events));
+  for (int64_t i = 0; i < kRows; ++i) {
+    EXPECT_EQ(product[i], x[i] * y[i]) << "row " << i;
+  }
+
+  // Result buffer too small for the requested number of rows.
+  EXPECT_THAT(jit->RunBatchedWithViews(
+                  {reinterpret_cast<uint8_t*>(x.data()),
+                   reinterpret_cast<uint8_t*>(y.data())},
+                  absl::MakeSpan(reinterpret_cast<uint8_t*>(product.data()),
+                                 kRows * sizeof(uint32_t)),
+                  kRows + 1, &events),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(FunctionJitTest, RunBatchedCollectsEvents) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn traced(tkn: token, pred: bits[1], x: bits[8]) -> token {
+    ret trace.1: token = trace(tkn, pred, format="x is {}", data_operands=[x], id=1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<std::vector<Value>> result,
+      jit->RunBatched({{Value::Token(), Value(UBits(1, 1)), Value(UBits(1, 8))},
+                       {Value::Token(), Value(UBits(0, 1)), Value(UBits(2, 8))},
+                       {Value::Token(), Value(UBits(1, 1)),
+                        Value(UBits(3, 8))}}));
+  EXPECT_EQ(result.value.size(), 3);
+  ASSERT_EQ(result.events.trace_msgs.size(), 2);
+  EXPECT_EQ(result.events.trace_msgs[0].message, "x is 1");
+  EXPECT_EQ(result.events.trace_msgs[1].message, "x is 3");
+}
+
 TEST(FunctionJitTest, OneHotZeroBit) {
   Package package("my_package");
   std::string ir_text = R"(
@@ -789,6 +877,125 @@ TEST(FunctionJitTest, ArrayConcatArrayOfArrays) {
   EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(ret));
 }
 
+TEST(FunctionJitTest, VectorizedMap) {
+  // Both maps apply element-wise functions to narrow bits and are lowered to
+  // vector operations. The array sizes are not multiples of the vector width
+  // so the remainder handling is exercised too.
+  std::string ir_text = R"(
+  package test
+
+  fn body5(x: bits[5]) -> bits[6] {
+    three: bits[5] = literal(value=3)
+    twenty: bits[5] = literal(value=20)
+    two: bits[3] = literal(value=2)
+    add: bits[5] = add(x, three)
+    not: bits[5] = not(x)
+    gt: bits[1] = ugt(x, twenty)
+    sel: bits[5] = sel(gt, cases=[add, not])
+    shll: bits[5] = shll(sel, two)
+    slice: bits[3] = bit_slice(x, start=1, width=3)
+    sign_ext: bits[6] = sign_ext(slice, new_bit_count=6)
+    zero_ext: bits[6] = zero_ext(shll, new_bit_count=6)
+    ret xor: bits[6] = xor(zero_ext, sign_ext)
+  }
+
+  fn body32(x: bits[32]) -> bits[32] {
+    k: bits[32] = literal(value=2654435761)
+    seven: bits[32] = literal(value=7)
+    forty: bits[32] = literal(value=40)
+    umul: bits[32] = umul(x, k)
+    shrl: bits[32] = shrl(umul, seven)
+    zero: bits[32] = shrl(x, forty)
+    ret sub: bits[32] = sub(shrl, zero)
+  }
+
+  top fn f(a: bits[5][100], b: bits[32][19]) -> (bits[6][100], bits[32][19]) {
+    map5: bits[6][100] = map(a, to_apply=body5)
+    map32: bits[32][19] = map(b, to_apply=body32)
+    ret tuple: (bits[6][100], bits[32][19]) = tuple(map5, map32)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<uint64_t> a;
+  std::vector<uint64_t> expected_a;
+  for (uint64_t x = 0; x < 100; ++x) {
+    a.push_back(x % 32);
+    uint64_t sel = (x % 32) > 20 ? ~x & 31 : (x + 3) & 31;
+    uint64_t slice = (x >> 1) & 7;
+    uint64_t sign_ext = (slice & 4) != 0 ? slice | 0x38 : slice;
+    expected_a.push_back(((sel << 2) & 31) ^ sign_ext);
+  }
+  std::vector<uint64_t> b;
+  std::vector<uint64_t> expected_b;
+  for (uint64_t x = 0; x < 19; ++x) {
+    b.push_back(x * 0x01010101);
+    expected_b.push_back(((x * 0x01010101 * 2654435761) & Mask(32)) >> 7);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value a_value, Value::UBitsArray(a, 5));
+  XLS_ASSERT_OK_AND_ASSIGN(Value b_value, Value::UBitsArray(b, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected_a_value,
+                           Value::UBitsArray(expected_a, 6));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected_b_value,
+                           Value::UBitsArray(expected_b, 32));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {a_value, b_value}),
+              IsOkAndHolds(Value::Tuple({expected_a_value, expected_b_value})));
+}
+
+TEST(FunctionJitTest, MapNotVectorized) {
+  // A select with a default value and a map over a single element are not
+  // vectorized; check that the per-element fallback computes the same thing.
+  std::string ir_text = R"(
+  package test
+
+  fn body(x: bits[8]) -> bits[8] {
+    one: bits[8] = literal(value=1)
+    selector: bits[2] = bit_slice(x, start=0, width=2)
+    add: bits[8] = add(x, one)
+    not: bits[8] = not(x)
+    ret sel: bits[8] = sel(selector, cases=[add, not], default=x)
+  }
+
+  top fn f(a: bits[8][37], b: bits[8][1]) -> (bits[8][37], bits[8][1]) {
+    map_a: bits[8][37] = map(a, to_apply=body)
+    map_b: bits[8][1] = map(b, to_apply=body)
+    ret tuple: (bits[8][37], bits[8][1]) = tuple(map_a, map_b)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  auto body = [](uint64_t x) -> uint64_t {
+    switch (x & 3) {
+      case 0:
+        return (x + 1) & 0xff;
+      case 1:
+        return ~x & 0xff;
+      default:
+        return x;
+    }
+  };
+  std::vector<uint64_t> a;
+  std::vector<uint64_t> expected_a;
+  for (uint64_t x = 0; x < 37; ++x) {
+    a.push_back(x * 7);
+    expected_a.push_back(body(x * 7));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value a_value, Value::UBitsArray(a, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value b_value, Value::UBitsArray({201}, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected_a_value,
+                           Value::UBitsArray(expected_a, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected_b_value,
+                           Value::UBitsArray({body(201)}, 8));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {a_value, b_value}),
+              IsOkAndHolds(Value::Tuple({expected_a_value, expected_b_value})));
+}
+
 // The assert tests below are duplicates of the ones in
 // xls/interpereter/ir_evaluator_test_base.cc because those recompile
 // the test function each time they run it. These tests check that
@@ -39,15 +39,24 @@
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/GEPNoWrapFlags.h"
+#include "llvm/include/llvm/IR/GlobalValue.h"
+#include "llvm/include/llvm/IR/GlobalVariable.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/InstrTypes.h"
 #include "llvm/include/llvm/IR/Instructions.h"
 #include "llvm/include/llvm/IR/Intrinsics.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/MDBuilder.h"
+#include "llvm/include/llvm/IR/Metadata.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "llvm/include/llvm/Support/Alignment.h"
+#include "llvm/include/llvm/Support/AtomicOrdering.h"
 #include "llvm/include/llvm/Support/Casting.h"
+#include "llvm/include/llvm/Support/TypeSize.h"
+#include "xls/common/bits_util.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -63,10 +72,12 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/llvm_type_converter.h"
 
 namespace xls {
@@ -79,6 +90,123 @@ bool ShouldMaterializeAtUse(Node* node) {
   return node->Is<Literal>() && node->GetType()->IsBits();
 }
 
+llvm::Value* JitBuilderContext::GetProfileCounterPtr(
+    llvm::Value* index, llvm::IRBuilder<>& builder) {
+  llvm::Type* i64 = builder.getInt64Ty();
+  if (profile_counters_ == nullptr) {
+    profile_counters_ = new llvm::GlobalVariable(
+        *module_, llvm::ArrayType::get(i64, 0), /*isConstant=*/false,
+        llvm::GlobalValue::ExternalLinkage, /*Initializer=*/nullptr,
+        ProfileCountersName());
+  }
+  return builder.CreateGEP(llvm::ArrayType::get(i64, 0), profile_counters_,
+                           {builder.getInt32(0), index});
+}
+
+void JitBuilderContext::EmitNodeProfileCount(const Node* node,
+                                             int64_t arm_count,
+                                             llvm::Value* arm,
+                                             llvm::IRBuilder<>& builder) {
+  CHECK(profile_options_.instrument);
+  auto [it, inserted] = profile_counter_layout_.nodes.try_emplace(
+      node, profile_counter_layout_.counter_count, arm_count);
+  if (inserted) {
+    profile_counter_layout_.counter_count += arm_count;
+  }
+  CHECK_EQ(it->second.second, arm_count);
+  llvm::Value* index = builder.CreateAdd(
+      builder.CreateZExtOrTrunc(arm, builder.getInt64Ty()),
+      builder.getInt64(it->second.first));
+  // Counters are shared by all invocations of the jitted code which may run on
+  // different threads.
+  builder.CreateAtomicRMW(llvm::AtomicRMWInst::Add,
+                          GetProfileCounterPtr(index, builder),
+                          builder.getInt64(1), llvm::MaybeAlign(8),
+                          llvm::AtomicOrdering::Monotonic);
+}
+
+void JitBuilderContext::EmitEarlyExitProfileCount(int64_t early_exit_id,
+                                                  llvm::Value* exited,
+                                                  llvm::IRBuilder<>& builder) {
+  CHECK(profile_options_.instrument);
+  auto [it, inserted] = profile_counter_layout_.early_exits.try_emplace(
+      early_exit_id, profile_counter_layout_.counter_count);
+  CHECK(inserted) << "Early exit point " << early_exit_id
+                  << " instrumented twice";
+  profile_counter_layout_.counter_count += 2;
+  llvm::Value* index =
+      builder.CreateAdd(builder.CreateZExt(exited, builder.getInt64Ty()),
+                        builder.getInt64(it->second));
+  builder.CreateAtomicRMW(llvm::AtomicRMWInst::Add,
+                          GetProfileCounterPtr(index, builder),
+                          builder.getInt64(1), llvm::MaybeAlign(8),
+                          llvm::AtomicOrdering::Monotonic);
+}
+
+llvm::MDNode* JitBuilderContext::BranchWeights(int64_t taken,
+                                               int64_t not_taken) {
+  std::optional<std::pair<uint32_t, uint32_t>> weights =
+      ScaleBranchWeights(taken, not_taken);
+  if (!weights.has_value()) {
+    return nullptr;
+  }
+  return llvm::MDBuilder(context()).createBranchWeights(weights->first,
+                                                        weights->second);
+}
+
+namespace {
+
+// Returns the profiled arm counts of `node` if there are exactly `arm_count`
+// of them.
+std::optional<absl::Span<const int64_t>> GetProfiledArmCounts(
+    const JitBuilderContext& jit_context, const Node* node, int64_t arm_count) {
+  const JitProfile* profile = jit_context.profile_options().profile;
+  if (profile == nullptr) {
+    return std::nullopt;
+  }
+  std::optional<absl::Span<const int64_t>> counts =
+      profile->GetNodeCounts(node);
+  if (!counts.has_value() || counts->size() != arm_count) {
+    return std::nullopt;
+  }
+  return counts;
+}
+
+// Attaches weights to the cascade of selects built for a select-like node
+// where `selects[i]` picks arm `i` over all arms after it.
+void SetCascadeBranchWeights(JitBuilderContext& jit_context,
+                             absl::Span<llvm::Value* const> selects,
+                             absl::Span<const int64_t> counts) {
+  int64_t remaining = absl::c_accumulate(counts, int64_t{0});
+  for (int64_t i = 0; i < selects.size(); ++i) {
+    remaining -= counts[i];
+    auto* select = llvm::dyn_cast<llvm::SelectInst>(selects[i]);
+    llvm::MDNode* weights = jit_context.BranchWeights(counts[i], remaining);
+    if (select != nullptr && weights != nullptr) {
+      select->setMetadata(llvm::LLVMContext::MD_prof, weights);
+    }
+  }
+}
+
+}  // namespace
+
+void JitBuilderContext::FinalizeProfileCounters() {
+  if (profile_counters_ == nullptr) {
+    return;
+  }
+  llvm::ArrayType* type = llvm::ArrayType::get(
+      llvm::Type::getInt64Ty(context()),
+      std::max<int64_t>(profile_counter_layout_.counter_count, 1));
+  auto* definition = new llvm::GlobalVariable(
+      *module_, type, /*isConstant=*/false, llvm::GlobalValue::ExternalLinkage,
+      llvm::ConstantAggregateZero::get(type));
+  definition->setAlignment(llvm::Align(8));
+  profile_counters_->replaceAllUsesWith(definition);
+  definition->takeName(profile_counters_);
+  profile_counters_->eraseFromParent();
+  profile_counters_ = definition;
+}
+
 namespace {
 
 // Abstraction representing a value carried across iterations of the loop.
@@ -291,8 +419,10 @@ struct LlvmIfThen {
   }
 };
 
+// If given, `branch_weights` is attached to the conditional branch.
 LlvmIfThen CreateIfThen(llvm::Value* condition, llvm::IRBuilder<>& builder,
-                        std::string_view prefix) {
+                        std::string_view prefix,
+                        llvm::MDNode* branch_weights = nullptr) {
   llvm::Function* function = builder.GetInsertBlock()->getParent();
   llvm::LLVMContext& context = builder.getContext();
   llvm::BasicBlock* then_block = llvm::BasicBlock::Create(
@@ -300,7 +430,7 @@ LlvmIfThen CreateIfThen(llvm::Value* condition, llvm::IRBuilder<>& builder,
   llvm::BasicBlock* join_block = llvm::BasicBlock::Create(
       context, absl::StrFormat("%s_join", prefix), function);
 
-  builder.CreateCondBr(condition, then_block, join_block);
+  builder.CreateCondBr(condition, then_block, join_block, branch_weights);
 
   LlvmIfThen if_then;
   if_then.then_builder = std::make_unique<llvm::IRBuilder<>>(then_block);
@@ -2437,6 +2567,250 @@ absl::Status IrBuilderVisitor::HandleLiteral(Literal* literal) {
   return FinalizeNodeIrContextWithValue(std::move(node_context), llvm_literal);
 }
 
+namespace {
+
+// Number of bytes of array elements processed by each iteration of a
+// vectorized map. This is the width of an AVX-512 register; LLVM splits the
+// vectors into narrower operations on targets without such registers.
+constexpr int64_t kVectorizedMapBytes = 64;
+
+bool IsVectorizableBitsType(Type* type) {
+  return type->IsBits() && type->GetFlatBitCount() > 0 &&
+         type->GetFlatBitCount() <= 64;
+}
+
+// Returns true if `node` can be evaluated lane-wise on LLVM vectors of its
+// native integer type.
+bool IsVectorizableNode(Node* node) {
+  if (!IsVectorizableBitsType(node->GetType()) ||
+      !absl::c_all_of(node->operands(), [](Node* operand) {
+        return IsVectorizableBitsType(operand->GetType());
+      })) {
+    return false;
+  }
+  switch (node->op()) {
+    case Op::kParam:
+    case Op::kLiteral:
+    case Op::kIdentity:
+    case Op::kAdd:
+    case Op::kSub:
+    case Op::kAnd:
+    case Op::kOr:
+    case Op::kXor:
+    case Op::kNot:
+    case Op::kNeg:
+    case Op::kEq:
+    case Op::kNe:
+    case Op::kULt:
+    case Op::kULe:
+    case Op::kUGt:
+    case Op::kUGe:
+    case Op::kZeroExt:
+    case Op::kSignExt:
+    case Op::kBitSlice:
+      return true;
+    case Op::kUMul:
+      return node->operand(0)->GetType() == node->GetType() &&
+             node->operand(1)->GetType() == node->GetType();
+    case Op::kShll:
+    case Op::kShrl:
+      return node->operand(1)->Is<Literal>();
+    case Op::kSel: {
+      Select* sel = node->As<Select>();
+      return sel->selector()->BitCountOrDie() == 1 &&
+             sel->cases().size() == 2 && !sel->default_value().has_value();
+    }
+    default:
+      return false;
+  }
+}
+
+// Returns true if `map` applies a function built only from element-wise
+// operations on bits values which fit in a native integer to an array of such
+// values. These maps are lowered to operations on LLVM vectors covering
+// several array elements rather than a call of the function per element.
+bool IsVectorizableMap(Map* map) {
+  ArrayType* input_array_type = map->operand(0)->GetType()->AsArrayOrDie();
+  ArrayType* result_array_type = map->GetType()->AsArrayOrDie();
+  if (input_array_type->size() < 2 ||
+      !IsVectorizableBitsType(input_array_type->element_type()) ||
+      !IsVectorizableBitsType(result_array_type->element_type())) {
+    return false;
+  }
+  Function* to_apply = map->to_apply();
+  return to_apply->params().size() == 1 &&
+         absl::c_all_of(to_apply->nodes(), IsVectorizableNode);
+}
+
+// Emits the function applied by vectorizable `map` on `lanes` consecutive
+// array elements loaded from `input` and stores the results to `output`.
+absl::Status EmitVectorizedMapBody(Map* map, llvm::Value* input,
+                                   llvm::Value* output, int64_t lanes,
+                                   const LlvmTypeConverter& type_converter,
+                                   llvm::IRBuilder<>& b) {
+  auto vector_type = [&](Type* type) {
+    return llvm::FixedVectorType::get(type_converter.ConvertToLlvmType(type),
+                                      lanes);
+  };
+  auto splat = [&](Type* type, uint64_t value) -> llvm::Constant* {
+    return llvm::ConstantVector::getSplat(
+        llvm::ElementCount::getFixed(lanes),
+        llvm::ConstantInt::get(type_converter.ConvertToLlvmType(type), value));
+  };
+  // Native integers are wider than the XLS type unless the bit count is a
+  // power of two (and at least 8), so the padding must be cleared after
+  // operations which can set it.
+  auto clear_padding = [&](llvm::Value* value, Type* type) -> llvm::Value* {
+    int64_t bit_count = type->GetFlatBitCount();
+    if (bit_count == type_converter.GetLlvmBitCount(bit_count)) {
+      return value;
+    }
+    return b.CreateAnd(value, splat(type, Mask(bit_count)));
+  };
+  auto compare = [&](Node* node, llvm::CmpInst::Predicate predicate,
+                     llvm::Value* lhs, llvm::Value* rhs) {
+    return b.CreateZExt(b.CreateICmp(predicate, lhs, rhs),
+                        vector_type(node->GetType()));
+  };
+
+  Function* f = map->to_apply();
+  Type* input_element_type =
+      map->operand(0)->GetType()->AsArrayOrDie()->element_type();
+  Type* result_element_type = map->GetType()->AsArrayOrDie()->element_type();
+  absl::flat_hash_map<Node*, llvm::Value*> values;
+  values[f->param(0)] = b.CreateAlignedLoad(
+      vector_type(input_element_type), input,
+      llvm::Align(type_converter.GetTypeAbiAlignment(input_element_type)));
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    auto operand = [&](int64_t i) { return values.at(node->operand(i)); };
+    Type* type = node->GetType();
+    llvm::Value* result;
+    switch (node->op()) {
+      case Op::kLiteral: {
+        XLS_ASSIGN_OR_RETURN(uint64_t value,
+                             node->As<Literal>()->value().bits().ToUint64());
+        result = splat(type, value);
+        break;
+      }
+      case Op::kIdentity:
+        result = operand(0);
+        break;
+      case Op::kAdd:
+        result = clear_padding(b.CreateAdd(operand(0), operand(1)), type);
+        break;
+      case Op::kSub:
+        result = clear_padding(b.CreateSub(operand(0), operand(1)), type);
+        break;
+      case Op::kUMul:
+        result = clear_padding(b.CreateMul(operand(0), operand(1)), type);
+        break;
+      case Op::kAnd:
+      case Op::kOr:
+      case Op::kXor: {
+        llvm::Instruction::BinaryOps opcode =
+            node->op() == Op::kAnd  ? llvm::Instruction::And
+            : node->op() == Op::kOr ? llvm::Instruction::Or
+                                    : llvm::Instruction::Xor;
+        result = operand(0);
+        for (int64_t i = 1; i < node->operand_count(); ++i) {
+          result = b.CreateBinOp(opcode, result, operand(i));
+        }
+        break;
+      }
+      case Op::kNot:
+        result = clear_padding(b.CreateNot(operand(0)), type);
+        break;
+      case Op::kNeg:
+        result = clear_padding(b.CreateNeg(operand(0)), type);
+        break;
+      case Op::kEq:
+        result = compare(node, llvm::CmpInst::ICMP_EQ, operand(0), operand(1));
+        break;
+      case Op::kNe:
+        result = compare(node, llvm::CmpInst::ICMP_NE, operand(0), operand(1));
+        break;
+      case Op::kULt:
+        result = compare(node, llvm::CmpInst::ICMP_ULT, operand(0), operand(1));
+        break;
+      case Op::kULe:
+        result = compare(node, llvm::CmpInst::ICMP_ULE, operand(0), operand(1));
+        break;
+      case Op::kUGt:
+        result = compare(node, llvm::CmpInst::ICMP_UGT, operand(0), operand(1));
+        break;
+      case Op::kUGe:
+        result = compare(node, llvm::CmpInst::ICMP_UGE, operand(0), operand(1));
+        break;
+      case Op::kShll:
+      case Op::kShrl: {
+        const Bits& amount = node->operand(1)->As<Literal>()->value().bits();
+        uint64_t bit_count = type->GetFlatBitCount();
+        uint64_t shift =
+            amount.FitsInUint64() ? *amount.ToUint64() : bit_count;
+        if (shift >= bit_count) {
+          result = splat(type, 0);
+        } else if (node->op() == Op::kShll) {
+          result = clear_padding(b.CreateShl(operand(0), splat(type, shift)),
+                                 type);
+        } else {
+          result = b.CreateLShr(operand(0), splat(type, shift));
+        }
+        break;
+      }
+      case Op::kZeroExt:
+        result = b.CreateZExtOrTrunc(operand(0), vector_type(type));
+        break;
+      case Op::kSignExt: {
+        // Move the sign bit of the operand to the top of its native integer so
+        // the arithmetic shift back down replicates it into the padding.
+        Type* operand_type = node->operand(0)->GetType();
+        int64_t padding =
+            type_converter.GetLlvmBitCount(operand_type->GetFlatBitCount()) -
+            operand_type->GetFlatBitCount();
+        result = operand(0);
+        if (padding > 0) {
+          result = b.CreateAShr(b.CreateShl(result, splat(operand_type, padding)),
+                                splat(operand_type, padding));
+        }
+        result = clear_padding(b.CreateSExtOrTrunc(result, vector_type(type)),
+                               type);
+        break;
+      }
+      case Op::kBitSlice: {
+        BitSlice* bit_slice = node->As<BitSlice>();
+        result = b.CreateZExtOrTrunc(
+            b.CreateLShr(operand(0), splat(node->operand(0)->GetType(),
+                                           bit_slice->start())),
+            vector_type(type));
+        result = clear_padding(result, type);
+        break;
+      }
+      case Op::kSel: {
+        Select* sel = node->As<Select>();
+        llvm::Value* selector = values.at(sel->selector());
+        result = b.CreateSelect(
+            b.CreateICmpNE(selector, splat(sel->selector()->GetType(), 0)),
+            values.at(sel->get_case(1)), values.at(sel->get_case(0)));
+        break;
+      }
+      default:
+        return absl::InternalError(
+            absl::StrFormat("Unexpected node in vectorized map: %s",
+                            node->ToString()));
+    }
+    values[node] = result;
+  }
+  b.CreateAlignedStore(
+      values.at(f->return_value()), output,
+      llvm::Align(type_converter.GetTypeAbiAlignment(result_element_type)));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 absl::Status IrBuilderVisitor::HandleMap(Map* map) {
   XLS_ASSIGN_OR_RETURN(
       NodeIrContext node_context,
@@ -2452,11 +2826,49 @@ absl::Status IrBuilderVisitor::HandleMap(Map* map) {
   llvm::Value* input_buffer = node_context.GetOperandPtr(0);
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
 
+  llvm::Type* i32 = llvm::Type::getInt32Ty(ctx());
+  if (IsVectorizableMap(map)) {
+    // Process the arrays in chunks of `lanes` elements followed by a single
+    // narrower chunk covering any remaining elements.
+    int64_t element_bytes = std::max(
+        type_converter()->GetTypeByteSize(input_array_type->element_type()),
+        type_converter()->GetTypeByteSize(result_array_type->element_type()));
+    int64_t lanes = std::clamp<int64_t>(kVectorizedMapBytes / element_bytes, 1,
+                                        result_array_type->size());
+    int64_t chunk_count = result_array_type->size() / lanes;
+    int64_t remainder = result_array_type->size() % lanes;
+
+    LlvmIrLoop loop(chunk_count, node_context.entry_builder(),
+                    /*stride=*/lanes);
+    XLS_RETURN_IF_ERROR(EmitVectorizedMapBody(
+        map,
+        loop.body_builder().CreateGEP(
+            input_type, input_buffer,
+            {llvm::ConstantInt::get(i32, 0), loop.index()}),
+        loop.body_builder().CreateGEP(
+            output_type, output_buffer,
+            {llvm::ConstantInt::get(i32, 0), loop.index()}),
+        lanes, *type_converter(), loop.body_builder()));
+    loop.Finalize();
+    if (remainder > 0) {
+      llvm::Value* index = llvm::ConstantInt::get(i32, chunk_count * lanes);
+      XLS_RETURN_IF_ERROR(EmitVectorizedMapBody(
+          map,
+          loop.exit_builder().CreateGEP(
+              input_type, input_buffer, {llvm::ConstantInt::get(i32, 0), index}),
+          loop.exit_builder().CreateGEP(
+              output_type, output_buffer,
+              {llvm::ConstantInt::get(i32, 0), index}),
+          remainder, *type_converter(), loop.exit_builder()));
+    }
+    return FinalizeNodeIrContextWithPointerToValue(
+        std::move(node_context), output_buffer, &loop.exit_builder());
+  }
+
   // Loop through each index of the arrays.
   LlvmIrLoop loop(result_array_type->size(), node_context.entry_builder());
 
   // Compute address of input and output elements.
-  llvm::Type* i32 = llvm::Type::getInt32Ty(ctx());
   llvm::Value* input_element = loop.body_builder().CreateGEP(
       input_type, input_buffer, {llvm::ConstantInt::get(i32, 0), loop.index()});
   llvm::Value* output_element = loop.body_builder().CreateGEP(
@@ -2851,13 +3263,32 @@ absl::Status IrBuilderVisitor::HandleOneHotSel(OneHotSelect* sel) {
   builder->CreateStore(LlvmTypeConverter::ZeroOfType(
                            type_converter()->ConvertToLlvmType(sel->GetType())),
                        output_buffer);
+  // One counter per case plus one counting evaluations of the node.
+  const int64_t case_count = sel->cases().size();
+  const bool instrument = jit_context_.profile_options().instrument;
+  if (instrument) {
+    jit_context_.EmitNodeProfileCount(sel, case_count + 1,
+                                      builder->getInt64(case_count), *builder);
+  }
+  std::optional<absl::Span<const int64_t>> counts =
+      GetProfiledArmCounts(jit_context_, sel, case_count + 1);
   for (int64_t i = 0; i < sel->cases().size(); ++i) {
     // Create a if-then construct where the `then` block is executed if the case
     // is selected. This `then` block ORs in the case value.
     llvm::Value* select_bit = builder->CreateTrunc(
         builder->CreateLShr(selector, i), llvm::Type::getInt1Ty(ctx()));
-    LlvmIfThen if_then =
-        CreateIfThen(select_bit, *builder, absl::StrFormat("case_%d", i));
+    llvm::MDNode* weights =
+        counts.has_value()
+            ? jit_context_.BranchWeights((*counts)[i],
+                                         (*counts)[case_count] - (*counts)[i])
+            : nullptr;
+    LlvmIfThen if_then = CreateIfThen(select_bit, *builder,
+                                      absl::StrFormat("case_%d", i), weights);
+    if (instrument) {
+      jit_context_.EmitNodeProfileCount(sel, case_count + 1,
+                                        if_then.then_builder->getInt64(i),
+                                        *if_then.then_builder);
+    }
     llvm::Value* case_buffer =
         node_context.GetOperandPtr(i + 1, if_then.then_builder.get());
     std::unique_ptr<llvm::IRBuilder<>> b =
@@ -2902,16 +3333,30 @@ absl::Status IrBuilderVisitor::HandlePrioritySel(PrioritySelect* sel) {
   llvm::Function* cttz = llvm::Intrinsic::getOrInsertDeclaration(
       module(), llvm::Intrinsic::cttz, {selector->getType()});
   llvm::Value* selected_index = b.CreateCall(cttz, {selector, llvm_false});
+  const int64_t arm_count = cases.size() + 1;
+  if (jit_context_.profile_options().instrument) {
+    // A zero selector (cttz returns the bit width) picks the default arm.
+    llvm::Value* arm = b.CreateBinaryIntrinsic(
+        llvm::Intrinsic::umin, b.CreateZExt(selected_index, b.getInt64Ty()),
+        b.getInt64(cases.size()));
+    jit_context_.EmitNodeProfileCount(sel, arm_count, arm, b);
+  }
 
   // Sel is implemented by a cascading series of select ops, e.g.,
   // selector == 0 ? cases[0] : selector == 1 ? cases[1] : selector == 2 ? ...
   // Fallthough is the default value.
   llvm::Value* llvm_sel = default_value;
+  std::vector<llvm::Value*> selects(cases.size());
   for (int i = cases.size() - 1; i >= 0; i--) {
     llvm::Value* current_index =
         llvm::ConstantInt::get(selected_index->getType(), i);
     llvm::Value* cmp = b.CreateICmpEQ(selected_index, current_index);
     llvm_sel = b.CreateSelect(cmp, cases.at(i), llvm_sel);
+    selects[i] = llvm_sel;
+  }
+  if (std::optional<absl::Span<const int64_t>> counts =
+          GetProfiledArmCounts(jit_context_, sel, arm_count)) {
+    SetCascadeBranchWeights(jit_context_, selects, *counts);
   }
 
   return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
@@ -2976,10 +3421,24 @@ absl::Status IrBuilderVisitor::HandleSel(Select* sel) {
   // Sel is implemented by a cascading series of select ops, e.g.,
   // selector == 0 ? cases[0] : selector == 1 ? cases[1] : selector == 2 ? ...
   llvm::Value* selector = node_context.LoadOperand(0);
+  const int64_t case_count = sel->cases().size();
+  const int64_t arm_count = case_count + (sel->default_value() ? 1 : 0);
+  if (jit_context_.profile_options().instrument) {
+    // Selector values past the last case all pick the default arm.
+    llvm::Value* arm = b.CreateZExt(selector, b.getInt64Ty());
+    if (sel->default_value()) {
+      arm = b.CreateBinaryIntrinsic(llvm::Intrinsic::umin, arm,
+                                    b.getInt64(case_count));
+    }
+    jit_context_.EmitNodeProfileCount(sel, arm_count, arm, b);
+  }
+
   llvm::Value* llvm_sel =
       sel->default_value()
           ? node_context.GetOperandPtr(sel->operand_count() - 1)
           : nullptr;
+  // selects[i] chooses case `i` over the later arms.
+  std::vector<llvm::Value*> selects(arm_count - 1);
   for (int i = sel->cases().size() - 1; i >= 0; i--) {
     llvm::Value* llvm_case = node_context.GetOperandPtr(i + 1);
     if (llvm_sel == nullptr) {
@@ -2989,8 +3448,13 @@ absl::Status IrBuilderVisitor::HandleSel(Select* sel) {
       llvm::Value* index = llvm::ConstantInt::get(selector->getType(), i);
       llvm::Value* cmp = b.CreateICmpEQ(selector, index);
       llvm_sel = b.CreateSelect(cmp, llvm_case, llvm_sel);
+      selects[i] = llvm_sel;
     }
   }
+  if (std::optional<absl::Span<const int64_t>> counts =
+          GetProfiledArmCounts(jit_context_, sel, arm_count)) {
+    SetCascadeBranchWeights(jit_context_, selects, *counts);
+  }
   return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
                                                  llvm_sel);
 }
@@ -3348,8 +3812,29 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
   // Call the wrapper to JitChannelQueue::Recv.
   llvm::Value* queue_index_value =
       llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), queue_index);
-  return InvokeCallback<InstanceContext::kQueueReceiveWrapperOffset>(
-      builder, bool_type, instance_context, {queue_index_value, output_ptr});
+  if (!jit_context_.packed_channel_payloads()) {
+    return InvokeCallback<InstanceContext::kQueueReceiveWrapperOffset>(
+        builder, bool_type, instance_context, {queue_index_value, output_ptr});
+  }
+  // The queue holds payloads in the packed layout. Receive into a zeroed
+  // scratch buffer and unpack into `output_ptr`. If the receive did not fire
+  // the scratch buffer is still zero so `output_ptr` is zeroed as well.
+  Type* payload_type = receive->GetPayloadType();
+  int64_t packed_size =
+      CeilOfRatio(payload_type->GetFlatBitCount(), int64_t{8});
+  llvm::Value* packed_buffer = builder->CreateAlloca(
+      llvm::ArrayType::get(builder->getInt8Ty(), std::max<int64_t>(
+                                                     packed_size, 1)));
+  builder->CreateMemSet(packed_buffer, builder->getInt8(0), packed_size,
+                        llvm::MaybeAlign(1));
+  llvm::Value* receive_fired =
+      InvokeCallback<InstanceContext::kQueueReceiveWrapperOffset>(
+          builder, bool_type, instance_context,
+          {queue_index_value, packed_buffer});
+  XLS_RETURN_IF_ERROR(UnpackValue(packed_buffer, output_ptr, payload_type,
+                                  /*bit_offset=*/0, *type_converter(),
+                                  builder));
+  return receive_fired;
 }
 
 absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
@@ -3468,6 +3953,19 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
   llvm::Type* void_type = llvm::Type::getVoidTy(ctx());
   llvm::Value* queue_index_value =
       llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()), queue_index);
+  if (jit_context_.packed_channel_payloads()) {
+    // The queue holds payloads in the packed layout.
+    Type* payload_type = send->data()->GetType();
+    int64_t packed_size =
+        CeilOfRatio(payload_type->GetFlatBitCount(), int64_t{8});
+    llvm::Value* packed_buffer = builder->CreateAlloca(
+        llvm::ArrayType::get(builder->getInt8Ty(), std::max<int64_t>(
+                                                       packed_size, 1)));
+    XLS_RETURN_IF_ERROR(PackValue(send_data_ptr, packed_buffer, payload_type,
+                                  /*bit_offset=*/0, *type_converter(),
+                                  builder));
+    send_data_ptr = packed_buffer;
+  }
   InvokeCallback<InstanceContext::kQueueSendWrapperOffset>(
       builder, void_type, instance_context, {queue_index_value, send_data_ptr});
   return absl::OkStatus();
@@ -3543,6 +4041,222 @@ llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                               llvm::MaybeAlign(1), size);
 }
 
+// Unpacks the packed value in `packed_buffer` and writes it to
+// `unpacked_buffer`. `bit_offset` is a value maintained across recursive
+// calls of this function indicating the offset within `packed_buffer` to read
+// the packed value.
+// TODO(meheff): 2022/10/03 Consider loading values in granularity larger than
+// bytes when unpacking values.
+absl::Status UnpackValue(llvm::Value* packed_buffer,
+                         llvm::Value* unpacked_buffer, Type* xls_type,
+                         int64_t bit_offset,
+                         const LlvmTypeConverter& type_converter,
+                         llvm::IRBuilder<>* builder) {
+  if (xls_type->GetFlatBitCount() == 0) {
+    // Zero-width values (e.g., tokens and empty tuples) have no packed bits
+    // and carry no data in the native layout either.
+    return absl::OkStatus();
+  }
+  switch (xls_type->kind()) {
+    case TypeKind::kBits: {
+      // Compute the byte offset into `packed_buffer` where first bit of data
+      // for this Bits value lives.
+      llvm::Type* byte_array_type =
+          llvm::ArrayType::get(llvm::Type::getInt8Ty(builder->getContext()), 0);
+      int64_t byte_offset = FloorOfRatio(bit_offset, int64_t{8});
+      llvm::Value* byte_ptr = builder->CreateGEP(
+          byte_array_type, packed_buffer,
+          {builder->getInt32(0), builder->getInt32(byte_offset)});
+
+      // Determine how many bytes need to be loaded to capture all of the bits
+      // for this Bits value.
+      int64_t remainder = bit_offset - byte_offset * 8;
+      int64_t bytes_to_load =
+          CeilOfRatio(xls_type->GetFlatBitCount() + remainder, int64_t{8});
+
+      // The packed interface has no alignment assumptions, so make accesses
+      // align(1).
+      llvm::Align packed_alignment(1);
+      // Load the bits and shift by the remainder.
+      llvm::Value* loaded_value = builder->CreateLShr(
+          builder->CreateAlignedLoad(
+              builder->getIntNTy(static_cast<unsigned int>(bytes_to_load * 8)),
+              byte_ptr, packed_alignment),
+          remainder);
+
+      // Convert to the native type and mask off any extra bits.
+      llvm::Value* value = builder->CreateAnd(
+          type_converter.PaddingMask(xls_type, *builder),
+          builder->CreateIntCast(loaded_value,
+                                 type_converter.ConvertToLlvmType(xls_type),
+                                 /*isSigned=*/false));
+      builder->CreateStore(value, unpacked_buffer);
+      return absl::OkStatus();
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = xls_type->AsArrayOrDie();
+      Type* element_xls_type = array_type->element_type();
+      llvm::Type* array_llvm_type =
+          type_converter.ConvertToLlvmType(array_type);
+      for (uint32_t i = 0; i < array_type->size(); i++) {
+        llvm::Value* unpacked_element_ptr =
+            builder->CreateGEP(array_llvm_type, unpacked_buffer,
+                               {
+                                   builder->getInt32(0),
+                                   builder->getInt32(i),
+                               });
+        XLS_RETURN_IF_ERROR(UnpackValue(packed_buffer, unpacked_element_ptr,
+                                        element_xls_type, bit_offset,
+                                        type_converter, builder));
+        bit_offset += element_xls_type->GetFlatBitCount();
+      }
+      return absl::OkStatus();
+    }
+    case TypeKind::kTuple: {
+      TupleType* tuple_type = xls_type->AsTupleOrDie();
+      llvm::Type* tuple_llvm_type =
+          type_converter.ConvertToLlvmType(tuple_type);
+      for (int32_t i = tuple_type->size() - 1; i >= 0; i--) {
+        // Tuple elements are stored MSB -> LSB, so we need to extract in
+        // reverse order to match native layout.
+        Type* element_type = tuple_type->element_type(i);
+        llvm::Value* unpacked_element_ptr =
+            builder->CreateGEP(tuple_llvm_type, unpacked_buffer,
+                               {
+                                   builder->getInt32(0),
+                                   builder->getInt32(i),
+                               });
+        XLS_RETURN_IF_ERROR(UnpackValue(packed_buffer, unpacked_element_ptr,
+                                        element_type, bit_offset,
+                                        type_converter, builder));
+        bit_offset += element_type->GetFlatBitCount();
+      }
+      return absl::OkStatus();
+    }
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unhandled type kind: ", TypeKindToString(xls_type->kind())));
+  }
+}
+
+// Loads the value in `unpacked_buffer`, packs it and writes it to
+// `packed_buffer`. `bit_offset` is a value maintained across recursive calls of
+// this function indicating the offset within `packed_buffer` to wite the packed
+// value.
+absl::Status PackValue(llvm::Value* unpacked_buffer, llvm::Value* packed_buffer,
+                       Type* xls_type, int64_t bit_offset,
+                       const LlvmTypeConverter& type_converter,
+                       llvm::IRBuilder<>* builder) {
+  if (xls_type->GetFlatBitCount() == 0) {
+    return absl::OkStatus();
+  }
+  switch (xls_type->kind()) {
+    case TypeKind::kBits: {
+      // Compute the byte offset into `packed_buffer` where this data should be
+      // written to.
+      llvm::Type* byte_array_type =
+          llvm::ArrayType::get(llvm::Type::getInt8Ty(builder->getContext()), 0);
+      int64_t byte_offset = FloorOfRatio(bit_offset, int64_t{8});
+      llvm::Value* byte_ptr = builder->CreateGEP(
+          byte_array_type, packed_buffer,
+          {builder->getInt32(0), builder->getInt32(byte_offset)});
+
+      // Determine how many bytes will be touched when writing this Bits value.
+      int64_t remainder = bit_offset - byte_offset * 8;
+      int64_t bytes_to_load =
+          CeilOfRatio(xls_type->GetFlatBitCount() + remainder, int64_t{8});
+      llvm::IntegerType* loaded_type = builder->getIntNTy(bytes_to_load * 8);
+
+      // Load the unpacked value and cast it to the type used for loading and
+      // storing to the packed buffer.
+      llvm::Value* unpacked_value = builder->CreateIntCast(
+          builder->CreateLoad(type_converter.ConvertToLlvmType(xls_type),
+                              unpacked_buffer),
+          loaded_type, /*isSigned=*/false);
+
+      // The packed interface has no alignment assumptions, so make accesses
+      // align(1).
+      llvm::Align packed_alignment(1);
+      if (remainder == 0) {
+        // The packed value is on a byte boundary. Just write the value into the
+        // buffer.
+        builder->CreateAlignedStore(unpacked_value, byte_ptr, packed_alignment);
+      } else {
+        // Packed value is not on a byte boundary. Load in the packed value at
+        // the location and do some masking and shifting. First load the packed
+        // bits in the location to be written to.
+        llvm::Value* loaded_packed_value =
+            builder->CreateAlignedLoad(loaded_type, byte_ptr, packed_alignment);
+
+        // Mask off any beyond the remainder bits.
+        llvm::Value* remainder_mask =
+            builder->CreateLShr(llvm::ConstantInt::getSigned(loaded_type, -1),
+                                loaded_type->getBitWidth() - remainder);
+        llvm::Value* masked_loaded_packed_value =
+            builder->CreateAnd(remainder_mask, loaded_packed_value);
+
+        // Shift the unpacked value over by the remainder.
+        llvm::Value* shifted_unpacked_value =
+            builder->CreateShl(unpacked_value, remainder);
+
+        // Or the value to write with the existing bits in the loaded value.
+        llvm::Value* value = builder->CreateOr(shifted_unpacked_value,
+                                               masked_loaded_packed_value);
+        builder->CreateAlignedStore(value, byte_ptr, packed_alignment);
+      }
+      return absl::OkStatus();
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = xls_type->AsArrayOrDie();
+      Type* element_xls_type = array_type->element_type();
+      llvm::Type* array_llvm_type =
+          type_converter.ConvertToLlvmType(array_type);
+      for (uint32_t i = 0; i < array_type->size(); i++) {
+        llvm::Value* unpacked_element_ptr =
+            builder->CreateGEP(array_llvm_type, unpacked_buffer,
+                               {
+                                   builder->getInt32(0),
+                                   builder->getInt32(i),
+                               });
+        XLS_RETURN_IF_ERROR(PackValue(unpacked_element_ptr, packed_buffer,
+                                      element_xls_type, bit_offset,
+                                      type_converter, builder));
+        bit_offset += element_xls_type->GetFlatBitCount();
+      }
+      return absl::OkStatus();
+    }
+    case TypeKind::kTuple: {
+      // Write the unpacked elements into the buffer one-by-one.
+      TupleType* tuple_type = xls_type->AsTupleOrDie();
+      llvm::Type* tuple_llvm_type =
+          type_converter.ConvertToLlvmType(tuple_type);
+      for (int32_t i = tuple_type->size() - 1; i >= 0; i--) {
+        // Tuple elements are stored MSB -> LSB, so we need to extract in
+        // reverse order to match native layout.
+        Type* element_type = tuple_type->element_type(i);
+        llvm::Value* unpacked_element_ptr =
+            builder->CreateGEP(tuple_llvm_type, unpacked_buffer,
+                               {
+                                   builder->getInt32(0),
+                                   builder->getInt32(i),
+                               });
+        XLS_RETURN_IF_ERROR(PackValue(unpacked_element_ptr, packed_buffer,
+                                      element_type, bit_offset, type_converter,
+                                      builder));
+        bit_offset += element_type->GetFlatBitCount();
+      }
+      return absl::OkStatus();
+    }
+    case TypeKind::kToken: {
+      // Tokens are zero-bit constructs, so there's nothing to do!
+      return absl::OkStatus();
+    }
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unhandled element kind: ", TypeKindToString(xls_type->kind())));
+  }
+}
+
 absl::StatusOr<NodeFunction> CreateNodeFunction(
     Node* node, int64_t output_arg_count,
     const JitCompilationMetadata& metadata, JitBuilderContext& jit_context) {
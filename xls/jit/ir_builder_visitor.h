@@ -27,11 +27,14 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/GlobalVariable.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Metadata.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
 
@@ -46,12 +49,19 @@ bool ShouldMaterializeAtUse(Node* node);
 // etc.
 class JitBuilderContext {
  public:
-  explicit JitBuilderContext(LlvmCompiler& llvm_compiler, FunctionBase* top)
+  // If `packed_channel_payloads` is true the data sent and received on
+  // channel queues is in the packed layout (see TypeLayout).
+  explicit JitBuilderContext(
+      LlvmCompiler& llvm_compiler, FunctionBase* top,
+      const JitProfileOptions& profile_options = JitProfileOptions(),
+      bool packed_channel_payloads = false)
       : module_(llvm_compiler.NewModule("__module")),
         llvm_compiler_(llvm_compiler),
         top_(top),
         type_converter_(llvm_compiler_.GetContext(),
-                        llvm_compiler_.CreateDataLayout().value()) {
+                        llvm_compiler_.CreateDataLayout().value()),
+        profile_options_(profile_options),
+        packed_channel_payloads_(packed_channel_payloads) {
     CHECK_EQ(module_->getTargetTriple().str(), llvm_compiler_.target_triple());
   }
 
@@ -101,7 +111,44 @@ class JitBuilderContext {
     return absl::StrFormat("%s____SUBROUTINE_OF_%s", f->name(), top()->name());
   }
 
+  const JitProfileOptions& profile_options() const { return profile_options_; }
+
+  bool packed_channel_payloads() const { return packed_channel_payloads_; }
+
+  // Emits code which increments the `arm`-th profile counter of `node`.
+  // `arm_count` counters are allocated for the node on first use. Must only be
+  // called if profile_options().instrument is set.
+  void EmitNodeProfileCount(const Node* node, int64_t arm_count,
+                            llvm::Value* arm, llvm::IRBuilder<>& builder);
+
+  // Emits code which increments the `exited` (an i1) or continued counter of
+  // the given early exit point. Must only be called if
+  // profile_options().instrument is set.
+  void EmitEarlyExitProfileCount(int64_t early_exit_id, llvm::Value* exited,
+                                 llvm::IRBuilder<>& builder);
+
+  // Returns branch weight metadata for a branch which was taken `taken` times
+  // and not taken `not_taken` times. Returns nullptr if both are zero.
+  llvm::MDNode* BranchWeights(int64_t taken, int64_t not_taken);
+
+  // Defines the global variable holding the profile counters. Must be called
+  // after all counters have been emitted and before the module is consumed.
+  // Does nothing if no counters were emitted.
+  void FinalizeProfileCounters();
+
+  // Name of the global variable holding the profile counters.
+  std::string ProfileCountersName() const {
+    return absl::StrFormat("__%s_profile_counters", top()->name());
+  }
+  const JitProfileCounterLayout& profile_counter_layout() const {
+    return profile_counter_layout_;
+  }
+
  private:
+  // Returns a pointer to the `index`-th profile counter.
+  llvm::Value* GetProfileCounterPtr(llvm::Value* index,
+                                    llvm::IRBuilder<>& builder);
+
   std::unique_ptr<llvm::Module> module_;
   LlvmCompiler& llvm_compiler_;
   FunctionBase* top_;
@@ -112,6 +159,14 @@ class JitBuilderContext {
 
   // A map from channel name to queue index.
   absl::btree_map<std::string, int64_t> queue_indices_;
+
+  JitProfileOptions profile_options_;
+  bool packed_channel_payloads_;
+  JitProfileCounterLayout profile_counter_layout_;
+  // Declaration of the profile counter array referenced by the instrumented
+  // code. Replaced with a definition of the final size by
+  // FinalizeProfileCounters.
+  llvm::GlobalVariable* profile_counters_ = nullptr;
 };
 
 // Abstraction representing an llvm::Function implementing an xls::Node. The
@@ -177,6 +232,24 @@ absl::StatusOr<NodeFunction> CreateNodeFunction(
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder);
 
+// Emits code which unpacks the value of type `xls_type` at bit `bit_offset` of
+// the packed-layout buffer `packed_buffer` and stores it in native layout to
+// `unpacked_buffer`.
+absl::Status UnpackValue(llvm::Value* packed_buffer,
+                         llvm::Value* unpacked_buffer, Type* xls_type,
+                         int64_t bit_offset,
+                         const LlvmTypeConverter& type_converter,
+                         llvm::IRBuilder<>* builder);
+
+// Emits code which loads the native-layout value of type `xls_type` in
+// `unpacked_buffer` and writes it to bit `bit_offset` of the packed-layout
+// buffer `packed_buffer`. Values must be packed in order of increasing bit
+// offset as bits above the written value in its last byte are cleared.
+absl::Status PackValue(llvm::Value* unpacked_buffer, llvm::Value* packed_buffer,
+                       Type* xls_type, int64_t bit_offset,
+                       const LlvmTypeConverter& type_converter,
+                       llvm::IRBuilder<>* builder);
+
 }  // namespace xls
 
 #endif  // XLS_JIT_IR_BUILDER_VISITOR_H_
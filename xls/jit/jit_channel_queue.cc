@@ -19,9 +19,12 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/memory/memory.h"
@@ -30,7 +33,12 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -39,30 +47,69 @@
 namespace xls {
 namespace {
 
-void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
-                       ByteQueue& queue) {
-  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
-      queue.element_size());
-  runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
-  queue.Write(buffer.data());
+absl::StatusOr<ChannelInstance*> GetChannelInstance(
+    const ProcElaboration& elaboration, ProcInstance* proc_instance,
+    std::string_view channel_name) {
+  if (proc_instance->path().has_value()) {
+    // New-style proc-scoped channels.
+    return elaboration.GetChannelInstance(channel_name,
+                                          *proc_instance->path());
+  }
+  // Old-style global channels.
+  XLS_ASSIGN_OR_RETURN(
+      Channel * channel,
+      proc_instance->proc()->package()->GetChannel(channel_name));
+  return elaboration.GetUniqueInstance(channel);
 }
 
-std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
-                                        ByteQueue& queue) {
-  std::vector<uint8_t> buffer(queue.element_size());
-  if (!queue.Read(buffer.data())) {
-    return std::nullopt;
+// Returns the channel instances which are provably accessed by exactly one
+// sending and one receiving proc instance in the elaboration and nothing else.
+absl::StatusOr<absl::flat_hash_set<ChannelInstance*>>
+GetSingleProducerSingleConsumerChannels(const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      senders;
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      receivers;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          ChannelInstance * channel_instance,
+          GetChannelInstance(elaboration, proc_instance,
+                             node->As<ChannelNode>()->channel_name()));
+      (node->Is<Send>() ? senders : receivers)[channel_instance].insert(
+          proc_instance);
+    }
+  }
+  absl::flat_hash_set<ChannelInstance*> result;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    Channel* channel = channel_instance->channel;
+    // Channels on the interface of the network are also accessed by whatever
+    // drives the network (e.g., a testbench).
+    if (channel->kind() != ChannelKind::kStreaming ||
+        channel->supported_ops() != ChannelOps::kSendReceive ||
+        elaboration.IsTopInterfaceChannel(channel_instance)) {
+      continue;
+    }
+    auto sender_it = senders.find(channel_instance);
+    auto receiver_it = receivers.find(channel_instance);
+    if (sender_it != senders.end() && sender_it->second.size() == 1 &&
+        receiver_it != receivers.end() && receiver_it->second.size() == 1) {
+      result.insert(channel_instance);
+    }
   }
-  return runtime.UnpackBuffer(buffer.data(), type);
+  return result;
 }
 
 }  // namespace
 
-ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
+ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value,
+                     int64_t element_alignment)
     : channel_element_size_(channel_element_size),
       allocated_element_size_(
-          RoundUpToNearest(channel_element_size,
-                           static_cast<int64_t>(alignof(std::max_align_t)))),
+          RoundUpToNearest(channel_element_size, element_alignment)),
       is_single_value_(is_single_value) {
   // Special case to handle empty tuples. Assigning the allocated element size
   // to one serves as a tangible instance for the number of elements within the
@@ -102,21 +149,52 @@ void ByteQueue::Resize() {
   }
 }
 
+JitChannelQueue::JitChannelQueue(ChannelInstance* channel,
+                                 JitRuntime* jit_runtime, bool packed_payloads)
+    : ChannelQueue(channel), jit_runtime_(jit_runtime) {
+  if (packed_payloads) {
+    packed_layout_ = jit_runtime->CreateTypeLayout(channel->channel->type());
+    raw_element_size_ = packed_layout_->packed_size();
+  } else {
+    raw_element_size_ = jit_runtime->GetTypeByteSize(channel->channel->type());
+  }
+}
+
+Value JitChannelQueue::RawToValue(const uint8_t* data) const {
+  if (packed_layout_.has_value()) {
+    return packed_layout_->PackedLayoutToValue(data);
+  }
+  return jit_runtime_->UnpackBuffer(data, channel()->type());
+}
+
+void JitChannelQueue::ValueToRaw(const Value& value,
+                                 absl::Span<uint8_t> buffer) const {
+  if (packed_layout_.has_value()) {
+    packed_layout_->ValueToPackedLayout(value, buffer.data());
+    return;
+  }
+  jit_runtime_->BlitValueToBuffer(value, channel()->type(), buffer);
+}
+
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
 void ThreadSafeJitChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      raw_element_size());
+  ValueToRaw(value, absl::MakeSpan(buffer));
+  byte_queue_.Write(buffer.data());
 }
 
 std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
-  std::optional<Value> value =
-      ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
-  if (value.has_value()) {
-    CallReadCallbacks(value.value());
+  std::vector<uint8_t> buffer(raw_element_size());
+  if (!byte_queue_.Read(buffer.data())) {
+    return std::nullopt;
   }
+  Value value = RawToValue(buffer.data());
+  CallReadCallbacks(value);
   return value;
 }
 
@@ -126,56 +204,142 @@ int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
 
 void ThreadUnsafeJitChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      raw_element_size());
+  ValueToRaw(value, absl::MakeSpan(buffer));
+  byte_queue_.Write(buffer.data());
 }
 
 std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
-  std::optional<Value> value =
-      ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
-  if (value.has_value()) {
-    CallReadCallbacks(value.value());
+  std::vector<uint8_t> buffer(raw_element_size());
+  if (!byte_queue_.Read(buffer.data())) {
+    return std::nullopt;
+  }
+  Value value = RawToValue(buffer.data());
+  CallReadCallbacks(value);
+  return value;
+}
+
+SpscJitChannelQueue::SpscJitChannelQueue(ChannelInstance* channel_instance,
+                                         JitRuntime* jit_runtime,
+                                         bool packed_payloads)
+    : JitChannelQueue(channel_instance, jit_runtime, packed_payloads),
+      element_size_(raw_element_size()),
+      // Native elements are aligned to the largest scalar type, packed
+      // elements are stored back-to-back. Zero-width elements (empty tuples)
+      // still occupy one byte to keep indexing uniform.
+      element_stride_(std::max<int64_t>(
+          RoundUpToNearest(element_size_, raw_element_alignment()), 1)) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming)
+      << "SpscJitChannelQueue only supports streaming channels";
+  head_ = tail_ = new Ring(/*start=*/0, kInitialCapacity, element_stride_);
+}
+
+SpscJitChannelQueue::~SpscJitChannelQueue() {
+  Ring* ring = head_;
+  while (ring != nullptr) {
+    Ring* next = ring->next.load(std::memory_order_relaxed);
+    delete ring;
+    ring = next;
+  }
+}
+
+void SpscJitChannelQueue::Grow(int64_t index) {
+  Ring* ring = new Ring(/*start=*/index, 2 * (tail_->mask + 1), element_stride_);
+  // Publishing `ring` happens before the write counter passes `index` so the
+  // consumer always finds the ring before it needs to read from it.
+  tail_->next.store(ring, std::memory_order_release);
+  tail_ = ring;
+}
+
+void SpscJitChannelQueue::AdvanceHead(int64_t index) {
+  Ring* next = head_->next.load(std::memory_order_acquire);
+  while (next != nullptr && index >= next->start) {
+    // The producer never touches a ring again once it has linked in the next
+    // one so the consumer may free it.
+    delete head_;
+    head_ = next;
+    next = head_->next.load(std::memory_order_acquire);
+  }
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  // Load the read counter first so the result is never negative.
+  int64_t read_count = read_count_.load(std::memory_order_acquire);
+  return write_count_.load(std::memory_order_acquire) - read_count;
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  CallWriteCallbacks(value);
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  ValueToRaw(value, absl::MakeSpan(buffer));
+  Push(buffer.data());
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  std::vector<uint8_t> buffer(element_size_);
+  if (!Pop(buffer.data())) {
+    return std::nullopt;
   }
+  Value value = RawToValue(buffer.data());
+  CallReadCallbacks(value);
   return value;
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package,
-                                         std::unique_ptr<JitRuntime> runtime) {
+                                         std::unique_ptr<JitRuntime> runtime,
+                                         bool packed_payloads) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateThreadSafe(std::move(elaboration), std::move(runtime));
+  return CreateThreadSafe(std::move(elaboration), std::move(runtime),
+                          packed_payloads);
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(ProcElaboration&& elaboration,
-                                         std::unique_ptr<JitRuntime> runtime) {
+                                         std::unique_ptr<JitRuntime> runtime,
+                                         bool packed_payloads) {
+  XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<ChannelInstance*> spsc_channels,
+                       GetSingleProducerSingleConsumerChannels(elaboration));
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
-        channel_instance, runtime.get()));
+    if (spsc_channels.contains(channel_instance)) {
+      queues.push_back(std::make_unique<SpscJitChannelQueue>(
+          channel_instance, runtime.get(), packed_payloads));
+    } else {
+      queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
+          channel_instance, runtime.get(), packed_payloads));
+    }
   }
-  return absl::WrapUnique(new JitChannelQueueManager(
-      std::move(elaboration), std::move(queues), std::move(runtime)));
+  return absl::WrapUnique(
+      new JitChannelQueueManager(std::move(elaboration), std::move(queues),
+                                 std::move(runtime), packed_payloads));
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadUnsafe(
-    Package* package, std::unique_ptr<JitRuntime> runtime) {
+    Package* package, std::unique_ptr<JitRuntime> runtime,
+    bool packed_payloads) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateThreadUnsafe(std::move(elaboration), std::move(runtime));
+  return CreateThreadUnsafe(std::move(elaboration), std::move(runtime),
+                            packed_payloads);
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadUnsafe(
-    ProcElaboration&& elaboration, std::unique_ptr<JitRuntime> runtime) {
+    ProcElaboration&& elaboration, std::unique_ptr<JitRuntime> runtime,
+    bool packed_payloads) {
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
     queues.push_back(std::make_unique<ThreadUnsafeJitChannelQueue>(
-        channel_instance, runtime.get()));
+        channel_instance, runtime.get(), packed_payloads));
   }
-  return absl::WrapUnique(new JitChannelQueueManager(
-      std::move(elaboration), std::move(queues), std::move(runtime)));
+  return absl::WrapUnique(
+      new JitChannelQueueManager(std::move(elaboration), std::move(queues),
+                                 std::move(runtime), packed_payloads));
 }
 
 JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
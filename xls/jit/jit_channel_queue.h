@@ -14,6 +14,9 @@
 #ifndef XLS_JIT_JIT_CHANNEL_QUEUE_H_
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -21,16 +24,19 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -42,8 +48,10 @@ class ByteQueue {
   // indicates whether this queue follows single-value channel semantics where
   // the queue only holds a single value; writes overwrite the value in the
   // queue and reads are non-destructive. If `is_single_value` is false then the
-  // queue has FIFO semantics.
-  ByteQueue(int64_t channel_element_size, bool is_single_value);
+  // queue has FIFO semantics. Elements are stored at multiples of
+  // `element_alignment` bytes.
+  ByteQueue(int64_t channel_element_size, bool is_single_value,
+            int64_t element_alignment = alignof(std::max_align_t));
 
   int64_t element_size() const { return channel_element_size_; }
 
@@ -94,7 +102,7 @@ class ByteQueue {
   // Size of an element in the channel in units of bytes.
   int64_t channel_element_size_ = 0;
   // Allocated size of an element in the circular buffer in units of bytes. The
-  // elements are aligned to the largest scalar type.
+  // elements are aligned to the element alignment given at construction.
   int64_t allocated_element_size_ = 0;
   // TODO(vmirian): 8-09-2022 Place the following guarded members on a single
   // cache line for optimal performance.
@@ -115,17 +123,39 @@ class ByteQueue {
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
+//
+// By default the raw bytes are a value in LLVM's native layout. If
+// `packed_payloads` is true the raw bytes are in the packed layout of the
+// channel type instead (see TypeLayout) and each element occupies only
+// `raw_element_size()` bytes with no alignment padding. Procs must be compiled
+// with JitProcLayoutOptions::packed_channel_payloads to use such queues.
 class JitChannelQueue : public ChannelQueue {
  public:
-  JitChannelQueue(ChannelInstance* channel, JitRuntime* jit_runtime)
-      : ChannelQueue(channel), jit_runtime_(jit_runtime) {}
+  JitChannelQueue(ChannelInstance* channel, JitRuntime* jit_runtime,
+                  bool packed_payloads = false);
   ~JitChannelQueue() override = default;
 
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  bool packed_payloads() const { return packed_layout_.has_value(); }
+
+  // The number of bytes read or written by each ReadRaw/WriteRaw call.
+  int64_t raw_element_size() const { return raw_element_size_; }
+
  protected:
+  // Alignment of the elements in the underlying storage.
+  int64_t raw_element_alignment() const {
+    return packed_payloads() ? 1 : alignof(std::max_align_t);
+  }
+
+  // Converts between Values and the raw representation of the elements.
+  Value RawToValue(const uint8_t* data) const;
+  void ValueToRaw(const Value& value, absl::Span<uint8_t> buffer) const;
+
   JitRuntime* jit_runtime_;
+  std::optional<TypeLayout> packed_layout_;
+  int64_t raw_element_size_;
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -133,24 +163,28 @@ class JitChannelQueue : public ChannelQueue {
 class ThreadSafeJitChannelQueue : public JitChannelQueue {
  public:
   ThreadSafeJitChannelQueue(ChannelInstance* channel_instance,
-                            JitRuntime* jit_runtime)
-      : JitChannelQueue(channel_instance, jit_runtime),
+                            JitRuntime* jit_runtime,
+                            bool packed_payloads = false)
+      : JitChannelQueue(channel_instance, jit_runtime, packed_payloads),
         byte_queue_(
-            jit_runtime->GetTypeByteSize(channel_instance->channel->type()),
-            channel_instance->channel->kind() == ChannelKind::kSingleValue) {}
+            raw_element_size(),
+            channel_instance->channel->kind() == ChannelKind::kSingleValue,
+            raw_element_alignment()) {}
   ~ThreadSafeJitChannelQueue() override = default;
 
-  // Write raw bytes representing a value in LLVM's native format.
+  // Write raw bytes representing a value in LLVM's native format (or the
+  // packed format if `packed_payloads()`).
   void WriteRaw(const uint8_t* data) override {
     absl::MutexLock lock(&mutex_);
     byte_queue_.Write(data);
     if (!callbacks_.empty()) {
-      CallWriteCallbacks(jit_runtime_->UnpackBuffer(data, channel()->type()));
+      CallWriteCallbacks(RawToValue(data));
     }
   }
 
-  // Reads raw bytes representing a value in LLVM's native format. Returns
-  // true if queue was not empty and data was read.
+  // Reads raw bytes representing a value in LLVM's native format (or the
+  // packed format if `packed_payloads()`). Returns true if queue was not empty
+  // and data was read.
   bool ReadRaw(uint8_t* buffer) override {
     absl::MutexLock lock(&mutex_);
     if (generator_.has_value()) {
@@ -161,7 +195,7 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
     }
     bool value_read = byte_queue_.Read(buffer);
     if (value_read && !callbacks_.empty()) {
-      CallReadCallbacks(jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+      CallReadCallbacks(RawToValue(buffer));
     }
     return value_read;
   }
@@ -180,17 +214,19 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
 class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
  public:
   ThreadUnsafeJitChannelQueue(ChannelInstance* channel_instance,
-                              JitRuntime* jit_runtime)
-      : JitChannelQueue(channel_instance, jit_runtime),
+                              JitRuntime* jit_runtime,
+                              bool packed_payloads = false)
+      : JitChannelQueue(channel_instance, jit_runtime, packed_payloads),
         byte_queue_(
-            jit_runtime->GetTypeByteSize(channel_instance->channel->type()),
-            channel_instance->channel->kind() == ChannelKind::kSingleValue) {}
+            raw_element_size(),
+            channel_instance->channel->kind() == ChannelKind::kSingleValue,
+            raw_element_alignment()) {}
   ~ThreadUnsafeJitChannelQueue() override = default;
 
   void WriteRaw(const uint8_t* data) override {
     byte_queue_.Write(data);
     if (!callbacks_.empty()) {
-      CallWriteCallbacks(jit_runtime_->UnpackBuffer(data, channel()->type()));
+      CallWriteCallbacks(RawToValue(data));
     }
   }
   bool ReadRaw(uint8_t* buffer) override {
@@ -202,7 +238,7 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
     }
     bool value_read = byte_queue_.Read(buffer);
     if (value_read && !callbacks_.empty()) {
-      CallReadCallbacks(jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+      CallReadCallbacks(RawToValue(buffer));
     }
     return value_read;
   }
@@ -215,37 +251,179 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A lock-free JIT channel queue for streaming channels with a single producer
+// and a single consumer.
+//
+// Elements are stored in a chain of power-of-two sized ring buffers. The
+// producer writes into the newest ring and, when it fills up, links in a new
+// ring of twice the capacity rather than moving existing elements. The consumer
+// drains rings in order and frees each one once it has moved past it. The only
+// synchronization between the two sides is a pair of monotonically increasing
+// element counters (plus the link to the next ring) so neither side ever
+// blocks.
+//
+// At most one thread may write (WriteRaw/Write) and at most one thread may read
+// (ReadRaw/Read) at any time; accesses from different threads on the same side
+// must be ordered externally (e.g., by the proc runtime scheduler). GetSize may
+// be called from any thread. Callbacks and generators are supported with the
+// same caveats as ThreadUnsafeJitChannelQueue. Single-value channels are not
+// supported.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  SpscJitChannelQueue(ChannelInstance* channel_instance,
+                      JitRuntime* jit_runtime, bool packed_payloads = false);
+  ~SpscJitChannelQueue() override;
+
+  void WriteRaw(const uint8_t* data) override {
+    Push(data);
+    if (!callbacks_.empty()) {
+      CallWriteCallbacks(RawToValue(data));
+    }
+  }
+  bool ReadRaw(uint8_t* buffer) override {
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    bool value_read = Pop(buffer);
+    if (value_read && !callbacks_.empty()) {
+      CallReadCallbacks(RawToValue(buffer));
+    }
+    return value_read;
+  }
+
+  // Number of elements the first ring buffer can hold.
+  static constexpr int64_t kInitialCapacity = 64;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  struct Ring {
+    Ring(int64_t start, int64_t capacity, int64_t element_stride)
+        : start(start),
+          mask(capacity - 1),
+          data(new uint8_t[capacity * element_stride]) {}
+
+    // Index (in the global sequence of elements written to the queue) of the
+    // first element written to this ring.
+    const int64_t start;
+    // Capacity of the ring (a power of two) minus one.
+    const int64_t mask;
+    std::unique_ptr<uint8_t[]> data;
+    // The ring the producer moved on to after this one filled up.
+    std::atomic<Ring*> next = nullptr;
+  };
+
+  void Push(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, element_size_);
+#endif
+    int64_t index = write_count_.load(std::memory_order_relaxed);
+    if (index - std::max(cached_read_count_, tail_->start) > tail_->mask) {
+      cached_read_count_ = read_count_.load(std::memory_order_acquire);
+      if (index - std::max(cached_read_count_, tail_->start) > tail_->mask) {
+        Grow(index);
+      }
+    }
+    memcpy(tail_->data.get() +
+               ((index - tail_->start) & tail_->mask) * element_stride_,
+           data, element_size_);
+    write_count_.store(index + 1, std::memory_order_release);
+  }
+
+  bool Pop(uint8_t* buffer) {
+    int64_t index = read_count_.load(std::memory_order_relaxed);
+    if (index == cached_write_count_) {
+      cached_write_count_ = write_count_.load(std::memory_order_acquire);
+      if (index == cached_write_count_) {
+        return false;
+      }
+    }
+    Ring* next = head_->next.load(std::memory_order_acquire);
+    if (next != nullptr && index >= next->start) {
+      AdvanceHead(index);
+    }
+    memcpy(buffer,
+           head_->data.get() +
+               ((index - head_->start) & head_->mask) * element_stride_,
+           element_size_);
+    read_count_.store(index + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Links a new ring of twice the capacity for elements starting at `index`.
+  // Called by the producer when the current ring is full.
+  void Grow(int64_t index);
+
+  // Frees rings which have been completely consumed so that the ring holding
+  // element `index` becomes the head. Called by the consumer.
+  void AdvanceHead(int64_t index);
+
+  const int64_t element_size_;
+  const int64_t element_stride_;
+
+  // State owned by the consumer.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> read_count_ = 0;
+  Ring* head_;
+  int64_t cached_write_count_ = 0;
+
+  // State owned by the producer.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> write_count_ = 0;
+  Ring* tail_;
+  int64_t cached_read_count_ = 0;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   ~JitChannelQueueManager() override = default;
 
   // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // queues. The thread-safe factories use a SpscJitChannelQueue for every
+  // streaming channel instance which the elaboration proves has exactly one
+  // sending and one receiving proc instance (and is not on the top-level
+  // interface) and a ThreadSafeJitChannelQueue for all others. If
+  // `packed_payloads` is true all queues hold their elements in the packed
+  // layout (see JitChannelQueue).
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
-  CreateThreadSafe(Package* package, std::unique_ptr<JitRuntime> runtime);
+  CreateThreadSafe(Package* package, std::unique_ptr<JitRuntime> runtime,
+                   bool packed_payloads = false);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(ProcElaboration&& elaboration,
-                   std::unique_ptr<JitRuntime> runtime);
+                   std::unique_ptr<JitRuntime> runtime,
+                   bool packed_payloads = false);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
-  CreateThreadUnsafe(Package* package, std::unique_ptr<JitRuntime> runtime);
+  CreateThreadUnsafe(Package* package, std::unique_ptr<JitRuntime> runtime,
+                     bool packed_payloads = false);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadUnsafe(ProcElaboration&& elaboration,
-                     std::unique_ptr<JitRuntime> runtime);
+                     std::unique_ptr<JitRuntime> runtime,
+                     bool packed_payloads = false);
 
   JitChannelQueue& GetJitQueue(Channel* channel);
   JitChannelQueue& GetJitQueue(ChannelInstance* channel_instance);
 
   JitRuntime& runtime() { return *runtime_; }
 
+  // Whether the queues hold their elements in the packed layout.
+  bool packed_payloads() const { return packed_payloads_; }
+
  protected:
   JitChannelQueueManager(ProcElaboration elaboration,
                          std::vector<std::unique_ptr<ChannelQueue>>&& queues,
-                         std::unique_ptr<JitRuntime> runtime)
+                         std::unique_ptr<JitRuntime> runtime,
+                         bool packed_payloads)
       : ChannelQueueManager(std::move(elaboration), std::move(queues)),
-        runtime_(std::move(runtime)) {}
+        runtime_(std::move(runtime)),
+        packed_payloads_(packed_payloads) {}
 
   std::unique_ptr<JitRuntime> runtime_;
+  bool packed_payloads_;
 };
 
 }  // namespace xls
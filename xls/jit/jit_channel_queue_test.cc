@@ -25,12 +25,16 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
@@ -68,7 +72,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -181,5 +186,183 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, ManyElementsInterleaved) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+
+  // Interleave writes and reads so the occupancy grows past the initial
+  // capacity of the queue while the read position is in the middle of it.
+  uint64_t next_write = 0;
+  uint64_t next_read = 0;
+  for (int64_t round = 0; round < 50; ++round) {
+    for (int64_t i = 0; i < 3 * round; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&next_write));
+      ++next_write;
+    }
+    for (int64_t i = 0; i < round; ++i) {
+      uint64_t value;
+      ASSERT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+      EXPECT_EQ(value, next_read++);
+    }
+    EXPECT_EQ(queue.GetSize(), static_cast<int64_t>(next_write - next_read));
+  }
+  uint64_t value;
+  while (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+    EXPECT_EQ(value, next_read++);
+  }
+  EXPECT_EQ(next_read, next_write);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TYPED_TEST(JitChannelQueueTest, PackedPayloads) {
+  Package package("test");
+  // (bits[1], bits[3]) occupies a single byte in the packed layout.
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(1), package.GetBitsType(3)});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     type));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime(), /*packed_payloads=*/true);
+  EXPECT_TRUE(queue.packed_payloads());
+  EXPECT_EQ(queue.raw_element_size(), 1);
+
+  std::vector<Value> written;
+  for (int64_t i = 0; i < 100; ++i) {
+    Value value =
+        Value::Tuple({Value(UBits(i % 2, 1)), Value(UBits(i % 8, 3))});
+    written.push_back(value);
+    if (i % 2 == 0) {
+      XLS_ASSERT_OK(queue.Write(value));
+    } else {
+      // Element 1 of the tuple is in the least significant bits.
+      uint8_t packed = ((i % 2) << 3) | (i % 8);
+      queue.WriteRaw(&packed);
+    }
+  }
+  for (int64_t i = 0; i < 100; ++i) {
+    if (i % 2 == 0) {
+      uint8_t packed;
+      ASSERT_TRUE(queue.ReadRaw(&packed));
+      EXPECT_EQ(packed, ((i % 2) << 3) | (i % 8));
+    } else {
+      EXPECT_EQ(queue.Read(), written[i]);
+    }
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  SpscJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                            GetJitRuntime());
+
+  constexpr uint64_t kCount = 200000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, SpscQueuesForPointToPointChannels) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      package.CreateStreamingChannel("internal", ChannelOps::kSendReceive, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * shared,
+      package.CreateStreamingChannel("shared", ChannelOps::kSendReceive, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single_value,
+      package.CreateSingleValueChannel("single_value",
+                                       ChannelOps::kSendReceive, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+  {
+    // Forwards `in` to `internal` and also sends on `shared`.
+    ProcBuilder pb("producer", &package);
+    BValue recv = pb.Receive(in, pb.Literal(Value::Token()));
+    BValue tkn = pb.Send(internal, pb.TupleIndex(recv, 0),
+                         pb.TupleIndex(recv, 1));
+    tkn = pb.Send(shared, tkn, pb.TupleIndex(recv, 1));
+    pb.Send(single_value, tkn, pb.TupleIndex(recv, 1));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+  {
+    // A second sender on `shared`.
+    ProcBuilder pb("other_producer", &package);
+    pb.Send(shared, pb.Literal(Value::Token()), pb.Literal(UBits(1, 32)));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+  {
+    ProcBuilder pb("consumer", &package);
+    BValue a = pb.Receive(internal, pb.Literal(Value::Token()));
+    BValue b = pb.Receive(shared, pb.TupleIndex(a, 0));
+    BValue c = pb.Receive(single_value, pb.TupleIndex(b, 0));
+    pb.Send(out, pb.TupleIndex(c, 0),
+            pb.Add(pb.TupleIndex(a, 1), pb.TupleIndex(b, 1)));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          &package,
+          std::make_unique<JitRuntime>(GetJitRuntime()->data_layout())));
+  auto is_spsc = [&](Channel* channel) {
+    return dynamic_cast<SpscJitChannelQueue*>(&manager->GetJitQueue(channel)) !=
+           nullptr;
+  };
+  EXPECT_TRUE(is_spsc(internal));
+  EXPECT_FALSE(is_spsc(shared));
+  EXPECT_FALSE(is_spsc(single_value));
+  EXPECT_FALSE(is_spsc(in));
+  EXPECT_FALSE(is_spsc(out));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> unsafe_manager,
+      JitChannelQueueManager::CreateThreadUnsafe(
+          &package,
+          std::make_unique<JitRuntime>(GetJitRuntime()->data_layout())));
+  EXPECT_NE(dynamic_cast<ThreadUnsafeJitChannelQueue*>(
+                &unsafe_manager->GetJitQueue(internal)),
+            nullptr);
+}
+
 }  // namespace
 }  // namespace xls
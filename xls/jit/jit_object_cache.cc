@@ -0,0 +1,192 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/Config/llvm-config.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/ErrorOr.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Support/raw_ostream.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace {
+
+// Bumped whenever the layout of the cache directory or the meaning of keys
+// changes so stale entries from older binaries are never picked up.
+constexpr std::string_view kCacheFormatVersion = "1";
+
+// Streams everything written to it into a SHA-256 digest without materializing
+// the (potentially very large) module text.
+class Sha256Ostream final : public llvm::raw_ostream {
+ public:
+  Sha256Ostream() { SHA256_Init(&context_); }
+  ~Sha256Ostream() override { flush(); }
+
+  std::string Finish() {
+    flush();
+    std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+    SHA256_Final(digest.data(), &context_);
+    return absl::BytesToHexString(std::string_view(
+        reinterpret_cast<const char*>(digest.data()), digest.size()));
+  }
+
+ private:
+  void write_impl(const char* ptr, size_t size) override {
+    SHA256_Update(&context_, ptr, size);
+    position_ += size;
+  }
+  uint64_t current_pos() const override { return position_; }
+
+  SHA256_CTX context_;
+  uint64_t position_ = 0;
+};
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return std::unique_ptr<JitObjectCache>(new JitObjectCache(directory));
+}
+
+/* static */ JitObjectCache* JitObjectCache::GetDefault() {
+  static absl::NoDestructor<std::unique_ptr<JitObjectCache>> cache(
+      []() -> std::unique_ptr<JitObjectCache> {
+        const char* directory =
+            std::getenv(std::string(kJitObjectCacheDirEnvVar).c_str());
+        if (directory == nullptr || directory[0] == '\0') {
+          return nullptr;
+        }
+        absl::StatusOr<std::unique_ptr<JitObjectCache>> created =
+            Create(directory);
+        if (!created.ok()) {
+          LOG(WARNING) << "Unable to use JIT object cache directory `"
+                       << directory << "`: " << created.status();
+          return nullptr;
+        }
+        VLOG(1) << "Using JIT object cache in " << directory;
+        return *std::move(created);
+      }());
+  return cache->get();
+}
+
+/* static */ std::string JitObjectCache::ComputeKey(
+    const llvm::Module& module, std::string_view configuration) {
+  Sha256Ostream hasher;
+  hasher << "xls-jit-object-cache:" << kCacheFormatVersion << "\n"
+         << "llvm:" << LLVM_VERSION_STRING << "\n"
+         << "config:" << configuration << "\n";
+  module.print(hasher, /*AAW=*/nullptr);
+  return hasher.Finish();
+}
+
+std::filesystem::path JitObjectCache::PathForKey(std::string_view key) const {
+  // Shard on the first two hex digits to keep directories small.
+  return directory_ / key.substr(0, 2) / absl::StrCat(key, ".o");
+}
+
+std::optional<std::unique_ptr<llvm::MemoryBuffer>> JitObjectCache::Lookup(
+    std::string_view key) {
+  std::filesystem::path path = PathForKey(key);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path.string(), /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  absl::MutexLock lock(&mutex_);
+  if (!buffer || (*buffer)->getBufferSize() == 0) {
+    ++misses_;
+    VLOG(2) << "JIT object cache miss: " << key;
+    return std::nullopt;
+  }
+  ++hits_;
+  VLOG(2) << "JIT object cache hit: " << path;
+  return std::move(*buffer);
+}
+
+absl::Status JitObjectCache::Store(std::string_view key,
+                                   std::string_view object_code) {
+  static std::atomic<int64_t> unique_suffix = 0;
+  std::filesystem::path path = PathForKey(key);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+  // Write to a uniquely named temporary and rename it into place so that
+  // concurrent readers (possibly in other processes) never observe a partially
+  // written object file.
+  std::filesystem::path temp_path = absl::StrFormat(
+      "%s.tmp.%d.%d", path.string(), getpid(), unique_suffix.fetch_add(1));
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, object_code));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    return absl::InternalError(
+        absl::StrFormat("Unable to write JIT object cache entry %s: %s",
+                        path.string(), ec.message()));
+  }
+  VLOG(2) << "JIT object cache stored: " << path;
+  return absl::OkStatus();
+}
+
+void JitObjectCache::ExpectObject(const llvm::Module* module,
+                                  std::string key) {
+  absl::MutexLock lock(&mutex_);
+  pending_keys_[module] = std::move(key);
+}
+
+void JitObjectCache::notifyObjectCompiled(const llvm::Module* module,
+                                          llvm::MemoryBufferRef object) {
+  std::string key;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = pending_keys_.find(module);
+    if (it == pending_keys_.end()) {
+      return;
+    }
+    key = std::move(it->second);
+    pending_keys_.erase(it);
+  }
+  absl::Status stored = Store(
+      key, std::string_view(object.getBufferStart(), object.getBufferSize()));
+  if (!stored.ok()) {
+    // The cache is purely an optimization so failing to populate it is not an
+    // error for the compilation itself.
+    LOG(WARNING) << stored;
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,131 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+
+namespace llvm {
+class Module;
+}  // namespace llvm
+
+namespace xls {
+
+// Environment variable which, when set, names the directory used by the
+// process-wide default object cache (see JitObjectCache::GetDefault).
+inline constexpr std::string_view kJitObjectCacheDirEnvVar =
+    "XLS_JIT_OBJECT_CACHE_DIR";
+
+// A persistent, content-addressed on-disk cache of object code produced by the
+// OrcJit.
+//
+// Entries are keyed by a SHA-256 digest of the unoptimized LLVM module (which
+// is a deterministic function of the XLS IR being compiled) combined with
+// everything else that affects the generated code: the LLVM version, the
+// optimization level, the target triple/CPU/features and whether msan
+// instrumentation is included. On a hit the stored object file is handed
+// directly to the object linking layer, skipping LLVM optimization and code
+// generation entirely. The ABI metadata which accompanies the object code
+// (buffer sizes, alignments, etc.) is recomputed from the XLS IR by
+// JittedFunctionBase::Build, so only the object file itself needs to be
+// stored.
+//
+// Modules which embed process-specific values (e.g. the node pointers passed
+// to observer callbacks) must not be cached.
+//
+// Thread-safe. Writes are atomic (write-to-temporary then rename) so multiple
+// processes may share a single cache directory.
+class JitObjectCache : public llvm::ObjectCache {
+ public:
+  // Creates a cache backed by the given directory, creating the directory if
+  // it does not already exist.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the process-wide cache configured by the XLS_JIT_OBJECT_CACHE_DIR
+  // environment variable or nullptr if the variable is unset (or the cache
+  // directory could not be created).
+  static JitObjectCache* GetDefault();
+
+  // Computes the cache key for the given (unoptimized) module. `configuration`
+  // should describe everything about the compiler which affects the generated
+  // code and is not captured by the module itself.
+  static std::string ComputeKey(const llvm::Module& module,
+                                std::string_view configuration);
+
+  // Returns the cached object code for the given key, if any.
+  std::optional<std::unique_ptr<llvm::MemoryBuffer>> Lookup(
+      std::string_view key);
+
+  // Writes the given object code to the cache under the given key.
+  absl::Status Store(std::string_view key, std::string_view object_code);
+
+  // Records that when object code for `module` is next produced it should be
+  // stored under `key`. Used with the llvm::ObjectCache interface below since
+  // the compile layer only sees the module after it has been optimized.
+  void ExpectObject(const llvm::Module* module, std::string key);
+
+  // llvm::ObjectCache implementation.
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override;
+  // Always returns nullptr; lookups happen before optimization through Lookup.
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override {
+    return nullptr;
+  }
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  int64_t hits() const {
+    absl::MutexLock lock(&mutex_);
+    return hits_;
+  }
+  int64_t misses() const {
+    absl::MutexLock lock(&mutex_);
+    return misses_;
+  }
+
+ private:
+  explicit JitObjectCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  std::filesystem::path PathForKey(std::string_view key) const;
+
+  const std::filesystem::path directory_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<const llvm::Module*, std::string> pending_keys_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,148 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class JitObjectCacheTest : public IrTestBase {
+ public:
+  absl::StatusOr<Function*> TestFunction(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    fb.UMul(fb.Add(x, y), y);
+    return fb.Build();
+  }
+
+  // Compiles `f` with the given cache and evaluates it on (x, y).
+  absl::StatusOr<Value> CompileAndRun(Function* f, JitObjectCache* cache,
+                                      int64_t x, int64_t y) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<OrcJit> jit,
+        OrcJit::Create(OrcJit::kDefaultOptLevel,
+                       /*include_observer_callbacks=*/false,
+                       /*jit_observer=*/nullptr, cache));
+    XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                         jit->CreateDataLayout());
+    JitRuntime runtime(data_layout);
+    XLS_ASSIGN_OR_RETURN(JittedFunctionBase jfb,
+                         JittedFunctionBase::Build(f, *jit));
+    JitArgumentSet inputs = jfb.CreateInputBuffer();
+    JitArgumentSet outputs = jfb.CreateOutputBuffer();
+    JitTempBuffer temp = jfb.CreateTempBuffer();
+    std::vector<Type*> param_types;
+    for (Param* param : f->params()) {
+      param_types.push_back(param->GetType());
+    }
+    XLS_RETURN_IF_ERROR(runtime.PackArgs(
+        {Value(UBits(x, 32)), Value(UBits(y, 32))}, param_types,
+        inputs.pointers()));
+    InterpreterEvents events;
+    InstanceContext context = InstanceContext::CreateForFunc();
+    jfb.RunJittedFunction(inputs, outputs, temp, &events, &context, &runtime,
+                          /*continuation_point=*/0);
+    return runtime.UnpackBuffer(outputs.pointers()[0],
+                                f->return_value()->GetType());
+  }
+};
+
+TEST_F(JitObjectCacheTest, MissThenHit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, TestFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path()));
+
+  EXPECT_THAT(CompileAndRun(f, cache.get(), 3, 4),
+              IsOkAndHolds(Value(UBits(28, 32))));
+  EXPECT_EQ(cache->hits(), 0);
+  EXPECT_EQ(cache->misses(), 1);
+
+  // The second compile of identical IR is served from the cache and computes
+  // the same thing.
+  EXPECT_THAT(CompileAndRun(f, cache.get(), 5, 6),
+              IsOkAndHolds(Value(UBits(66, 32))));
+  EXPECT_EQ(cache->hits(), 1);
+  EXPECT_EQ(cache->misses(), 1);
+}
+
+TEST_F(JitObjectCacheTest, CacheSurvivesRecreation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, TestFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                             JitObjectCache::Create(temp_dir.path()));
+    XLS_ASSERT_OK(CompileAndRun(f, cache.get(), 1, 2).status());
+    EXPECT_EQ(cache->misses(), 1);
+  }
+  // A fresh cache object on the same directory (i.e., a new process) sees the
+  // stored object.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path()));
+  EXPECT_THAT(CompileAndRun(f, cache.get(), 1, 2),
+              IsOkAndHolds(Value(UBits(6, 32))));
+  EXPECT_EQ(cache->hits(), 1);
+  EXPECT_EQ(cache->misses(), 0);
+}
+
+TEST_F(JitObjectCacheTest, DifferentIrMisses) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, TestFunction(p.get()));
+  FunctionBuilder fb("other", p.get());
+  fb.Subtract(fb.Param("x", p->GetBitsType(32)),
+              fb.Param("y", p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path()));
+
+  XLS_ASSERT_OK(CompileAndRun(f, cache.get(), 1, 2).status());
+  EXPECT_THAT(CompileAndRun(other, cache.get(), 7, 2),
+              IsOkAndHolds(Value(UBits(5, 32))));
+  EXPECT_EQ(cache->hits(), 0);
+  EXPECT_EQ(cache->misses(), 2);
+}
+
+}  // namespace
+}  // namespace xls
@@ -38,7 +38,9 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
@@ -48,10 +50,12 @@
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/proc_jit.h"
+#include "xls/jit/tiered_proc_evaluator.h"
 
 namespace xls {
 namespace {
@@ -166,6 +170,8 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
     ProcElaboration elaboration, const AotPackageEntrypointsProto& entrypoints,
     absl::Span<ProcAotEntrypoints const> impls,
     const EvaluatorOptions& options) {
+  XLS_RET_CHECK(!options.packed_jit_layout())
+      << "The packed JIT layout is not supported by AOT compiled procs";
   XLS_RET_CHECK_EQ(elaboration.procs().size(), entrypoints.entrypoint_size());
   XLS_RET_CHECK_EQ(elaboration.procs().size(), impls.size());
   absl::flat_hash_map<std::string, AotProcJitArgs> procs_by_name;
@@ -232,7 +238,13 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
   return std::move(proc_runtime);
 }
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+struct ProcJitNetwork {
+  std::unique_ptr<JitChannelQueueManager> queue_manager;
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
+};
+
+// Creates thread-safe queues and a ProcJit for each proc of the elaboration.
+absl::StatusOr<ProcJitNetwork> CreateProcJitNetwork(
     ProcElaboration elaboration, const EvaluatorOptions& options) {
   // We use the compiler to know the data layout.
   XLS_ASSIGN_OR_RETURN(
@@ -243,28 +255,132 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout layout, comp->CreateDataLayout());
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
+  ProcJitNetwork network;
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      network.queue_manager,
       JitChannelQueueManager::CreateThreadSafe(
-          std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+          std::move(elaboration), std::make_unique<JitRuntime>(layout),
+          /*packed_payloads=*/options.packed_jit_layout()));
 
   // Create a ProcJit for each Proc.
-  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
-  for (Proc* proc : queue_manager->elaboration().procs()) {
+  for (Proc* proc : network.queue_manager->elaboration().procs()) {
     XLS_ASSIGN_OR_RETURN(
         std::unique_ptr<ProcJit> proc_jit,
         ProcJit::Create(
-            proc, &queue_manager->runtime(), queue_manager.get(),
-            /*include_observer_callbacks=*/options.support_observers()));
-    proc_jits.push_back(std::move(proc_jit));
+            proc, &network.queue_manager->runtime(),
+            network.queue_manager.get(),
+            /*include_observer_callbacks=*/options.support_observers(),
+            /*observer=*/nullptr, JitProfileOptions(),
+            /*packed_state=*/options.packed_jit_layout()));
+    network.proc_jits.push_back(std::move(proc_jit));
   }
+  return network;
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options) {
+  XLS_ASSIGN_OR_RETURN(ProcJitNetwork network,
+                       CreateProcJitNetwork(std::move(elaboration), options));
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
+                       SerialProcRuntime::Create(
+                           std::move(network.proc_jits),
+                           std::move(network.queue_manager), options));
+
+  XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
+      proc_runtime->elaboration(), proc_runtime->queue_manager()));
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcJitNetwork network,
+                       CreateProcJitNetwork(std::move(elaboration), options));
 
   // Create a runtime.
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<SerialProcRuntime> proc_runtime,
-      SerialProcRuntime::Create(std::move(proc_jits), std::move(queue_manager),
-                                options));
+      std::unique_ptr<ParallelProcRuntime> proc_runtime,
+      ParallelProcRuntime::Create(std::move(network.proc_jits),
+                                  std::move(network.queue_manager), options,
+                                  thread_count));
+
+  XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
+      proc_runtime->elaboration(), proc_runtime->queue_manager()));
+  return std::move(proc_runtime);
+}
+
+// Creates a tiered runtime. If `profile_warmup_ticks` is given the first tier
+// is a profiling ProcJit and the second tier is compiled using its profile
+// once the first tier has run the given number of ticks. Otherwise the first
+// tier is the interpreter and the JIT is compiled immediately.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateTieredRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    JitObserver* observer, std::optional<int64_t> profile_warmup_ticks) {
+  // We use the compiler to know the data layout.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<OrcJit> comp,
+      OrcJit::Create(
+          LlvmCompiler::kDefaultOptLevel,
+          /*include_observer_callbacks=*/options.support_observers()));
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout layout, comp->CreateDataLayout());
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          std::move(elaboration), std::make_unique<JitRuntime>(layout),
+          /*packed_payloads=*/options.packed_jit_layout()));
+
+  // Both tiers share the same queues so a proc instance can switch between
+  // them at any tick boundary. The background compilation creates types in
+  // the package concurrently with the first tier; TypeManager serializes these
+  // with its own lock.
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    JitChannelQueueManager* jit_queue_manager = queue_manager.get();
+    bool include_observer_callbacks = options.support_observers();
+    bool packed_state = options.packed_jit_layout();
+    if (!profile_warmup_ticks.has_value()) {
+      evaluators.push_back(std::make_unique<TieredProcEvaluator>(
+          proc, std::make_unique<ProcInterpreter>(proc, jit_queue_manager),
+          [proc, jit_queue_manager, include_observer_callbacks, observer,
+           packed_state]() -> absl::StatusOr<std::unique_ptr<ProcEvaluator>> {
+            return ProcJit::Create(proc, &jit_queue_manager->runtime(),
+                                   jit_queue_manager,
+                                   include_observer_callbacks, observer,
+                                   JitProfileOptions(), packed_state);
+          },
+          observer));
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcJit> instrumented,
+        ProcJit::Create(proc, &jit_queue_manager->runtime(), jit_queue_manager,
+                        include_observer_callbacks, observer,
+                        JitProfileOptions{.instrument = true}, packed_state));
+    // Owned by the tiered evaluator which also owns the compile function.
+    const ProcJit* first_tier = instrumented.get();
+    evaluators.push_back(std::make_unique<TieredProcEvaluator>(
+        proc, std::move(instrumented),
+        [proc, jit_queue_manager, include_observer_callbacks, observer,
+         packed_state,
+         first_tier]() -> absl::StatusOr<std::unique_ptr<ProcEvaluator>> {
+          // The branch weights are copied into the IR during the build so the
+          // profile need not outlive it.
+          JitProfile profile = first_tier->GetProfile();
+          return ProcJit::Create(proc, &jit_queue_manager->runtime(),
+                                 jit_queue_manager, include_observer_callbacks,
+                                 observer,
+                                 JitProfileOptions{.profile = &profile},
+                                 packed_state);
+        },
+        observer, *profile_warmup_ticks));
+  }
 
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SerialProcRuntime> proc_runtime,
+      SerialProcRuntime::Create(std::move(evaluators),
+                                std::move(queue_manager), options));
   XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
       proc_runtime->elaboration(), proc_runtime->queue_manager()));
   return std::move(proc_runtime);
@@ -286,6 +402,64 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
   return CreateRuntime(std::move(elaboration), options);
 }
 
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package, const EvaluatorOptions& options,
+                             std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateParallelRuntime(std::move(elaboration), options, thread_count);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Proc* top, const EvaluatorOptions& options,
+                             std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateParallelRuntime(std::move(elaboration), options, thread_count);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(
+    Package* package, const EvaluatorOptions& options, JitObserver* observer) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateTieredRuntime(std::move(elaboration), options, observer,
+                             /*profile_warmup_ticks=*/std::nullopt);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(
+    Proc* top, const EvaluatorOptions& options, JitObserver* observer) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateTieredRuntime(std::move(elaboration), options, observer,
+                             /*profile_warmup_ticks=*/std::nullopt);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateProfileGuidedSerialProcRuntime(Package* package,
+                                     const EvaluatorOptions& options,
+                                     int64_t warmup_ticks,
+                                     JitObserver* observer) {
+  XLS_RET_CHECK_GT(warmup_ticks, 0);
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateTieredRuntime(std::move(elaboration), options, observer,
+                             warmup_ticks);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateProfileGuidedSerialProcRuntime(Proc* top,
+                                     const EvaluatorOptions& options,
+                                     int64_t warmup_ticks,
+                                     JitObserver* observer) {
+  XLS_RET_CHECK_GT(warmup_ticks, 0);
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateTieredRuntime(std::move(elaboration), options, observer,
+                             warmup_ticks);
+}
+
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Package* package,
                                                       int64_t opt_level,
                                                       bool with_msan,
@@ -22,6 +22,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
 #include "xls/ir/xls_ir_interface.pb.h"
@@ -41,6 +42,62 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top, const EvaluatorOptions& options = EvaluatorOptions());
 
+// Create a ParallelProcRuntime composed of ProcJits which ticks procs using up
+// to `thread_count` threads (defaults to the number of available CPUs).
+// Supports old-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions(),
+    std::optional<int64_t> thread_count = std::nullopt);
+
+// Create a ParallelProcRuntime composed of ProcJits. Constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Proc* top, const EvaluatorOptions& options = EvaluatorOptions(),
+    std::optional<int64_t> thread_count = std::nullopt);
+
+// Create a SerialProcRuntime whose procs start out executing in the
+// interpreter while ProcJits are compiled on background threads. Each proc
+// instance switches to its ProcJit at the first tick boundary after the JIT is
+// ready. Compilation latencies and switch points are reported to `observer`
+// (if not null). Supports old-style procs.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions(),
+    JitObserver* observer = nullptr);
+
+// Create a tiered SerialProcRuntime (see above) constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(
+    Proc* top, const EvaluatorOptions& options = EvaluatorOptions(),
+    JitObserver* observer = nullptr);
+
+// Default number of ticks the instrumented tier of a profile-guided runtime
+// runs before the optimized code is compiled.
+inline constexpr int64_t kDefaultProfileWarmupTicks = 1000;
+
+// Create a tiered SerialProcRuntime whose procs start out in ProcJits
+// instrumented to count which arms of selects are taken and how often early
+// exits fire. Once the first tier has run `warmup_ticks` ticks, every proc is
+// recompiled on a background thread with branch weights derived from the
+// gathered profile so LLVM lays out the hot paths contiguously and keeps cold
+// ones out of line. Supports old-style procs.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateProfileGuidedSerialProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions(),
+    int64_t warmup_ticks = kDefaultProfileWarmupTicks,
+    JitObserver* observer = nullptr);
+
+// Create a profile-guided SerialProcRuntime (see above) constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateProfileGuidedSerialProcRuntime(
+    Proc* top, const EvaluatorOptions& options = EvaluatorOptions(),
+    int64_t warmup_ticks = kDefaultProfileWarmupTicks,
+    JitObserver* observer = nullptr);
+
 struct ProcAotEntrypoints {
   // What proc these entrypoints are associated with.
   PackageInterfaceProto::Proc proc_interface_proto;
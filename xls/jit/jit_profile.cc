@@ -0,0 +1,106 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+std::optional<absl::Span<const int64_t>> JitProfile::GetNodeCounts(
+    const Node* node) const {
+  auto it = node_counts_.find(node);
+  if (it == node_counts_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::optional<JitProfile::EarlyExitCounts> JitProfile::GetEarlyExitCounts(
+    int64_t early_exit_id) const {
+  auto it = early_exit_counts_.find(early_exit_id);
+  if (it == early_exit_counts_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::string JitProfile::ToString() const {
+  std::vector<std::string> lines;
+  for (const auto& [node, counts] : node_counts_) {
+    lines.push_back(absl::StrFormat("%s: [%s]", node->GetName(),
+                                    absl::StrJoin(counts, ", ")));
+  }
+  for (const auto& [id, counts] : early_exit_counts_) {
+    lines.push_back(absl::StrFormat("early_exit_%d: continued=%d exited=%d",
+                                    id, counts.continued, counts.exited));
+  }
+  // Hash map iteration order is unspecified.
+  absl::c_sort(lines);
+  return absl::StrJoin(lines, "\n");
+}
+
+JitProfile JitProfileCounterLayout::Read(int64_t* counters) const {
+  auto load = [&](int64_t index) {
+    return std::atomic_ref<int64_t>(counters[index])
+        .load(std::memory_order_relaxed);
+  };
+  JitProfile profile;
+  for (const auto& [node, slots] : nodes) {
+    std::vector<int64_t> counts;
+    counts.reserve(slots.second);
+    for (int64_t i = 0; i < slots.second; ++i) {
+      counts.push_back(load(slots.first + i));
+    }
+    profile.SetNodeCounts(node, std::move(counts));
+  }
+  for (const auto& [id, slot] : early_exits) {
+    profile.SetEarlyExitCounts(
+        id, JitProfile::EarlyExitCounts{.continued = load(slot),
+                                        .exited = load(slot + 1)});
+  }
+  return profile;
+}
+
+std::optional<std::pair<uint32_t, uint32_t>> ScaleBranchWeights(
+    int64_t taken, int64_t not_taken) {
+  uint64_t a = std::max<int64_t>(taken, 0);
+  uint64_t b = std::max<int64_t>(not_taken, 0);
+  if (a == 0 && b == 0) {
+    return std::nullopt;
+  }
+  constexpr uint64_t kMax = std::numeric_limits<uint32_t>::max();
+  uint64_t largest = std::max(a, b);
+  if (largest > kMax) {
+    uint64_t scale = largest / kMax + 1;
+    a /= scale;
+    b /= scale;
+  }
+  return std::make_pair(static_cast<uint32_t>(a), static_cast<uint32_t>(b));
+}
+
+}  // namespace xls
@@ -0,0 +1,112 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_PROFILE_H_
+#define XLS_JIT_JIT_PROFILE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Execution counts gathered by profiling-instrumented jitted code. Used to
+// annotate the code generated by a later compilation of the same FunctionBase
+// with branch weights.
+class JitProfile {
+ public:
+  // Number of times a proc early exit point (e.g., a blocking receive) was
+  // reached and execution either continued or left the jitted function.
+  struct EarlyExitCounts {
+    int64_t continued = 0;
+    int64_t exited = 0;
+
+    bool operator==(const EarlyExitCounts&) const = default;
+  };
+
+  // Sets the number of times each arm of the select-like node `node` was
+  // chosen. The meaning of the arms depends on the node:
+  //
+  //   sel:           one count per case followed by the default (if any).
+  //   priority_sel:  one count per case followed by the default.
+  //   one_hot_sel:   one count per case followed by the number of times the
+  //                  node was evaluated (several cases may be chosen at once).
+  void SetNodeCounts(const Node* node, std::vector<int64_t> counts) {
+    node_counts_[node] = std::move(counts);
+  }
+  std::optional<absl::Span<const int64_t>> GetNodeCounts(
+      const Node* node) const;
+
+  void SetEarlyExitCounts(int64_t early_exit_id, EarlyExitCounts counts) {
+    early_exit_counts_[early_exit_id] = counts;
+  }
+  std::optional<EarlyExitCounts> GetEarlyExitCounts(
+      int64_t early_exit_id) const;
+
+  bool empty() const {
+    return node_counts_.empty() && early_exit_counts_.empty();
+  }
+
+  std::string ToString() const;
+
+ private:
+  absl::flat_hash_map<const Node*, std::vector<int64_t>> node_counts_;
+  absl::flat_hash_map<int64_t, EarlyExitCounts> early_exit_counts_;
+};
+
+// Options for profile-guided compilation of a FunctionBase.
+struct JitProfileOptions {
+  // If true the jitted code counts how often each arm of every select-like
+  // node and each early exit point is taken. The counts are read with
+  // JittedFunctionBase::GetProfile. Only supported by the ORC JIT.
+  bool instrument = false;
+
+  // Counts from an earlier (instrumented) run of the same FunctionBase. They
+  // are attached to the generated code as LLVM branch weights so that rarely
+  // taken paths are laid out (and optimized) as cold.
+  const JitProfile* profile = nullptr;
+};
+
+// Assignment of the profile counters of an instrumented function to the nodes
+// and early exit points they count.
+struct JitProfileCounterLayout {
+  // The index of the first counter and the number of counters of each
+  // instrumented node.
+  absl::flat_hash_map<const Node*, std::pair<int64_t, int64_t>> nodes;
+  // The index of the first counter of each instrumented early exit point. The
+  // first counter counts continuations and the second exits.
+  absl::flat_hash_map<int64_t, int64_t> early_exits;
+  // Total number of counters.
+  int64_t counter_count = 0;
+
+  // Builds a profile from the counters. The counters may be concurrently
+  // incremented by jitted code.
+  JitProfile Read(int64_t* counters) const;
+};
+
+// Scales the pair of counts so both fit the 32-bit branch weights used by
+// LLVM while keeping their ratio. Returns nullopt if both counts are zero
+// (i.e., there is no information).
+std::optional<std::pair<uint32_t, uint32_t>> ScaleBranchWeights(
+    int64_t taken, int64_t not_taken);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_PROFILE_H_
@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_profile.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+class JitProfileTest : public IrTestBase {
+ public:
+  // Builds a function returning (sel, priority_sel, one_hot_sel) of the
+  // constant cases 10, 20, 30 and 40 under the given two-bit selector.
+  absl::StatusOr<Function*> BuildSelects(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue s = fb.Param("s", p->GetBitsType(2));
+    BValue a = fb.Literal(UBits(10, 32));
+    BValue b = fb.Literal(UBits(20, 32));
+    BValue c = fb.Literal(UBits(30, 32));
+    BValue d = fb.Literal(UBits(40, 32));
+    BValue sel = fb.Select(s, {a, b, c}, d, SourceInfo(), "sel");
+    BValue priority_sel =
+        fb.PrioritySelect(s, {a, b}, c, SourceInfo(), "priority_sel");
+    BValue one_hot_sel =
+        fb.OneHotSelect(s, {a, b}, SourceInfo(), "one_hot_sel");
+    fb.Tuple({sel, priority_sel, one_hot_sel});
+    sel_ = sel.node();
+    priority_sel_ = priority_sel.node();
+    one_hot_sel_ = one_hot_sel.node();
+    return fb.Build();
+  }
+
+  static Value Expected(int64_t s) {
+    int64_t sel = std::vector<int64_t>{10, 20, 30, 40}[s];
+    int64_t priority_sel = (s & 1) ? 10 : (s & 2) ? 20 : 30;
+    int64_t one_hot_sel = ((s & 1) ? 10 : 0) | ((s & 2) ? 20 : 0);
+    return Value::Tuple({Value(UBits(sel, 32)), Value(UBits(priority_sel, 32)),
+                         Value(UBits(one_hot_sel, 32))});
+  }
+
+  // Runs `jit` on every selector in `selectors` and checks the results.
+  static void RunAll(FunctionJit* jit, absl::Span<const int64_t> selectors) {
+    for (int64_t s : selectors) {
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                               jit->Run({Value(UBits(s, 2))}));
+      EXPECT_EQ(result.value, Expected(s)) << "s=" << s;
+    }
+  }
+
+  Node* sel_ = nullptr;
+  Node* priority_sel_ = nullptr;
+  Node* one_hot_sel_ = nullptr;
+};
+
+TEST_F(JitProfileTest, CountsSelectArms) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildSelects(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> jit,
+      FunctionJit::Create(f, /*opt_level=*/3,
+                          /*include_observer_callbacks=*/false,
+                          /*jit_observer=*/nullptr,
+                          JitProfileOptions{.instrument = true}));
+  ASSERT_TRUE(jit->jitted_function_base().HasProfileInstrumentation());
+
+  RunAll(jit.get(), {0, 1, 1, 2, 3, 3, 3});
+  JitProfile profile = jit->jitted_function_base().GetProfile();
+  EXPECT_THAT(profile.GetNodeCounts(sel_), Optional(ElementsAre(1, 2, 1, 3)));
+  // Bit 0 wins over bit 1; no bits set picks the default.
+  EXPECT_THAT(profile.GetNodeCounts(priority_sel_),
+              Optional(ElementsAre(5, 1, 1)));
+  // Per-case counts followed by the number of evaluations.
+  EXPECT_THAT(profile.GetNodeCounts(one_hot_sel_),
+              Optional(ElementsAre(5, 4, 7)));
+
+  jit->jitted_function_base().ResetProfile();
+  RunAll(jit.get(), {2});
+  profile = jit->jitted_function_base().GetProfile();
+  EXPECT_THAT(profile.GetNodeCounts(sel_), Optional(ElementsAre(0, 0, 1, 0)));
+}
+
+TEST_F(JitProfileTest, UninstrumentedFunctionHasEmptyProfile) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildSelects(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f));
+  EXPECT_FALSE(jit->jitted_function_base().HasProfileInstrumentation());
+  RunAll(jit.get(), {0, 1, 2, 3});
+  EXPECT_TRUE(jit->jitted_function_base().GetProfile().empty());
+}
+
+TEST_F(JitProfileTest, ProfileGuidedBuildComputesSameResults) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildSelects(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> instrumented,
+      FunctionJit::Create(f, /*opt_level=*/3,
+                          /*include_observer_callbacks=*/false,
+                          /*jit_observer=*/nullptr,
+                          JitProfileOptions{.instrument = true}));
+  // A heavily skewed profile.
+  std::vector<int64_t> selectors(100, 3);
+  selectors.push_back(0);
+  RunAll(instrumented.get(), selectors);
+  JitProfile profile = instrumented->jitted_function_base().GetProfile();
+  ASSERT_FALSE(profile.empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FunctionJit> optimized,
+      FunctionJit::Create(f, /*opt_level=*/3,
+                          /*include_observer_callbacks=*/false,
+                          /*jit_observer=*/nullptr,
+                          JitProfileOptions{.profile = &profile}));
+  EXPECT_FALSE(optimized->jitted_function_base().HasProfileInstrumentation());
+  RunAll(optimized.get(), {0, 1, 2, 3});
+}
+
+TEST_F(JitProfileTest, ToString) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildSelects(p.get()));
+  JitProfile profile;
+  EXPECT_TRUE(profile.empty());
+  profile.SetNodeCounts(f->GetNode("sel").value(), {1, 2, 3, 4});
+  profile.SetEarlyExitCounts(0, {.continued = 5, .exited = 6});
+  EXPECT_EQ(profile.ToString(),
+            "early_exit_0: continued=5 exited=6\nsel: [1, 2, 3, 4]");
+  EXPECT_THAT(profile.GetEarlyExitCounts(0),
+              Optional(JitProfile::EarlyExitCounts{.continued = 5,
+                                                   .exited = 6}));
+  EXPECT_EQ(profile.GetEarlyExitCounts(1), std::nullopt);
+}
+
+TEST(ScaleBranchWeightsTest, Scaling) {
+  EXPECT_EQ(ScaleBranchWeights(0, 0), std::nullopt);
+  EXPECT_THAT(ScaleBranchWeights(3, 0), Optional(std::make_pair(3u, 0u)));
+  EXPECT_THAT(ScaleBranchWeights(7, 11), Optional(std::make_pair(7u, 11u)));
+
+  constexpr int64_t kBig = std::numeric_limits<int64_t>::max();
+  std::optional<std::pair<uint32_t, uint32_t>> scaled =
+      ScaleBranchWeights(kBig, kBig / 4);
+  ASSERT_TRUE(scaled.has_value());
+  EXPECT_GT(scaled->first, 0u);
+  EXPECT_NEAR(static_cast<double>(scaled->first) / scaled->second, 4.0, 0.01);
+}
+
+}  // namespace
+}  // namespace xls
@@ -27,6 +27,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -108,6 +109,13 @@ class JitRuntime {
     return type_converter_->GetTypePreferredAlignment(xls_type);
   }
 
+  // Returns the layout of the given type in the native LLVM data layout. The
+  // layout can also be used to convert to and from the packed layout.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    absl::MutexLock lock(&mutex_);
+    return type_converter_->CreateTypeLayout(xls_type);
+  }
+
   const llvm::DataLayout& data_layout() const { return data_layout_; }
 
  private:
@@ -14,6 +14,8 @@
 
 #include "xls/jit/llvm_compiler.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstdint>
 #include <memory>
@@ -47,6 +49,8 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/jit/parallel_compile.h"
 
 namespace xls {
 
@@ -58,8 +62,34 @@ void OnceInit() {
   LLVMInitializeNativeAsmPrinter();
   LLVMInitializeNativeAsmParser();
 }
+
+// Upper bound on the number of compile threads used by default. Splitting a
+// module into more pieces than this rarely helps and loses optimization
+// opportunities across partition boundaries.
+constexpr int64_t kMaxDefaultCompileThreads = 8;
+
+// Zero means the default has not been set explicitly.
+std::atomic<int64_t> default_compile_threads = 0;
 }  // namespace
 
+/* static */ void LlvmCompiler::SetDefaultCompileThreads(int64_t threads) {
+  CHECK_GT(threads, 0);
+  default_compile_threads.store(threads);
+}
+
+/* static */ int64_t LlvmCompiler::DefaultCompileThreads() {
+  int64_t threads = default_compile_threads.load();
+  if (threads > 0) {
+    return threads;
+  }
+  return std::clamp<int64_t>(AvailableCPUs(), 1, kMaxDefaultCompileThreads);
+}
+
+bool LlvmCompiler::ShouldCompileInParallel(const llvm::Module& module) const {
+  return compile_threads_ > 1 &&
+         CountInstructions(module) >= parallel_compile_min_instructions_;
+}
+
 std::string LlvmCompiler::target_triple() const {
   return target_machine_->getTargetTriple().getTriple();
 }
@@ -92,6 +92,26 @@ class LlvmCompiler {
     return include_observer_callbacks_;
   }
 
+  // Modules with at least this many LLVM instructions are split into several
+  // modules (see SplitModuleToBitcode) which are optimized, and in the case of
+  // the JIT also compiled to object code, concurrently.
+  static constexpr int64_t kDefaultParallelCompileMinInstructions = 10000;
+
+  // Sets the process-wide default for the number of threads used to compile a
+  // single module by compilers created after this call. A value of 1 disables
+  // parallel compilation.
+  static void SetDefaultCompileThreads(int64_t threads);
+  static int64_t DefaultCompileThreads();
+
+  // The number of threads used to compile a single large module. A value of 1
+  // disables parallel compilation.
+  int64_t compile_threads() const { return compile_threads_; }
+  void set_compile_threads(int64_t threads) { compile_threads_ = threads; }
+
+  void set_parallel_compile_min_instructions(int64_t count) {
+    parallel_compile_min_instructions_ = count;
+  }
+
  protected:
   absl::Status Init();
 
@@ -99,8 +119,15 @@ class LlvmCompiler {
 
   absl::Status VerifyModule(const llvm::Module& module);
 
+  // Runs the standard optimization pipeline on the given module. Thread-safe
+  // as long as each concurrent call operates on a module in its own
+  // LLVMContext.
   llvm::Error PerformStandardOptimization(llvm::Module* module);
 
+  // Returns true if the given module is large enough that it should be split
+  // and compiled by several threads.
+  bool ShouldCompileInParallel(const llvm::Module& module) const;
+
   LlvmCompiler(int64_t opt_level, bool include_msan,
                bool include_observer_callbacks)
       : data_layout_(""),
@@ -133,6 +160,10 @@ class LlvmCompiler {
   const bool include_observer_callbacks_;
 
   bool module_created_ = false;
+
+  int64_t compile_threads_ = DefaultCompileThreads();
+  int64_t parallel_compile_min_instructions_ =
+      kDefaultParallelCompileMinInstructions;
 };
 
 // Calls the dump method on the given LLVM object and returns the string.
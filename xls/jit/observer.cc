@@ -18,7 +18,10 @@
 #include <string_view>
 
 #include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/jit/jit_runtime.h"
 
@@ -43,6 +46,11 @@ JitObserverRequests CompoundJitObserver::GetNotificationOptions() const {
                          [](auto* o) {
                            return o->GetNotificationOptions().assembly_code_str;
                          }),
+      .tiering_events =
+          absl::c_any_of(observers_,
+                         [](auto* o) {
+                           return o->GetNotificationOptions().tiering_events;
+                         }),
   };
 }
 void CompoundJitObserver::UnoptimizedModule(const llvm::Module* module) {
@@ -68,6 +76,24 @@ void CompoundJitObserver::AssemblyCodeString(const llvm::Module* module,
   }
 }
 
+void CompoundJitObserver::TieredCompilationComplete(
+    FunctionBase* function_base, absl::Duration latency,
+    const absl::Status& status) {
+  for (auto* o : observers_) {
+    if (o->GetNotificationOptions().tiering_events) {
+      o->TieredCompilationComplete(function_base, latency, status);
+    }
+  }
+}
+void CompoundJitObserver::SwitchedToJit(FunctionBase* function_base,
+                                        int64_t interpreted_invocations) {
+  for (auto* o : observers_) {
+    if (o->GetNotificationOptions().tiering_events) {
+      o->SwitchedToJit(function_base, interpreted_invocations);
+    }
+  }
+}
+
 void CompoundJitObserver::AddObserver(JitObserver* o) {
   observers_.push_back(o);
 }
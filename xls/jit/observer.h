@@ -22,8 +22,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/interpreter/observer.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
@@ -45,6 +48,9 @@ struct JitObserverRequests {
   bool optimized_module = false;
   // Do we want to get called with optimized asm code.
   bool assembly_code_str = false;
+  // Do we want to get called when tiered execution finishes compiling in the
+  // background and when it switches from the interpreter to jitted code.
+  bool tiering_events = false;
 };
 
 // Basic observer for JIT compilation events
@@ -60,6 +66,18 @@ class JitObserver {
   // Called when a LLVM module has been compiled with the module code.
   virtual void AssemblyCodeString(const llvm::Module* module,
                                   std::string_view asm_code) {}
+  // Called when background compilation of `function_base` started by a tiered
+  // evaluator has finished. `latency` is the wall time taken by the
+  // compilation and `status` its result. May be called from any thread.
+  virtual void TieredCompilationComplete(FunctionBase* function_base,
+                                         absl::Duration latency,
+                                         const absl::Status& status) {}
+  // Called when a tiered evaluator switches execution of `function_base` from
+  // the interpreter to jitted code. `interpreted_invocations` is the number of
+  // calls (for functions) or completed ticks (for proc instances) executed by
+  // the interpreter before the switch.
+  virtual void SwitchedToJit(FunctionBase* function_base,
+                             int64_t interpreted_invocations) {}
 };
 
 // A compound observer that lets one trigger multiple observers at once.
@@ -72,6 +90,11 @@ class CompoundJitObserver final : public JitObserver {
   void OptimizedModule(const llvm::Module* module) final;
   void AssemblyCodeString(const llvm::Module* module,
                           std::string_view asm_code) final;
+  void TieredCompilationComplete(FunctionBase* function_base,
+                                 absl::Duration latency,
+                                 const absl::Status& status) final;
+  void SwitchedToJit(FunctionBase* function_base,
+                     int64_t interpreted_invocations) final;
 
   void AddObserver(JitObserver* o);
 
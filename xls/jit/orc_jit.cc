@@ -20,6 +20,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
@@ -46,25 +47,30 @@
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IRPrinter/IRPrintingPasses.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
+#include "llvm/include/llvm/Target/TargetMachine.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/jit/jit_clang_builtins.h"
 #include "xls/jit/jit_emulated_tls.h"  // NOLINT: Used with MSAN
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
+#include "xls/jit/parallel_compile.h"
 
 namespace xls {
 
 OrcJit::OrcJit(int64_t opt_level, bool include_msan,
-               bool include_observer_callbacks)
+               bool include_observer_callbacks, JitObjectCache* object_cache)
     : LlvmCompiler(opt_level, include_msan, include_observer_callbacks),
       context_(std::make_unique<llvm::LLVMContext>()),
       execution_session_(
@@ -72,7 +78,8 @@ OrcJit::OrcJit(int64_t opt_level, bool include_msan,
       object_layer_(
           execution_session_,
           []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
-      dylib_(execution_session_.createBareJITDylib("main")) {}
+      dylib_(execution_session_.createBareJITDylib("main")),
+      object_cache_(include_observer_callbacks ? nullptr : object_cache) {}
 
 OrcJit::~OrcJit() {
   if (auto err = execution_session_.endSession()) {
@@ -133,7 +140,8 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
 }
 
 absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
-    int64_t opt_level, bool include_observer_callbacks, JitObserver* observer) {
+    int64_t opt_level, bool include_observer_callbacks, JitObserver* observer,
+    JitObjectCache* object_cache) {
   LlvmCompiler::InitializeLlvm();
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
   constexpr bool kHasMsan = true;
@@ -141,7 +149,8 @@ absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
   constexpr bool kHasMsan = false;
 #endif
   std::unique_ptr<OrcJit> jit = absl::WrapUnique(
-      new OrcJit(opt_level, kHasMsan, include_observer_callbacks));
+      new OrcJit(opt_level, kHasMsan, include_observer_callbacks,
+                 object_cache));
   jit->SetJitObserver(observer);
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
@@ -221,7 +230,8 @@ absl::Status OrcJit::InitInternal() {
   // Add some selected compiler-rt symbols.
   XLS_RETURN_IF_ERROR(AddCompilerRtSymbols(dylib_, data_layout_));
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_,
+                                                               object_cache_);
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -237,8 +247,36 @@ absl::Status OrcJit::InitInternal() {
   return absl::OkStatus();
 }
 
+std::string OrcJit::ObjectCacheConfiguration() const {
+  return absl::StrFormat(
+      "opt_level=%d;msan=%d;triple=%s;cpu=%s;features=%s", opt_level_,
+      include_msan_, target_machine_->getTargetTriple().normalize(),
+      target_machine_->getTargetCPU().str(),
+      target_machine_->getTargetFeatureString().str());
+}
+
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
+  if (jit_observer_ == nullptr && ShouldCompileInParallel(*module)) {
+    return CompileModuleInParallel(std::move(module));
+  }
+  if (object_cache_ != nullptr) {
+    std::string key =
+        JitObjectCache::ComputeKey(*module, ObjectCacheConfiguration());
+    std::optional<std::unique_ptr<llvm::MemoryBuffer>> cached =
+        object_cache_->Lookup(key);
+    if (cached.has_value()) {
+      llvm::Error error = object_layer_.add(dylib_, *std::move(cached));
+      if (error) {
+        return absl::UnknownError(
+            absl::StrFormat("Error linking cached object code: %s",
+                            llvm::toString(std::move(error))));
+      }
+      return absl::OkStatus();
+    }
+    // Have the compile layer store the object once it has been generated.
+    object_cache_->ExpectObject(module.get(), std::move(key));
+  }
   llvm::Error error = transform_layer_->add(
       dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
   if (error) {
@@ -248,6 +286,76 @@ absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   return absl::OkStatus();
 }
 
+absl::Status OrcJit::CompileModuleInParallel(
+    std::unique_ptr<llvm::Module> module) {
+  std::vector<std::string> partitions =
+      SplitModuleToBitcode(*module, compile_threads());
+  module.reset();
+  VLOG(2) << absl::StreamFormat("Compiling %d module partitions on %d threads",
+                                partitions.size(), compile_threads());
+
+  std::string configuration;
+  if (object_cache_ != nullptr) {
+    configuration = ObjectCacheConfiguration();
+  }
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(partitions.size());
+  XLS_RETURN_IF_ERROR(ParallelFor(
+      partitions.size(), compile_threads(), [&](int64_t i) -> absl::Status {
+        // Each partition gets its own context so it can be processed
+        // independently of the others.
+        llvm::LLVMContext context;
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> partition,
+                             ParseModuleBitcode(partitions[i], context));
+        std::optional<std::string> key;
+        if (object_cache_ != nullptr) {
+          key = JitObjectCache::ComputeKey(*partition, configuration);
+          std::optional<std::unique_ptr<llvm::MemoryBuffer>> cached =
+              object_cache_->Lookup(*key);
+          if (cached.has_value()) {
+            objects[i] = *std::move(cached);
+            return absl::OkStatus();
+          }
+        }
+        llvm::Error error = PerformStandardOptimization(partition.get());
+        if (error) {
+          return absl::UnknownError(
+              absl::StrFormat("Error optimizing module partition: %s",
+                              llvm::toString(std::move(error))));
+        }
+        // Target machines may not be shared between threads.
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target,
+                             CreateTargetMachine());
+        llvm::orc::SimpleCompiler compiler(*target);
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+            compiler(*partition);
+        if (!object) {
+          return absl::UnknownError(
+              absl::StrFormat("Error compiling module partition: %s",
+                              llvm::toString(object.takeError())));
+        }
+        if (key.has_value()) {
+          absl::Status stored = object_cache_->Store(
+              *key, std::string_view((*object)->getBufferStart(),
+                                     (*object)->getBufferSize()));
+          if (!stored.ok()) {
+            LOG(WARNING) << stored;
+          }
+        }
+        objects[i] = std::move(*object);
+        return absl::OkStatus();
+      }));
+
+  for (std::unique_ptr<llvm::MemoryBuffer>& object : objects) {
+    llvm::Error error = object_layer_.add(dylib_, std::move(object));
+    if (error) {
+      return absl::UnknownError(
+          absl::StrFormat("Error linking compiled module partition: %s",
+                          llvm::toString(std::move(error))));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<llvm::orc::ExecutorAddr> OrcJit::LoadSymbol(
     std::string_view function_name) {
 #ifdef __APPLE__
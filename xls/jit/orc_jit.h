@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
 
 #include "absl/status/status.h"
@@ -31,6 +32,7 @@
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
@@ -50,16 +52,29 @@ class OrcJit : public LlvmCompiler {
   // compiler should use the 3-argument version above. Passing nullopt to
   // emit_msan directs the jit to use MSAN if the running binary is MSAN and
   // vice-versa.
+  //
+  // If `object_cache` is non-null compiled object code is looked up in and
+  // stored to the given cache. By default the process-wide cache configured by
+  // the XLS_JIT_OBJECT_CACHE_DIR environment variable (if any) is used. Caching
+  // is always disabled when observer callbacks are included since the
+  // generated code then embeds process-specific node pointers.
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
       int64_t opt_level = kDefaultOptLevel,
       bool include_observer_callbacks = false,
-      JitObserver* jit_observer = nullptr);
+      JitObserver* jit_observer = nullptr,
+      JitObjectCache* object_cache = JitObjectCache::GetDefault());
 
   void SetJitObserver(JitObserver* o) { jit_observer_ = o; }
 
   JitObserver* jit_observer() const { return jit_observer_; }
 
-  // Compiles the given LLVM module into the JIT's execution session.
+  // Compiles the given LLVM module into the JIT's execution session. If the
+  // object cache holds code for an identical module the cached object is
+  // linked instead and no JitObserver module/assembly notifications are sent.
+  //
+  // Large modules are split and the pieces are optimized and compiled
+  // concurrently using up to compile_threads() threads unless a JitObserver is
+  // set (observers expect to see the whole module).
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
   // Returns the address of the given JIT'ed function.
@@ -76,7 +91,17 @@ class OrcJit : public LlvmCompiler {
   absl::Status InitInternal() override;
 
  private:
-  OrcJit(int64_t opt_level, bool include_msan, bool include_observer_callbacks);
+  OrcJit(int64_t opt_level, bool include_msan, bool include_observer_callbacks,
+         JitObjectCache* object_cache);
+
+  // Returns a description of the compiler configuration which, together with
+  // the module contents, determines the generated object code.
+  std::string ObjectCacheConfiguration() const;
+
+  // Splits the module into up to compile_threads() partitions, optimizes and
+  // compiles each on its own thread, and adds the resulting objects to the
+  // dylib. The object cache, if any, is consulted per partition.
+  absl::Status CompileModuleInParallel(std::unique_ptr<llvm::Module> module);
 
   // Method which optimizes the given module. Used within the JIT to form an IR
   // transform layer.
@@ -93,6 +118,9 @@ class OrcJit : public LlvmCompiler {
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
 
   JitObserver* jit_observer_ = nullptr;
+
+  // Cache of compiled object code. May be null.
+  JitObjectCache* const object_cache_;
 };
 
 }  // namespace xls
@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/parallel_compile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "llvm/include/llvm/ADT/STLExtras.h"
+#include "llvm/include/llvm/ADT/StringRef.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/GlobalValue.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBufferRef.h"
+#include "llvm/include/llvm/Support/raw_ostream.h"
+#include "llvm/include/llvm/Transforms/Utils/SplitModule.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+
+int64_t CountInstructions(const llvm::Module& module) {
+  int64_t count = 0;
+  for (const llvm::Function& function : module) {
+    count += function.getInstructionCount();
+  }
+  return count;
+}
+
+std::vector<std::string> SplitModuleToBitcode(llvm::Module& module,
+                                              int64_t partition_count) {
+  std::vector<std::string> partitions;
+  llvm::SplitModule(
+      module, std::max<int64_t>(partition_count, 1),
+      [&](std::unique_ptr<llvm::Module> partition) {
+        if (llvm::none_of(partition->global_values(),
+                          [](const llvm::GlobalValue& value) {
+                            return !value.isDeclaration();
+                          })) {
+          return;
+        }
+        partitions.push_back(WriteModuleBitcode(*partition));
+      },
+      /*PreserveLocals=*/true);
+  VLOG(2) << absl::StreamFormat("Split module `%s` into %d partitions",
+                                module.getModuleIdentifier(),
+                                partitions.size());
+  return partitions;
+}
+
+std::string WriteModuleBitcode(const llvm::Module& module) {
+  std::string bitcode;
+  llvm::raw_string_ostream ostream(bitcode);
+  llvm::WriteBitcodeToFile(module, ostream);
+  ostream.flush();
+  return bitcode;
+}
+
+absl::StatusOr<std::unique_ptr<llvm::Module>> ParseModuleBitcode(
+    std::string_view bitcode, llvm::LLVMContext& context) {
+  llvm::Expected<std::unique_ptr<llvm::Module>> module =
+      llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+                                "partition"),
+          context);
+  if (!module) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to parse module bitcode: %s",
+                        llvm::toString(module.takeError())));
+  }
+  return std::move(*module);
+}
+
+absl::Status ParallelFor(int64_t count, int64_t thread_count,
+                         const std::function<absl::Status(int64_t)>& fn) {
+  std::vector<absl::Status> statuses(count);
+  std::atomic<int64_t> next = 0;
+  auto work = [&]() {
+    for (int64_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+      statuses[i] = fn(i);
+    }
+  };
+  // The calling thread also does work so only `thread_count - 1` additional
+  // threads are needed.
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < std::min(thread_count, count); ++i) {
+    threads.push_back(std::make_unique<Thread>(work));
+  }
+  work();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (absl::Status& status : statuses) {
+    if (!status.ok()) {
+      return std::move(status);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_PARALLEL_COMPILE_H_
+#define XLS_JIT_PARALLEL_COMPILE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace llvm {
+class LLVMContext;
+class Module;
+}  // namespace llvm
+
+namespace xls {
+
+// Utilities for splitting a large LLVM module into pieces which can be
+// optimized and compiled concurrently.
+
+// Returns the number of LLVM instructions in the given module.
+int64_t CountInstructions(const llvm::Module& module);
+
+// Splits `module` into at most `partition_count` modules of roughly equal size.
+// Functions are the unit of partitioning. Symbols with local linkage (e.g., the
+// per-node functions emitted by the IR builder) are kept in the same partition
+// as all of their users so inlining within a partition is unaffected; only
+// calls between externally visible functions (e.g., between the partition
+// functions of a jitted function base) cross partition boundaries.
+//
+// Each partition is returned as bitcode so that it can be materialized in its
+// own LLVMContext and processed on any thread. Partitions which define no
+// symbols are omitted. `module` is left in an unspecified state.
+std::vector<std::string> SplitModuleToBitcode(llvm::Module& module,
+                                              int64_t partition_count);
+
+// Serializes the given module to bitcode.
+std::string WriteModuleBitcode(const llvm::Module& module);
+
+// Parses bitcode (e.g., produced by SplitModuleToBitcode) into `context`.
+absl::StatusOr<std::unique_ptr<llvm::Module>> ParseModuleBitcode(
+    std::string_view bitcode, llvm::LLVMContext& context);
+
+// Calls `fn(i)` for every i in [0, count) using up to `thread_count` threads
+// (including the calling thread). Returns the error of the smallest failing
+// index, if any.
+absl::Status ParallelFor(int64_t count, int64_t thread_count,
+                         const std::function<absl::Status(int64_t)>& fn);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_PARALLEL_COMPILE_H_
@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/parallel_compile.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/aot_compiler.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_object_cache.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+
+// Number of multiply-add steps in the test function. Large enough that the
+// function is divided into several partition functions.
+constexpr int64_t kSteps = 400;
+
+uint32_t ExpectedResult(uint32_t x, uint32_t y) {
+  uint32_t acc = x;
+  for (int64_t i = 0; i < kSteps; ++i) {
+    acc = acc * 3 + (y ^ static_cast<uint32_t>(i));
+  }
+  return acc;
+}
+
+class ParallelCompileTest : public IrTestBase {
+ public:
+  absl::StatusOr<Function*> TestFunction(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    BValue acc = x;
+    for (int64_t i = 0; i < kSteps; ++i) {
+      acc = fb.Add(fb.UMul(acc, fb.Literal(UBits(3, 32))),
+                   fb.Xor(y, fb.Literal(UBits(i, 32))));
+    }
+    return fb.Build();
+  }
+
+  // Compiles `f` splitting the module into up to `threads` partitions and
+  // evaluates it on (x, y).
+  absl::StatusOr<Value> CompileAndRun(Function* f, int64_t threads,
+                                      JitObjectCache* cache, uint32_t x,
+                                      uint32_t y) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<OrcJit> jit,
+        OrcJit::Create(OrcJit::kDefaultOptLevel,
+                       /*include_observer_callbacks=*/false,
+                       /*jit_observer=*/nullptr, cache));
+    jit->set_compile_threads(threads);
+    jit->set_parallel_compile_min_instructions(0);
+    XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                         jit->CreateDataLayout());
+    JitRuntime runtime(data_layout);
+    XLS_ASSIGN_OR_RETURN(JittedFunctionBase jfb,
+                         JittedFunctionBase::Build(f, *jit));
+    JitArgumentSet inputs = jfb.CreateInputBuffer();
+    JitArgumentSet outputs = jfb.CreateOutputBuffer();
+    JitTempBuffer temp = jfb.CreateTempBuffer();
+    std::vector<Type*> param_types;
+    for (Param* param : f->params()) {
+      param_types.push_back(param->GetType());
+    }
+    XLS_RETURN_IF_ERROR(runtime.PackArgs(
+        {Value(UBits(x, 32)), Value(UBits(y, 32))}, param_types,
+        inputs.pointers()));
+    InterpreterEvents events;
+    InstanceContext context = InstanceContext::CreateForFunc();
+    jfb.RunJittedFunction(inputs, outputs, temp, &events, &context, &runtime,
+                          /*continuation_point=*/0);
+    return runtime.UnpackBuffer(outputs.pointers()[0],
+                                f->return_value()->GetType());
+  }
+};
+
+TEST_F(ParallelCompileTest, ParallelForVisitsEveryIndex) {
+  std::vector<std::atomic<int64_t>> visits(100);
+  XLS_ASSERT_OK(ParallelFor(visits.size(), /*thread_count=*/4,
+                            [&](int64_t i) -> absl::Status {
+                              visits[i].fetch_add(1);
+                              return absl::OkStatus();
+                            }));
+  for (const std::atomic<int64_t>& count : visits) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+TEST_F(ParallelCompileTest, ParallelForReturnsFirstError) {
+  EXPECT_THAT(ParallelFor(20, /*thread_count=*/4,
+                          [&](int64_t i) -> absl::Status {
+                            if (i == 7 || i == 13) {
+                              return absl::InternalError(absl::StrCat(i));
+                            }
+                            return absl::OkStatus();
+                          }),
+              StatusIs(absl::StatusCode::kInternal, "7"));
+}
+
+TEST_F(ParallelCompileTest, JitMatchesSerialCompilation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, TestFunction(p.get()));
+  for (int64_t threads : {1, 2, 4}) {
+    EXPECT_THAT(CompileAndRun(f, threads, /*cache=*/nullptr, 5, 17),
+                IsOkAndHolds(Value(UBits(ExpectedResult(5, 17), 32))))
+        << "threads=" << threads;
+  }
+}
+
+TEST_F(ParallelCompileTest, JitCachesEachPartition) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, TestFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path()));
+
+  EXPECT_THAT(CompileAndRun(f, /*threads=*/4, cache.get(), 1, 2),
+              IsOkAndHolds(Value(UBits(ExpectedResult(1, 2), 32))));
+  int64_t partitions = cache->misses();
+  EXPECT_GT(partitions, 1);
+  EXPECT_EQ(cache->hits(), 0);
+
+  EXPECT_THAT(CompileAndRun(f, /*threads=*/4, cache.get(), 3, 4),
+              IsOkAndHolds(Value(UBits(ExpectedResult(3, 4), 32))));
+  EXPECT_EQ(cache->hits(), partitions);
+  EXPECT_EQ(cache->misses(), partitions);
+}
+
+TEST_F(ParallelCompileTest, AotProducesObjectCode) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, TestFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotCompiler> compiler,
+                           AotCompiler::Create(/*include_msan=*/false));
+  compiler->set_compile_threads(4);
+  compiler->set_parallel_compile_min_instructions(0);
+  XLS_ASSERT_OK(JittedFunctionBase::Build(f, *compiler).status());
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint8_t> object_code,
+                           std::move(*compiler).GetObjectCode());
+  EXPECT_FALSE(object_code.empty());
+}
+
+}  // namespace
+}  // namespace xls
@@ -50,15 +50,45 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
 namespace {
 
+// Creates a buffer holding the state elements of a proc. If
+// `packed_state_layouts` is non-null the state is held in the packed layout,
+// otherwise in the native layout expected by `jit_func`.
+JitArgumentSet CreateStateBuffer(
+    const JittedFunctionBase& jit_func,
+    const std::vector<TypeLayout>* packed_state_layouts) {
+  if (packed_state_layouts == nullptr) {
+    return jit_func.CreateInputOutputBuffer().value();
+  }
+  std::vector<int64_t> sizes;
+  sizes.reserve(packed_state_layouts->size());
+  for (const TypeLayout& layout : *packed_state_layouts) {
+    sizes.push_back(layout.packed_size());
+  }
+  // The packed wrapper makes no alignment assumptions.
+  std::vector<int64_t> alignments(sizes.size(), 1);
+  JitArgumentSet buffer =
+      JitArgumentSet::CreateInputOutput(&jit_func, {alignments, alignments},
+                                        {sizes, sizes})
+          .value();
+  // The packed wrapper unpacks the outputs before running the proc so keep
+  // them defined even if the proc never writes them.
+  for (int64_t i = 0; i < sizes.size(); ++i) {
+    memset(buffer.pointers()[i], 0, sizes[i]);
+  }
+  return buffer;
+}
+
 // A continuation used by the ProcJit. Stores control and data state of proc
 // execution for the JIT.
 class ProcJitContinuation : public ProcContinuation {
@@ -67,12 +97,13 @@ class ProcJitContinuation : public ProcContinuation {
   // set to its initial values with no proc nodes yet executed. `queues` is the
   // set of channel queues needed by this proc instance. The order of the queues
   // in the vector is determined at JIT compile time and stored in the
-  // JittedFunctionBase.
-  explicit ProcJitContinuation(ProcInstance* proc_instance,
-                               JitRuntime* jit_runtime,
-                               std::vector<JitChannelQueue*> queues,
-                               const JittedFunctionBase& jit_func,
-                               bool has_observer_callbacks);
+  // JittedFunctionBase. If `packed_state_layouts` is non-null the state is
+  // held in the packed layout described by the given per-element layouts.
+  explicit ProcJitContinuation(
+      ProcInstance* proc_instance, JitRuntime* jit_runtime,
+      std::vector<JitChannelQueue*> queues, const JittedFunctionBase& jit_func,
+      bool has_observer_callbacks,
+      const std::vector<TypeLayout>* packed_state_layouts);
 
   ~ProcJitContinuation() override = default;
 
@@ -108,7 +139,16 @@ class ProcJitContinuation : public ProcContinuation {
   void ClearObserver() override;
   bool SupportsObservers() const override { return has_observer_callbacks_; }
 
+  bool packed_state() const { return packed_state_layouts_ != nullptr; }
+
  private:
+  // Returns the number of bytes of the buffer holding the given state element.
+  int64_t StateBufferSize(int64_t state_index) const;
+  // Converts between Values and the contents of a state buffer.
+  Value StateBufferToValue(int64_t state_index, const uint8_t* buffer) const;
+  void ValueToStateBuffer(int64_t state_index, const Value& value,
+                          uint8_t* buffer) const;
+
   class RuntimeObserverShim : public RuntimeObserver {
    public:
     explicit RuntimeObserverShim(ProcJitContinuation* owner) : owner_(owner) {}
@@ -149,32 +189,63 @@ class ProcJitContinuation : public ProcContinuation {
 
   // if the code has observer callbacks compiled in.
   bool has_observer_callbacks_;
+
+  // Layouts of the state elements if the state is held in the packed layout,
+  // nullptr otherwise. Owned by the ProcJit.
+  const std::vector<TypeLayout>* packed_state_layouts_;
 };
 
-ProcJitContinuation::ProcJitContinuation(ProcInstance* proc_instance,
-                                         JitRuntime* jit_runtime,
-                                         std::vector<JitChannelQueue*> queues,
-                                         const JittedFunctionBase& jit_func,
-                                         bool has_observer_callbacks)
+ProcJitContinuation::ProcJitContinuation(
+    ProcInstance* proc_instance, JitRuntime* jit_runtime,
+    std::vector<JitChannelQueue*> queues, const JittedFunctionBase& jit_func,
+    bool has_observer_callbacks,
+    const std::vector<TypeLayout>* packed_state_layouts)
     : ProcContinuation(proc_instance),
       continuation_point_(0),
       jit_runtime_(jit_runtime),
-      input_(jit_func.CreateInputOutputBuffer().value()),
-      output_(jit_func.CreateInputOutputBuffer().value()),
+      input_(CreateStateBuffer(jit_func, packed_state_layouts)),
+      output_(CreateStateBuffer(jit_func, packed_state_layouts)),
       temp_buffer_(jit_func.CreateTempBuffer()),
       instance_context_(
           InstanceContext::CreateForProc(proc_instance, std::move(queues))),
       observer_shim_(this),
-      has_observer_callbacks_(has_observer_callbacks) {
+      has_observer_callbacks_(has_observer_callbacks),
+      packed_state_layouts_(packed_state_layouts) {
   // Write initial state value to the input_buffer.
   for (StateElement* state_element : proc()->StateElements()) {
     int64_t state_index = *proc()->GetStateElementIndex(state_element);
-    jit_runtime->BlitValueToBuffer(
-        state_element->initial_value(), state_element->type(),
-        absl::Span<uint8_t>(
-            input_.pointers()[state_index],
-            jit_runtime_->GetTypeByteSize(state_element->type())));
+    ValueToStateBuffer(state_index, state_element->initial_value(),
+                       input_.pointers()[state_index]);
+  }
+}
+
+int64_t ProcJitContinuation::StateBufferSize(int64_t state_index) const {
+  if (packed_state()) {
+    return (*packed_state_layouts_)[state_index].packed_size();
   }
+  return jit_runtime_->GetTypeByteSize(
+      proc()->GetStateElementType(state_index));
+}
+
+Value ProcJitContinuation::StateBufferToValue(int64_t state_index,
+                                              const uint8_t* buffer) const {
+  if (packed_state()) {
+    return (*packed_state_layouts_)[state_index].PackedLayoutToValue(buffer);
+  }
+  return jit_runtime_->UnpackBuffer(buffer,
+                                    proc()->GetStateElementType(state_index));
+}
+
+void ProcJitContinuation::ValueToStateBuffer(int64_t state_index,
+                                             const Value& value,
+                                             uint8_t* buffer) const {
+  if (packed_state()) {
+    (*packed_state_layouts_)[state_index].ValueToPackedLayout(value, buffer);
+    return;
+  }
+  jit_runtime_->BlitValueToBuffer(
+      value, proc()->GetStateElementType(state_index),
+      absl::Span<uint8_t>(buffer, StateBufferSize(state_index)));
 }
 
 void ProcJitContinuation::ClearObserver() {
@@ -201,8 +272,8 @@ std::vector<Value> ProcJitContinuation::GetState() const {
   std::vector<Value> state;
   for (StateElement* state_element : proc()->StateElements()) {
     int64_t state_index = *proc()->GetStateElementIndex(state_element);
-    state.push_back(jit_runtime_->UnpackBuffer(input_.pointers()[state_index],
-                                               state_element->type()));
+    state.push_back(
+        StateBufferToValue(state_index, input_.pointers()[state_index]));
   }
   return state;
 }
@@ -212,11 +283,8 @@ absl::Status ProcJitContinuation::SetState(std::vector<Value> v) {
 
   for (StateElement* state_element : proc()->StateElements()) {
     int64_t state_index = *proc()->GetStateElementIndex(state_element);
-    jit_runtime_->BlitValueToBuffer(
-        v[state_index], state_element->type(),
-        absl::Span<uint8_t>(
-            input_.pointers()[state_index],
-            jit_runtime_->GetTypeByteSize(state_element->type())));
+    ValueToStateBuffer(state_index, v[state_index],
+                       input_.pointers()[state_index]);
   }
 
   return absl::OkStatus();
@@ -269,8 +337,7 @@ absl::Status ProcJitContinuation::NextTick() {
     for (int64_t state_index = 0; state_index < proc()->GetStateElementCount();
          ++state_index) {
       memcpy(output_.pointers()[state_index], input_.pointers()[state_index],
-             jit_runtime_->GetTypeByteSize(
-                 proc()->GetStateElementType(state_index)));
+             StateBufferSize(state_index));
     }
   }
   return absl::OkStatus();
@@ -318,6 +385,8 @@ absl::Status InitializeChannelQueues(
     Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
     const AotEntrypointProto& entrypoint, JitFunctionType unpacked,
     std::optional<JitFunctionType> packed) {
+  XLS_RET_CHECK(!queue_mgr->packed_payloads())
+      << "AOT compiled procs do not support packed channel payloads";
   // TODO(allight): Supporting observer callbacks in aot would be nice.
   auto jit = std::unique_ptr<ProcJit>(
       new ProcJit(proc, jit_runtime, queue_mgr, /*orc_jit=*/nullptr,
@@ -333,7 +402,8 @@ absl::Status InitializeChannelQueues(
 
 absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
     Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
-    bool include_observer_callbacks, JitObserver* jit_observer) {
+    bool include_observer_callbacks, JitObserver* jit_observer,
+    const JitProfileOptions& profile_options, bool packed_state) {
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OrcJit> orc_jit,
       OrcJit::Create(LlvmCompiler::kDefaultOptLevel, include_observer_callbacks,
@@ -341,9 +411,24 @@ absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
   auto jit = absl::WrapUnique(
       new ProcJit(proc, jit_runtime, queue_mgr, std::move(orc_jit),
                   /*has_observer_callbacks=*/include_observer_callbacks));
-  XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       JittedFunctionBase::Build(proc, jit->GetOrcJit()));
+  XLS_ASSIGN_OR_RETURN(
+      jit->jitted_function_base_,
+      JittedFunctionBase::Build(
+          proc, jit->GetOrcJit(), profile_options,
+          JitProcLayoutOptions{
+              .packed_state = packed_state,
+              .packed_channel_payloads = queue_mgr->packed_payloads()}));
   XLS_RET_CHECK(jit->jitted_function_base_.InputsAndOutputsAreEquivalent());
+  if (packed_state) {
+    XLS_RET_CHECK(jit->jitted_function_base_.HasPackedFunction());
+    std::vector<TypeLayout> layouts;
+    layouts.reserve(proc->GetStateElementCount());
+    for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+      layouts.push_back(
+          jit_runtime->CreateTypeLayout(proc->GetStateElementType(i)));
+    }
+    jit->packed_state_layouts_ = std::move(layouts);
+  }
 
   XLS_RETURN_IF_ERROR(InitializeChannelQueues(
       proc, queue_mgr, jit->jitted_function_base_, jit->channel_queues_));
@@ -356,7 +441,8 @@ std::unique_ptr<ProcContinuation> ProcJit::NewContinuation(
   CHECK_EQ(proc_instance->proc(), proc());
   return std::make_unique<ProcJitContinuation>(
       proc_instance, jit_runtime_, channel_queues_.at(proc_instance),
-      jitted_function_base_, has_observer_callbacks_);
+      jitted_function_base_, has_observer_callbacks_,
+      packed_state_layouts_.has_value() ? &*packed_state_layouts_ : nullptr);
 }
 
 absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
@@ -367,9 +453,20 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
 
   // The jitted function returns the early exit point at which execution
   // halted. A return value of zero indicates that the tick completed.
-  int64_t next_continuation_point = jitted_function_base_.RunJittedFunction(
-      cont->input(), cont->output(), cont->temp_buffer(), &cont->GetEvents(),
-      cont->instance_context(), runtime(), cont->GetContinuationPoint());
+  int64_t next_continuation_point;
+  if (cont->packed_state()) {
+    std::optional<int64_t> result =
+        jitted_function_base_.RunPackedJittedFunction(
+            cont->input().get(), cont->output().get(),
+            cont->temp_buffer().get(), &cont->GetEvents(),
+            cont->instance_context(), runtime(), cont->GetContinuationPoint());
+    XLS_RET_CHECK(result.has_value());
+    next_continuation_point = *result;
+  } else {
+    next_continuation_point = jitted_function_base_.RunJittedFunction(
+        cont->input(), cont->output(), cont->temp_buffer(), &cont->GetEvents(),
+        cont->instance_context(), runtime(), cont->GetContinuationPoint());
+  }
 
   if (next_continuation_point == 0) {
     // The proc successfully completed its tick.
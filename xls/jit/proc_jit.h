@@ -29,9 +29,11 @@
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -40,10 +42,17 @@ namespace xls {
 class ProcJit : public ProcEvaluator {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // proc.
+  // proc. `profile_options` can be used to instrument the code to gather a
+  // JitProfile (see GetProfile) or to compile with the branch weights of an
+  // earlier profile. If `packed_state` is true the continuations hold the
+  // proc state in the bit-packed layout (see TypeLayout) between ticks rather
+  // than the native LLVM layout. Channel payloads use the layout of the queues
+  // in `queue_mgr`.
   static absl::StatusOr<std::unique_ptr<ProcJit>> Create(
       Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
-      bool include_observer_callbacks = false, JitObserver* observer = nullptr);
+      bool include_observer_callbacks = false, JitObserver* observer = nullptr,
+      const JitProfileOptions& profile_options = JitProfileOptions(),
+      bool packed_state = false);
 
   static absl::StatusOr<std::unique_ptr<ProcJit>> CreateFromAot(
       Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
@@ -59,6 +68,13 @@ class ProcJit : public ProcEvaluator {
 
   JitRuntime* runtime() const { return jit_runtime_; }
 
+  // Returns the counts gathered so far by all instances of the proc if it was
+  // compiled with profiling instrumentation, or an empty profile otherwise.
+  JitProfile GetProfile() const { return jitted_function_base_.GetProfile(); }
+
+  // Whether the proc state is held in the packed layout.
+  bool packed_state() const { return packed_state_layouts_.has_value(); }
+
   OrcJit& GetOrcJit() { return *orc_jit_; }
 
  private:
@@ -78,6 +94,9 @@ class ProcJit : public ProcEvaluator {
   // We need to have compiled in the callbacks in order to support the
   // Evaluation/RuntimeObserver apis.
   bool has_observer_callbacks_;
+  // Layouts of the state elements (in state element index order) if the state
+  // is held in the packed layout.
+  std::optional<std::vector<TypeLayout>> packed_state_layouts_;
 
   // The set of channel queues used in each proc instance. The vector is in a
   // predetermined order assigned at JIT compile time. The JITted code looks for
@@ -24,6 +24,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -37,32 +38,42 @@ JitRuntime* GetJitRuntime() {
   return jit_runtime.get();
 }
 
-template <bool kWithObserver>
+template <bool kWithObserver, bool kPackedState = false>
 std::unique_ptr<ProcEvaluator> EvaluatorFromProc(
     Proc* proc, ChannelQueueManager* queue_manager) {
   JitChannelQueueManager* jit_queue_manager =
       dynamic_cast<JitChannelQueueManager*>(queue_manager);
   CHECK(jit_queue_manager != nullptr);
   return ProcJit::Create(proc, GetJitRuntime(), jit_queue_manager,
-                         /*include_observer_callbacks=*/kWithObserver)
+                         /*include_observer_callbacks=*/kWithObserver,
+                         /*observer=*/nullptr, JitProfileOptions(),
+                         /*packed_state=*/kPackedState)
       .value();
 }
 
+template <bool kPackedPayloads = false>
 std::unique_ptr<ChannelQueueManager> QueueManagerForPackage(Package* package) {
   return JitChannelQueueManager::CreateThreadSafe(
              package,
-             std::make_unique<JitRuntime>(GetJitRuntime()->data_layout()))
+             std::make_unique<JitRuntime>(GetJitRuntime()->data_layout()),
+             /*packed_payloads=*/kPackedPayloads)
       .value();
 }
 // Instantiate and run all the tests in proc_evaluator_test_base.cc.
 INSTANTIATE_TEST_SUITE_P(
     ProcJitTest, ProcEvaluatorTestBase,
     testing::Values(ProcEvaluatorTestParam(EvaluatorFromProc<false>,
-                                           QueueManagerForPackage,
+                                           QueueManagerForPackage<>,
                                            /*supports_observers=*/false),
                     ProcEvaluatorTestParam(EvaluatorFromProc<true>,
-                                           QueueManagerForPackage,
-                                           /*supports_observers=*/true)));
+                                           QueueManagerForPackage<>,
+                                           /*supports_observers=*/true),
+                    // Bit-packed proc state and channel payloads.
+                    ProcEvaluatorTestParam(
+                        EvaluatorFromProc</*kWithObserver=*/false,
+                                          /*kPackedState=*/true>,
+                        QueueManagerForPackage</*kPackedPayloads=*/true>,
+                        /*supports_observers=*/false)));
 
 }  // namespace
 }  // namespace xls
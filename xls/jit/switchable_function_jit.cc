@@ -18,17 +18,24 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/bytecode_interpreter.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
+#include "xls/ir/keyword_args.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/value.h"
@@ -65,6 +72,47 @@ SwitchableFunctionJit::CreateInterpreter(Function* xls_function) {
       new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
 }
 
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateBytecode(Function* xls_function) {
+  auto runner = std::unique_ptr<SwitchableFunctionJit>(
+      new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
+  XLS_ASSIGN_OR_RETURN(runner->bytecode_,
+                       BytecodeFunctionInterpreter::Create(xls_function));
+  return runner;
+}
+
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateTiered(Function* xls_function, int64_t opt_level,
+                                    JitObserver* observer) {
+  auto runner = std::unique_ptr<SwitchableFunctionJit>(
+      new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
+  runner->tiered_ = std::make_unique<TieredCompilation>();
+  TieredCompilation* tiered = runner->tiered_.get();
+  tiered->observer = observer;
+  // The compilation creates types in the package's TypeManager concurrently
+  // with the interpreter (and any other user of the package); TypeManager
+  // serializes these with its own lock.
+  tiered->thread = std::make_unique<Thread>(
+      [tiered, xls_function, opt_level, observer]() {
+        absl::Time start = absl::Now();
+        absl::StatusOr<std::unique_ptr<FunctionJit>> jit = FunctionJit::Create(
+            xls_function, opt_level,
+            /*include_observer_callbacks=*/false, observer);
+        absl::Duration latency = absl::Now() - start;
+        VLOG(1) << "Tiered compilation of " << xls_function->name()
+                << " finished in " << latency << ": " << jit.status();
+        if (observer != nullptr &&
+            observer->GetNotificationOptions().tiering_events) {
+          observer->TieredCompilationComplete(xls_function, latency,
+                                              jit.status());
+        }
+        absl::MutexLock lock(&tiered->mutex);
+        tiered->result = std::move(jit);
+        tiered->done = true;
+      });
+  return runner;
+}
+
 absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
 SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
                               int64_t opt_level, JitObserver* observer) {
@@ -76,9 +124,14 @@ SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
   switch (execution) {
     case ExecutionType::kInterpreter:
       return SwitchableFunctionJit::CreateInterpreter(xls_function);
+    case ExecutionType::kBytecode:
+      return SwitchableFunctionJit::CreateBytecode(xls_function);
     case ExecutionType::kJit:
       return SwitchableFunctionJit::CreateJit(xls_function, opt_level,
                                               observer);
+    case ExecutionType::kTiered:
+      return SwitchableFunctionJit::CreateTiered(xls_function, opt_level,
+                                                 observer);
     case ExecutionType::kDefault:
       LOG(FATAL) << "Unreachable";
   }
@@ -129,20 +182,68 @@ absl::StatusOr<InterpreterResult<Value>> Interpret(
 }
 }  // namespace
 
+void SwitchableFunctionJit::MaybeSwitchToJit(bool wait) {
+  if (tiered_ == nullptr) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&tiered_->mutex);
+    if (wait) {
+      tiered_->mutex.Await(absl::Condition(&tiered_->done));
+    } else if (!tiered_->done) {
+      return;
+    }
+  }
+  tiered_->thread->Join();
+  tiered_status_ = tiered_->result.status();
+  if (tiered_->result.ok()) {
+    function_jit_ = *std::move(tiered_->result);
+    use_jit_ = true;
+    JitObserver* observer = tiered_->observer;
+    if (observer != nullptr &&
+        observer->GetNotificationOptions().tiering_events) {
+      observer->SwitchedToJit(xls_function_, interpreted_invocations_);
+    }
+  } else {
+    // Compilation failure is not fatal; keep using the interpreter.
+    LOG(WARNING) << "Tiered compilation of " << xls_function_->name()
+                 << " failed, continuing in the interpreter: "
+                 << tiered_status_;
+  }
+  tiered_.reset();
+}
+
+absl::Status SwitchableFunctionJit::WaitForJit() {
+  MaybeSwitchToJit(/*wait=*/true);
+  return tiered_status_;
+}
+
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     absl::Span<const Value> args) {
+  MaybeSwitchToJit(/*wait=*/false);
   if (use_jit_) {
     return function_jit_->Run(args);
   }
+  if (bytecode_ != nullptr) {
+    return bytecode_->Run(args);
+  }
+  ++interpreted_invocations_;
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(args, function()));
   return Interpret(std::move(node_args), function());
 }
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
+  MaybeSwitchToJit(/*wait=*/false);
   if (use_jit_) {
     return function_jit_->Run(kwargs);
   }
+  if (bytecode_ != nullptr) {
+    XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                         KeywordArgsToPositional(*function(), kwargs));
+    return bytecode_->Run(args);
+  }
+  ++interpreted_invocations_;
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(kwargs, function()));
   return Interpret(std::move(node_args), function());
 }
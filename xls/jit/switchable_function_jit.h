@@ -21,9 +21,14 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/bytecode_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
@@ -36,6 +41,13 @@ enum class ExecutionType {
   kDefault,
   kJit,
   kInterpreter,
+  // Compile the function to interpreter bytecode (see
+  // BytecodeFunctionInterpreter). Cheap to create like the interpreter while
+  // evaluating narrow datapaths much faster.
+  kBytecode,
+  // Start executing in the interpreter while the JIT compiles the function on
+  // a background thread and switch to jitted code once it is ready.
+  kTiered,
 };
 
 // A wrapper for the jit structures that can be turned off at build time if
@@ -51,6 +63,16 @@ class SwitchableFunctionJit {
       JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
   CreateInterpreter(Function* xls_function);
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> CreateBytecode(
+      Function* xls_function);
+  // Returns an object which interprets the function until a JIT compiled
+  // version, built on a background thread, becomes available. The switch
+  // happens between calls to Run. The compilation and the switch are reported
+  // to `observer` (if any). The function must not be modified while the
+  // compilation is in progress.
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> CreateTiered(
+      Function* xls_function, int64_t opt_level = 3,
+      JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> Create(
       Function* xls_function, ExecutionType execution = ExecutionType::kDefault,
       int64_t opt_level = 3, JitObserver* observer = nullptr);
@@ -74,16 +96,43 @@ class SwitchableFunctionJit {
     return std::nullopt;
   }
 
+  // For tiered execution, blocks until the background compilation is done
+  // and switches to the jitted code if compilation succeeded. Returns the
+  // status of the compilation. Returns OK immediately for the other execution
+  // types.
+  absl::Status WaitForJit();
+
  private:
+  // State shared with the background compilation thread in tiered mode.
+  struct TieredCompilation {
+    JitObserver* observer;
+    absl::Mutex mutex;
+    bool done ABSL_GUARDED_BY(mutex) = false;
+    absl::StatusOr<std::unique_ptr<FunctionJit>> result ABSL_GUARDED_BY(mutex);
+    std::unique_ptr<Thread> thread;
+  };
+
   explicit SwitchableFunctionJit(Function* xls_function, bool use_jit,
                                  std::unique_ptr<FunctionJit>&& jit)
       : xls_function_(xls_function),
         use_jit_(use_jit),
         function_jit_(std::move(jit)) {}
 
+  // Switches to the jitted code if the background compilation has completed.
+  // If `wait` is true blocks until it does.
+  void MaybeSwitchToJit(bool wait);
+
   Function* xls_function_;
   bool use_jit_;
   std::unique_ptr<FunctionJit> function_jit_;
+  // Non-null for bytecode execution.
+  std::unique_ptr<BytecodeFunctionInterpreter> bytecode_;
+
+  // Non-null while a background compilation is pending.
+  std::unique_ptr<TieredCompilation> tiered_;
+  absl::Status tiered_status_;
+  // Number of calls executed by the interpreter in tiered mode.
+  int64_t interpreted_invocations_ = 0;
 };
 }  // namespace xls
 
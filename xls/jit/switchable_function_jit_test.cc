@@ -14,16 +14,24 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/observer.h"
 
 namespace xls {
 namespace {
@@ -53,6 +61,25 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteInterpreter) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+TEST_F(SwitchableFunctionJitTest, CanExecuteBytecode) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kBytecode));
+  EXPECT_FALSE(runner->function_jit().has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      runner->Run(std::vector<Value>{Value(UBits(8, 8)), Value(UBits(4, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, runner->Run(absl::flat_hash_map<std::string, Value>{
+                  {"p1", Value(UBits(200, 8))}, {"p2", Value(UBits(100, 8))}}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(44, 8)), Value(UBits(32, 8))}));
+}
+
 TEST_F(SwitchableFunctionJitTest, CanExecuteJit) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
@@ -79,5 +106,77 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteDefault) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+class TieringObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.tiering_events = true};
+  }
+  void TieredCompilationComplete(FunctionBase* function_base,
+                                 absl::Duration latency,
+                                 const absl::Status& status) override {
+    compiled = function_base;
+    compile_status = status;
+  }
+  void SwitchedToJit(FunctionBase* function_base,
+                     int64_t interpreted_invocations) override {
+    switched = function_base;
+    invocations_before_switch = interpreted_invocations;
+  }
+
+  FunctionBase* compiled = nullptr;
+  absl::Status compile_status;
+  FunctionBase* switched = nullptr;
+  std::optional<int64_t> invocations_before_switch;
+};
+
+TEST_F(SwitchableFunctionJitTest, CanExecuteTiered) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  TieringObserver observer;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kTiered,
+                                                 /*opt_level=*/3, &observer));
+  // Whichever tier runs the call the result is the same.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      runner->Run(std::vector<Value>{Value(UBits(8, 8)), Value(UBits(4, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
+
+  XLS_ASSERT_OK(runner->WaitForJit());
+  EXPECT_TRUE(runner->function_jit().has_value());
+  EXPECT_EQ(observer.compiled, f);
+  XLS_EXPECT_OK(observer.compile_status);
+  EXPECT_EQ(observer.switched, f);
+  ASSERT_TRUE(observer.invocations_before_switch.has_value());
+  EXPECT_LE(*observer.invocations_before_switch, 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result,
+      runner->Run(std::vector<Value>{Value(UBits(3, 8)), Value(UBits(5, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(8, 8)), Value(UBits(15, 8))}));
+}
+
+TEST_F(SwitchableFunctionJitTest, TieredCompilationRacesTypeCreation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kTiered));
+  // The background compilation looks up and creates types in the package
+  // while the foreground does the same; run under TSAN this checks that the
+  // two are synchronized.
+  for (int64_t i = 1; i < 256; ++i) {
+    p->GetArrayType(2, p->GetBitsType(i));
+    XLS_ASSERT_OK(
+        runner->Run(std::vector<Value>{Value(UBits(i % 8, 8)),
+                                       Value(UBits(1, 8))})
+            .status());
+  }
+  XLS_ASSERT_OK(runner->WaitForJit());
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,234 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/tiered_proc_evaluator.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/observer.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/events.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/observer.h"
+
+namespace xls {
+namespace {
+
+// Continuation which wraps the continuation of whichever evaluator is
+// currently executing the proc instance.
+class TieredProcContinuation final : public ProcContinuation {
+ public:
+  TieredProcContinuation(ProcInstance* proc_instance,
+                         std::unique_ptr<ProcContinuation> interpreted)
+      : ProcContinuation(proc_instance), active_(std::move(interpreted)) {}
+
+  std::vector<Value> GetState() const override { return active_->GetState(); }
+  absl::Status SetState(std::vector<Value> v) override {
+    return active_->SetState(std::move(v));
+  }
+  const InterpreterEvents& GetEvents() const override {
+    return active_->GetEvents();
+  }
+  InterpreterEvents& GetEvents() override { return active_->GetEvents(); }
+  void ClearEvents() override { active_->ClearEvents(); }
+  bool AtStartOfTick() const override { return active_->AtStartOfTick(); }
+
+  void ClearObserver() override {
+    ProcContinuation::ClearObserver();
+    active_->ClearObserver();
+    switch_blocked_by_observer_ = false;
+  }
+  absl::Status SetObserver(EvaluationObserver* observer) override {
+    XLS_RETURN_IF_ERROR(active_->SetObserver(observer));
+    return ProcContinuation::SetObserver(observer);
+  }
+  bool SupportsObservers() const override {
+    return active_->SupportsObservers();
+  }
+
+  ProcContinuation& active() { return *active_; }
+  bool compiled() const { return compiled_; }
+  bool switch_blocked_by_observer() const {
+    return switch_blocked_by_observer_;
+  }
+  int64_t interpreted_ticks() const { return interpreted_ticks_; }
+  void IncrementInterpretedTicks() { ++interpreted_ticks_; }
+
+  // Moves execution to `compiled`, carrying over the proc state, events and
+  // observer. Must be called at the start of a tick. Returns false, leaving
+  // execution where it is until the observer is cleared, if an observer is
+  // attached and `compiled` was built without observer callbacks.
+  absl::StatusOr<bool> SwitchTo(std::unique_ptr<ProcContinuation> compiled) {
+    CHECK(AtStartOfTick());
+    if (GetObserver().has_value() && !compiled->SupportsObservers()) {
+      VLOG(1) << "Not switching proc instance "
+              << proc_instance()->GetName()
+              << " to the compiled tier: it does not support observers";
+      switch_blocked_by_observer_ = true;
+      return false;
+    }
+    XLS_RETURN_IF_ERROR(compiled->SetState(active_->GetState()));
+    compiled->GetEvents() = active_->GetEvents();
+    if (GetObserver().has_value()) {
+      XLS_RETURN_IF_ERROR(compiled->SetObserver(*GetObserver()));
+    }
+    active_ = std::move(compiled);
+    compiled_ = true;
+    return true;
+  }
+
+ private:
+  std::unique_ptr<ProcContinuation> active_;
+  bool compiled_ = false;
+  // Set when a switch was refused because of the attached observer, so the
+  // compiled continuation is not recreated on every tick.
+  bool switch_blocked_by_observer_ = false;
+  int64_t interpreted_ticks_ = 0;
+};
+
+}  // namespace
+
+TieredProcEvaluator::TieredProcEvaluator(
+    Proc* proc, std::unique_ptr<ProcEvaluator> interpreter, CompileFn compile,
+    JitObserver* observer, int64_t warmup_ticks)
+    : ProcEvaluator(proc),
+      interpreter_(std::move(interpreter)),
+      compile_(std::move(compile)),
+      observer_(observer),
+      warmup_ticks_(warmup_ticks) {
+  if (warmup_ticks_ <= 0) {
+    StartCompilation();
+  }
+}
+
+void TieredProcEvaluator::StartCompilation() const {
+  absl::MutexLock lock(&mutex_);
+  if (thread_ != nullptr) {
+    return;
+  }
+  VLOG(1) << "Starting tiered compilation of proc " << proc()->name()
+          << " after " << first_tier_ticks_.load() << " ticks";
+  // The thread only reads members which are immutable after construction
+  // until it takes the lock to publish its result.
+  auto* self = const_cast<TieredProcEvaluator*>(this);
+  thread_ = std::make_unique<Thread>([self]() {
+    absl::Time start = absl::Now();
+    absl::StatusOr<std::unique_ptr<ProcEvaluator>> compiled = self->compile_();
+    absl::Duration latency = absl::Now() - start;
+    VLOG(1) << "Tiered compilation of proc " << self->proc()->name()
+            << " finished in " << latency << ": " << compiled.status();
+    if (!compiled.ok()) {
+      LOG(WARNING) << "Tiered compilation of proc " << self->proc()->name()
+                   << " failed, continuing in the first tier: "
+                   << compiled.status();
+    }
+    if (self->observer_ != nullptr &&
+        self->observer_->GetNotificationOptions().tiering_events) {
+      self->observer_->TieredCompilationComplete(self->proc(), latency,
+                                                 compiled.status());
+    }
+    absl::MutexLock lock(&self->mutex_);
+    self->compile_status_ = compiled.status();
+    if (compiled.ok()) {
+      self->compiled_ = *std::move(compiled);
+      self->compiled_ptr_.store(self->compiled_.get(),
+                                std::memory_order_release);
+    }
+    self->done_ = true;
+  });
+}
+
+TieredProcEvaluator::~TieredProcEvaluator() {
+  std::unique_ptr<Thread> thread;
+  {
+    absl::MutexLock lock(&mutex_);
+    thread = std::move(thread_);
+  }
+  // The thread takes the lock before finishing so it must be joined without
+  // holding it.
+  if (thread != nullptr) {
+    thread->Join();
+  }
+}
+
+absl::Status TieredProcEvaluator::WaitForCompilation() const {
+  absl::MutexLock lock(&mutex_);
+  if (thread_ == nullptr) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Compilation of proc %s has not started; %d of %d warm-up ticks done",
+        proc()->name(), first_tier_ticks_.load(), warmup_ticks_));
+  }
+  mutex_.Await(absl::Condition(&done_));
+  return compile_status_;
+}
+
+/* static */ bool TieredProcEvaluator::IsCompiled(
+    const ProcContinuation& continuation) {
+  return static_cast<const TieredProcContinuation&>(continuation).compiled();
+}
+
+std::unique_ptr<ProcContinuation> TieredProcEvaluator::NewContinuation(
+    ProcInstance* proc_instance) const {
+  return std::make_unique<TieredProcContinuation>(
+      proc_instance, interpreter_->NewContinuation(proc_instance));
+}
+
+absl::StatusOr<TickResult> TieredProcEvaluator::Tick(
+    ProcContinuation& continuation) const {
+  auto& tiered = static_cast<TieredProcContinuation&>(continuation);
+  if (!tiered.compiled() && !tiered.switch_blocked_by_observer() &&
+      tiered.AtStartOfTick()) {
+    if (const ProcEvaluator* compiled_evaluator = compiled();
+        compiled_evaluator != nullptr) {
+      XLS_ASSIGN_OR_RETURN(
+          bool switched,
+          tiered.SwitchTo(
+              compiled_evaluator->NewContinuation(tiered.proc_instance())));
+      if (switched && observer_ != nullptr &&
+          observer_->GetNotificationOptions().tiering_events) {
+        observer_->SwitchedToJit(proc(), tiered.interpreted_ticks());
+      }
+    }
+  }
+  if (tiered.compiled()) {
+    return compiled()->Tick(tiered.active());
+  }
+  XLS_ASSIGN_OR_RETURN(TickResult result, interpreter_->Tick(tiered.active()));
+  if (result.execution_state == TickExecutionState::kCompleted) {
+    tiered.IncrementInterpretedTicks();
+    if (warmup_ticks_ > 0 &&
+        first_tier_ticks_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+            warmup_ticks_) {
+      StartCompilation();
+    }
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,107 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_TIERED_PROC_EVALUATOR_H_
+#define XLS_JIT_TIERED_PROC_EVALUATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/jit/observer.h"
+
+namespace xls {
+
+// A proc evaluator which starts out ticking procs with a (cheap to create)
+// interpreter while a compiled evaluator (e.g., a ProcJit) is built on a
+// background thread. Each proc instance switches to the compiled evaluator at
+// the first tick boundary after it becomes available; the proc state is
+// transferred with ProcContinuation::SetState. Instances which are blocked in
+// the middle of a tick finish that tick in the interpreter, and instances with
+// an observer attached stay in the first tier while the observer is attached
+// if the compiled evaluator does not support observers.
+//
+// Both evaluators must operate on the same channel queues.
+//
+// The first tier need not be an interpreter. For profile-guided compilation it
+// is a profiling-instrumented ProcJit and `warmup_ticks` delays the second
+// compilation until the instrumented code has gathered a profile.
+class TieredProcEvaluator : public ProcEvaluator {
+ public:
+  using CompileFn =
+      std::function<absl::StatusOr<std::unique_ptr<ProcEvaluator>>()>;
+
+  // Creates the evaluator. `compile` is called on a background thread, either
+  // immediately or, if `warmup_ticks` is positive, once the first tier has
+  // completed that many ticks (summed over all proc instances). Background
+  // compilation and per-instance switches are reported to `observer` (if not
+  // null).
+  TieredProcEvaluator(Proc* proc, std::unique_ptr<ProcEvaluator> interpreter,
+                      CompileFn compile, JitObserver* observer = nullptr,
+                      int64_t warmup_ticks = 0);
+  ~TieredProcEvaluator() override;
+
+  std::unique_ptr<ProcContinuation> NewContinuation(
+      ProcInstance* proc_instance) const override;
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override;
+
+  // Blocks until the background compilation is done and returns its status.
+  // Returns a FailedPrecondition error if the compilation has not started
+  // because the warm-up period has not elapsed yet.
+  absl::Status WaitForCompilation() const;
+
+  // Returns true if `continuation` (which must have been created by this
+  // evaluator) is executing with the compiled evaluator.
+  static bool IsCompiled(const ProcContinuation& continuation);
+
+ private:
+  // Returns the compiled evaluator if it is ready, nullptr otherwise.
+  const ProcEvaluator* compiled() const {
+    return compiled_ptr_.load(std::memory_order_acquire);
+  }
+
+  // Starts the background compilation if it has not been started yet.
+  void StartCompilation() const;
+
+  std::unique_ptr<ProcEvaluator> interpreter_;
+  CompileFn compile_;
+  JitObserver* observer_;
+  int64_t warmup_ticks_;
+  // Number of ticks completed by the first tier.
+  mutable std::atomic<int64_t> first_tier_ticks_ = 0;
+
+  mutable absl::Mutex mutex_;
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status compile_status_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<ProcEvaluator> compiled_ ABSL_GUARDED_BY(mutex_);
+  // Lock-free view of `compiled_` for the tick path; set once.
+  std::atomic<const ProcEvaluator*> compiled_ptr_ = nullptr;
+
+  // The background compilation thread. Joined by the destructor.
+  mutable std::unique_ptr<Thread> thread_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_TIERED_PROC_EVALUATOR_H_
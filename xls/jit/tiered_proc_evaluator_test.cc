@@ -0,0 +1,341 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/tiered_proc_evaluator.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/observer.h"
+#include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/jit_profile.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/observer.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+namespace {
+
+JitRuntime* GetJitRuntime() {
+  static auto orc_jit = OrcJit::Create().value();
+  static auto jit_runtime =
+      std::make_unique<JitRuntime>(orc_jit->CreateDataLayout().value());
+  return jit_runtime.get();
+}
+
+std::unique_ptr<ChannelQueueManager> QueueManagerForPackage(Package* package) {
+  return JitChannelQueueManager::CreateThreadSafe(
+             package,
+             std::make_unique<JitRuntime>(GetJitRuntime()->data_layout()))
+      .value();
+}
+
+std::unique_ptr<TieredProcEvaluator> CreateTieredEvaluator(
+    Proc* proc, ChannelQueueManager* queue_manager,
+    absl::Notification* start_compilation = nullptr,
+    JitObserver* observer = nullptr) {
+  JitChannelQueueManager* jit_queue_manager =
+      dynamic_cast<JitChannelQueueManager*>(queue_manager);
+  CHECK(jit_queue_manager != nullptr);
+  return std::make_unique<TieredProcEvaluator>(
+      proc, std::make_unique<ProcInterpreter>(proc, queue_manager),
+      [proc, jit_queue_manager, start_compilation]()
+          -> absl::StatusOr<std::unique_ptr<ProcEvaluator>> {
+        if (start_compilation != nullptr) {
+          start_compilation->WaitForNotification();
+        }
+        return ProcJit::Create(proc, GetJitRuntime(), jit_queue_manager);
+      },
+      observer);
+}
+
+// Tiered evaluator which may switch to the JIT at any point.
+std::unique_ptr<ProcEvaluator> RacingEvaluator(
+    Proc* proc, ChannelQueueManager* queue_manager) {
+  return CreateTieredEvaluator(proc, queue_manager);
+}
+
+// Tiered evaluator whose JIT is ready before the first tick.
+std::unique_ptr<ProcEvaluator> CompiledEvaluator(
+    Proc* proc, ChannelQueueManager* queue_manager) {
+  std::unique_ptr<TieredProcEvaluator> evaluator =
+      CreateTieredEvaluator(proc, queue_manager);
+  CHECK_OK(evaluator->WaitForCompilation());
+  return evaluator;
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TieredProcEvaluatorTest, ProcEvaluatorTestBase,
+    testing::Values(ProcEvaluatorTestParam(RacingEvaluator,
+                                           QueueManagerForPackage,
+                                           /*supports_observers=*/false),
+                    ProcEvaluatorTestParam(CompiledEvaluator,
+                                           QueueManagerForPackage,
+                                           /*supports_observers=*/false)));
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using the
+// tiered runtime.
+INSTANTIATE_TEST_SUITE_P(
+    TieredProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "tiered",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateTieredSerialProcRuntime(package, options).value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateTieredSerialProcRuntime(top, options).value();
+            },
+            /*supports_observers=*/false),
+        ProcRuntimeTestParam(
+            "profile_guided",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateProfileGuidedSerialProcRuntime(package, options,
+                                                          /*warmup_ticks=*/2)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateProfileGuidedSerialProcRuntime(top, options,
+                                                          /*warmup_ticks=*/2)
+                  .value();
+            },
+            /*supports_observers=*/false)),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+class TieringObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const override {
+    return JitObserverRequests{.tiering_events = true};
+  }
+  void TieredCompilationComplete(FunctionBase* function_base,
+                                 absl::Duration latency,
+                                 const absl::Status& status) override {
+    compile_status = status;
+  }
+  void SwitchedToJit(FunctionBase* function_base,
+                     int64_t interpreted_invocations) override {
+    switch_points.push_back(interpreted_invocations);
+  }
+
+  absl::Status compile_status = absl::UnknownError("not compiled");
+  std::vector<int64_t> switch_points;
+};
+
+class TieredProcEvaluatorTest : public IrTestBase {};
+
+TEST_F(TieredProcEvaluatorTest, StateCarriesOverToJit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  ProcBuilder pb(TestName(), p.get());
+  BValue count = pb.StateElement("count", Value(UBits(0, 32)));
+  pb.Send(out, pb.Literal(Value::Token()), count);
+  BValue next = pb.Add(count, pb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      QueueManagerForPackage(p.get());
+  absl::Notification start_compilation;
+  TieringObserver observer;
+  std::unique_ptr<TieredProcEvaluator> evaluator = CreateTieredEvaluator(
+      proc, queue_manager.get(), &start_compilation, &observer);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+  std::unique_ptr<ProcContinuation> continuation =
+      evaluator->NewContinuation(instance);
+  ChannelQueue& out_queue = queue_manager->GetQueue(out);
+
+  auto tick = [&]() -> absl::Status {
+    absl::StatusOr<TickResult> result = evaluator->Tick(*continuation);
+    while (result.ok() &&
+           result->execution_state != TickExecutionState::kCompleted) {
+      result = evaluator->Tick(*continuation);
+    }
+    return result.status();
+  };
+
+  // The JIT cannot finish before the notification so these ticks are
+  // interpreted.
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(tick());
+  }
+  EXPECT_FALSE(TieredProcEvaluator::IsCompiled(*continuation));
+
+  start_compilation.Notify();
+  XLS_ASSERT_OK(evaluator->WaitForCompilation());
+  XLS_EXPECT_OK(observer.compile_status);
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(tick());
+  }
+  EXPECT_TRUE(TieredProcEvaluator::IsCompiled(*continuation));
+  EXPECT_THAT(observer.switch_points, testing::ElementsAre(3));
+
+  for (int64_t i = 0; i < 6; ++i) {
+    EXPECT_EQ(out_queue.Read(), Value(UBits(i, 32)));
+  }
+  EXPECT_EQ(continuation->GetState(),
+            std::vector<Value>{Value(UBits(6, 32))});
+}
+
+TEST_F(TieredProcEvaluatorTest, WarmupDelaysCompilation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  ProcBuilder pb(TestName(), p.get());
+  BValue count = pb.StateElement("count", Value(UBits(0, 32)));
+  BValue odd = pb.BitSlice(count, 0, 1);
+  pb.Send(out, pb.Literal(Value::Token()),
+          pb.Select(odd, count, pb.Literal(UBits(100, 32)),
+                    SourceInfo(), "sel"));
+  BValue next = pb.Add(count, pb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      QueueManagerForPackage(p.get());
+  JitChannelQueueManager* jit_queue_manager =
+      dynamic_cast<JitChannelQueueManager*>(queue_manager.get());
+  ASSERT_NE(jit_queue_manager, nullptr);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> instrumented,
+      ProcJit::Create(proc, GetJitRuntime(), jit_queue_manager,
+                      /*include_observer_callbacks=*/false,
+                      /*observer=*/nullptr,
+                      JitProfileOptions{.instrument = true}));
+  const ProcJit* first_tier = instrumented.get();
+  JitProfile profile;
+  TieredProcEvaluator evaluator(
+      proc, std::move(instrumented),
+      [&]() -> absl::StatusOr<std::unique_ptr<ProcEvaluator>> {
+        profile = first_tier->GetProfile();
+        return ProcJit::Create(proc, GetJitRuntime(), jit_queue_manager,
+                               /*include_observer_callbacks=*/false,
+                               /*observer=*/nullptr,
+                               JitProfileOptions{.profile = &profile});
+      },
+      /*observer=*/nullptr, /*warmup_ticks=*/4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+  std::unique_ptr<ProcContinuation> continuation =
+      evaluator.NewContinuation(instance);
+
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(evaluator.Tick(*continuation).status());
+  }
+  EXPECT_THAT(evaluator.WaitForCompilation(),
+              absl_testing::StatusIs(absl::StatusCode::kFailedPrecondition));
+  XLS_ASSERT_OK(evaluator.Tick(*continuation).status());
+  XLS_ASSERT_OK(evaluator.WaitForCompilation());
+  // The profile was read after exactly the warm-up ticks.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * select, proc->GetNode("sel"));
+  EXPECT_THAT(profile.GetNodeCounts(select),
+              testing::Optional(testing::ElementsAre(2, 2)));
+
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(evaluator.Tick(*continuation).status());
+  }
+  EXPECT_TRUE(TieredProcEvaluator::IsCompiled(*continuation));
+  ChannelQueue& out_queue = queue_manager->GetQueue(out);
+  for (int64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(out_queue.Read(), Value(UBits(i % 2 == 1 ? i : 100, 32)));
+  }
+}
+
+TEST_F(TieredProcEvaluatorTest, ObserverKeepsInstanceInInterpreter) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  ProcBuilder pb(TestName(), p.get());
+  BValue count = pb.StateElement("count", Value(UBits(0, 32)));
+  pb.Send(out, pb.Literal(Value::Token()), count);
+  BValue next = pb.Add(count, pb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  // The JIT is built without observer callbacks so it cannot take over an
+  // instance which has an observer attached.
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      QueueManagerForPackage(p.get());
+  std::unique_ptr<TieredProcEvaluator> evaluator =
+      CreateTieredEvaluator(proc, queue_manager.get());
+  XLS_ASSERT_OK(evaluator->WaitForCompilation());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcInstance * instance,
+      queue_manager->elaboration().GetUniqueInstance(proc));
+  std::unique_ptr<ProcContinuation> continuation =
+      evaluator->NewContinuation(instance);
+  CollectingEvaluationObserver observer;
+  XLS_ASSERT_OK(continuation->SetObserver(&observer));
+
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK(evaluator->Tick(*continuation).status());
+  }
+  EXPECT_FALSE(TieredProcEvaluator::IsCompiled(*continuation));
+  EXPECT_THAT(observer.values().at(next.node()),
+              testing::ElementsAre(Value(UBits(1, 32)), Value(UBits(2, 32))));
+
+  // Once the observer is gone the instance switches at the next tick.
+  continuation->ClearObserver();
+  XLS_ASSERT_OK(evaluator->Tick(*continuation).status());
+  EXPECT_TRUE(TieredProcEvaluator::IsCompiled(*continuation));
+  EXPECT_EQ(continuation->GetState(),
+            std::vector<Value>{Value(UBits(3, 32))});
+  ChannelQueue& out_queue = queue_manager->GetQueue(out);
+  for (int64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(out_queue.Read(), Value(UBits(i, 32)));
+  }
+}
+
+}  // namespace
+}  // namespace xls
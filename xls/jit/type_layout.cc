@@ -14,6 +14,7 @@
 
 #include "xls/jit/type_layout.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <ostream>
@@ -42,6 +43,35 @@ static bool IsLeafValue(const Value& value) {
   return value.IsBits() || value.IsToken();
 }
 
+// ORs `bit_count` bits starting at bit `src_offset` of `src` into `dst`
+// starting at bit `dst_offset`. Bits are numbered from the least significant
+// bit of byte zero. Only the bytes containing the bits are accessed. Works on
+// up to 56 bits at a time so a chunk plus its sub-byte shift always fits a
+// 64-bit word (the JIT only targets little-endian hosts).
+static void OrBits(const uint8_t* src, int64_t src_offset, uint8_t* dst,
+                   int64_t dst_offset, int64_t bit_count) {
+  constexpr int64_t kChunkBits = 56;
+  while (bit_count > 0) {
+    int64_t chunk = std::min(bit_count, kChunkBits);
+    int64_t src_shift = src_offset % 8;
+    uint64_t word = 0;
+    std::memcpy(&word, src + src_offset / 8,
+                CeilOfRatio(chunk + src_shift, int64_t{8}));
+    word = (word >> src_shift) & ((uint64_t{1} << chunk) - 1);
+
+    int64_t dst_shift = dst_offset % 8;
+    int64_t dst_bytes = CeilOfRatio(chunk + dst_shift, int64_t{8});
+    uint64_t dst_word = 0;
+    std::memcpy(&dst_word, dst + dst_offset / 8, dst_bytes);
+    dst_word |= word << dst_shift;
+    std::memcpy(dst + dst_offset / 8, &dst_word, dst_bytes);
+
+    src_offset += chunk;
+    dst_offset += chunk;
+    bit_count -= chunk;
+  }
+}
+
 static void LeafValueToNativeLayout(const Value& value,
                                     const ElementLayout& element_layout,
                                     uint8_t* buffer) {
@@ -151,6 +181,130 @@ Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
   return NativeLayoutToValueInternal(type_, buffer, &leaf_index);
 }
 
+void TypeLayout::ComputePackedElements() {
+  packed_elements_.clear();
+  packed_elements_.reserve(elements_.size());
+  // Leaves are visited in the order of `elements_`. Bit offsets follow the
+  // packed entry points of the JIT: array elements are stored LSB first and
+  // tuple elements MSB first.
+  auto visit = [&](auto& self, Type* t, int64_t bit_offset) -> void {
+    if (t->IsBits() || t->IsToken()) {
+      packed_elements_.push_back(PackedElement{
+          .bit_offset = bit_offset, .bit_count = t->GetFlatBitCount()});
+      return;
+    }
+    if (t->IsArray()) {
+      ArrayType* array_type = t->AsArrayOrDie();
+      int64_t element_bits = array_type->element_type()->GetFlatBitCount();
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        self(self, array_type->element_type(), bit_offset + i * element_bits);
+      }
+      return;
+    }
+    TupleType* tuple_type = t->AsTupleOrDie();
+    int64_t element_offset = bit_offset + tuple_type->GetFlatBitCount();
+    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+      element_offset -= tuple_type->element_type(i)->GetFlatBitCount();
+      self(self, tuple_type->element_type(i), element_offset);
+    }
+  };
+  visit(visit, type_, /*bit_offset=*/0);
+  CHECK_EQ(packed_elements_.size(), elements_.size());
+  packed_size_ = CeilOfRatio(type_->GetFlatBitCount(), int64_t{8});
+}
+
+void TypeLayout::ValueToPackedLayoutInternal(const Value& value,
+                                             uint8_t* buffer,
+                                             int64_t* leaf_index) const {
+  if (value.IsToken()) {
+    ++(*leaf_index);
+    return;
+  }
+  if (value.IsBits()) {
+    const PackedElement& element = packed_elements_[*leaf_index];
+    ++(*leaf_index);
+    absl::InlinedVector<uint8_t, 16> bytes(
+        CeilOfRatio(element.bit_count, int64_t{8}));
+    value.bits().ToBytes(absl::MakeSpan(bytes));
+    OrBits(bytes.data(), 0, buffer, element.bit_offset, element.bit_count);
+    return;
+  }
+  for (const Value& element : value.elements()) {
+    ValueToPackedLayoutInternal(element, buffer, leaf_index);
+  }
+}
+
+void TypeLayout::ValueToPackedLayout(const Value& value,
+                                     uint8_t* buffer) const {
+  DCHECK(ValueConformsToType(value, type())) << absl::StreamFormat(
+      "Value `%s` is not of type `%s`", value.ToString(), type()->ToString());
+  std::memset(buffer, 0, packed_size_);
+  int64_t leaf_index = 0;
+  ValueToPackedLayoutInternal(value, buffer, &leaf_index);
+  CHECK_EQ(leaf_index, packed_elements_.size());
+}
+
+Value TypeLayout::PackedLayoutToValueInternal(Type* element_type,
+                                              const uint8_t* buffer,
+                                              int64_t* leaf_index) const {
+  if (element_type->IsBits()) {
+    const PackedElement& element = packed_elements_[*leaf_index];
+    ++(*leaf_index);
+    absl::InlinedVector<uint8_t, 16> bytes(
+        CeilOfRatio(element.bit_count, int64_t{8}), 0);
+    OrBits(buffer, element.bit_offset, bytes.data(), 0, element.bit_count);
+    return Value(Bits::FromBytes(bytes, element.bit_count));
+  }
+  if (element_type->IsToken()) {
+    ++(*leaf_index);
+    return Value::Token();
+  }
+  if (element_type->IsTuple()) {
+    TupleType* tuple_type = element_type->AsTupleOrDie();
+    std::vector<Value> elements;
+    elements.reserve(tuple_type->size());
+    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+      elements.push_back(PackedLayoutToValueInternal(
+          tuple_type->element_type(i), buffer, leaf_index));
+    }
+    return Value::TupleOwned(std::move(elements));
+  }
+
+  CHECK(element_type->IsArray());
+  ArrayType* array_type = element_type->AsArrayOrDie();
+  std::vector<Value> elements;
+  elements.reserve(array_type->size());
+  for (int64_t i = 0; i < array_type->size(); ++i) {
+    elements.push_back(PackedLayoutToValueInternal(array_type->element_type(),
+                                                   buffer, leaf_index));
+  }
+  return Value::ArrayOwned(std::move(elements));
+}
+
+Value TypeLayout::PackedLayoutToValue(const uint8_t* buffer) const {
+  int64_t leaf_index = 0;
+  return PackedLayoutToValueInternal(type_, buffer, &leaf_index);
+}
+
+void TypeLayout::NativeToPackedLayout(const uint8_t* native_buffer,
+                                      uint8_t* packed_buffer) const {
+  std::memset(packed_buffer, 0, packed_size_);
+  for (int64_t i = 0; i < elements_.size(); ++i) {
+    OrBits(native_buffer + elements_[i].offset, 0, packed_buffer,
+           packed_elements_[i].bit_offset, packed_elements_[i].bit_count);
+  }
+}
+
+void TypeLayout::PackedToNativeLayout(const uint8_t* packed_buffer,
+                                      uint8_t* native_buffer) const {
+  std::memset(native_buffer, 0, size_);
+  for (int64_t i = 0; i < elements_.size(); ++i) {
+    OrBits(packed_buffer, packed_elements_[i].bit_offset,
+           native_buffer + elements_[i].offset, 0,
+           packed_elements_[i].bit_count);
+  }
+}
+
 std::string TypeLayout::ToString() const {
   std::vector<std::string> lines;
   lines.push_back(absl::StrFormat("TypeLayout {"));
@@ -84,12 +84,20 @@ struct ElementLayout {
 //
 // TODO(https://github.com/google/xls/issues/760): Reduce the redundancy in the
 // array element layouts.
+//
+// A TypeLayout also describes the packed layout of the type which stores the
+// flattened bits of a value contiguously with no padding (the layout used by
+// the packed entry points of jitted functions). Array element 0 and the last
+// tuple element occupy the least significant bits. For example, a value of
+// type (bits[1], bits[3])[2] occupies a single byte in the packed layout
+// rather than the eight bytes of its native layout.
 class TypeLayout {
  public:
   explicit TypeLayout(Type* type, int64_t size,
                       absl::Span<const ElementLayout> elements)
       : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
     CHECK_EQ(elements.size(), type->leaf_count());
+    ComputePackedElements();
   }
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
@@ -109,6 +117,25 @@ class TypeLayout {
   // representations value.
   std::vector<uint8_t> mask() const;
 
+  // Writes `value` out to `buffer` in the packed layout of the type. `buffer`
+  // must have room for at least `packed_size()` bytes.
+  void ValueToPackedLayout(const Value& value, uint8_t* buffer) const;
+
+  // Returns a Value object representing the data of XLS type `type()` stored in
+  // the packed layout in `buffer`.
+  Value PackedLayoutToValue(const uint8_t* buffer) const;
+
+  // Converts between the native and packed layouts of the type. Padding in
+  // the native layout is zeroed.
+  void NativeToPackedLayout(const uint8_t* native_buffer,
+                            uint8_t* packed_buffer) const;
+  void PackedToNativeLayout(const uint8_t* packed_buffer,
+                            uint8_t* native_buffer) const;
+
+  // Returns the number of bytes an instance of the type occupies in the packed
+  // layout.
+  int64_t packed_size() const { return packed_size_; }
+
   absl::Span<const ElementLayout> elements() const { return elements_; }
 
   // Returns the number of bytes an instances of the type occupies.
@@ -121,10 +148,26 @@ class TypeLayout {
  private:
   Value NativeLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
                                     int64_t* leaf_index) const;
+  void ValueToPackedLayoutInternal(const Value& value, uint8_t* buffer,
+                                   int64_t* leaf_index) const;
+  Value PackedLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
+                                    int64_t* leaf_index) const;
+
+  // Computes `packed_elements_` and `packed_size_` from the type.
+  void ComputePackedElements();
+
+  // Location of a leaf element in the packed layout.
+  struct PackedElement {
+    int64_t bit_offset;
+    int64_t bit_count;
+  };
 
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+  // Packed layout of each leaf element in the same order as `elements_`.
+  std::vector<PackedElement> packed_elements_;
+  int64_t packed_size_ = 0;
 };
 
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
@@ -312,6 +312,41 @@ TEST_F(TypeLayoutTest, SimpleArray) {
           ElementLayout{.offset = 4, .data_size = 2, .padded_size = 2}));
 }
 
+TEST_F(TypeLayoutTest, PackedLayout) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Type * type, Parser::ParseType("(bits[1], bits[3])[2]", package.get()));
+  TypeLayout layout = CreateTypeLayout(type);
+  EXPECT_EQ(layout.size(), 4);
+  EXPECT_EQ(layout.packed_size(), 1);
+
+  Value value = Value::ArrayOrDie(
+      {Value::Tuple({Value(UBits(1, 1)), Value(UBits(5, 3))}),
+       Value::Tuple({Value(UBits(0, 1)), Value(UBits(2, 3))})});
+  // Array element 0 occupies the low nibble and the first tuple element is
+  // the most significant bit of each nibble.
+  std::vector<uint8_t> packed(1, 0xff);
+  layout.ValueToPackedLayout(value, packed.data());
+  EXPECT_THAT(packed, ElementsAre(0x2d));
+  EXPECT_EQ(layout.PackedLayoutToValue(packed.data()), value);
+
+  // Leaves wider than a word and not byte aligned.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Type * wide_type,
+      Parser::ParseType("(bits[3], bits[100], bits[5])", package.get()));
+  TypeLayout wide_layout = CreateTypeLayout(wide_type);
+  EXPECT_EQ(wide_layout.packed_size(), 14);
+  Value wide_value = Value::Tuple(
+      {Value(UBits(6, 3)), Value(Bits::AllOnes(100)), Value(UBits(0, 5))});
+  std::vector<uint8_t> wide_packed(wide_layout.packed_size());
+  wide_layout.ValueToPackedLayout(wide_value, wide_packed.data());
+  // Bits [5, 105) are ones followed by 0b110 in bits [105, 108).
+  EXPECT_EQ(wide_packed[0], 0xe0);
+  EXPECT_EQ(wide_packed[12], 0xff);
+  EXPECT_EQ(wide_packed[13], 0x0d);
+  EXPECT_EQ(wide_layout.PackedLayoutToValue(wide_packed.data()), wide_value);
+}
+
 TEST_F(TypeLayoutTest, JitTypes) {
   // Randomly test the layout of a bunch of types. TypeLayouts are generated by
   // the JIT and random xls::Values are round-tripped through the native layout.
@@ -342,6 +377,18 @@ TEST_F(TypeLayoutTest, JitTypes) {
 
       EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
 
+      // Round trip through the packed layout, both from the value and from
+      // the native layout.
+      std::vector<uint8_t> packed(layout.packed_size(), 0xff);
+      layout.ValueToPackedLayout(value, packed.data());
+      EXPECT_EQ(layout.PackedLayoutToValue(packed.data()), value);
+      std::vector<uint8_t> packed_from_native(layout.packed_size(), 0xff);
+      layout.NativeToPackedLayout(buffer.data(), packed_from_native.data());
+      EXPECT_EQ(packed_from_native, packed);
+      std::vector<uint8_t> native_from_packed(layout.size(), 0xff);
+      layout.PackedToNativeLayout(packed.data(), native_from_packed.data());
+      EXPECT_EQ(native_from_packed, buffer);
+
       // Verify padding bits and bytes are zero in the buffer for each element.
       for (int64_t leaf_index = 0; leaf_index < leaf_types.size();
            ++leaf_index) {
@@ -18,13 +18,20 @@
 #include <vector>
 
 #include "benchmark/benchmark.h"
+#include "absl/log/check.h"
 #include "xls/common/benchmark_support.h"
 #include "xls/common/init_xls.h"
+#include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 #include "xls/jit/type_layout.h"
@@ -32,8 +39,8 @@
 namespace xls {
 namespace {
 
-// Measure the performance of conversion of a Value to/from the native XLS type
-// layout used by the jit.
+// Measure the performance of conversion of a Value to/from the native and
+// packed XLS type layouts used by the jit.
 constexpr int kNumTypes = 10;
 const char* kValueTypes[] = {
     "()",
@@ -77,8 +84,107 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+// Reports the footprint of a value of the given layout in the native and
+// packed layouts.
+static void SetFootprintCounters(benchmark::State& state,
+                                 const TypeLayout& type_layout) {
+  state.counters["native_bytes"] = type_layout.size();
+  state.counters["packed_bytes"] = type_layout.packed_size();
+}
+
+static void BM_ValueToPackedLayout(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  Value value = RandomValue(type, bitgen);
+  TypeLayout type_layout = CreateTypeLayout(type);
+  std::vector<uint8_t> buffer(type_layout.packed_size());
+  for (auto _ : state) {
+    type_layout.ValueToPackedLayout(value, buffer.data());
+  }
+  SetFootprintCounters(state, type_layout);
+}
+
+static void BM_PackedLayoutToValue(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  TypeLayout type_layout = CreateTypeLayout(type);
+  std::vector<uint8_t> buffer(type_layout.packed_size(), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(type_layout.PackedLayoutToValue(buffer.data()));
+  }
+  SetFootprintCounters(state, type_layout);
+}
+
+// Measure the cost of converting between the native and packed layouts which
+// is the work done at the boundary of jitted code using the packed layout.
+static void BM_NativeToPackedLayout(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  TypeLayout type_layout = CreateTypeLayout(type);
+  std::vector<uint8_t> native(type_layout.size());
+  type_layout.ValueToNativeLayout(RandomValue(type, bitgen), native.data());
+  std::vector<uint8_t> packed(type_layout.packed_size());
+  for (auto _ : state) {
+    type_layout.NativeToPackedLayout(native.data(), packed.data());
+    benchmark::DoNotOptimize(packed.data());
+  }
+  SetFootprintCounters(state, type_layout);
+  state.SetBytesProcessed(state.iterations() * type_layout.size());
+}
+
+static void BM_PackedToNativeLayout(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  TypeLayout type_layout = CreateTypeLayout(type);
+  std::vector<uint8_t> packed(type_layout.packed_size());
+  type_layout.ValueToPackedLayout(RandomValue(type, bitgen), packed.data());
+  std::vector<uint8_t> native(type_layout.size());
+  for (auto _ : state) {
+    type_layout.PackedToNativeLayout(packed.data(), native.data());
+    benchmark::DoNotOptimize(native.data());
+  }
+  SetFootprintCounters(state, type_layout);
+  state.SetBytesProcessed(state.iterations() * type_layout.size());
+}
+
+// Measure the throughput of a jitted proc whose state is a wide array of flags
+// with the state held in the native (range(0) == 0) or packed (range(0) == 1)
+// layout. Each tick flips one flag.
+static void BM_FlagProcTick(benchmark::State& state) {
+  constexpr int64_t kFlagCount = 1024;
+  bool packed = state.range(0) != 0;
+  Package package("BM");
+  Type* flags_type = package.GetArrayType(kFlagCount, package.GetBitsType(1));
+  ProcBuilder pb("flags", &package);
+  BValue flags = pb.StateElement("flags", ZeroOfType(flags_type));
+  BValue index = pb.StateElement("index", Value(UBits(0, 10)));
+  BValue flag = pb.ArrayIndex(flags, {index});
+  BValue next_flags = pb.ArrayUpdate(flags, pb.Not(flag), {index});
+  BValue next_index = pb.Add(index, pb.Literal(UBits(1, 10)));
+  CHECK_OK(pb.Build({next_flags, next_index}).status());
+
+  std::unique_ptr<SerialProcRuntime> runtime =
+      CreateJitSerialProcRuntime(
+          &package, EvaluatorOptions().set_packed_jit_layout(packed))
+          .value();
+  for (auto _ : state) {
+    CHECK_OK(runtime->Tick());
+  }
+  TypeLayout type_layout = CreateTypeLayout(flags_type);
+  state.counters["state_bytes"] =
+      packed ? type_layout.packed_size() : type_layout.size();
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_ValueToPackedLayout)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_PackedLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_NativeToPackedLayout)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_PackedToNativeLayout)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_FlagProcTick)->DenseRange(0, 1);
 
 }  // namespace
 }  // namespace xls
@@ -237,12 +237,17 @@ class BddQueryEngine::AssumingQueryEngine final : public QueryEngine {
  public:
   AssumingQueryEngine(const BddQueryEngine* query_engine,
                       BddNodeIndex assumption)
-      : query_engine_(query_engine), assumption_(assumption) {}
+      : query_engine_(query_engine), assumption_(assumption) {
+    ++query_engine_->assuming_engine_count_;
+  }
   AssumingQueryEngine(std::shared_ptr<BddQueryEngine> query_engine,
                       BddNodeIndex assumption)
       : query_engine_storage_(std::move(query_engine)),
         query_engine_(query_engine_storage_.get()),
-        assumption_(assumption) {}
+        assumption_(assumption) {
+    ++query_engine_->assuming_engine_count_;
+  }
+  ~AssumingQueryEngine() override { --query_engine_->assuming_engine_count_; }
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
   bool IsTracked(Node* node) const override;
@@ -489,6 +494,10 @@ BddTree BddQueryEngine::ComputeInfo(
     return leaf_type_tree::Clone(GetVariablesFor(node));
   }
 
+  if (eagerly_populating_) {
+    MaybeReorderVariables();
+  }
+
   VLOG(3) << "  computing BDD value...";
   BddNodeEvaluator node_evaluator(
       *evaluator_, [this](Node* node) { return GetVariablesFor(node); });
@@ -697,6 +706,64 @@ std::unique_ptr<QueryEngine> BddQueryEngine::SpecializeGivenPredicate(
   return SpecializeGiven(givens);
 }
 
+absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
+  // Reordering collects garbage too.
+  bool collected = MaybeReorderVariables();
+  if (!collected && bdd_->size() >= garbage_collection_threshold_) {
+    CollectGarbage();
+    collected = true;
+  }
+  if (collected) {
+    garbage_collection_threshold_ =
+        std::max(kMinGarbageCollectionThreshold, 2 * bdd_->size());
+  }
+  return Base::Populate(f);
+}
+
+std::vector<BddNodeIndex> BddQueryEngine::GetHeldBddNodes() const {
+  // The variables in `bit_variables_` and `node_variables_` are always kept
+  // by the BDD, so only the cached expressions are needed.
+  std::vector<BddNodeIndex> roots;
+  info().ForEachHeldInfo([&](const BddTree& tree) {
+    for (const BddVector& bits : tree.elements()) {
+      for (const SaturatingBddNodeIndex& bit : bits) {
+        if (std::holds_alternative<BddNodeIndex>(bit)) {
+          roots.push_back(std::get<BddNodeIndex>(bit));
+        }
+      }
+    }
+  });
+  return roots;
+}
+
+int64_t BddQueryEngine::CollectGarbage() {
+  if (assuming_engine_count_ > 0) {
+    VLOG(2) << "Not collecting BDD garbage; specialized engines are alive.";
+    return 0;
+  }
+  return bdd_->GarbageCollect(GetHeldBddNodes());
+}
+
+int64_t BddQueryEngine::ReorderVariables() {
+  if (assuming_engine_count_ > 0) {
+    VLOG(2) << "Not reordering BDD variables; specialized engines are alive.";
+    return bdd_->size();
+  }
+  return bdd_->ReorderVariables(
+      GetHeldBddNodes(), reordering_options_.value_or(BddReorderingOptions()));
+}
+
+bool BddQueryEngine::MaybeReorderVariables() const {
+  if (!reordering_options_.has_value() || assuming_engine_count_ > 0 ||
+      bdd_->size() < reordering_threshold_) {
+    return false;
+  }
+  int64_t size =
+      bdd_->ReorderVariables(GetHeldBddNodes(), *reordering_options_);
+  reordering_threshold_ = std::max(kMinReorderingThreshold, 2 * size);
+  return true;
+}
+
 std::unique_ptr<QueryEngine> BddQueryEngine::SpecializeGiven(
     const absl::btree_map<Node*, ValueKnowledge, Node::NodeIdLessThan>& givens)
     const {
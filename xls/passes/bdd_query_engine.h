@@ -27,11 +27,15 @@
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/value.h"
 #include "xls/passes/bdd_evaluator.h"
@@ -94,6 +98,43 @@ class BddQueryEngine
         evaluator_(
             std::make_unique<SaturatingBddEvaluator>(path_limit, bdd_.get())) {}
 
+  // Reorders the BDD variables (see ReorderVariables) or collects garbage in
+  // the BDD (see CollectGarbage) if it has grown enough since the last time,
+  // then populates as usual.
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  // Computes the information for every node of `f` up front. Unlike lazy
+  // population, this also reorders the BDD variables whenever the BDD grows
+  // past the reordering threshold.
+  absl::Status EagerlyPopulate(FunctionBase* f) {
+    eagerly_populating_ = true;
+    absl::Status status = Base::EagerlyPopulate(f);
+    eagerly_populating_ = false;
+    return status;
+  }
+
+  // Frees the BDD nodes which are no longer referenced by the information held
+  // for the bound function, e.g. intermediate results and the expressions of
+  // nodes which have since changed, and returns the number of nodes freed.
+  // Nothing is freed while an engine returned by SpecializeGiven or
+  // SpecializeGivenPredicate is alive, as those hold BDD nodes of their own.
+  // Any BddNodeIndex previously returned by GetBddNode may be invalidated.
+  int64_t CollectGarbage();
+
+  // Reorders the BDD variables by sifting to reduce the size of the BDD,
+  // freeing garbage as CollectGarbage does, and returns the number of BDD
+  // nodes afterwards. The BDD nodes of the information held for the bound
+  // function keep their indices. Does nothing while an engine returned by
+  // SpecializeGiven or SpecializeGivenPredicate is alive.
+  int64_t ReorderVariables();
+
+  // Sets the options used to reorder the BDD variables when the BDD grows past
+  // a threshold, or disables the automatic reordering if `options` is
+  // std::nullopt.
+  void set_reordering_options(std::optional<BddReorderingOptions> options) {
+    reordering_options_ = options;
+  }
+
   std::optional<SharedLeafTypeTree<TernaryVector>> GetTernary(
       Node* node) const override;
 
@@ -216,6 +257,36 @@ class BddQueryEngine
   // The maximum number of paths in expression in the BDD before truncating.
   int64_t path_limit_;
 
+  // Populate collects garbage once the BDD has at least this many nodes. The
+  // threshold is reset to twice the surviving node count after a collection
+  // so that the cost of collection stays proportional to the work done.
+  static constexpr int64_t kMinGarbageCollectionThreshold = 1 << 16;
+  int64_t garbage_collection_threshold_ = kMinGarbageCollectionThreshold;
+
+  // Number of live AssumingQueryEngines created from this engine.
+  mutable int64_t assuming_engine_count_ = 0;
+
+  // Returns the BDD nodes in the information held for the bound function.
+  std::vector<BddNodeIndex> GetHeldBddNodes() const;
+
+  // Reorders the BDD variables if automatic reordering is enabled and the BDD
+  // has grown past `reordering_threshold_`. Returns true if the variables were
+  // reordered. Must only be called when every BDD node in use is held in the
+  // information for the bound function, i.e. not while a query is in
+  // progress, as nodes which are not held are freed.
+  bool MaybeReorderVariables() const;
+
+  // Reordering is attempted once the BDD has at least this many nodes, and the
+  // threshold is then reset to twice the resulting node count.
+  static constexpr int64_t kMinReorderingThreshold = 1 << 14;
+  mutable int64_t reordering_threshold_ = kMinReorderingThreshold;
+  std::optional<BddReorderingOptions> reordering_options_ =
+      BddReorderingOptions();
+  // Whether EagerlyPopulate is in progress. Information is then computed for
+  // one node at a time with nothing else holding BDD nodes, so the variables
+  // may be reordered between nodes.
+  bool eagerly_populating_ = false;
+
   std::optional<std::function<bool(const Node*)>> node_filter_;
 
   std::unique_ptr<BinaryDecisionDiagram> bdd_;
@@ -228,7 +299,7 @@ class BddQueryEngine
 
   // A map from nodes to BDD variables used to represent fully-unknown values;
   // used to avoid creating new variables for the same node.
-  mutable absl::flat_hash_map<Node*, std::unique_ptr<BddTree>> node_variables_;
+  mutable NodeMap<std::unique_ptr<BddTree>> node_variables_;
   BddTreeView GetVariablesFor(Node* node) const;
 };
 
@@ -377,5 +377,61 @@ fn __sample__main(x: bits[60]) -> bits[35] {
   EXPECT_EQ(specialized->KnownValueAsBits(target), std::nullopt);
 }
 
+TEST_F(BddQueryEngineTest, CollectGarbagePreservesResults) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue x_lt_y = fb.ULt(x, y);
+  BValue y_gt_x = fb.UGt(y, x);
+  BValue x_eq_y = fb.Eq(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  BddQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.EagerlyPopulate(f));
+
+  // The comparisons leave intermediate expressions behind in the BDD.
+  int64_t size_before = query_engine.bdd().size();
+  int64_t freed = query_engine.CollectGarbage();
+  EXPECT_GT(freed, 0);
+  EXPECT_EQ(query_engine.bdd().size(), size_before - freed);
+  EXPECT_EQ(query_engine.bdd().GetStats().garbage_collections, 1);
+
+  EXPECT_TRUE(KnownEquals(query_engine, x_lt_y.node(), y_gt_x.node()));
+  EXPECT_TRUE(query_engine.AtMostOneNodeTrue({x_eq_y.node(), x_lt_y.node()}));
+  EXPECT_FALSE(query_engine.AtLeastOneNodeTrue({x_eq_y.node(), x_lt_y.node()}));
+
+  // Nothing is collected while a specialized engine is alive.
+  std::unique_ptr<QueryEngine> specialized = query_engine.SpecializeGiven(
+      {{x_eq_y.node(),
+        ValueKnowledge{.intervals = IntervalSetTree::CreateSingleElementTree(
+                           x_eq_y.node()->GetType(),
+                           IntervalSet::Precise(UBits(1, 1)))}}});
+  EXPECT_FALSE(specialized->IsOne(TreeBitLocation(x_lt_y.node(), 0)));
+  EXPECT_EQ(query_engine.CollectGarbage(), 0);
+}
+
+TEST_F(BddQueryEngineTest, ReorderVariablesPreservesResults) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(8));
+  BValue b = fb.Param("b", p->GetBitsType(8));
+  // The variables for `a` are all created before those for `b`, which is a
+  // poor order for this expression.
+  BValue any_pair = fb.OrReduce(fb.And(a, b));
+  BValue no_pair = fb.Not(any_pair);
+  BValue a_zero = fb.Eq(a, fb.Literal(UBits(0, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  BddQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.EagerlyPopulate(f));
+
+  int64_t size_before = query_engine.bdd().size();
+  EXPECT_LT(query_engine.ReorderVariables(), size_before);
+  EXPECT_EQ(query_engine.bdd().GetStats().reorderings, 1);
+
+  EXPECT_TRUE(KnownNotEquals(query_engine, any_pair.node(), no_pair.node()));
+  EXPECT_TRUE(Implies(query_engine, a_zero.node(), no_pair.node()));
+  EXPECT_FALSE(Implies(query_engine, no_pair.node(), a_zero.node()));
+}
+
 }  // namespace
 }  // namespace xls
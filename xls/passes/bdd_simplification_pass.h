@@ -35,6 +35,8 @@ class BddSimplificationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "BDD-based Simplification") {}
   ~BddSimplificationPass() override = default;
 
+  bool SupportsParallelExecution() const override { return true; }
+
  protected:
   // Run all registered passes in order of registration.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
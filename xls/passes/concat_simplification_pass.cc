@@ -550,6 +550,18 @@ absl::StatusOr<bool> TryDistributeReducibleOperation(Node* node) {
 
 }  // namespace
 
+std::optional<absl::Span<const Op>> ConcatSimplificationPass::RelevantOps()
+    const {
+  // Concats, and the operations which are simplified around them.
+  static constexpr Op kOps[] = {
+      Op::kConcat,   Op::kAnd,       Op::kNand, Op::kNor,
+      Op::kNot,      Op::kOr,        Op::kXor,  Op::kAndReduce,
+      Op::kOrReduce, Op::kXorReduce, Op::kEq,   Op::kNe,
+      Op::kReverse,
+  };
+  return kOps;
+}
+
 absl::StatusOr<bool> ConcatSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results, OptimizationContext& context) const {
@@ -15,10 +15,13 @@
 #ifndef XLS_PASSES_CONCAT_SIMPLIFICATION_PASS_H_
 #define XLS_PASSES_CONCAT_SIMPLIFICATION_PASS_H_
 
+#include <optional>
 #include <string_view>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/op.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
@@ -33,6 +36,8 @@ class ConcatSimplificationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Concat simplification") {}
   ~ConcatSimplificationPass() override = default;
 
+  std::optional<absl::Span<const Op>> RelevantOps() const override;
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
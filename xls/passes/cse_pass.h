@@ -69,6 +69,8 @@ class CsePass : public OptimizationFunctionBasePass {
         common_literals_(common_literals) {}
   ~CsePass() override = default;
 
+  bool SupportsParallelExecution() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
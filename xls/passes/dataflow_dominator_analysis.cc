@@ -26,6 +26,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
@@ -94,7 +95,7 @@ DataflowDominatorAnalysis::Run(FunctionBase* f) {
   // Construct the dominators for each node. Dominators are gathered as a sorted
   // vector containing the node indices (in a toposort) of the dominator nodes;
   // nodes that don't provide variable data correspond to nullopt entries.
-  absl::flat_hash_map<Node*, std::optional<std::vector<NodeIndex>>> dominators;
+  NodeMap<std::optional<std::vector<NodeIndex>>> dominators(f);
   for (NodeIndex i = 0; i < toposort.size(); ++i) {
     Node* node = toposort[i];
     if (node->OpIn({Op::kReceive, Op::kRegisterRead, Op::kParam, Op::kStateRead,
@@ -14,7 +14,10 @@
 
 #include "xls/passes/identity_removal_pass.h"
 
+#include <optional>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -25,6 +28,11 @@
 
 namespace xls {
 
+std::optional<absl::Span<const Op>> IdentityRemovalPass::RelevantOps() const {
+  static constexpr Op kOps[] = {Op::kIdentity};
+  return kOps;
+}
+
 // Identity Removal performs one forward pass over the nodes and replaces
 // identities with their respective operands.
 absl::StatusOr<bool> IdentityRemovalPass::RunOnFunctionBaseInternal(
@@ -17,10 +17,13 @@
 #ifndef XLS_PASSES_IDENTITY_REMOVAL_PASS_H_
 #define XLS_PASSES_IDENTITY_REMOVAL_PASS_H_
 
+#include <optional>
 #include <string_view>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/op.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
@@ -36,6 +39,8 @@ class IdentityRemovalPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Identity Removal") {}
   ~IdentityRemovalPass() override = default;
 
+  std::optional<absl::Span<const Op>> RelevantOps() const override;
+
  protected:
   // Iterate all nodes and eliminate identities.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -0,0 +1,107 @@
+// Copyright 2025 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/lazy_dag_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+
+namespace xls {
+namespace {
+
+// A DAG over integer keys which is not the IR graph, so the cache can only
+// learn about it through the provider. Each source's value is read from
+// `source_values`; every other key's value is one more than the largest value
+// of its inputs.
+class IntDagProvider : public LazyDagCache<int64_t, int64_t>::DagProvider {
+ public:
+  void AddEdge(int64_t from, int64_t to) {
+    users_[from].push_back(to);
+    inputs_[to].push_back(from);
+  }
+
+  absl::flat_hash_map<int64_t, int64_t>& source_values() {
+    return source_values_;
+  }
+
+  std::string GetName(const int64_t& key) const override {
+    return absl::StrCat(key);
+  }
+  absl::Span<const int64_t> GetInputs(const int64_t& key) const override {
+    auto it = inputs_.find(key);
+    return it == inputs_.end() ? absl::Span<const int64_t>() : it->second;
+  }
+  absl::Span<const int64_t> GetUsers(const int64_t& key) const override {
+    auto it = users_.find(key);
+    return it == users_.end() ? absl::Span<const int64_t>() : it->second;
+  }
+
+  absl::StatusOr<int64_t> ComputeValue(
+      const int64_t& key,
+      absl::Span<const int64_t* const> input_values) const override {
+    if (input_values.empty()) {
+      return source_values_.at(key);
+    }
+    int64_t value = 0;
+    for (const int64_t* input_value : input_values) {
+      value = std::max(value, *input_value + 1);
+    }
+    return value;
+  }
+
+ private:
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> inputs_;
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> users_;
+  absl::flat_hash_map<int64_t, int64_t> source_values_;
+};
+
+TEST(LazyDagCacheTest, ComputesValues) {
+  IntDagProvider provider;
+  provider.AddEdge(0, 1);
+  provider.AddEdge(1, 2);
+  provider.AddEdge(0, 2);
+  provider.source_values()[0] = 5;
+  LazyDagCache<int64_t, int64_t> cache(&provider);
+  EXPECT_EQ(*cache.QueryValue(2), 7);
+  EXPECT_EQ(*cache.QueryValue(1), 6);
+}
+
+TEST(LazyDagCacheTest, ForgetRevisitsTransitiveUsersFromProvider) {
+  // A chain 0 -> 1 -> 2 -> 3; forgetting 0 must reach 3 through the
+  // provider's users, two steps removed from the forgotten key.
+  IntDagProvider provider;
+  provider.AddEdge(0, 1);
+  provider.AddEdge(1, 2);
+  provider.AddEdge(2, 3);
+  provider.source_values()[0] = 0;
+  LazyDagCache<int64_t, int64_t> cache(&provider);
+  EXPECT_EQ(*cache.QueryValue(3), 3);
+
+  provider.source_values()[0] = 10;
+  cache.Forget(0);
+  EXPECT_EQ(*cache.QueryValue(3), 13);
+  EXPECT_EQ(*cache.QueryValue(2), 12);
+}
+
+}  // namespace
+}  // namespace xls
@@ -21,6 +21,7 @@
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -275,6 +276,25 @@ class LazyNodeInfo
     return info->AsView().AsShared();
   }
 
+  // Calls `fn` on each piece of information currently held for the bound
+  // function, without computing anything: the cached information of each node
+  // (which may be out of date) and the givens.
+  void ForEachHeldInfo(
+      absl::FunctionRef<void(const LeafTypeTree<Info>&)> fn) const {
+    if (f_ == nullptr) {
+      return;
+    }
+    for (Node* node : f_->nodes()) {
+      if (const LeafTypeTree<Info>* info = cache_.GetCachedValue(node);
+          info != nullptr) {
+        fn(*info);
+      }
+    }
+    for (const auto& [_, given] : givens_) {
+      fn(given);
+    }
+  }
+
   // No action necessary on NodeAdded.
 
   void NodeDeleted(Node* node) override { cache_.Forget(node); }
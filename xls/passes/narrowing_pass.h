@@ -44,6 +44,8 @@ class NarrowingPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Narrowing"), analysis_(analysis) {}
   ~NarrowingPass() override = default;
 
+  bool SupportsParallelExecution() const override { return true; }
+
   absl::StatusOr<PassPipelineProto::Element> ToProto() const override;
 
  protected:
@@ -14,9 +14,12 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -31,18 +34,33 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/change_listener.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
+namespace {
+
+// Returns true if `f` contains a node which applies another function.
+bool CallsOtherFunctions(FunctionBase* f) {
+  return absl::c_any_of(f->nodes(), [](Node* node) {
+    return node->OpIn(
+        {Op::kInvoke, Op::kMap, Op::kCountedFor, Op::kDynamicCountedFor});
+  });
+}
+
+}  // namespace
 
 std::string_view RamKindToString(RamKind kind) {
   switch (kind) {
@@ -133,17 +151,22 @@ absl::StatusOr<std::vector<RamRewrite>> RamRewritesFromProto(
 
 const std::vector<Node*>& OptimizationContext::ReverseTopoSortReference(
     FunctionBase* f) {
-  auto it = reverse_topo_sort_.find(f);
-  if (it == reverse_topo_sort_.end()) {
-    bool inserted = false;
-    std::tie(it, inserted) = reverse_topo_sort_.emplace(
-        f, InvalidatingVector(f, xls::ReverseTopoSort(f)));
-    CHECK(inserted);
+  InvalidatingVector* topo_sort;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = reverse_topo_sort_.find(f);
+    if (it == reverse_topo_sort_.end()) {
+      bool inserted = false;
+      std::tie(it, inserted) =
+          reverse_topo_sort_.emplace(f, InvalidatingVector(f));
+      CHECK(inserted);
+    }
+    topo_sort = &it->second;
   }
-  if (it->second->empty() && f->node_count() > 0) {
-    *it->second = xls::ReverseTopoSort(f);
+  if ((*topo_sort)->empty() && f->node_count() > 0) {
+    **topo_sort = xls::ReverseTopoSort(f);
   }
-  return *it->second;
+  return **topo_sort;
 }
 
 std::vector<Node*> OptimizationContext::ReverseTopoSort(FunctionBase* f) {
@@ -176,8 +199,13 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options, PassResults* results,
     OptimizationContext& context) const {
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  if (options.function_base_threads > 1 && function_bases.size() > 1 &&
+      SupportsParallelExecution()) {
+    return RunInParallel(function_bases, options, results, context);
+  }
   bool changed = false;
-  for (FunctionBase* f : p->GetFunctionBases()) {
+  for (FunctionBase* f : function_bases) {
     XLS_ASSIGN_OR_RETURN(
         bool function_changed,
         RunOnFunctionBaseInternal(f, options, results, context));
@@ -186,6 +214,71 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
   return changed;
 }
 
+absl::StatusOr<bool> OptimizationFunctionBasePass::RunInParallel(
+    absl::Span<FunctionBase* const> function_bases,
+    const OptimizationPassOptions& options, PassResults* results,
+    OptimizationContext& context) const {
+  // Node ids are the only package-wide counter touched by the transformation
+  // of a single FunctionBase. Each FunctionBase draws ids from a private range
+  // chosen by its position in the package (not by the thread running it), and
+  // afterwards the new nodes are renumbered densely in package order. This
+  // keeps the result independent of the number of threads and of how the
+  // work was scheduled.
+  constexpr int64_t kNodeIdRangeSize = int64_t{1} << 40;
+  Package* p = function_bases.front()->package();
+  const int64_t first_node_id = p->next_node_id();
+  const int64_t count = function_bases.size();
+  // A pass may look into the functions called by the FunctionBase it runs on
+  // (e.g., to evaluate an invoke), so callers are only transformed once every
+  // other FunctionBase is done.
+  std::vector<int64_t> independent;
+  std::vector<int64_t> callers;
+  for (int64_t i = 0; i < count; ++i) {
+    function_bases[i]->BeginIsolation(first_node_id + i * kNodeIdRangeSize);
+    (CallsOtherFunctions(function_bases[i]) ? callers : independent)
+        .push_back(i);
+  }
+
+  std::vector<absl::StatusOr<bool>> changed(count, false);
+  const int64_t independent_count = independent.size();
+  std::atomic<int64_t> next = 0;
+  {
+    int64_t thread_count =
+        std::min(options.function_base_threads, independent_count);
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>([&]() {
+        for (int64_t n = next++; n < independent_count; n = next++) {
+          int64_t i = independent[n];
+          changed[i] = RunOnFunctionBaseInternal(function_bases[i], options,
+                                                 results, context);
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (int64_t i : callers) {
+    changed[i] = RunOnFunctionBaseInternal(function_bases[i], options, results,
+                                           context);
+  }
+
+  int64_t next_node_id = first_node_id;
+  for (FunctionBase* f : function_bases) {
+    next_node_id += f->EndIsolation(next_node_id);
+  }
+  // Report the error from the first failing FunctionBase, as a sequential
+  // run would.
+  bool any_changed = false;
+  for (absl::StatusOr<bool>& f_changed : changed) {
+    XLS_RETURN_IF_ERROR(f_changed.status());
+    any_changed = any_changed || *f_changed;
+  }
+  return any_changed;
+}
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
     FunctionBase* f,
     std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
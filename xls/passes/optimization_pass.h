@@ -29,17 +29,21 @@
 #include <vector>
 
 #include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/change_listener.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/ram_rewrite.pb.h"
@@ -178,6 +182,13 @@ struct OptimizationPassOptions : public PassOptionsBase {
 
   // Optimize for best case throughput, even at the cost of area.
   bool optimize_for_best_case_throughput = false;
+
+  // Number of threads used to run function-level passes which support it (see
+  // OptimizationFunctionBasePass::SupportsParallelExecution) over the
+  // FunctionBases of a package. Values of one or less run every pass
+  // sequentially. For values greater than one the optimized IR does not
+  // depend on the number of threads.
+  int64_t function_base_threads = 1;
 };
 
 class OptimizationContext {
@@ -186,7 +197,7 @@ class OptimizationContext {
     requires(std::is_base_of_v<QueryEngine, QueryEngineT>)
   QueryEngineT* SharedQueryEngine(FunctionBase* f) {
     absl::flat_hash_map<std::type_index, std::shared_ptr<QueryEngine>>&
-        f_query_engines = shared_query_engines_[f];
+        f_query_engines = QueryEnginesFor(f);
     auto it = f_query_engines.find(typeid(QueryEngineT));
     if (it == f_query_engines.end()) {
       bool inserted = false;
@@ -212,6 +223,7 @@ class OptimizationContext {
   }
 
   std::vector<QueryEngine*> ListQueryEngines() {
+    absl::MutexLock lock(&mutex_);
     std::vector<QueryEngine*> query_engines;
     for (auto& [f, f_query_engines] : shared_query_engines_) {
       query_engines.reserve(query_engines.size() + f_query_engines.size());
@@ -223,6 +235,7 @@ class OptimizationContext {
   }
 
   void Abandon(FunctionBase* f) {
+    absl::MutexLock lock(&mutex_);
     shared_query_engines_.erase(f);
     reverse_topo_sort_.erase(f);
   }
@@ -233,6 +246,12 @@ class OptimizationContext {
  private:
   const std::vector<Node*>& ReverseTopoSortReference(FunctionBase* f);
 
+  absl::flat_hash_map<std::type_index, std::shared_ptr<QueryEngine>>&
+  QueryEnginesFor(FunctionBase* f) {
+    absl::MutexLock lock(&mutex_);
+    return shared_query_engines_[f];
+  }
+
   class InvalidatingVector : public ChangeListener {
    public:
     InvalidatingVector(FunctionBase* f, std::vector<Node*> value = {})
@@ -282,12 +301,21 @@ class OptimizationContext {
     FunctionBase* f_;
     std::vector<Node*> storage_;
   };
-  absl::flat_hash_map<FunctionBase*, InvalidatingVector> reverse_topo_sort_;
 
-  absl::flat_hash_map<
+  // Passes may run on several FunctionBases of a package concurrently (see
+  // OptimizationPassOptions::function_base_threads), so the per-FunctionBase
+  // tables are guarded by `mutex_`. Everything stored for one FunctionBase is
+  // only ever used by the thread working on that FunctionBase, so the entries
+  // themselves need no locking; node_hash_map keeps them at stable addresses
+  // while other threads insert.
+  absl::Mutex mutex_;
+  absl::node_hash_map<FunctionBase*, InvalidatingVector> reverse_topo_sort_
+      ABSL_GUARDED_BY(mutex_);
+
+  absl::node_hash_map<
       FunctionBase*,
       absl::flat_hash_map<std::type_index, std::shared_ptr<QueryEngine>>>
-      shared_query_engines_;
+      shared_query_engines_ ABSL_GUARDED_BY(mutex_);
 };
 
 // Construct a query engine that forwards to the shared implementation from
@@ -353,6 +381,9 @@ class DynamicCapOptLevel : public OptimizationPass {
     res.mutable_options()->set_max_opt_level(level_);
     return res;
   }
+  std::optional<absl::Span<const Op>> RelevantOps() const override {
+    return inner_.RelevantOps();
+  }
 
  protected:
   absl::StatusOr<bool> RunInternal(
@@ -393,6 +424,9 @@ class DynamicIfOptLevelAtLeast : public OptimizationPass {
     res.mutable_options()->set_min_opt_level(level_);
     return res;
   }
+  std::optional<absl::Span<const Op>> RelevantOps() const override {
+    return inner_.RelevantOps();
+  }
 
  protected:
   absl::StatusOr<bool> RunInternal(
@@ -485,9 +519,16 @@ class OptimizationFunctionBasePass : public OptimizationPass {
                                          PassResults* results,
                                          OptimizationContext& context) const;
 
+  // Returns true if RunOnFunctionBaseInternal modifies nothing but the given
+  // FunctionBase (and the package's types) and reads nothing else but the
+  // functions it calls, in which case the pass may run on several
+  // FunctionBases of a package at once.
+  virtual bool SupportsParallelExecution() const { return false; }
+
  protected:
   // Iterates over each function and proc in the package calling
-  // RunOnFunctionBase.
+  // RunOnFunctionBase, spreading the work over
+  // `options.function_base_threads` threads if the pass supports it.
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results,
@@ -507,6 +548,12 @@ class OptimizationFunctionBasePass : public OptimizationPass {
   absl::StatusOr<bool> TransformNodesToFixedPoint(
       FunctionBase* f,
       std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+
+ private:
+  absl::StatusOr<bool> RunInParallel(
+      absl::Span<FunctionBase* const> function_bases,
+      const OptimizationPassOptions& options, PassResults* results,
+      OptimizationContext& context) const;
 };
 
 // Abstract base class for passes operate on procs. The derived
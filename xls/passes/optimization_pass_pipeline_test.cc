@@ -25,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
@@ -37,6 +38,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -326,5 +328,43 @@ TEST_F(OptimizationPipelineTest, ProcScopedChannels) {
   ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
 }
 
+TEST_F(OptimizationPipelineTest, ParallelPipelineMatchesSequential) {
+  // Several independent functions with multiplies to narrow, selects to
+  // simplify and expressions to fold, so that the parallel passes create and
+  // name new nodes in each of them.
+  std::string ir_text = "package many_functions\n";
+  for (int64_t i = 0; i < 6; ++i) {
+    absl::StrAppendFormat(&ir_text, R"(
+fn f%d(x: bits[16], y: bits[16], s: bits[1]) -> bits[40] {
+  zeros: bits[%d] = literal(value=0)
+  x_shifted: bits[%d] = concat(x, zeros)
+  y_wide: bits[%d] = zero_ext(y, new_bit_count=%d)
+  product: bits[40] = umul(x_shifted, y_wide)
+  one: bits[40] = literal(value=1)
+  sum: bits[40] = add(product, one)
+  sum2: bits[40] = add(sum, one)
+  ret result: bits[40] = sel(s, cases=[sum2, product])
+}
+)",
+                          i, i + 1, 17 + i, 17 + i, 17 + i);
+  }
+  auto run = [&](int64_t threads) -> absl::StatusOr<std::string> {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p, ParsePackage(ir_text));
+    OptimizationPassOptions options;
+    options.function_base_threads = threads;
+    PassResults results;
+    OptimizationContext context;
+    XLS_RETURN_IF_ERROR(CreateOptimizationPassPipeline()
+                            ->Run(p.get(), options, &results, context)
+                            .status());
+    return p->DumpIr();
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string sequential, run(1));
+  for (int64_t threads : {2, 6}) {
+    EXPECT_THAT(run(threads), IsOkAndHolds(sequential)) << threads;
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -38,9 +38,11 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
+#include "xls/ir/verifier.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
@@ -524,6 +526,82 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
               IsOkAndHolds(false));
 }
 
+// Replaces every add with a subtract of the negated operand. The subtract is
+// named after the (new) negation, as passes often do.
+class AddToSubPass : public OptimizationFunctionBasePass {
+ public:
+  AddToSubPass() : OptimizationFunctionBasePass("add_to_sub", "Add to sub") {}
+
+  bool SupportsParallelExecution() const override { return true; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results, OptimizationContext& context) const override {
+    bool changed = false;
+    for (Node* node : context.TopoSort(f)) {
+      if (node->op() != Op::kAdd) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          Node * neg,
+          f->MakeNode<UnOp>(node->loc(), node->operand(1), Op::kNeg));
+      XLS_ASSIGN_OR_RETURN(
+          Node * sub, node->ReplaceUsesWithNew<BinOp>(node->operand(0), neg,
+                                                      Op::kSub));
+      sub->SetName(absl::StrCat(neg->GetName(), "_sub"));
+      XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+      changed = true;
+    }
+    return changed;
+  }
+};
+
+std::unique_ptr<Package> BuildManyFunctions() {
+  auto p = std::make_unique<Package>("many_functions");
+  Function* callee = nullptr;
+  for (int64_t i = 0; i < 8; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue sum = x;
+    for (int64_t j = 0; j <= i; ++j) {
+      sum = fb.Add(sum, fb.Literal(UBits(j, 32)));
+    }
+    callee = fb.BuildWithReturnValue(sum).value();
+  }
+  FunctionBuilder fb("caller", p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  CHECK_OK(fb.BuildWithReturnValue(fb.Add(fb.Invoke({x}, callee), x)));
+  return p;
+}
+
+TEST(PassesTest, ParallelFunctionBasePassMatchesSequential) {
+  std::unique_ptr<Package> sequential = BuildManyFunctions();
+  PassResults results;
+  OptimizationContext context;
+  ASSERT_THAT(AddToSubPass().Run(sequential.get(), OptimizationPassOptions(),
+                                 &results, context),
+              IsOkAndHolds(true));
+
+  for (int64_t threads : {2, 4, 16}) {
+    std::unique_ptr<Package> parallel = BuildManyFunctions();
+    OptimizationPassOptions options;
+    options.function_base_threads = threads;
+    PassResults parallel_results;
+    OptimizationContext parallel_context;
+    ASSERT_THAT(AddToSubPass().Run(parallel.get(), options, &parallel_results,
+                                   parallel_context),
+                IsOkAndHolds(true));
+    XLS_ASSERT_OK(VerifyPackage(parallel.get()));
+    EXPECT_EQ(parallel->DumpIr(), sequential->DumpIr());
+    EXPECT_EQ(parallel->next_node_id(), sequential->next_node_id());
+    EXPECT_EQ(parallel->transform_metrics().nodes_added,
+              sequential->transform_metrics().nodes_added);
+    EXPECT_EQ(parallel->transform_metrics().nodes_removed,
+              sequential->transform_metrics().nodes_removed);
+  }
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -23,11 +24,43 @@
 #include "google/protobuf/duration.pb.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_metrics.pb.h"
 
 namespace xls {
 
+bool FixedPointWorklist::ShouldRun(
+    int64_t index, std::optional<absl::Span<const Op>> relevant_ops,
+    const TransformMetrics& metrics) const {
+  const std::optional<CleanRun>& clean_run = clean_runs_[index];
+  if (!clean_run.has_value()) {
+    return true;
+  }
+  if (clean_run->change_count == change_count_) {
+    return false;
+  }
+  if (!relevant_ops.has_value()) {
+    return true;
+  }
+  return std::any_of(relevant_ops->begin(), relevant_ops->end(), [&](Op op) {
+    int64_t i = static_cast<int64_t>(op);
+    return metrics.op_changes[i] != clean_run->metrics.op_changes[i];
+  });
+}
+
+void FixedPointWorklist::RecordRun(int64_t index, bool changed,
+                                   const TransformMetrics& metrics) {
+  if (changed) {
+    ++change_count_;
+    clean_runs_[index] = std::nullopt;
+    return;
+  }
+  clean_runs_[index] =
+      CleanRun{.change_count = change_count_, .metrics = metrics};
+}
+
 void CompoundPassResult::AddSinglePassResult(std::string_view pass_name,
                                              bool changed,
                                              absl::Duration duration,
@@ -41,6 +41,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
@@ -74,6 +75,13 @@ struct PassOptionsBase {
   // If true, record metrics about runtime, number of nodes affected and other
   // information as appropriate for each pass run.
   bool record_metrics = false;
+
+  // If true, fixed-point compound passes only rerun a pass if the IR has
+  // changed since the pass last ran without changing anything. Passes which
+  // declare the ops they act on (see PassBase::RelevantOps) are further only
+  // rerun if a node with one of those ops, or one of its neighbors, was
+  // touched in the meantime.
+  bool incremental_fixed_point = false;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -228,6 +236,17 @@ class PassBase {
   // Returns true if this is a compound pass.
   virtual bool IsCompound() const { return false; }
 
+  // Returns the ops of the nodes this pass acts on, or std::nullopt if the
+  // pass may act on any node. A pass which declares its ops must be a pure
+  // function of the nodes with those ops together with their operands and
+  // users: if none of those nodes were added, removed, or rewired since the
+  // pass last ran without changing the IR, running it again must not change
+  // the IR either. Fixed-point compound passes use this to skip passes when
+  // PassOptionsBase::incremental_fixed_point is set.
+  virtual std::optional<absl::Span<const Op>> RelevantOps() const {
+    return std::nullopt;
+  }
+
  protected:
   // Derived classes should override this function which is invoked from Run.
   virtual absl::StatusOr<bool> RunInternal(IrT* ir, const OptionsT& options,
@@ -252,6 +271,9 @@ class WrapperPassBase final
   absl::StatusOr<PassPipelineProto::Element> ToProto() const final {
     return base_->ToProto();
   }
+  std::optional<absl::Span<const Op>> RelevantOps() const final {
+    return base_->RelevantOps();
+  }
 
  protected:
   absl::StatusOr<bool> RunInternal(IrT* ir, const OptionsT& options,
@@ -264,6 +286,36 @@ class WrapperPassBase final
   std::unique_ptr<PassBase<IrT, OptionsT, ResultsT, ContextT...>> base_;
 };
 
+// Tracks which passes of a fixed-point compound pass may change the IR if run
+// again, using the per-op change counters in TransformMetrics. A pass only
+// needs to rerun once the IR has changed since its last run which did not
+// change anything; if the pass declares its relevant ops, the change must also
+// have touched a node with one of those ops.
+class FixedPointWorklist {
+ public:
+  explicit FixedPointWorklist(int64_t pass_count) : clean_runs_(pass_count) {}
+
+  // Returns whether the pass at `index` must be run given the current
+  // `metrics` of the IR.
+  bool ShouldRun(int64_t index,
+                 std::optional<absl::Span<const Op>> relevant_ops,
+                 const TransformMetrics& metrics) const;
+
+  // Records that the pass at `index` ran, leaving the IR with `metrics`.
+  void RecordRun(int64_t index, bool changed, const TransformMetrics& metrics);
+
+ private:
+  struct CleanRun {
+    // The value of `change_count_` after the run.
+    int64_t change_count;
+    TransformMetrics metrics;
+  };
+
+  // Number of pass runs which changed the IR.
+  int64_t change_count_ = 0;
+  std::vector<std::optional<CleanRun>> clean_runs_;
+};
+
 // A base class for abstractions which check invariants of the IR. These
 // checkers are added to compound passes (pass pipelines) and run before and
 // after each pass in the pipeline.
@@ -365,7 +417,19 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT, ContextT...> {
   virtual absl::StatusOr<CompoundPassResult> RunNested(
       IrT* ir, const OptionsT& options, ResultsT* results, ContextT&... context,
       std::string_view top_level_name,
-      absl::Span<const InvariantChecker* const> invariant_checkers) const;
+      absl::Span<const InvariantChecker* const> invariant_checkers) const {
+    return RunPasses(ir, options, results, context..., top_level_name,
+                     invariant_checkers, /*worklist=*/nullptr);
+  }
+
+  // Runs each of the passes once. If `worklist` is non-null, passes it
+  // reports as unable to change the IR are skipped and each run is recorded
+  // in it.
+  absl::StatusOr<CompoundPassResult> RunPasses(
+      IrT* ir, const OptionsT& options, ResultsT* results, ContextT&... context,
+      std::string_view top_level_name,
+      absl::Span<const InvariantChecker* const> invariant_checkers,
+      FixedPointWorklist* worklist) const;
 
   // Dump the IR to a file in the given directory. Name is determined by the
   // various arguments passed in. File names will be lexicographically ordered
@@ -419,13 +483,17 @@ class FixedPointCompoundPassBase
     bool local_changed = true;
     int64_t iteration_count = 0;
     CompoundPassResult aggregate_result;
+    std::optional<FixedPointWorklist> worklist;
+    if (options.incremental_fixed_point) {
+      worklist.emplace(this->passes().size());
+    }
     while (local_changed) {
       ++iteration_count;
       XLS_ASSIGN_OR_RETURN(
           CompoundPassResult compound_result,
-          (CompoundPassBase<IrT, OptionsT, ResultsT, ContextT...>::RunNested(
-              ir, options, results, context..., top_level_name,
-              invariant_checkers)),
+          this->RunPasses(ir, options, results, context..., top_level_name,
+                          invariant_checkers,
+                          worklist.has_value() ? &*worklist : nullptr),
           _ << "Running pass #" << results->invocations.size() << ": "
             << this->long_name() << " [short: " << this->short_name() << "]");
       local_changed = compound_result.changed();
@@ -442,10 +510,11 @@ class FixedPointCompoundPassBase
 template <typename IrT, typename OptionsT, typename ResultsT,
           typename... ContextT>
 absl::StatusOr<CompoundPassResult>
-CompoundPassBase<IrT, OptionsT, ResultsT, ContextT...>::RunNested(
+CompoundPassBase<IrT, OptionsT, ResultsT, ContextT...>::RunPasses(
     IrT* ir, const OptionsT& options, ResultsT* results, ContextT&... context,
     std::string_view top_level_name,
-    absl::Span<const InvariantChecker* const> invariant_checkers) const {
+    absl::Span<const InvariantChecker* const> invariant_checkers,
+    FixedPointWorklist* worklist) const {
   VLOG(1) << "Running " << this->short_name() << " compound pass on package "
           << ir->name();
   VLOG(2) << "Start of compound pass " << this->short_name() << ":";
@@ -475,7 +544,16 @@ CompoundPassBase<IrT, OptionsT, ResultsT, ContextT...>::RunNested(
 
   CompoundPassResult aggregate_result;
   bool changed = false;
-  for (const auto& pass : passes_) {
+  for (int64_t pass_index = 0; pass_index < passes_.size(); ++pass_index) {
+    const std::unique_ptr<Pass>& pass = passes_[pass_index];
+    if (worklist != nullptr &&
+        !worklist->ShouldRun(pass_index, pass->RelevantOps(),
+                             ir->transform_metrics())) {
+      VLOG(1) << absl::StreamFormat(
+          "Skipping %s (%s) pass; no relevant changes since its last run.",
+          pass->long_name(), pass->short_name());
+      continue;
+    }
     VLOG(1) << absl::StreamFormat("Running %s (%s, #%d) pass on package %s",
                                   pass->long_name(), pass->short_name(),
                                   results->invocations.size(), ir->name());
@@ -540,6 +618,9 @@ CompoundPassBase<IrT, OptionsT, ResultsT, ContextT...>::RunNested(
     }
 #endif
     changed = changed || pass_changed;
+    if (worklist != nullptr) {
+      worklist->RecordRun(pass_index, pass_changed, ir->transform_metrics());
+    }
     TransformMetrics pass_metrics = ir->transform_metrics() - before_metrics;
     VLOG(1) << absl::StreamFormat(
         "[elapsed %s] Pass %s %s.", FormatDuration(duration),
@@ -35,8 +35,10 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/passes/dce_pass.h"
+#include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace m = ::xls::op_matchers;
@@ -123,6 +125,9 @@ auto DceInvoke() { return Field(&PassInvocation::pass_name, Eq("dce")); }
 auto LevelUpInvoke() {
   return Field(&PassInvocation::pass_name, Eq("level_up"));
 }
+auto IdentityRemovalInvoke() {
+  return Field(&PassInvocation::pass_name, Eq("ident_remove"));
+}
 
 TEST_F(PassBaseTest, DetectEasyIncorrectReturn) {
   auto p = CreatePackage();
@@ -295,5 +300,54 @@ TEST_F(PassBaseTest, BisectLimitZero) {
   EXPECT_THAT(results.invocations, IsEmpty());
 }
 
+TEST_F(PassBaseTest, IncrementalFixedPoint) {
+  auto build_pipeline = []() {
+    auto fp =
+        std::make_unique<OptimizationFixedPointCompoundPass>("fixed", "fixed");
+    fp->Add<IdentityRemovalPass>();
+    fp->Add<LevelUpPass>();
+    fp->Add<DeadCodeEliminationPass>();
+    return fp;
+  };
+  auto build_function = [&](Package* p) -> absl::StatusOr<Function*> {
+    FunctionBuilder fb(TestName(), p);
+    fb.Identity(fb.Literal(UBits(0, 2)));
+    return fb.Build();
+  };
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, build_function(p.get()));
+  PassResults results;
+  OptimizationContext context;
+  EXPECT_THAT(build_pipeline()->Run(p.get(), OptimizationPassOptions(),
+                                    &results, context),
+              IsOk());
+  EXPECT_THAT(f->return_value(), m::Literal(UBits(3, 2)));
+  EXPECT_EQ(results.invocations.size(), 12);
+
+  // Identity removal only acts on identities, so once it has run without
+  // changing anything it is skipped until an identity is touched again. The
+  // other passes are rerun only after something changed since their last
+  // unproductive run.
+  auto incremental_p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * incremental_f,
+                           build_function(incremental_p.get()));
+  PassResults incremental_results;
+  OptimizationContext incremental_context;
+  EXPECT_THAT(
+      build_pipeline()->Run(incremental_p.get(),
+                            OptimizationPassOptions(PassOptionsBase{
+                                .incremental_fixed_point = true}),
+                            &incremental_results, incremental_context),
+      IsOk());
+  EXPECT_THAT(incremental_f->return_value(), m::Literal(UBits(3, 2)));
+  EXPECT_EQ(incremental_f->node_count(), 1);
+  EXPECT_THAT(incremental_results.invocations,
+              ElementsAre(IdentityRemovalInvoke(), LevelUpInvoke(), DceInvoke(),
+                          IdentityRemovalInvoke(), LevelUpInvoke(), DceInvoke(),
+                          LevelUpInvoke(), DceInvoke(), LevelUpInvoke(),
+                          DceInvoke()));
+}
+
 }  // namespace
 }  // namespace xls
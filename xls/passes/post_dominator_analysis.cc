@@ -25,6 +25,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/topo_sort.h"
@@ -95,7 +96,7 @@ PostDominatorAnalysis::Run(FunctionBase* f) {
   // Construct the postdominators for each node. Postdominators are gathered as
   // a sorted vector containing the node indices (in a reverse toposort) of the
   // post dominator nodes.
-  absl::flat_hash_map<Node*, std::vector<NodeIndex>> postdominators;
+  NodeMap<std::vector<NodeIndex>> postdominators(f);
   for (NodeIndex i = 0; i < reverse_toposort.size(); ++i) {
     Node* node = reverse_toposort[i];
     std::vector<absl::Span<const NodeIndex>> user_postdominators;
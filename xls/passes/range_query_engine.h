@@ -21,7 +21,6 @@
 #include <string>
 #include <utility>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -33,6 +32,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/interval_set.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/passes/query_engine.h"
@@ -245,9 +245,9 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
-  absl::flat_hash_map<Node*, Bits> known_bits_;
-  absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  NodeMap<Bits> known_bits_;
+  NodeMap<Bits> known_bit_values_;
+  NodeMap<IntervalSetTree> interval_sets_;
 };
 
 std::string IntervalSetTreeToString(const IntervalSetTree& tree);
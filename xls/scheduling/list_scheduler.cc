@@ -0,0 +1,359 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/list_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/log_lines.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/schedule_util.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+namespace {
+
+// The maximum number of list scheduling passes.
+constexpr int64_t kMaxPasses = 4;
+
+// A requirement that `target` be scheduled at least `latency` cycles after the
+// node the edge belongs to.
+struct LatencyEdge {
+  Node* target;
+  int64_t latency;
+};
+
+using LatencyEdges = NodeMap<std::vector<LatencyEdge>>;
+
+// Returns the minimum-latency edges implied by MinDelay nodes and by any
+// SendThenRecvConstraint, keyed by their source.
+LatencyEdges GetLatencyEdges(
+    FunctionBase* f, absl::Span<const SchedulingConstraint> constraints) {
+  LatencyEdges edges(f);
+  for (Node* node : f->nodes()) {
+    // A MinDelay node must be scheduled at least its delay after its operand;
+    // its users then follow it as usual.
+    if (node->Is<MinDelay>() && node->As<MinDelay>()->delay() > 0) {
+      for (Node* operand : node->operands()) {
+        edges[operand].push_back({node, node->As<MinDelay>()->delay()});
+      }
+    }
+  }
+
+  int64_t send_then_recv_latency = 0;
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (const auto* send_then_recv =
+            std::get_if<SendThenRecvConstraint>(&constraint)) {
+      send_then_recv_latency = std::max(send_then_recv_latency,
+                                        send_then_recv->MinimumLatency());
+    }
+  }
+  if (send_then_recv_latency == 0) {
+    return edges;
+  }
+  // As in the SDC scheduler, each receive must follow the sends it depends on;
+  // the search stops at sends and receives since earlier ones are handled
+  // transitively.
+  for (Node* recv : f->nodes()) {
+    if (!recv->Is<Receive>()) {
+      continue;
+    }
+    std::vector<Node*> stack(recv->operands().begin(), recv->operands().end());
+    absl::flat_hash_set<Node*> seen;
+    while (!stack.empty()) {
+      Node* node = stack.back();
+      stack.pop_back();
+      if (!seen.insert(node).second) {
+        continue;
+      }
+      if (node->Is<Send>()) {
+        edges[node].push_back({recv, send_then_recv_latency});
+        continue;
+      }
+      if (node->Is<Receive>()) {
+        continue;
+      }
+      stack.insert(stack.end(), node->operands().begin(),
+                   node->operands().end());
+    }
+  }
+  return edges;
+}
+
+// Propagates the lower bounds through both the data dependencies and the
+// latency edges until they reach a fixed point. Both kinds of edges point
+// forward in topological order, so this terminates.
+absl::Status PropagateLowerBoundsWithLatencies(
+    absl::Span<Node* const> topo_sort, const LatencyEdges& edges,
+    sched::ScheduleBounds* bounds) {
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (Node* node : topo_sort) {
+      auto it = edges.find(node);
+      if (it == edges.end()) {
+        continue;
+      }
+      for (const LatencyEdge& edge : it->second) {
+        if (bounds->lb(edge.target) < bounds->lb(node) + edge.latency) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(
+              edge.target, bounds->lb(node) + edge.latency));
+          changed = true;
+        }
+      }
+    }
+    if (changed) {
+      XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Returns the number of register bits implied by the given cycle assignment,
+// counting each value once for every cycle boundary it is live across.
+int64_t CountRegisterBits(absl::Span<Node* const> topo_sort,
+                          const NodeMap<int64_t>& cycles) {
+  int64_t bits = 0;
+  for (Node* node : topo_sort) {
+    int64_t last_use = cycles.at(node);
+    for (Node* user : node->users()) {
+      last_use = std::max(last_use, cycles.at(user));
+    }
+    bits += node->GetType()->GetFlatBitCount() * (last_use - cycles.at(node));
+  }
+  return bits;
+}
+
+// Runs one list scheduling pass, placing each node in reverse topological
+// order; `estimate` gives the expected cycle of each node's operands, which
+// have not been placed yet when the node is.
+absl::StatusOr<NodeMap<int64_t>> ListSchedulePass(
+    FunctionBase* f, absl::Span<Node* const> topo_sort,
+    const sched::ScheduleBounds& bounds, const LatencyEdges& latency_edges,
+    const NodeMap<int64_t>& delays, int64_t clock_period_ps,
+    int64_t pipeline_stages, const NodeMap<int64_t>& estimate) {
+  NodeMap<int64_t> cycles(f);
+  // The delay from the start of each node to the end of the longest
+  // combinational path from it within its cycle.
+  NodeMap<int64_t> path_delays(f);
+  // The latest cycle in which each node is used by the users placed so far.
+  NodeMap<int64_t> last_uses(f);
+
+  for (auto it = topo_sort.rbegin(); it != topo_sort.rend(); ++it) {
+    Node* node = *it;
+    const int64_t lo = bounds.lb(node);
+    int64_t hi = std::min(bounds.ub(node), pipeline_stages - 1);
+    std::optional<int64_t> first_user_cycle;
+    std::optional<int64_t> last_user_cycle;
+    for (Node* user : node->users()) {
+      const int64_t user_cycle = cycles.at(user);
+      first_user_cycle = std::min(first_user_cycle.value_or(user_cycle),
+                                  user_cycle);
+      last_user_cycle = std::max(last_user_cycle.value_or(user_cycle),
+                                 user_cycle);
+    }
+    if (first_user_cycle.has_value()) {
+      hi = std::min(hi, *first_user_cycle);
+    }
+    if (auto edges_it = latency_edges.find(node);
+        edges_it != latency_edges.end()) {
+      for (const LatencyEdge& edge : edges_it->second) {
+        hi = std::min(hi, cycles.at(edge.target) - edge.latency);
+      }
+    }
+
+    // The node can only share a combinational path with the users in the
+    // earliest of their cycles.
+    int64_t user_path_delay = 0;
+    if (first_user_cycle.has_value()) {
+      for (Node* user : node->users()) {
+        if (cycles.at(user) == *first_user_cycle) {
+          user_path_delay = std::max(user_path_delay, path_delays.at(user));
+        }
+      }
+      if (hi == *first_user_cycle &&
+          delays.at(node) + user_path_delay > clock_period_ps) {
+        --hi;
+      }
+    }
+    XLS_RET_CHECK_LE(lo, hi) << "No legal cycle for " << node->GetName();
+
+    // Pick the cycle which minimizes the bits live across the node's output
+    // and its operands, preferring earlier cycles on ties. An operand used
+    // more than once is counted once per use; this is only an estimate.
+    const int64_t node_bits = node->GetType()->GetFlatBitCount();
+    int64_t best_cycle = lo;
+    int64_t best_cost = std::numeric_limits<int64_t>::max();
+    for (int64_t cycle = lo; cycle <= hi; ++cycle) {
+      int64_t cost = 0;
+      if (last_user_cycle.has_value()) {
+        cost += node_bits * (*last_user_cycle - cycle);
+      }
+      for (Node* operand : node->operands()) {
+        int64_t live_from = std::min(estimate.at(operand), cycle);
+        int64_t live_to = cycle;
+        if (auto last_use = last_uses.find(operand);
+            last_use != last_uses.end()) {
+          live_to = std::max(live_to, last_use->second);
+        }
+        cost += operand->GetType()->GetFlatBitCount() * (live_to - live_from);
+      }
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_cycle = cycle;
+      }
+    }
+
+    cycles[node] = best_cycle;
+    path_delays[node] =
+        delays.at(node) +
+        (best_cycle == first_user_cycle ? user_path_delay : int64_t{0});
+    for (Node* operand : node->operands()) {
+      auto [last_use, inserted] = last_uses.try_emplace(operand, best_cycle);
+      if (!inserted) {
+        last_use->second = std::max(last_use->second, best_cycle);
+      }
+    }
+  }
+  return cycles;
+}
+
+}  // namespace
+
+absl::Status TightenBoundsForLatencyConstraints(
+    FunctionBase* f, absl::Span<const SchedulingConstraint> constraints,
+    sched::ScheduleBounds* bounds) {
+  return PropagateLowerBoundsWithLatencies(
+      TopoSort(f), GetLatencyEdges(f, constraints), bounds);
+}
+
+absl::StatusOr<ScheduleCycleMap> ListScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints) {
+  VLOG(3) << "ListScheduler()";
+  VLOG(3) << "  pipeline stages = " << pipeline_stages;
+  XLS_VLOG_LINES(4, f->DumpIr());
+
+  bool has_backedge_constraint = false;
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (std::holds_alternative<IOConstraint>(constraint) ||
+        std::holds_alternative<DifferenceConstraint>(constraint)) {
+      return absl::UnimplementedError(
+          "ListScheduler doesn't support I/O or difference constraints; use "
+          "the SDC scheduler instead.");
+    }
+    if (std::holds_alternative<NodeInCycleConstraint>(constraint)) {
+      const auto& nic = std::get<NodeInCycleConstraint>(constraint);
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(nic.GetNode(), nic.GetCycle()));
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(nic.GetNode(), nic.GetCycle()));
+    } else if (std::holds_alternative<RecvsFirstSendsLastConstraint>(
+                   constraint)) {
+      for (Node* node : f->nodes()) {
+        if (node->Is<Receive>()) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+        } else if (node->Is<Send>()) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, pipeline_stages - 1));
+        }
+      }
+    } else if (std::holds_alternative<BackedgeConstraint>(constraint)) {
+      has_backedge_constraint = true;
+    }
+  }
+
+  std::vector<Node*> topo_sort = TopoSort(f);
+  LatencyEdges latency_edges = GetLatencyEdges(f, constraints);
+  XLS_RETURN_IF_ERROR(
+      PropagateLowerBoundsWithLatencies(topo_sort, latency_edges, bounds));
+
+  // Since state reads are never scheduled before their lower bounds, capping
+  // each next_value at II - 1 cycles after that bound keeps backedges short
+  // enough.
+  if (Proc* proc = dynamic_cast<Proc*>(f);
+      proc != nullptr && has_backedge_constraint) {
+    const int64_t ii = proc->GetInitiationInterval().value_or(1);
+    if (ii > 0) {
+      for (Next* next : proc->next_values()) {
+        XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(
+            next, bounds->lb(next->state_read()) + ii - 1));
+      }
+    }
+  }
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+
+  VLOG(4) << "Initial bounds:";
+  XLS_VLOG_LINES(4, bounds->ToString());
+
+  // Nodes which are dead after synthesis have no delay, as in ScheduleBounds.
+  absl::flat_hash_set<Node*> dead_after_synthesis =
+      GetDeadAfterSynthesisNodes(f);
+  NodeMap<int64_t> delays(f);
+  NodeMap<int64_t> estimate(f);
+  for (Node* node : topo_sort) {
+    int64_t delay = 0;
+    if (!dead_after_synthesis.contains(node)) {
+      XLS_ASSIGN_OR_RETURN(delay, delay_estimator.GetOperationDelayInPs(node));
+    }
+    delays[node] = delay;
+    estimate[node] = bounds->lb(node);
+  }
+
+  std::optional<NodeMap<int64_t>> best;
+  int64_t best_register_bits = std::numeric_limits<int64_t>::max();
+  for (int64_t pass = 0; pass < kMaxPasses; ++pass) {
+    XLS_ASSIGN_OR_RETURN(
+        NodeMap<int64_t> cycles,
+        ListSchedulePass(f, topo_sort, *bounds, latency_edges, delays,
+                         clock_period_ps, pipeline_stages, estimate));
+    const int64_t register_bits = CountRegisterBits(topo_sort, cycles);
+    VLOG(3) << "List scheduling pass " << pass << ": " << register_bits
+            << " register bits";
+    if (register_bits >= best_register_bits) {
+      break;
+    }
+    best_register_bits = register_bits;
+    best = cycles;
+    estimate = std::move(cycles);
+  }
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : topo_sort) {
+    cycle_map[node] = best->at(node);
+  }
+  return cycle_map;
+}
+
+}  // namespace xls
@@ -0,0 +1,60 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_LIST_SCHEDULER_H_
+#define XLS_SCHEDULING_LIST_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// Tightens the lower bounds in `bounds` to account for the minimum latencies
+// required by `constraints` which ScheduleBounds does not model on its own
+// (i.e., SendThenRecvConstraint). ListScheduler does this as well, but calling
+// this before the upper bounds are set lets the pipeline length account for
+// these latencies.
+absl::Status TightenBoundsForLatencyConstraints(
+    FunctionBase* f, absl::Span<const SchedulingConstraint> constraints,
+    sched::ScheduleBounds* bounds);
+
+// Schedules the given function into a pipeline with the given clock period
+// without solving a linear program; intended for functions which are too large
+// for the SDC scheduler.
+//
+// Nodes are placed one at a time in reverse topological order, each in the
+// cycle within its bounds which minimizes the register bits live across its
+// output and operands while meeting the dependency, clock period and minimum
+// latency constraints. A node's lower bound is always a legal choice, so this
+// never fails to find a schedule. Operand placement is estimated from the
+// previous pass (initially, from the lower bounds), and passes are repeated
+// while the number of register bits decreases. Each pass takes O((N + E) * S)
+// time for N nodes, E edges and S pipeline stages.
+//
+// I/O constraints and difference constraints are not supported.
+absl::StatusOr<ScheduleCycleMap> ListScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_LIST_SCHEDULER_H_
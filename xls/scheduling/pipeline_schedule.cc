@@ -131,8 +131,12 @@ absl::StatusOr<PipelineSchedule> PipelineSchedule::FromProto(
   if (schedule_it->second.has_min_clock_period_ps()) {
     min_clock_period_ps = schedule_it->second.min_clock_period_ps();
   }
-  return PipelineSchedule(function, cycle_map, /*length=*/std::nullopt,
-                          min_clock_period_ps);
+  PipelineSchedule schedule(function, cycle_map, /*length=*/std::nullopt,
+                            min_clock_period_ps);
+  if (schedule_it->second.has_sdc_solver_metrics()) {
+    schedule.set_sdc_solver_metrics(schedule_it->second.sdc_solver_metrics());
+  }
+  return schedule;
 }
 
 absl::StatusOr<PipelineSchedule> PipelineSchedule::SingleStage(
@@ -559,6 +563,9 @@ PipelineScheduleProto PipelineSchedule::ToProto(
   if (min_clock_period_ps_.has_value()) {
     proto.set_min_clock_period_ps(*min_clock_period_ps_);
   }
+  if (sdc_solver_metrics_.has_value()) {
+    *proto.mutable_sdc_solver_metrics() = *sdc_solver_metrics_;
+  }
   return proto;
 }
 
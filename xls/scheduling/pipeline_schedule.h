@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -94,6 +95,15 @@ class PipelineSchedule {
     return min_clock_period_ps_;
   }
 
+  // Returns statistics about the SDC solves performed while creating the
+  // schedule, if any. This is purely for tracing purposes.
+  const std::optional<SdcSolverMetricsProto>& sdc_solver_metrics() const {
+    return sdc_solver_metrics_;
+  }
+  void set_sdc_solver_metrics(SdcSolverMetricsProto metrics) {
+    sdc_solver_metrics_ = std::move(metrics);
+  }
+
   // Verifies various invariants of the schedule (each node scheduled exactly
   // once, node not scheduled before operands, etc.).
   absl::Status Verify() const;
@@ -130,6 +140,9 @@ class PipelineSchedule {
 
   // The minimum possible clock period, if known.
   std::optional<int64_t> min_clock_period_ps_;
+
+  // Statistics about the SDC solves performed, if known.
+  std::optional<SdcSolverMetricsProto> sdc_solver_metrics_;
 };
 
 // Group of PipelineSchedules for subset of FunctionBases in a package.
@@ -1203,6 +1203,63 @@ TEST_F(PipelineScheduleTest, MinimizedThroughputWorksWithGivenClockPeriod) {
   EXPECT_EQ(proc->GetInitiationInterval().value_or(1), 3);
 }
 
+TEST_F(PipelineScheduleTest, SdcSweepsReuseTheModel) {
+  Package package = Package(TestName());
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+  ProcBuilder pb(TestName(), &package);
+  BValue tkn = pb.Literal(Value::Token());
+  BValue state = pb.StateElement("state", Value(Bits(32)));
+
+  BValue send = pb.Send(ch_out, tkn, state);
+  BValue delay = pb.MinDelay(send, /*delay=*/2);
+  BValue rcv = pb.Receive(ch_in, /*token=*/delay);
+  BValue next = pb.Add(pb.Negate(pb.TupleIndex(rcv, 1)), state);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  // Neither the clock period nor the worst-case throughput is given, so both
+  // are found by sweeping; all of the solves should share a single model.
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(proc, *delay_estimator,
+                          SchedulingOptions()
+                              .pipeline_stages(4)
+                              .worst_case_throughput(0)
+                              .minimize_worst_case_throughput(true)));
+  EXPECT_EQ(schedule.length(), 4);
+  EXPECT_EQ(schedule.cycle(rcv.node()) - schedule.cycle(send.node()), 2);
+
+  ASSERT_TRUE(schedule.sdc_solver_metrics().has_value());
+  const SdcSolverMetricsProto& metrics = *schedule.sdc_solver_metrics();
+  EXPECT_GT(metrics.solves(), 2);
+  EXPECT_GT(metrics.warm_started_solves(), 0);
+  EXPECT_LT(metrics.warm_started_solves(), metrics.solves());
+  EXPECT_GT(metrics.timing_constraints_added(), 0);
+
+  PipelineScheduleProto proto = schedule.ToProto(*delay_estimator);
+  EXPECT_EQ(proto.sdc_solver_metrics().solves(), metrics.solves());
+
+  // The metrics hold no timings, so the schedule output is reproducible.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule again,
+      RunPipelineSchedule(proc, *delay_estimator,
+                          SchedulingOptions()
+                              .pipeline_stages(4)
+                              .worst_case_throughput(0)
+                              .minimize_worst_case_throughput(true)));
+  EXPECT_EQ(again.ToProto(*delay_estimator).DebugString(),
+            proto.DebugString());
+}
+
 TEST_F(PipelineScheduleTest,
        SuggestReducedThroughputWhenFullThroughputFailsWithClockGiven) {
   Package package = Package(TestName());
@@ -1815,6 +1872,99 @@ TEST_F(PipelineScheduleTest, RandomSchedule) {
   }
 }
 
+TEST_F(PipelineScheduleTest, ListScheduleMinimizesRegisterBitslices) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto x_slice = fb.BitSlice(x, /*start=*/8, /*width=*/8);
+  auto y_slice = fb.BitSlice(y, /*start=*/8, /*width=*/8);
+  auto neg_neg_y = fb.Negate(fb.Negate(y));
+  // 'x' is live throughout the function, 'y' is not.
+  fb.Concat({x, x_slice, y_slice, neg_neg_y});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  for (bool lp_refinement : {false, true}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(
+            f, TestDelayEstimator(),
+            SchedulingOptions(SchedulingStrategy::LIST)
+                .clock_period_ps(1)
+                .list_scheduling_lp_refinement(lp_refinement)));
+
+    EXPECT_EQ(schedule.length(), 2);
+    EXPECT_THAT(schedule.nodes_in_cycle(0),
+                UnorderedElementsAre(m::Param("x"), m::Param("y"),
+                                     m::BitSlice(m::Param("y")), m::Neg()));
+    EXPECT_THAT(schedule.nodes_in_cycle(1),
+                UnorderedElementsAre(m::BitSlice(m::Param("x")), m::Neg(),
+                                     m::Concat()));
+  }
+}
+
+TEST_F(PipelineScheduleTest, ListScheduleIsLegal) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  BValue wide = fb.ZeroExtend(x, 256);
+  for (int64_t i = 0; i < 20; ++i) {
+    x = fb.Negate(x);
+    if (i % 5 == 0) {
+      wide = fb.Add(wide, fb.ZeroExtend(x, 256));
+    }
+  }
+  fb.Concat({x, wide});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  for (int64_t stages = 11; stages <= 20; ++stages) {
+    // Running the scheduler will call `VerifyTiming`.
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(func, TestDelayEstimator(),
+                            SchedulingOptions(SchedulingStrategy::LIST)
+                                .clock_period_ps(2)
+                                .pipeline_stages(stages)));
+    EXPECT_EQ(schedule.length(), stages);
+  }
+}
+
+TEST_F(PipelineScheduleTest, ListScheduleProcWithMinimumLatencies) {
+  Package package = Package(TestName());
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+  ProcBuilder pb(TestName(), &package);
+  BValue tkn = pb.Literal(Value::Token());
+  BValue state = pb.StateElement("state", Value(Bits(32)));
+
+  BValue send = pb.Send(ch_out, tkn, state);
+  BValue delay = pb.MinDelay(send, /*delay=*/2);
+  BValue rcv = pb.Receive(ch_in, /*token=*/delay);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({pb.TupleIndex(rcv, 1)}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(proc, *delay_estimator,
+                          SchedulingOptions(SchedulingStrategy::LIST)
+                              .pipeline_stages(4)
+                              .worst_case_throughput(3)));
+  XLS_EXPECT_OK(schedule.Verify());
+  EXPECT_EQ(schedule.length(), 4);
+  EXPECT_GE(schedule.cycle(delay.node()) - schedule.cycle(send.node()), 2);
+  EXPECT_EQ(schedule.cycle(rcv.node()) - schedule.cycle(send.node()), 2);
+}
+
 TEST_F(PipelineScheduleTest, SingleStageSchedule) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
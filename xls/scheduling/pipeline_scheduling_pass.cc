@@ -14,16 +14,27 @@
 
 #include "xls/scheduling/pipeline_scheduling_pass.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/data_structures/union_find.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -44,6 +55,64 @@ void AddCycleConstraints(const PipelineSchedule& schedule,
     }
   }
 }
+
+// Partitions `functions` into groups which must be scheduled together: an
+// IOConstraint relates the operations on two channels, which may be used by
+// different procs, so procs linked by such a constraint are placed in the same
+// group. Groups and the functions within them are in the order of
+// `functions`.
+std::vector<std::vector<FunctionBase*>> GroupByIOConstraints(
+    absl::Span<FunctionBase* const> functions,
+    absl::Span<const SchedulingConstraint> constraints) {
+  UnionFind<FunctionBase*> groups;
+  absl::flat_hash_map<std::string, std::vector<FunctionBase*>> channel_users;
+  for (FunctionBase* f : functions) {
+    groups.Insert(f);
+    for (Node* node : f->nodes()) {
+      if (node->Is<ChannelNode>()) {
+        std::vector<FunctionBase*>& users =
+            channel_users[node->As<ChannelNode>()->channel_name()];
+        if (users.empty() || users.back() != f) {
+          users.push_back(f);
+        }
+      }
+    }
+  }
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (!std::holds_alternative<IOConstraint>(constraint)) {
+      continue;
+    }
+    const IOConstraint& io_constraint = std::get<IOConstraint>(constraint);
+    std::optional<FunctionBase*> representative;
+    for (const std::string& channel :
+         {io_constraint.SourceChannel(), io_constraint.TargetChannel()}) {
+      auto it = channel_users.find(channel);
+      if (it == channel_users.end()) {
+        continue;
+      }
+      for (FunctionBase* f : it->second) {
+        if (representative.has_value()) {
+          groups.Union(*representative, f);
+        } else {
+          representative = f;
+        }
+      }
+    }
+  }
+
+  std::vector<std::vector<FunctionBase*>> result;
+  absl::flat_hash_map<FunctionBase*, int64_t> group_index;
+  for (FunctionBase* f : functions) {
+    auto [it, inserted] =
+        group_index.try_emplace(groups.Find(f), result.size());
+    if (inserted) {
+      result.emplace_back();
+    }
+    result[it->second].push_back(f);
+  }
+  return result;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> PipelineSchedulingPass::RunInternal(
@@ -67,28 +136,88 @@ absl::StatusOr<bool> PipelineSchedulingPass::RunInternal(
       elab.has_value() ? std::optional<const ProcElaboration*>(&elab.value())
                        : std::nullopt;
 
+  std::vector<FunctionBase*> functions;
   for (FunctionBase* f : schedulable_functions) {
-    if (f->ForeignFunctionData().has_value()) {
-      continue;
+    if (!f->ForeignFunctionData().has_value()) {
+      functions.push_back(f);
     }
-    absl::flat_hash_map<Node*, int64_t> schedule_cycle_map_before;
+  }
+
+  // Schedules a single function; only reads `unit`, so it may run for several
+  // functions concurrently.
+  auto schedule_function =
+      [&](FunctionBase* f) -> absl::StatusOr<PipelineSchedule> {
     SchedulingOptions scheduling_options = options.scheduling_options;
     auto schedule_itr = unit->schedules().find(f);
-    if (schedule_itr != unit->schedules().end()) {
-      const PipelineSchedule& schedule = schedule_itr->second;
-      schedule_cycle_map_before = schedule.GetCycleMap();
-      if (!scheduling_options.use_fdo()) {
-        AddCycleConstraints(schedule, scheduling_options);
+    if (schedule_itr != unit->schedules().end() &&
+        !scheduling_options.use_fdo()) {
+      AddCycleConstraints(schedule_itr->second, scheduling_options);
+    }
+    TimingAnalysis* timing_analysis =
+        options.timing_analysis != nullptr &&
+                options.timing_analysis->function_base() == f
+            ? options.timing_analysis
+            : nullptr;
+    return options.synthesizer == nullptr
+               ? RunPipelineSchedule(f, *options.delay_estimator,
+                                     scheduling_options, elab_opt,
+                                     timing_analysis)
+               : RunPipelineScheduleWithFdo(
+                     f, *options.delay_estimator, scheduling_options,
+                     *options.synthesizer, elab_opt, timing_analysis);
+  };
+
+  // Each function gets its own SDC model and solver, so functions can be
+  // scheduled concurrently unless a constraint links them. The synthesizer
+  // used for FDO is not thread-safe, so FDO always runs sequentially.
+  std::vector<std::vector<FunctionBase*>> groups =
+      GroupByIOConstraints(functions, options.scheduling_options.constraints());
+  int64_t thread_count =
+      options.synthesizer == nullptr
+          ? std::min<int64_t>(options.scheduling_options.scheduling_threads(),
+                              groups.size())
+          : 1;
+  absl::flat_hash_map<FunctionBase*, absl::StatusOr<PipelineSchedule>>
+      schedules;
+  if (thread_count > 1) {
+    const int64_t group_count = groups.size();
+    std::vector<std::vector<absl::StatusOr<PipelineSchedule>>> group_schedules(
+        group_count);
+    std::atomic<int64_t> next = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>([&]() {
+        for (int64_t g = next++; g < group_count; g = next++) {
+          for (FunctionBase* f : groups[g]) {
+            group_schedules[g].push_back(schedule_function(f));
+          }
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    for (int64_t g = 0; g < group_count; ++g) {
+      auto schedule_it = group_schedules[g].begin();
+      for (FunctionBase* f : groups[g]) {
+        schedules.emplace(f, std::move(*schedule_it++));
       }
     }
-    XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        options.synthesizer == nullptr
-            ? RunPipelineSchedule(f, *options.delay_estimator,
-                                  scheduling_options, elab_opt)
-            : RunPipelineScheduleWithFdo(f, *options.delay_estimator,
-                                         scheduling_options,
-                                         *options.synthesizer, elab_opt));
+  }
+
+  // Install the schedules in the original order, so errors are reported as
+  // they would be by a sequential run.
+  for (FunctionBase* f : functions) {
+    absl::flat_hash_map<Node*, int64_t> schedule_cycle_map_before;
+    auto schedule_itr = unit->schedules().find(f);
+    if (schedule_itr != unit->schedules().end()) {
+      schedule_cycle_map_before = schedule_itr->second.GetCycleMap();
+    }
+    auto it = schedules.find(f);
+    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
+                         it == schedules.end() ? schedule_function(f)
+                                               : std::move(it->second));
 
     // Compute `changed` before moving schedule into unit->schedules.
     changed = changed || (schedule_cycle_map_before != schedule.GetCycleMap());
@@ -14,14 +14,17 @@
 
 #include "xls/scheduling/pipeline_scheduling_pass.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -247,6 +250,60 @@ TEST_F(PipelineSchedulingPassTest, MultipleProcsWithIOConstraint) {
                                    Eq(2)))))))));
 }
 
+TEST_F(PipelineSchedulingPassTest, ParallelSchedulingMatchesSequential) {
+  auto p = CreatePackage();
+  std::vector<Proc*> procs;
+  std::vector<Channel*> channels;
+  for (int64_t i = 0; i <= 6; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * ch,
+        p->CreateStreamingChannel(absl::StrCat("ch", i),
+                                  i == 0   ? ChannelOps::kReceiveOnly
+                                  : i == 6 ? ChannelOps::kSendOnly
+                                           : ChannelOps::kSendReceive,
+                                  p->GetBitsType(32)));
+    channels.push_back(ch);
+  }
+  for (int64_t i = 0; i < 6; ++i) {
+    ProcBuilder pb(absl::StrCat("proc", i), p.get());
+    BValue tok = pb.Literal(Value::Token());
+    BValue recv = pb.Receive(channels[i], tok, SourceInfo(), "recv");
+    BValue data = pb.TupleIndex(recv, 1);
+    for (int64_t j = 0; j < i; ++j) {
+      data = pb.UMul(data, data);
+    }
+    pb.Send(channels[i + 1], pb.TupleIndex(recv, 0), data, SourceInfo(),
+            "send");
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+    procs.push_back(proc);
+  }
+  // Links proc0, proc1 and proc2 (the users of ch1 and ch2), which are then
+  // scheduled together.
+  SchedulingOptions options =
+      SchedulingOptions().pipeline_stages(4).add_constraint(IOConstraint(
+          /*source_channel=*/"ch1", /*source_direction=*/IODirection::kSend,
+          /*target_channel=*/"ch2", /*target_direction=*/IODirection::kSend,
+          /*minimum_latency=*/0, /*maximum_latency=*/3));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RunResultT sequential,
+      RunPipelineSchedulingPass(p.get(), SchedulingOptions(options)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RunResultT parallel,
+      RunPipelineSchedulingPass(
+          p.get(), SchedulingOptions(options).scheduling_threads(4)));
+  EXPECT_TRUE(parallel.first);
+  for (Proc* proc : procs) {
+    ASSERT_TRUE(sequential.second.schedules().contains(proc));
+    ASSERT_TRUE(parallel.second.schedules().contains(proc));
+    EXPECT_THAT(parallel.second.schedules().at(proc),
+                VerifiedPipelineSchedule());
+    EXPECT_EQ(parallel.second.schedules().at(proc).GetCycleMap(),
+              sequential.second.schedules().at(proc).GetCycleMap())
+        << proc->name();
+  }
+}
+
 TEST_F(PipelineSchedulingPassTest, FdoWithMultipleProcs) {
   auto p = CreatePackage();
   auto make_func =
@@ -26,6 +26,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/base/log_severity.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -42,6 +43,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/fdo/delay_manager.h"
 #include "xls/fdo/iterative_sdc_scheduler.h"
 #include "xls/fdo/synthesizer.h"
@@ -56,8 +58,10 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/scheduling/list_scheduler.h"
 #include "xls/scheduling/min_cut_scheduler.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/schedule_util.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -162,35 +166,6 @@ absl::Status TightenBounds(sched::ScheduleBounds& bounds, FunctionBase* f,
   return absl::OkStatus();
 }
 
-// Returns the critical path through the given nodes (ordered topologically),
-// ignoring nodes that will be dead after synthesis.
-absl::StatusOr<int64_t> ComputeCriticalPath(
-    absl::Span<Node* const> topo_sort,
-    const absl::flat_hash_set<Node*> dead_after_synthesis,
-    const DelayEstimator& delay_estimator) {
-  int64_t function_cp = 0;
-  absl::flat_hash_map<Node*, int64_t> node_cp;
-  for (Node* node : topo_sort) {
-    if (dead_after_synthesis.contains(node)) {
-      continue;
-    }
-    int64_t node_start = 0;
-    for (Node* operand : node->operands()) {
-      node_start = std::max(node_start, node_cp[operand]);
-    }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator.GetOperationDelayInPs(node));
-    node_cp[node] = node_start + node_delay;
-    function_cp = std::max(function_cp, node_cp[node]);
-  }
-  return function_cp;
-}
-absl::StatusOr<int64_t> ComputeCriticalPath(
-    FunctionBase* f, const DelayEstimator& delay_estimator) {
-  return ComputeCriticalPath(TopoSort(f), GetDeadAfterSynthesisNodes(f),
-                             delay_estimator);
-}
-
 // Returns the minimum clock period in picoseconds for which it is feasible to
 // schedule the function into a pipeline with the given number of stages. If
 // `target_clock_period_ps` is specified, will not try to check lower clock
@@ -198,7 +173,7 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     std::optional<int64_t> worst_case_throughput,
-    const DelayEstimator& delay_estimator, SDCScheduler& scheduler,
+    TimingAnalysis& timing_analysis, SDCScheduler& scheduler,
     SchedulingFailureBehavior failure_behavior,
     std::optional<int64_t> target_clock_period_ps = std::nullopt) {
   VLOG(4) << "FindMinimumClockPeriod()";
@@ -206,7 +181,7 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
           << (pipeline_stages.has_value() ? absl::StrCat(*pipeline_stages)
                                           : "(unspecified)");
   XLS_ASSIGN_OR_RETURN(int64_t function_cp_ps,
-                       ComputeCriticalPath(f, delay_estimator));
+                       timing_analysis.GetCriticalPathDelay());
 
   // The upper bound of the search is simply the critical path of the entire
   // function, and the lower bound is the critical path delay evenly distributed
@@ -356,7 +331,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options,
     const std::optional<const ProcElaboration*> elab,
-    const synthesis::Synthesizer* synthesizer) {
+    const synthesis::Synthesizer* synthesizer,
+    TimingAnalysis* timing_analysis) {
   if (!options.pipeline_stages().has_value() &&
       !options.clock_period_ps().has_value()) {
     return absl::InvalidArgumentError(
@@ -380,24 +356,26 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
   // each channel.
   int64_t max_io_delay = std::max(input_delay, output_delay);
 
+  auto io_delay = [&](Node* node) -> int64_t {
+    if (node->Is<ChannelNode>()) {
+      if (IsExternalIoNode(node->As<ChannelNode>(), elab)) {
+        return max_io_delay;
+      }
+      return 0;
+    }
+    if (node->function_base()->IsFunction()) {
+      if (node->Is<Param>()) {
+        return input_delay;
+      }
+      if (node->function_base()->AsFunctionOrDie()->return_value() == node) {
+        return output_delay;
+      }
+    }
+    return 0;
+  };
   DecoratingDelayEstimator io_delay_added(
       "io_delay_added", delay_estimator, [&](Node* node, int64_t base_delay) {
-        if (node->Is<ChannelNode>()) {
-          if (IsExternalIoNode(node->As<ChannelNode>(), elab)) {
-            return base_delay + max_io_delay;
-          }
-          return base_delay;
-        }
-        if (node->function_base()->IsFunction()) {
-          if (node->Is<Param>()) {
-            return base_delay + input_delay;
-          }
-          if (node->function_base()->AsFunctionOrDie()->return_value() ==
-              node) {
-            return base_delay + output_delay;
-          }
-        }
-        return base_delay;
+        return base_delay + io_delay(node);
       });
 
   if (options.worst_case_throughput().has_value()) {
@@ -423,11 +401,53 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
     return schedule;
   }
 
+  // The SDC scheduler, the FDO delay manager and the critical-path bounds all
+  // read from one timing analysis, shared with the caller if they supplied
+  // one. It sees the same I/O delays as `io_delay_added`, and nodes which will
+  // be dead after synthesis cost nothing; the caller's own overrides are put
+  // back once we're done.
+  std::optional<TimingAnalysis> owned_timing_analysis;
+  if (timing_analysis == nullptr) {
+    owned_timing_analysis.emplace(f, delay_estimator);
+    timing_analysis = &*owned_timing_analysis;
+  }
+  XLS_RET_CHECK_EQ(timing_analysis->function_base(), f);
+  absl::flat_hash_map<Node*, int64_t> previous_overrides =
+      timing_analysis->delay_overrides();
+  std::vector<Node*> adjusted_nodes;
+  absl::Cleanup restore_overrides = [&] {
+    for (Node* node : adjusted_nodes) {
+      auto it = previous_overrides.find(node);
+      if (it == previous_overrides.end()) {
+        timing_analysis->ClearNodeDelay(node);
+      } else {
+        timing_analysis->SetNodeDelay(node, it->second);
+      }
+    }
+  };
+  absl::flat_hash_set<Node*> dead_after_synthesis =
+      GetDeadAfterSynthesisNodes(f);
+  for (Node* node : f->nodes()) {
+    if (dead_after_synthesis.contains(node)) {
+      adjusted_nodes.push_back(node);
+      timing_analysis->SetNodeDelay(node, 0);
+      continue;
+    }
+    int64_t extra_delay = io_delay(node);
+    if (extra_delay == 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t base_delay,
+                         timing_analysis->GetNodeDelay(node));
+    adjusted_nodes.push_back(node);
+    timing_analysis->SetNodeDelay(node, base_delay + extra_delay);
+  }
+
   std::unique_ptr<SDCScheduler> sdc_scheduler;
   auto initialize_sdc_scheduler = [&]() -> absl::Status {
     if (sdc_scheduler == nullptr) {
       XLS_ASSIGN_OR_RETURN(sdc_scheduler,
-                           SDCScheduler::Create(f, io_delay_added));
+                           SDCScheduler::Create(f, *timing_analysis));
       XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
     }
     return absl::OkStatus();
@@ -470,7 +490,7 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
             f, options.pipeline_stages(),
             /*worst_case_throughput=*/f->IsProc() ? f->GetInitiationInterval()
                                                   : std::nullopt,
-            io_delay_added, *sdc_scheduler, options.failure_behavior()));
+            *timing_analysis, *sdc_scheduler, options.failure_behavior()));
     min_clock_period_ps_for_tracing = clock_period_ps;
 
     if (options.period_relaxation_percent().has_value()) {
@@ -545,15 +565,18 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
       isdc_options.path_evaluate_strategy =
           options.fdo_path_evaluate_strategy();
 
-      DelayManager delay_manager(f, delay_estimator);
+      DelayManager delay_manager(f, *timing_analysis);
+      SdcSolverMetricsProto isdc_metrics;
       XLS_ASSIGN_OR_RETURN(
           cycle_map,
           ScheduleByIterativeSDC(f, options.pipeline_stages(), clock_period_ps,
                                  delay_manager, options.constraints(),
-                                 isdc_options, options.failure_behavior()));
+                                 isdc_options, options.failure_behavior(),
+                                 &isdc_metrics));
 
       // Use delay manager for scheduling timing verification.
       auto schedule = PipelineSchedule(f, cycle_map, options.pipeline_stages());
+      schedule.set_sdc_solver_metrics(std::move(isdc_metrics));
       XLS_RETURN_IF_ERROR(schedule.Verify());
       XLS_RETURN_IF_ERROR(
           schedule.VerifyTiming(clock_period_ps, delay_manager));
@@ -592,7 +615,7 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
           XLS_RETURN_IF_ERROR(initialize_sdc_scheduler());
           absl::StatusOr<int64_t> min_clock_period_ps = FindMinimumClockPeriod(
               f, options.pipeline_stages(), worst_case_throughput,
-              io_delay_added, *sdc_scheduler, options.failure_behavior(),
+              *timing_analysis, *sdc_scheduler, options.failure_behavior(),
               target_clock_period_ps);
           if (min_clock_period_ps.ok()) {
             min_clock_period_ps_for_tracing = *min_clock_period_ps;
@@ -619,7 +642,7 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
 
         // Check if just increasing the clock period would have helped.
         XLS_ASSIGN_OR_RETURN(int64_t pessimistic_clock_period_ps,
-                             ComputeCriticalPath(f, io_delay_added));
+                             timing_analysis->GetCriticalPathDelay());
         // Make a copy of failure behavior with explain_feasibility true- we
         // always want to produce an error message because this we are
         // re-running the scheduler for its error message.
@@ -660,6 +683,12 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
     // chosen scheduler.
     sched::ScheduleBounds bounds(f, TopoSort(f), clock_period_ps,
                                  io_delay_added);
+    if (options.strategy() == SchedulingStrategy::LIST) {
+      // Let the pipeline length account for any minimum latencies between
+      // sends and receives.
+      XLS_RETURN_IF_ERROR(TightenBoundsForLatencyConstraints(
+          f, options.constraints(), &bounds));
+    }
     XLS_RETURN_IF_ERROR(TightenBounds(bounds, f, options.pipeline_stages()));
 
     if (options.strategy() == SchedulingStrategy::MIN_CUT) {
@@ -669,6 +698,29 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
               f,
               options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
               clock_period_ps, io_delay_added, &bounds, options.constraints()));
+    } else if (options.strategy() == SchedulingStrategy::LIST) {
+      const int64_t pipeline_stages =
+          options.pipeline_stages().value_or(bounds.max_lower_bound() + 1);
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          ListScheduler(f, pipeline_stages, clock_period_ps, io_delay_added,
+                        &bounds, options.constraints()));
+      if (options.list_scheduling_lp_refinement()) {
+        // The list schedule fixes the pipeline length, which spares the LP the
+        // search for it.
+        XLS_RETURN_IF_ERROR(initialize_sdc_scheduler());
+        absl::StatusOr<ScheduleCycleMap> refined = sdc_scheduler->Schedule(
+            pipeline_stages, clock_period_ps,
+            /*failure_behavior=*/{.explain_infeasibility = false},
+            /*check_feasibility=*/false, worst_case_throughput);
+        if (refined.ok()) {
+          cycle_map = *std::move(refined);
+        } else {
+          VLOG(2) << "LP refinement of the list schedule for '" << f->name()
+                  << "' failed; keeping the list schedule: "
+                  << refined.status();
+        }
+      }
     } else if (options.strategy() == SchedulingStrategy::RANDOM) {
       std::mt19937_64 gen(options.seed().value_or(0));
 
@@ -695,6 +747,9 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
 
   auto schedule = PipelineSchedule(f, cycle_map, options.pipeline_stages(),
                                    min_clock_period_ps_for_tracing);
+  if (sdc_scheduler != nullptr) {
+    schedule.set_sdc_solver_metrics(sdc_scheduler->metrics());
+  }
   XLS_RETURN_IF_ERROR(schedule.Verify());
   XLS_RETURN_IF_ERROR(schedule.VerifyTiming(clock_period_ps, io_delay_added));
   XLS_RETURN_IF_ERROR(schedule.VerifyConstraints(options.constraints(),
@@ -709,17 +764,19 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
 absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options,
-    std::optional<const ProcElaboration*> elab) {
+    std::optional<const ProcElaboration*> elab,
+    TimingAnalysis* timing_analysis) {
   return RunPipelineScheduleInternal(f, delay_estimator, options, elab,
-                                     /*synthesizer=*/nullptr);
+                                     /*synthesizer=*/nullptr, timing_analysis);
 }
 
 absl::StatusOr<PipelineSchedule> RunPipelineScheduleWithFdo(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options, const synthesis::Synthesizer& synthesizer,
-    std::optional<const ProcElaboration*> elab) {
+    std::optional<const ProcElaboration*> elab,
+    TimingAnalysis* timing_analysis) {
   return RunPipelineScheduleInternal(f, delay_estimator, options, elab,
-                                     &synthesizer);
+                                     &synthesizer, timing_analysis);
 }
 
 }  // namespace xls
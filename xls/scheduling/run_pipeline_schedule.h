@@ -19,6 +19,7 @@
 
 #include "absl/status/statusor.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/proc_elaboration.h"
@@ -30,16 +31,22 @@ namespace xls {
 // Produces a pipeline schedule using the given delay model and scheduling
 // options. `elab` must be specified if scheduling a proc with proc-scoped
 // channels.
+//
+// If `timing_analysis` is given it must be an analysis of `f` over
+// `delay_estimator`; the scheduler reads its delays from it instead of
+// building its own, and leaves its delay overrides as it found them.
 absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options,
-    std::optional<const ProcElaboration*> elab = std::nullopt);
+    std::optional<const ProcElaboration*> elab = std::nullopt,
+    TimingAnalysis* timing_analysis = nullptr);
 
 // Produce a pipeline schedule using feedback-directed scheduling.
 absl::StatusOr<PipelineSchedule> RunPipelineScheduleWithFdo(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options, const synthesis::Synthesizer& synthesizer,
-    std::optional<const ProcElaboration*> elab = std::nullopt);
+    std::optional<const ProcElaboration*> elab = std::nullopt,
+    TimingAnalysis* timing_analysis = nullptr);
 
 }  // namespace xls
 
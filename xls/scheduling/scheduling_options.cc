@@ -16,18 +16,27 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/estimators/estimate_cache.h"
 #include "xls/ir/package.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
 
@@ -234,14 +243,78 @@ absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
 
   scheduling_options.schedule_all_procs(proto.multi_proc());
 
+  if (proto.has_scheduling_threads()) {
+    scheduling_options.scheduling_threads(proto.scheduling_threads());
+  }
+
   return scheduling_options;
 }
 
+// The memoizing delay estimators made by SetUpDelayEstimator, by estimate cache
+// path. They live for the rest of the process, like the estimators they wrap.
+struct MemoizedDelayEstimators {
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, std::unique_ptr<MemoizingDelayEstimator>>
+      by_path ABSL_GUARDED_BY(mutex);
+};
+
+MemoizedDelayEstimators& GetMemoizedDelayEstimators() {
+  static absl::NoDestructor<MemoizedDelayEstimators> memoized;
+  return *memoized;
+}
+
 }  // namespace
 
 absl::StatusOr<DelayEstimator*> SetUpDelayEstimator(
     const SchedulingOptionsFlagsProto& flags) {
-  return GetDelayEstimator(flags.delay_model());
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                       GetDelayEstimator(flags.delay_model()));
+  if (flags.estimate_cache_path().empty()) {
+    return delay_estimator;
+  }
+
+  MemoizedDelayEstimators& memoized = GetMemoizedDelayEstimators();
+  absl::MutexLock lock(&memoized.mutex);
+  auto it = memoized.by_path.find(flags.estimate_cache_path());
+  if (it != memoized.by_path.end()) {
+    if (it->second->name() != delay_estimator->name()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Estimate cache %s is already in use by delay model `%s`, not `%s`",
+          flags.estimate_cache_path(), it->second->name(),
+          delay_estimator->name()));
+    }
+    return it->second.get();
+  }
+  // The memoizing estimator takes the name of the delay model, as that is what
+  // is reported in codegen metrics.
+  auto memoizing = std::make_unique<MemoizingDelayEstimator>(
+      delay_estimator->name(), *delay_estimator);
+  if (FileExists(flags.estimate_cache_path()).ok()) {
+    XLS_RETURN_IF_ERROR(memoizing->cache().Load(flags.estimate_cache_path()));
+    VLOG(1) << absl::StreamFormat("Loaded %d delay estimates from %s",
+                                  memoizing->cache().size(),
+                                  flags.estimate_cache_path());
+  }
+  DelayEstimator* result = memoizing.get();
+  memoized.by_path.emplace(flags.estimate_cache_path(), std::move(memoizing));
+  return result;
+}
+
+absl::Status SaveDelayEstimateCache(const SchedulingOptionsFlagsProto& flags) {
+  if (flags.estimate_cache_path().empty()) {
+    return absl::OkStatus();
+  }
+  MemoizedDelayEstimators& memoized = GetMemoizedDelayEstimators();
+  absl::MutexLock lock(&memoized.mutex);
+  auto it = memoized.by_path.find(flags.estimate_cache_path());
+  if (it == memoized.by_path.end()) {
+    return absl::OkStatus();
+  }
+  const EstimateCache<int64_t>& cache = it->second->cache();
+  VLOG(1) << absl::StreamFormat(
+      "Saving %d delay estimates to %s (%d hits, %d misses)", cache.size(),
+      flags.estimate_cache_path(), cache.hits(), cache.misses());
+  return cache.Save(flags.estimate_cache_path());
 }
 
 absl::StatusOr<bool> IsDelayModelSpecifiedViaFlag(
@@ -50,6 +50,12 @@ enum class SchedulingStrategy : int8_t {
 
   // Create a random but sound schedule. This is useful for testing.
   RANDOM,
+
+  // Approximately minimize the number of pipeline registers using iterative
+  // list scheduling, which takes near-linear time in the size of the function
+  // and so scales to functions too large to schedule with SDC. Optionally
+  // refined with an LP solve; see `list_scheduling_lp_refinement`.
+  LIST,
 };
 
 enum class PathEvaluateStrategy : int8_t {
@@ -249,7 +255,9 @@ class SchedulingOptions {
         fdo_refinement_stochastic_ratio_(1.0),
         fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
         fdo_synthesizer_name_("yosys"),
-        schedule_all_procs_(false) {}
+        schedule_all_procs_(false),
+        scheduling_threads_(1),
+        list_scheduling_lp_refinement_(false) {}
 
   // Returns the scheduling strategy.
   SchedulingStrategy strategy() const { return strategy_; }
@@ -534,6 +542,27 @@ class SchedulingOptions {
   }
   bool schedule_all_procs() const { return schedule_all_procs_; }
 
+  // Sets/gets the number of threads used to schedule the procs of a package.
+  // Procs are scheduled independently unless an IOConstraint relates their
+  // channels, so with more than one thread independent procs are scheduled
+  // concurrently. The resulting schedules do not depend on the thread count.
+  SchedulingOptions& scheduling_threads(int64_t value) {
+    scheduling_threads_ = value;
+    return *this;
+  }
+  int64_t scheduling_threads() const { return scheduling_threads_; }
+
+  // Sets/gets whether a schedule found by the LIST strategy is refined by
+  // solving the SDC linear program at the same pipeline length. If the solve
+  // fails, the list schedule is kept.
+  SchedulingOptions& list_scheduling_lp_refinement(bool value) {
+    list_scheduling_lp_refinement_ = value;
+    return *this;
+  }
+  bool list_scheduling_lp_refinement() const {
+    return list_scheduling_lp_refinement_;
+  }
+
  private:
   SchedulingStrategy strategy_;
   int64_t opt_level_;
@@ -567,6 +596,8 @@ class SchedulingOptions {
   std::string fdo_default_driver_cell_;
   std::string fdo_default_load_;
   bool schedule_all_procs_;
+  int64_t scheduling_threads_;
+  bool list_scheduling_lp_refinement_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
@@ -575,8 +606,16 @@ using ScheduleCycleMap = absl::flat_hash_map<Node*, int64_t>;
 absl::StatusOr<SchedulingOptions> SetUpSchedulingOptions(
     const SchedulingOptionsFlagsProto& flags, Package* p);
 
+// Returns the delay estimator named by `flags`. If `flags` also names an
+// estimate cache, the estimator memoizes its estimates, starting from those in
+// the cache file if it exists; SaveDelayEstimateCache writes them back.
 absl::StatusOr<DelayEstimator*> SetUpDelayEstimator(
     const SchedulingOptionsFlagsProto& flags);
+
+// Writes the estimates memoized by the delay estimator which
+// SetUpDelayEstimator returned for `flags` to the estimate cache file. Does
+// nothing if `flags` names no estimate cache, or no such estimator was set up.
+absl::Status SaveDelayEstimateCache(const SchedulingOptionsFlagsProto& flags);
 absl::StatusOr<bool> IsDelayModelSpecifiedViaFlag(
     const SchedulingOptionsFlagsProto& flags);
 
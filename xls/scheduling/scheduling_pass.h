@@ -23,6 +23,7 @@
 
 #include "absl/status/statusor.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
@@ -91,6 +92,10 @@ struct SchedulingPassOptions : public PassOptionsBase {
   // Delay estimator to use for scheduling.
   const DelayEstimator* delay_estimator = nullptr;
   const synthesis::Synthesizer* synthesizer = nullptr;
+
+  // Optional timing analysis over `delay_estimator`, reused when scheduling
+  // the function or proc it analyzes instead of building a fresh one.
+  TimingAnalysis* timing_analysis = nullptr;
 };
 
 using SchedulingPassResults = PassResults;
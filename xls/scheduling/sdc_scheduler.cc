@@ -34,10 +34,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -46,6 +49,7 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/state_element.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/schedule_util.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "ortools/math_opt/cpp/math_opt.h"
@@ -55,83 +59,10 @@ namespace xls {
 namespace {
 
 using DelayMap = absl::flat_hash_map<Node*, int64_t>;
+using DistancesToNode =
+    absl::flat_hash_map<Node*, TimingAnalysis::DistanceMap>;
 namespace math_opt = ::operations_research::math_opt;
 
-// A helper function to compute each node's delay by calling the delay
-// estimator; treats all dead-after-synthesis nodes as having a delay of 0.
-absl::StatusOr<DelayMap> ComputeNodeDelays(
-    FunctionBase* f, const absl::flat_hash_set<Node*>& dead_after_synthesis,
-    const DelayEstimator& delay_estimator) {
-  DelayMap result;
-  for (Node* node : f->nodes()) {
-    if (dead_after_synthesis.contains(node)) {
-      result[node] = 0;
-    } else {
-      XLS_ASSIGN_OR_RETURN(result[node],
-                           delay_estimator.GetOperationDelayInPs(node));
-    }
-  }
-  return result;
-}
-
-// Compute all-pairs longest distance between all nodes in `f`. The distance
-// from node `a` to node `b` is defined as the length of the longest delay path
-// from `a`'s start to `b`'s end, which includes the delay of the path endpoints
-// `a` and `b`. The all-pairs distance is stored in the map of maps
-// `distances_to_node` where `distances_to_node[y][x]` (if present) is the
-// critical-path distance from `x` to `y`.
-absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
-                        const DelayMap& delay_map) {
-  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-      distances_to_node;
-  distances_to_node.reserve(f->node_count());
-  for (Node* node : topo_sort) {
-    // Initialize the distance map entry to an empty map.
-    distances_to_node[node];
-  }
-
-  for (Node* node : topo_sort) {
-    absl::flat_hash_map<Node*, int64_t>& distances = distances_to_node.at(node);
-
-    // The critical path from `node` to `node` is always `node_delay` long.
-    int64_t node_delay = delay_map.at(node);
-    distances_to_node.at(node)[node] = node_delay;
-
-    // Compute the critical-path distance from `a` to `node` for all descendants
-    // `a` of each operand, extending the critical path from `a` to each operand
-    // of `node` by `node_delay`.
-    for (Node* operand : node->operands()) {
-      for (auto [a, operand_distance] : distances_to_node.at(operand)) {
-        auto [it, newly_reachable] =
-            distances.try_emplace(a, operand_distance + node_delay);
-        if (!newly_reachable) {
-          if (it->second >= operand_distance + node_delay) {
-            continue;
-          }
-          it->second = operand_distance + node_delay;
-        }
-      }
-    }
-  }
-
-  if (VLOG_IS_ON(4)) {
-    VLOG(4) << "All-pairs critical-path distances:";
-    for (Node* target : topo_sort) {
-      VLOG(4) << absl::StrFormat("  distances to %s:", target->GetName());
-      for (Node* source : topo_sort) {
-        VLOG(4) << absl::StrFormat(
-            "    %s -> %s : %s", source->GetName(), target->GetName(),
-            distances_to_node.at(target).contains(source)
-                ? absl::StrCat(distances_to_node.at(target).at(source))
-                : "(none)");
-      }
-    }
-  }
-
-  return distances_to_node;
-}
-
 // Returns the minimal set of schedule constraints which ensure that no
 // combinational path in the schedule exceeds `clock_period_ps`. The returned
 // map has a (potentially empty) vector entry for each node in `f`. The map
@@ -150,9 +81,7 @@ ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
 absl::flat_hash_map<Node*, std::vector<Node*>>
 ComputeCombinationalDelayConstraints(
     FunctionBase* f, absl::Span<Node* const> topo_sort, int64_t clock_period_ps,
-    const absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>&
-        distances_to_node,
-    const DelayMap& delay_map) {
+    const DistancesToNode& distances_to_node, const DelayMap& delay_map) {
   absl::flat_hash_map<Node*, std::vector<Node*>> result;
   result.reserve(f->node_count());
   for (Node* a : topo_sort) {
@@ -193,21 +122,21 @@ ComputeCombinationalDelayConstraints(
 
 SDCSchedulingModel::SDCSchedulingModel(
     FunctionBase* func, absl::flat_hash_set<Node*> dead_after_synthesis,
-    const DelayMap& delay_map, std::string_view model_name)
+    const DelayMap& delay_map, DistancesToNode distances_to_node,
+    std::string_view model_name)
     : func_(func),
       topo_sort_(TopoSort(func_)),
       dead_after_synthesis_(dead_after_synthesis),
       model_(model_name),
       delay_map_(delay_map),
+      distances_to_node_(std::move(distances_to_node)),
       last_stage_(model_.AddContinuousVariable(0.0, kMaxStages, "last_stage")),
       cycle_at_sinknode_(model_.AddContinuousVariable(-kInfinity, kInfinity,
                                                       "cycle_at_sinknode")) {
-  // when subclassed for Iterative SDC, delay_map_ and distances_to_node_
-  // are not used.
-  if (!delay_map_.empty()) {
-    distances_to_node_ = ComputeDistancesToNodes(func_, topo_sort_, delay_map_);
-  }
+  absl::Time start = absl::Now();
 
+  // When subclassed for Iterative SDC, delay_map_ and distances_to_node_ are
+  // empty and unused.
   for (Node* node : topo_sort_) {
     cycle_var_.emplace(
         node, model_.AddContinuousVariable(0.0, kMaxStages, node->GetName()));
@@ -237,6 +166,7 @@ SDCSchedulingModel::SDCSchedulingModel(
           absl::StrCat("return:", function->return_value()->GetName()));
     }
   }
+  RecordModelBuildTime(absl::Now() - start);
 }
 
 absl::Status SDCSchedulingModel::AddDefUseConstraints(
@@ -524,31 +454,55 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
 }
 
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
+  if (clock_period_ps_ == clock_period_ps) {
+    // Nothing to do; this is common while sweeping other parameters.
+    return;
+  }
+  clock_period_ps_ = clock_period_ps;
+  UpdateTimingConstraints(ComputeCombinationalDelayConstraints(
+      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_));
+}
+
+void SDCSchedulingModel::UpdateTimingConstraints(
+    absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints) {
   absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
       std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
+  delay_constraints_ = std::move(delay_constraints);
 
+  // Visit the sources in topological order so the constraints are added to
+  // the model in a deterministic order.
   for (Node* source : topo_sort_) {
-    if (!prev_delay_constraints.empty()) {
+    auto new_it = delay_constraints_.find(source);
+    if (auto prev_it = prev_delay_constraints.find(source);
+        prev_it != prev_delay_constraints.end()) {
       // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
-      for (Node* target : prev_delay_constraints.at(source)) {
+      absl::flat_hash_set<Node*> new_targets;
+      if (new_it != delay_constraints_.end()) {
+        new_targets.insert(new_it->second.begin(), new_it->second.end());
+      }
+      for (Node* target : prev_it->second) {
         if (new_targets.contains(target)) {
           continue;
         }
 
         // No longer related; remove constraint.
         auto it = timing_constraint_.find(std::make_pair(source, target));
+        if (it == timing_constraint_.end()) {
+          // Already removed; `target` was listed more than once.
+          continue;
+        }
         model_.DeleteLinearConstraint(it->second);
         timing_constraint_.erase(it);
+        metrics_.set_timing_constraints_removed(
+            metrics_.timing_constraints_removed() + 1);
       }
     }
+    if (new_it == delay_constraints_.end()) {
+      continue;
+    }
 
     // Add all new constraints, avoiding duplicates for any that already exist.
-    for (Node* target : delay_constraints_.at(source)) {
+    for (Node* target : new_it->second) {
       auto key = std::make_pair(source, target);
       if (timing_constraint_.contains(key)) {
         continue;
@@ -560,6 +514,8 @@ void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
                                  source->GetName());
       timing_constraint_.emplace(
           key, DiffAtLeastConstraint(target, source, 1, "timing"));
+      metrics_.set_timing_constraints_added(
+          metrics_.timing_constraints_added() + 1);
     }
   }
 }
@@ -578,6 +534,15 @@ absl::Status SDCSchedulingModel::SetWorstCaseThroughput(
   }
 
   proc->SetInitiationInterval(worst_case_throughput);
+  if (worst_case_throughput > 0 && !backedge_constraint_.empty()) {
+    // The constraints are already present; just move their bounds, which lets
+    // the solver warm-start from its previous basis.
+    for (auto& [nodes, constraint] : backedge_constraint_) {
+      model_.set_upper_bound(constraint,
+                             static_cast<double>(worst_case_throughput - 1));
+    }
+    return absl::OkStatus();
+  }
   for (auto& [nodes, constraint] : backedge_constraint_) {
     model_.DeleteLinearConstraint(constraint);
   }
@@ -697,6 +662,39 @@ absl::Status SDCSchedulingModel::AddSlackVariables(
   return absl::OkStatus();
 }
 
+absl::StatusOr<math_opt::SolveResult> SDCSchedulingModel::Solve(
+    math_opt::IncrementalSolver& solver) {
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(math_opt::UpdateResult update, solver.Update());
+  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result,
+                       solver.SolveWithoutUpdate());
+  const absl::Duration solve_time = absl::Now() - start;
+
+  // The first solve always starts from scratch; after that, the solver keeps
+  // its state (including the basis) as long as it supports all the changes
+  // made to the model since the previous solve.
+  const bool warm_started = metrics_.solves() > 0 && update.did_update;
+  metrics_.set_solves(metrics_.solves() + 1);
+  metrics_.set_simplex_iterations(metrics_.simplex_iterations() +
+                                  result.solve_stats.simplex_iterations);
+  if (warm_started) {
+    metrics_.set_warm_started_solves(metrics_.warm_started_solves() + 1);
+  }
+  solve_time_ += solve_time;
+  VLOG(2) << absl::StreamFormat(
+      "SDC solve %d (%s start) took %s and %d simplex iterations; %s spent "
+      "building the model and %s solving so far",
+      metrics_.solves(), warm_started ? "warm" : "cold",
+      absl::FormatDuration(solve_time), result.solve_stats.simplex_iterations,
+      absl::FormatDuration(model_build_time_),
+      absl::FormatDuration(solve_time_));
+  return result;
+}
+
+void SDCSchedulingModel::RecordModelBuildTime(absl::Duration duration) {
+  model_build_time_ += duration;
+}
+
 absl::Status SDCSchedulingModel::ExtractError(
     const math_opt::VariableMap<double>& variable_values) const {
   std::vector<std::string> problems;
@@ -909,26 +907,59 @@ SDCSchedulingModel::AddLowerBoundSlack(
 
 absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Create(
     FunctionBase* f, const DelayEstimator& delay_estimator) {
-  absl::flat_hash_set<Node*> dead_after_synthesis =
-      GetDeadAfterSynthesisNodes(f);
-  XLS_ASSIGN_OR_RETURN(
-      DelayMap delay_map,
-      ComputeNodeDelays(f, dead_after_synthesis, delay_estimator));
-  std::unique_ptr<SDCScheduler> scheduler(new SDCScheduler(
-      f, std::move(dead_after_synthesis), std::move(delay_map)));
+  // Treat all dead-after-synthesis nodes as having a delay of 0.
+  TimingAnalysis timing_analysis(f, delay_estimator);
+  for (Node* node : GetDeadAfterSynthesisNodes(f)) {
+    timing_analysis.SetNodeDelay(node, 0);
+  }
+  return Create(f, timing_analysis);
+}
+
+absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Create(
+    FunctionBase* f, TimingAnalysis& timing_analysis) {
+  XLS_RET_CHECK_EQ(timing_analysis.function_base(), f);
+  DelayMap delay_map;
+  DistancesToNode distances_to_node;
+  delay_map.reserve(f->node_count());
+  distances_to_node.reserve(f->node_count());
+  // Query in topological order so each node's operands are already known.
+  for (Node* node : TopoSort(f)) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay, timing_analysis.GetNodeDelay(node));
+    delay_map[node] = delay;
+    XLS_ASSIGN_OR_RETURN(distances_to_node[node],
+                         timing_analysis.GetDistancesToNode(node));
+  }
+
+  if (VLOG_IS_ON(4)) {
+    VLOG(4) << "All-pairs critical-path distances:";
+    for (Node* target : TopoSort(f)) {
+      VLOG(4) << absl::StrFormat("  distances to %s:", target->GetName());
+      for (const auto& [source, distance] : distances_to_node.at(target)) {
+        VLOG(4) << absl::StrFormat("    %s -> %s : %d", source->GetName(),
+                                   target->GetName(), distance);
+      }
+    }
+  }
+
+  std::unique_ptr<SDCScheduler> scheduler(
+      new SDCScheduler(f, GetDeadAfterSynthesisNodes(f), std::move(delay_map),
+                       std::move(distances_to_node)));
   XLS_RETURN_IF_ERROR(scheduler->Initialize());
   return std::move(scheduler);
 }
 
 SDCScheduler::SDCScheduler(FunctionBase* f,
                            absl::flat_hash_set<Node*> dead_after_synthesis,
-                           DelayMap delay_map)
+                           DelayMap delay_map,
+                           DistancesToNode distances_to_node)
     : f_(f),
       delay_map_(std::move(delay_map)),
       model_(f, std::move(dead_after_synthesis), delay_map_,
+             std::move(distances_to_node),
              absl::StrCat("sdc_model:", f->name())) {}
 
 absl::Status SDCScheduler::Initialize() {
+  absl::Time start = absl::Now();
   XLS_ASSIGN_OR_RETURN(
       solver_, math_opt::NewIncrementalSolver(&model_.UnderlyingModel(),
                                               math_opt::SolverType::kGlop));
@@ -942,14 +973,17 @@ absl::Status SDCScheduler::Initialize() {
     }
   }
 
+  model_.RecordModelBuildTime(absl::Now() - start);
   return absl::OkStatus();
 }
 
 absl::Status SDCScheduler::AddConstraints(
     absl::Span<const SchedulingConstraint> constraints) {
+  absl::Time start = absl::Now();
   for (const SchedulingConstraint& constraint : constraints) {
     XLS_RETURN_IF_ERROR(model_.AddSchedulingConstraint(constraint));
   }
+  model_.RecordModelBuildTime(absl::Now() - start);
   return absl::OkStatus();
 }
 
@@ -965,7 +999,7 @@ absl::Status SDCScheduler::BuildError(
     XLS_RETURN_IF_ERROR(model_.AddSlackVariables(
         failure_behavior.infeasible_per_state_backedge_slack_pool));
     XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result_with_slack,
-                         solver_->Solve());
+                         model_.Solve(*solver_));
     if (result_with_slack.termination.reason ==
             math_opt::TerminationReason::kOptimal ||
         result_with_slack.termination.reason ==
@@ -1000,7 +1034,7 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
     model_.MinimizePipelineLength();
     XLS_ASSIGN_OR_RETURN(
         const math_opt::SolveResult result_with_minimized_pipeline_length,
-        solver_->Solve());
+        model_.Solve(*solver_));
     if (result_with_minimized_pipeline_length.termination.reason !=
         math_opt::TerminationReason::kOptimal) {
       return BuildError(result_with_minimized_pipeline_length,
@@ -1019,7 +1053,7 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
     model_.SetObjective();
   }
 
-  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, solver_->Solve());
+  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, model_.Solve(*solver_));
   if (result.termination.reason == math_opt::TerminationReason::kOptimal ||
       (check_feasibility &&
        result.termination.reason == math_opt::TerminationReason::kFeasible)) {
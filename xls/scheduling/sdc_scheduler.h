@@ -27,10 +27,13 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -40,16 +43,26 @@ namespace xls {
 // class uses the LP solver from OR tools for problem solving. It provides
 // methods to add scheduling constraints, set objectives, and extract solving
 // results.
+//
+// The model is meant to be built once and then re-solved as the clock period,
+// worst-case throughput, or delay estimates change; the corresponding setters
+// only touch the constraints which differ, so an incremental solver can
+// warm-start from the basis of its previous solve.
 class SDCSchedulingModel {
   using DelayMap = absl::flat_hash_map<Node*, int64_t>;
+  using DistancesToNode =
+      absl::flat_hash_map<Node*, TimingAnalysis::DistanceMap>;
 
   static constexpr double kInfinity = std::numeric_limits<double>::infinity();
   static constexpr double kMaxStages = (1 << 20);
 
  public:
+  // `distances_to_node[y][x]` (if present) is the critical-path distance from
+  // `x` to `y`, as given by TimingAnalysis::GetDistancesToNode.
   SDCSchedulingModel(FunctionBase* func,
                      absl::flat_hash_set<Node*> dead_after_synthesis,
                      const DelayMap& delay_map,
+                     DistancesToNode distances_to_node,
                      std::string_view model_name = "");
 
   absl::Status AddDefUseConstraints(Node* node, std::optional<Node*> user);
@@ -66,8 +79,12 @@ class SDCSchedulingModel {
   absl::Status AddSendThenRecvConstraint(
       const SendThenRecvConstraint& constraint);
 
+  // Updates the timing constraints for the given clock period. Constraints
+  // which are needed at both the old and the new clock period are kept.
   void SetClockPeriod(int64_t clock_period_ps);
 
+  // Updates the state backedge constraints for the given worst-case
+  // throughput; if they already exist, only their bounds are changed.
   absl::Status SetWorstCaseThroughput(int64_t worst_case_throughput);
 
   void SetPipelineLength(std::optional<int64_t> pipeline_length);
@@ -83,6 +100,17 @@ class SDCSchedulingModel {
   absl::Status AddSlackVariables(
       std::optional<double> infeasible_per_state_backedge_slack_pool);
 
+  // Brings `solver` up to date with the model and solves it, recording
+  // statistics about the solve in metrics() and logging its time.
+  absl::StatusOr<operations_research::math_opt::SolveResult> Solve(
+      operations_research::math_opt::IncrementalSolver& solver);
+
+  // Records time spent building the model (outside of the constructor, which
+  // records its own time).
+  void RecordModelBuildTime(absl::Duration duration);
+
+  const SdcSolverMetricsProto& metrics() const { return metrics_; }
+
   operations_research::math_opt::Model& UnderlyingModel() { return model_; }
   const operations_research::math_opt::Model& UnderlyingModel() const {
     return model_;
@@ -121,6 +149,14 @@ class SDCSchedulingModel {
   operations_research::math_opt::LinearConstraint DiffEqualsConstraint(
       Node* x, Node* y, int64_t diff, std::string_view name);
 
+ protected:
+  // Replaces the timing constraints with the given ones, where each
+  // `delay_constraints[a]` lists the nodes which must be scheduled in a later
+  // stage than `a`. Constraints already present in the model are kept, so that
+  // only the difference is passed on to the solver.
+  void UpdateTimingConstraints(
+      absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints);
+
  private:
   operations_research::math_opt::Variable AddUpperBoundSlack(
       operations_research::math_opt::LinearConstraint c,
@@ -160,8 +196,7 @@ class SDCSchedulingModel {
   // Stores the critical-path distances between all pairs of Nodes; if there is
   // a path from `x` to `y`, `distances_to_node_[y][x]` is the length of the
   // critical path.
-  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-      distances_to_node_;
+  DistancesToNode distances_to_node_;
 
   operations_research::math_opt::Variable last_stage_;
   std::optional<operations_research::math_opt::Variable> last_stage_slack_;
@@ -179,8 +214,10 @@ class SDCSchedulingModel {
   // data-dependence graph.
   operations_research::math_opt::Variable cycle_at_sinknode_;
 
-  // A cache of the delay constraints.
+  // A cache of the delay constraints, and the clock period they were computed
+  // for (if any).
   absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
+  std::optional<int64_t> clock_period_ps_;
 
   absl::flat_hash_map<std::pair<Node*, Node*>,
                       operations_research::math_opt::LinearConstraint>
@@ -210,15 +247,29 @@ class SDCSchedulingModel {
     operations_research::math_opt::Variable max;
   };
   absl::flat_hash_map<IOConstraint, SlackPair> io_slack_;
+
+  SdcSolverMetricsProto metrics_;
+  // Wall-clock times, which are only logged (see Solve).
+  absl::Duration model_build_time_ = absl::ZeroDuration();
+  absl::Duration solve_time_ = absl::ZeroDuration();
 };
 
 class SDCScheduler {
   using DelayMap = absl::flat_hash_map<Node*, int64_t>;
+  using DistancesToNode =
+      absl::flat_hash_map<Node*, TimingAnalysis::DistanceMap>;
 
  public:
   static absl::StatusOr<std::unique_ptr<SDCScheduler>> Create(
       FunctionBase* f, const DelayEstimator& delay_estimator);
 
+  // Creates a scheduler whose delays and path constraints come from
+  // `timing_analysis`, which must analyze `f`. Nodes which are dead after
+  // synthesis should have their delays overridden with 0 in the analysis, as
+  // the overload above does.
+  static absl::StatusOr<std::unique_ptr<SDCScheduler>> Create(
+      FunctionBase* f, TimingAnalysis& timing_analysis);
+
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
 
@@ -251,9 +302,13 @@ class SDCScheduler {
       bool check_feasibility = false,
       std::optional<int64_t> worst_case_throughput = std::nullopt);
 
+  // Returns statistics about the solves performed so far. Since the model is
+  // reused across calls to Schedule(), these cover all of them.
+  const SdcSolverMetricsProto& metrics() const { return model_.metrics(); }
+
  private:
   SDCScheduler(FunctionBase* f, absl::flat_hash_set<Node*> dead_after_synthesis,
-               DelayMap delay_map);
+               DelayMap delay_map, DistancesToNode distances_to_node);
   absl::Status Initialize();
 
   absl::Status BuildError(
@@ -40,6 +40,7 @@
 #include "xls/common/stopwatch.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/ffi_delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/op.h"
@@ -246,12 +247,13 @@ using PipelineScheduleOrGroup =
 
 absl::StatusOr<PipelineScheduleOrGroup> RunSchedulingPipeline(
     FunctionBase* main, const SchedulingOptions& scheduling_options,
-    const DelayEstimator* delay_estimator,
-    synthesis::Synthesizer* synthesizer) {
+    const DelayEstimator* delay_estimator, synthesis::Synthesizer* synthesizer,
+    TimingAnalysis* timing_analysis) {
   SchedulingPassOptions sched_options;
   sched_options.scheduling_options = scheduling_options;
   sched_options.delay_estimator = delay_estimator;
   sched_options.synthesizer = synthesizer;
+  sched_options.timing_analysis = timing_analysis;
   OptimizationContext optimization_context;
   std::unique_ptr<SchedulingCompoundPass> scheduling_pipeline =
       CreateSchedulingPassPipeline(optimization_context,
@@ -418,7 +420,8 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
 absl::StatusOr<PipelineScheduleOrGroup> Schedule(
     Package* p, const SchedulingOptions& scheduling_options,
-    const DelayEstimator* delay_estimator, absl::Duration* scheduling_time) {
+    const DelayEstimator* delay_estimator, absl::Duration* scheduling_time,
+    TimingAnalysis* timing_analysis) {
   QCHECK(scheduling_options.pipeline_stages() != 0 ||
          scheduling_options.clock_period_ps() != 0)
       << "Must specify --pipeline_stages or --clock_period_ps (or both).";
@@ -431,8 +434,9 @@ absl::StatusOr<PipelineScheduleOrGroup> Schedule(
       !scheduling_options.fdo_synthesizer_name().empty()) {
     XLS_ASSIGN_OR_RETURN(synthesizer, SetUpSynthesizer(scheduling_options));
   }
-  absl::StatusOr<PipelineScheduleOrGroup> result = RunSchedulingPipeline(
-      *p->GetTop(), scheduling_options, delay_estimator, synthesizer);
+  absl::StatusOr<PipelineScheduleOrGroup> result =
+      RunSchedulingPipeline(*p->GetTop(), scheduling_options, delay_estimator,
+                            synthesizer, timing_analysis);
   if (scheduling_time != nullptr) {
     *scheduling_time = stopwatch->GetElapsedTime();
   }
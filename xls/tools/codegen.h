@@ -20,6 +20,7 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_analysis.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
@@ -35,10 +36,14 @@ namespace xls {
 using PipelineScheduleOrGroup =
     std::variant<PipelineSchedule, PackagePipelineSchedules>;
 
+// Schedules the top of `p`. If `timing_analysis` is given, it must be an
+// analysis over `delay_estimator`; it is reused when scheduling the function or
+// proc it analyzes.
 absl::StatusOr<PipelineScheduleOrGroup> Schedule(
     Package* p, const SchedulingOptions& scheduling_options,
     const DelayEstimator* delay_estimator,
-    absl::Duration* scheduling_time = nullptr);
+    absl::Duration* scheduling_time = nullptr,
+    TimingAnalysis* timing_analysis = nullptr);
 
 struct CodegenResult {
   verilog::ModuleGeneratorResult module_generator_result;
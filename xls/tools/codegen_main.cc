@@ -143,7 +143,7 @@ absl::Status RealMain(std::string_view ir_path) {
   } else {
     XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, result.verilog_text));
   }
-  return absl::OkStatus();
+  return SaveDelayEstimateCache(scheduling_options_flags_proto);
 }
 
 }  // namespace
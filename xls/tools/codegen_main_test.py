@@ -27,6 +27,8 @@ from absl.testing import parameterized
 from xls.codegen import module_signature_pb2
 from xls.common import runfiles
 from xls.common import test_base
+from xls.estimators import estimate_cache_pb2
+from xls.scheduling import pipeline_schedule_pb2
 
 _UPDATE_GOLDEN = flags.DEFINE_bool(
     'test_update_golden_files',
@@ -577,6 +579,58 @@ class CodeGenMainTest(parameterized.TestCase):
       merge = blk.read()
     self.assertNotEqual(no_merge, merge)
 
+  def test_estimate_cache_reused_across_runs(self):
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    cache_path = os.path.join(
+        self.create_tempdir().full_path, 'estimates.textproto'
+    )
+    schedule_file = self.create_tempfile()
+
+    def run_codegen():
+      """Runs codegen_main, returning the scheduled delay of each node."""
+      subprocess.check_call(
+          [
+              CODEGEN_MAIN_PATH,
+              '--generator=pipeline',
+              '--delay_model=unit',
+              '--pipeline_stages=1',
+              '--estimate_cache_path=' + cache_path,
+              '--output_schedule_path=' + schedule_file.full_path,
+              ir_file.full_path,
+          ],
+          stdout=subprocess.DEVNULL,
+      )
+      schedules = text_format.Parse(
+          schedule_file.read_text(),
+          pipeline_schedule_pb2.PackagePipelineSchedulesProto(),
+      )
+      return {
+          timed_node.node: timed_node.node_delay_ps
+          for schedule in schedules.schedules.values()
+          for stage in schedule.stages
+          for timed_node in stage.timed_nodes
+      }
+
+    first_delays = run_codegen()
+    self.assertNotIn(1000, first_delays.values())
+
+    # The first run saved its estimates. Change them, so that the second run
+    # can only report the new delays if it takes them from the cache.
+    with open(cache_path, 'r') as f:
+      cache = text_format.Parse(
+          f.read(), estimate_cache_pb2.EstimateCacheProto()
+      )
+    self.assertEqual(cache.estimator_name, 'unit')
+    self.assertNotEmpty(cache.delays_ps)
+    for signature in cache.delays_ps:
+      cache.delays_ps[signature] = 1000
+    with open(cache_path, 'w') as f:
+      f.write(text_format.MessageToString(cache))
+
+    second_delays = run_codegen()
+    self.assertCountEqual(second_delays.keys(), first_delays.keys())
+    self.assertIn(1000, second_delays.values())
+
 
 if __name__ == '__main__':
   absltest.main()
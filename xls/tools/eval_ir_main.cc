@@ -384,6 +384,11 @@ absl::StatusOr<std::vector<Value>> Eval(
                  /*include_observer_callbacks=*/eval_observer.has_value(),
                  &observer));
   }
+  // The interpreter keeps its node value storage across argument sets.
+  std::optional<PrecompiledFunctionInterpreter> interpreter;
+  if (!use_jit) {
+    interpreter.emplace(f);
+  }
 
   std::vector<Value> results;
   for (const ArgSet& arg_set : arg_sets) {
@@ -420,8 +425,8 @@ absl::StatusOr<std::vector<Value>> Eval(
       // resulting events once the JIT fully supports events. Note: This will
       // require rethinking some of the control flow because event comparison
       // only makes sense for certain modes (optimize_ir and test_llvm_jit).
-      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(InterpretFunction(
-                                       f, arg_set.args, eval_observer)));
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(interpreter->Run(
+                                       arg_set.args, eval_observer)));
     }
     std::cout << result.ToString(FormatPreference::kHex) << '\n';
 
@@ -60,6 +60,7 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
@@ -104,9 +105,14 @@ ABSL_FLAG(std::vector<std::string>, ticks, {},
 ABSL_FLAG(std::string, backend, "serial_jit",
           "Backend to use for evaluation. Valid options are:\n"
           " * serial_jit: JIT-backed single-stepping runtime.\n"
+          " * parallel_jit: JIT-backed runtime which ticks procs on a pool of "
+          "threads.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
           " * block_interpreter: Interpret a block generated from a proc.\n"
           " * block_jit: JIT-backed block execution generated from a proc.");
+ABSL_FLAG(std::optional<int64_t>, parallel_jit_threads, std::nullopt,
+          "Number of threads used by the parallel_jit backend. Defaults to the "
+          "number of available CPUs.");
 ABSL_FLAG(std::string, block_signature_proto, "",
           "Path to textproto file containing signature from codegen");
 ABSL_FLAG(int64_t, max_cycles_no_output, 100,
@@ -227,6 +233,8 @@ static absl::Status LogInterpreterEvents(std::string_view entity_name,
 
 struct EvaluateProcsOptions {
   bool use_jit = false;
+  // Only meaningful with `use_jit`.
+  bool use_parallel_runtime = false;
   bool fail_on_assert = false;
   std::vector<int64_t> ticks = {-1};
   std::optional<std::string> top = std::nullopt;
@@ -239,7 +247,7 @@ static absl::Status EvaluateProcs(
         expected_outputs_for_channels,
     const RamRewritesProto& ram_rewrites,
     const EvaluateProcsOptions& options = {}) {
-  std::unique_ptr<SerialProcRuntime> runtime;
+  std::unique_ptr<ProcRuntime> runtime;
   std::optional<JitRuntime*> jit;
   EvaluatorOptions evaluator_options;
   evaluator_options.set_trace_channels(absl::GetFlag(FLAGS_trace_channels));
@@ -254,7 +262,14 @@ static absl::Status EvaluateProcs(
     }
   }
   evaluator_options.set_support_observers(uses_observers);
-  if (options.use_jit) {
+  if (options.use_jit && options.use_parallel_runtime) {
+    XLS_ASSIGN_OR_RETURN(
+        runtime, CreateJitParallelProcRuntime(
+                     package, evaluator_options,
+                     absl::GetFlag(FLAGS_parallel_jit_threads)));
+    XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
+    jit = &jit_queue->runtime();
+  } else if (options.use_jit) {
     XLS_ASSIGN_OR_RETURN(
         runtime, CreateJitSerialProcRuntime(package, evaluator_options));
     XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
@@ -1185,6 +1200,9 @@ static absl::Status RealMain(
 
   if (backend == "serial_jit") {
     evaluate_procs_options.use_jit = true;
+  } else if (backend == "parallel_jit") {
+    evaluate_procs_options.use_jit = true;
+    evaluate_procs_options.use_parallel_runtime = true;
   } else if (backend == "ir_interpreter") {
     evaluate_procs_options.use_jit = false;
   } else {
@@ -1206,8 +1224,9 @@ int main(int argc, char* argv[]) {
   }
 
   std::string backend = absl::GetFlag(FLAGS_backend);
-  if (backend != "serial_jit" && backend != "ir_interpreter" &&
-      backend != "block_interpreter" && backend != "block_jit") {
+  if (backend != "serial_jit" && backend != "parallel_jit" &&
+      backend != "ir_interpreter" && backend != "block_interpreter" &&
+      backend != "block_jit") {
     LOG(QFATAL) << "Unrecognized backend choice.";
   }
 
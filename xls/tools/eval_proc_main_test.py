@@ -349,6 +349,7 @@ def parameterized_block_backends(func):
 def parameterized_proc_backends(func):
   return parameterized.named_parameters(
       ("serial_jit", ["--backend", "serial_jit"]),
+      ("parallel_jit", ["--backend", "parallel_jit"]),
       ("ir_interpreter", ["--backend", "ir_interpreter"]),
   )(func)
 
@@ -112,6 +112,8 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   pass_options.optimize_for_best_case_throughput =
       options.optimize_for_best_case_throughput;
   pass_options.bisect_limit = options.bisect_limit;
+  pass_options.function_base_threads = options.function_base_threads;
+  pass_options.incremental_fixed_point = options.incremental_fixed_point;
   pass_options.record_metrics = options.metrics != nullptr;
   PassResults results;
   OptimizationContext context;
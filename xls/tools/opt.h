@@ -52,6 +52,8 @@ struct OptOptions {
   std::optional<int64_t> bisect_limit;
   PipelineMetricsProto* metrics = nullptr;
   bool debug_optimizations = false;
+  int64_t function_base_threads = 1;
+  bool incremental_fixed_point = false;
 
   // TODO(allight): adding out-arguments like this (and metrics) is not very
   // clean.
@@ -144,6 +144,16 @@ ABSL_FLAG(bool, debug_optimizations, false,
           "If passed, run additional strict correctness-checking passes; this "
           "slows down the optimization significantly, and is mostly intended "
           "for internal XLS debugging.");
+ABSL_FLAG(int64_t, function_base_threads, 1,
+          "Number of threads used to run function-level passes over the "
+          "functions, procs and blocks of the package. Passes which only "
+          "touch a single function run on several of them at once when this "
+          "is greater than one. The optimized IR does not depend on the "
+          "number of threads.");
+ABSL_FLAG(bool, incremental_fixed_point, false,
+          "If true, fixed-point groups of passes only rerun a pass when the "
+          "nodes it acts on have changed since it last ran without changing "
+          "the IR, rather than rerunning every pass on every iteration.");
 
 namespace xls::tools {
 namespace {
@@ -264,6 +274,8 @@ absl::Status RealMain(std::string_view input_path) {
                        absl::GetFlag(FLAGS_pipeline_metrics_textproto);
 
   bool debug_optimizations = absl::GetFlag(FLAGS_debug_optimizations);
+  int64_t function_base_threads = absl::GetFlag(FLAGS_function_base_threads);
+  bool incremental_fixed_point = absl::GetFlag(FLAGS_incremental_fixed_point);
 
   PassResults results;
   XLS_ASSIGN_OR_RETURN(
@@ -285,6 +297,8 @@ absl::Status RealMain(std::string_view input_path) {
               .bisect_limit = bisect_limit,
               .metrics = wants_metrics ? &metrics : nullptr,
               .debug_optimizations = debug_optimizations,
+              .function_base_threads = function_base_threads,
+              .incremental_fixed_point = incremental_fixed_point,
               .results = &results,
           }));
   VLOG(2) << "Ran " << results.invocations.size() << " passes";
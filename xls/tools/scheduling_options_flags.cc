@@ -42,6 +42,10 @@ ABSL_FLAG(int64_t, pipeline_stages, 0,
           "https://google.github.io/xls/scheduling for details.");
 ABSL_FLAG(std::string, delay_model, "",
           "Delay model name to use from registry.");
+ABSL_FLAG(std::string, estimate_cache_path, "",
+          "If nonempty, path of a file of memoized delay estimates. The file "
+          "is loaded at startup if it exists and is written at exit, so that "
+          "runs with the same delay model share estimates.");
 ABSL_FLAG(int64_t, clock_margin_percent, 0,
           "The percentage of clock period to set aside as a margin to ensure "
           "timing is met. Effectively, this lowers the clock period by this "
@@ -162,6 +166,10 @@ ABSL_FLAG(std::string, fdo_default_load, "",
 // procs.
 ABSL_FLAG(bool, multi_proc, true,
           "If true, schedule all procs and codegen them all.");
+ABSL_FLAG(int64_t, scheduling_threads, 1,
+          "Number of threads to use to schedule the procs of a package. Procs "
+          "which are not related by an IO constraint are scheduled "
+          "concurrently; the schedules do not depend on the thread count.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_providers.bzl,
 //   //docs_src/codegen_options.md
@@ -194,6 +202,7 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(clock_period_ps);
   POPULATE_FLAG(pipeline_stages);
   POPULATE_FLAG(delay_model);
+  POPULATE_FLAG(estimate_cache_path);
   POPULATE_FLAG(clock_margin_percent);
   POPULATE_FLAG(period_relaxation_percent);
   POPULATE_FLAG(minimize_clock_on_failure);
@@ -225,6 +234,7 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_default_driver_cell);
   POPULATE_FLAG(fdo_default_load);
   POPULATE_FLAG(multi_proc);
+  POPULATE_FLAG(scheduling_threads);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
 
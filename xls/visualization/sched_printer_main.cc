@@ -385,7 +385,7 @@ absl::Status RealMain(std::string_view ir_path) {
 
   std::cout << DumpScheduleResultToDot(schedule, delay_map, nodes_on_cp);
 
-  return absl::OkStatus();
+  return SaveDelayEstimateCache(scheduling_options_flags_proto);
 }
 
 }  // namespace